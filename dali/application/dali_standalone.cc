@@ -30,6 +30,7 @@
 #include "dali/common/elapsed_time.h"
 #include "dali/common/helper.h"
 #include "dali/common/logging.h"
+#include "dali/common/profiler.h"
 
 #include "dali/placer.h"
 
@@ -42,6 +43,7 @@ int main(int argc, char *argv[]) {
   // parameters that can be configured via the command line
   std::string lef_file_name;
   std::string def_file_name;
+  std::string bookshelf_file_name;
   std::string cell_file_name;
   std::string m_cell_file_name;
   std::string output_name = "dali_out";
@@ -66,7 +68,18 @@ int main(int argc, char *argv[]) {
   int lg_threads = 1;
   int gb_maxiter = 100;
   bool lg_cplex = false;
+  bool lg_admm = false;
+  double lg_hpwl_weight = 0;
+  int lg_bands = 1;
+  int lg_reorder_range = 3;
+  bool lg_abacus = false;
   int num_threads = 1;
+  std::string gb_config_file_name;
+  std::string str_gb_solver;
+  bool is_gb_incremental = false;
+  std::string prior_pl_file_name;
+  std::string snapshot_file_name;
+  std::string profile_file_name;
 
   // parsing arguments
   for (int i = 1; i < argc;) {
@@ -85,6 +98,13 @@ int main(int argc, char *argv[]) {
         ReportUsage();
         return 1;
       }
+    } else if (arg == "-bookshelf" && i < argc) {
+      bookshelf_file_name = std::string(argv[i++]);
+      if (bookshelf_file_name.empty()) {
+        std::cout << "Invalid input aux file!\n";
+        ReportUsage();
+        return 1;
+      }
     } else if (arg == "-cell" && i < argc) {
       cell_file_name = std::string(argv[i++]);
       if (cell_file_name.empty()) {
@@ -194,6 +214,42 @@ int main(int argc, char *argv[]) {
       }
     } else if (arg == "-lgcplex") {
       lg_cplex = true;
+    } else if (arg == "-lgadmm") {
+      lg_admm = true;
+    } else if (arg == "-lgabacus") {
+      lg_abacus = true;
+    } else if (arg == "-lgbands" && i < argc) {
+      std::string str_lg_bands = std::string(argv[i++]);
+      try {
+        lg_bands = std::max(std::stoi(str_lg_bands), 1);
+      } catch (...) {
+        std::cout << "Invalid number of bands for legalization!\n";
+        ReportUsage();
+        return 1;
+      }
+    } else if (arg == "-lgreorder" && i < argc) {
+      std::string str_lg_reorder_range = std::string(argv[i++]);
+      try {
+        lg_reorder_range = std::stoi(str_lg_reorder_range);
+      } catch (...) {
+        std::cout << "Invalid local reordering range!\n";
+        ReportUsage();
+        return 1;
+      }
+      if (lg_reorder_range < 2 || lg_reorder_range > 8) {
+        std::cout << "Local reordering range must be in [2, 8]!\n";
+        ReportUsage();
+        return 1;
+      }
+    } else if (arg == "-lghpwl" && i < argc) {
+      std::string str_lg_hpwl_weight = std::string(argv[i++]);
+      try {
+        lg_hpwl_weight = std::max(std::stod(str_lg_hpwl_weight), 0.0);
+      } catch (...) {
+        std::cout << "Invalid HPWL weight for legalization!\n";
+        ReportUsage();
+        return 1;
+      }
     } else if (arg == "-gbmaxit" && i < argc) {
       std::string str_gb_maxiter = std::string(argv[i++]);
       try {
@@ -212,6 +268,29 @@ int main(int argc, char *argv[]) {
         ReportUsage();
         return 1;
       }
+      if (num_threads < 1) {
+        std::cout << "Number of threads must be at least 1!\n";
+        ReportUsage();
+        return 1;
+      }
+    } else if (arg == "-gpsolver" && i < argc) {
+      str_gb_solver = std::string(argv[i++]);
+      if (str_gb_solver != "diagonal" && str_gb_solver != "ic0"
+          && str_gb_solver != "amg" && str_gb_solver != "fused") {
+        std::cout << "Unknown linear solver: " << str_gb_solver << "\n";
+        ReportUsage();
+        return 1;
+      }
+    } else if (arg == "-gpincremental") {
+      is_gb_incremental = true;
+    } else if (arg == "-gppl" && i < argc) {
+      prior_pl_file_name = std::string(argv[i++]);
+    } else if (arg == "-gpconf" && i < argc) {
+      gb_config_file_name = std::string(argv[i++]);
+    } else if (arg == "-snapshot" && i < argc) {
+      snapshot_file_name = std::string(argv[i++]);
+    } else if (arg == "-profile" && i < argc) {
+      profile_file_name = std::string(argv[i++]);
     } else {
       std::cout << "Unknown flag\n";
       std::cout << arg << "\n";
@@ -242,29 +321,54 @@ int main(int argc, char *argv[]) {
   ElapsedTime elapsed_time;
   elapsed_time.RecordStartTime();
 
-  // load LEF/DEF/CELL files
+  if (!prior_pl_file_name.empty() && !is_gb_incremental) {
+    BOOST_LOG_TRIVIAL(info) << "-gppl needs -gpincremental!\n";
+    ReportUsage();
+    return 1;
+  }
+
+  // load LEF/DEF/CELL files, or Bookshelf files
   // (1). initialize PhyDB
-  if ((lef_file_name.empty()) || (def_file_name.empty())) {
+  bool is_bookshelf = !bookshelf_file_name.empty();
+  if (is_bookshelf) {
+    if (!cell_file_name.empty() || !m_cell_file_name.empty()) {
+      BOOST_LOG_TRIVIAL(info) << "Cell files need LEF/DEF files!\n";
+      ReportUsage();
+      return 1;
+    }
+  } else if ((lef_file_name.empty()) || (def_file_name.empty())) {
     BOOST_LOG_TRIVIAL(info) << "Invalid input files!\n";
     ReportUsage();
     return 1;
   }
+  int load_stage = GlobalProfiler().BeginStage("load input");
   phydb::PhyDB phy_db;
-  if (x_grid > 0 && y_grid > 0) {
-    phy_db.SetPlacementGrids(x_grid, y_grid);
-  }
-  phy_db.ReadLef(lef_file_name);
-  phy_db.ReadDef(def_file_name);
-  if (!cell_file_name.empty()) {
-    phy_db.ReadCell(cell_file_name);
+  if (!is_bookshelf) {
+    if (x_grid > 0 && y_grid > 0) {
+      phy_db.SetPlacementGrids(x_grid, y_grid);
+    }
+    phy_db.ReadLef(lef_file_name);
+    phy_db.ReadDef(def_file_name);
+    if (!cell_file_name.empty()) {
+      phy_db.ReadCell(cell_file_name);
+    }
   }
 
   // (2). initialize Circuit
   Circuit circuit;
-  circuit.InitializeFromPhyDB(&phy_db);
+  circuit.SetNumThreads(num_threads);
+  if (is_bookshelf) {
+    circuit.LoadBookshelf(bookshelf_file_name);
+  } else {
+    circuit.InitializeFromPhyDB(&phy_db);
+  }
   if (!m_cell_file_name.empty()) {
     circuit.ReadMultiWellCell(m_cell_file_name);
   }
+  if (!prior_pl_file_name.empty()) {
+    circuit.LoadBookshelfPl(prior_pl_file_name, true);
+  }
+  GlobalProfiler().EndStage(load_stage);
   circuit.ReportBriefSummary();
 
   // set the placement density
@@ -282,6 +386,15 @@ int main(int argc, char *argv[]) {
   gb_placer->SetInputCircuit(&circuit);
   gb_placer->SetNumThreads(num_threads);
   gb_placer->SetMaxIteration(gb_maxiter);
+  if (!gb_config_file_name.empty()) {
+    gb_placer->LoadConf(gb_config_file_name);
+  }
+  if (!str_gb_solver.empty()) {
+    gb_placer->SetLinearSolverType(StrToLinearSolverType(str_gb_solver));
+  }
+  if (is_gb_incremental) {
+    gb_placer->SetIncremental(true);
+  }
   if (!is_no_global) {
     gb_placer->SetPlacementDensity(target_density);
     //gb_placer->ReportBoundaries();
@@ -296,7 +409,9 @@ int main(int argc, char *argv[]) {
     // (a). single row gridded cell legalization
     auto well_legalizer = std::make_unique<StdClusterWellLegalizer>();
     well_legalizer->TakeOver(gb_placer.get());
+    well_legalizer->SetNumThreads(num_threads);
     well_legalizer->SetStripePartitionMode(well_legalization_mode);
+    well_legalizer->SetLocalReorderRange(lg_reorder_range);
     well_legalizer->StartPlacement();
     if (export_well_cluster_for_matlab) {
       circuit.GenMATLABTable("sc_result.txt");
@@ -312,12 +427,14 @@ int main(int argc, char *argv[]) {
     auto multi_well_legalizer = std::make_unique<GriddedRowLegalizer>();
     multi_well_legalizer->SetThreads(lg_threads);
     multi_well_legalizer->SetUseCplex(lg_cplex);
+    multi_well_legalizer->SetUseAdmm(lg_admm);
     multi_well_legalizer->TakeOver(gb_placer.get());
     multi_well_legalizer->SetWellTapCellParameters(
         is_well_tap_needed, false, -1, ""
     );
     multi_well_legalizer->SetMaxRowWidth(max_row_width);
     multi_well_legalizer->SetPartitionMode(well_legalization_mode);
+    multi_well_legalizer->SetLocalReorderRange(lg_reorder_range);
     multi_well_legalizer->StartPlacement();
     if (export_well_cluster_for_matlab) {
       circuit.GenMATLABTable("sc_result.txt");
@@ -330,15 +447,23 @@ int main(int argc, char *argv[]) {
       multi_well_legalizer->EmitDEFWellFile(output_name, 1);
     }
   } else {
-    // (c). Tetris Legalization
-    if (!is_no_legal) {
+    // (c). Abacus or Tetris Legalization
+    if (!is_no_legal && lg_abacus) {
+      auto legalizer = std::make_unique<AbacusLegalizer>();
+      legalizer->TakeOver(gb_placer.get());
+      legalizer->SetNumThreads(lg_threads);
+      legalizer->StartPlacement();
+    } else if (!is_no_legal) {
       auto legalizer = std::make_unique<LGTetrisEx>();
       legalizer->TakeOver(gb_placer.get());
+      legalizer->SetHpwlWeight(lg_hpwl_weight);
+      legalizer->SetNumBands(lg_bands);
+      legalizer->SetNumThreads(lg_threads);
       legalizer->StartPlacement();
     }
   }
 
-  if (!is_no_io_place) {
+  if (!is_no_io_place && !is_bookshelf) {
     auto io_placer = std::make_unique<IoPlacer>(&phy_db, &circuit);
     bool is_ioplacer_config_success =
         io_placer->ConfigSetGlobalMetalLayer(io_metal_layer);
@@ -348,10 +473,25 @@ int main(int argc, char *argv[]) {
   }
 
   // save placement result
-  circuit.SaveDefFile(output_name, "", def_file_name, 1, 1, 2, 1);
-  circuit.SaveDefFile(output_name, "_io", def_file_name, 1, 1, 1, 1);
-  circuit.SaveDefFile(output_name, "_filling", def_file_name, 1, 4, 2, 0);
-  circuit.SaveDefFileComponent(output_name + "_comp.def", def_file_name);
+  int save_stage = GlobalProfiler().BeginStage("save output");
+  if (is_bookshelf) {
+    circuit.SaveBookshelfPl(output_name + ".pl");
+  } else {
+    circuit.SaveDefFiles(
+        output_name,
+        def_file_name,
+        {
+            {"", 1, 1, 2, 1},
+            {"_io", 1, 1, 1, 1},
+            {"_filling", 1, 4, 2, 0}
+        }
+    );
+    circuit.SaveDefFileComponent(output_name + "_comp.def", def_file_name);
+  }
+  if (!snapshot_file_name.empty()) {
+    circuit.SaveSnapshot(snapshot_file_name);
+  }
+  GlobalProfiler().EndStage(save_stage);
 
   circuit.InitNetFanoutHistogram();
   circuit.ReportNetFanoutHistogram();
@@ -364,6 +504,10 @@ int main(int argc, char *argv[]) {
     << "(wall time: " << elapsed_time.GetWallTime() << "s, "
     << "cpu time: " << elapsed_time.GetCpuTime() << "s)****\n";
 
+  if (!profile_file_name.empty()) {
+    GlobalProfiler().SaveReport(profile_file_name);
+  }
+
   return 0;
 }
 
@@ -373,16 +517,29 @@ void ReportUsage() {
       << "Usage: dali\n"
       << "  -lef         <file.lef>\n"
       << "  -def         <file.def>\n"
+      << "  -bookshelf   <file.aux> (instead of -lef and -def, the placement is saved to <output_name>.pl)\n"
       << "  -cell        <file.cell> (optional, if provided, well placement flow will be triggered)\n"
       << "  -mcell       <file.cell> (multiwell gridded cell)\n"
       << "  -o           <output_name>.def (optional, default output file name dali_out.def)\n"
       << "  -g/-grid     grid_value_x grid_value_y (optional, default metal1 and metal2 pitch values)\n"
       << "  -d/-density  density (optional, value interval (0,1], default max(space_utility, 0.7))\n"
       << "  -nolegal     optional, if this flag is present, then only perform global placement\n"
+      << "  -lgcplex     optional, if this flag is present, then displacement of multiwell gridded cells is optimized by quadratic programming, using CPLEX if Dali is built with it, otherwise the built-in ADMM solver\n"
+      << "  -lgadmm      optional, if this flag is present, then -lgcplex uses the built-in ADMM solver even if Dali is built with CPLEX\n"
+      << "  -lgabacus    optional, if this flag is present, then standard cells are legalized by Abacus using -lgthreads threads\n"
+      << "  -lgbands     number of vertical bands legalized concurrently using -lgthreads threads (optional, default 1)\n"
+      << "  -lgreorder   number of cells in each local reordering window of well legalization (optional, 2-8, default 3)\n"
+      << "  -lghpwl      weight of HPWL in the cost of legalization candidates (optional, default 0, displacement only)\n"
       << "  -iolayer     metal layer number for I/O placement (optional, default 1 for m1)\n"
       << "  -wlgmode     <scavenge/strict> determine whether the last column use unassigned space\n"
       << "  -v           verbosity_level (optional, 0-5, default 1)\n"
       << "  -lognoprefix optional, if this flag is present, then only messages will be saved to the log file\n"
+      << "  -gpsolver    <diagonal/ic0/amg/fused> linear solver for global placement (optional, default diagonal)\n"
+      << "  -gpincremental optional, if this flag is present, then only UNPLACED cells are placed, and PLACED cells stay close to their locations\n"
+      << "  -gppl        <file.pl> prior placement in Bookshelf format, needs -gpincremental (optional)\n"
+      << "  -gpconf      <file.conf> configuration file for global placement (optional)\n"
+      << "  -snapshot    <file.snap> save the placed circuit in the binary snapshot format (optional)\n"
+      << "  -profile     <file.json/file.csv> save wall time, cpu time and memory of each stage, and HPWL of each global placement iteration (optional)\n"
       << "(flag order does not matter)"
       << "\033[0m\n";
 }
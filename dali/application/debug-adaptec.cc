@@ -38,9 +38,12 @@ int main(int argc, char **argv) {
   InitLogging("", boost::log::trivial::trace, false);
 
   double tune_param;
+  std::string aux_file_name;
   for (int i = 1; i < argc;) {
     std::string arg(argv[i++]);
-    if ((arg == "-param") && i < argc) {
+    if ((arg == "-bookshelf") && i < argc) {
+      aux_file_name = std::string(argv[i++]);
+    } else if ((arg == "-param") && i < argc) {
       std::string tmp_str = std::string(argv[i++]);
       try {
         tune_param = std::stod(tmp_str);
@@ -77,14 +80,20 @@ int main(int argc, char **argv) {
   std::string adaptec1_def = "ISPD2005/adaptec1.def";
 #endif
 
+  // ISPD2005 benchmarks can also be loaded from Bookshelf files directly,
+  // e.g., -bookshelf ISPD2005/adaptec1/adaptec1.aux
   phydb::PhyDB phy_db;
-  phy_db.SetPlacementGrids(0.01, 0.01);
-  phy_db.ReadLef(adaptec1_lef);
-  phy_db.ReadDef(adaptec1_def);
-  ReportMemory();
-
   Circuit circuit;
-  circuit.InitializeFromPhyDB(&phy_db);
+  if (aux_file_name.empty()) {
+    phy_db.SetPlacementGrids(0.01, 0.01);
+    phy_db.ReadLef(adaptec1_lef);
+    phy_db.ReadDef(adaptec1_def);
+    ReportMemory();
+    circuit.InitializeFromPhyDB(&phy_db);
+  } else {
+    circuit.LoadBookshelf(aux_file_name);
+    ReportMemory();
+  }
   //circuit.SetGridValue(0.01, 0.01);
   //circuit.ReadLefFile(adaptec1_lef);
   //circuit.ReadDefFile(adaptec1_def);
@@ -110,7 +119,9 @@ int main(int argc, char **argv) {
   gb_placer.SetShouldSaveIntermediateResult(false);
 #if !TEST_LG
   gb_placer.StartPlacement();
-  circuit.SaveDefFile("ISPD2005/adaptec1_dali", "", adaptec1_def, 1, 1, 1, 1);
+  if (aux_file_name.empty()) {
+    circuit.SaveDefFile("ISPD2005/adaptec1_dali", "", adaptec1_def, 1, 1, 1, 1);
+  }
   circuit.SaveBookshelfPl("adaptec1bs.pl");
 #endif
   circuit.GenMATLABTable("gb_result.txt");
@@ -26,6 +26,7 @@
 #include "dali/circuit/circuit.h"
 #include "dali/common/helper.h"
 #include "dali/common/logging.h"
+#include "dali/common/profiler.h"
 
 #include "dali/placer.h"
 
@@ -47,6 +48,7 @@ int main(int argc, char *argv[]) {
   std::vector<std::string> lef_files;
   std::vector<std::string> def_files;
   std::string output_name = "dali_out";
+  std::string profile_file_name;
   int number_of_threads = 1;
   bool is_export_matlab = false;
   double k_width = 0.0;
@@ -72,6 +74,9 @@ int main(int argc, char *argv[]) {
       } catch (...) {
         DaliExpects(false, "Invalid #threads!");
       }
+    } else if (flag == "--profile") {
+      DaliExpects(option.size() >= 2, "No profile file name provided!");
+      profile_file_name = option[1];
     } else if (flag == "--clsmatlab") {
       is_export_matlab = true;
     } else if (flag == "--kwidth") {
@@ -105,6 +110,7 @@ int main(int argc, char *argv[]) {
 
   /**** read LEF/DEF/CELL ****/
   // (1). initialize PhyDB
+  int load_stage = GlobalProfiler().BeginStage("load input");
   phydb::PhyDB phy_db;
   phy_db.SetPlacementGrids(0.2, 0.2);
   for (auto &lef_file_name : lef_files) {
@@ -118,6 +124,7 @@ int main(int argc, char *argv[]) {
   Circuit circuit;
   circuit.InitializeFromPhyDB(&phy_db);
   circuit.CreateFakeWellForStandardCell();
+  GlobalProfiler().EndStage(load_stage);
   circuit.ReportBriefSummary();
   circuit.ReportHPWL();
   circuit.ReportBoundingBox();
@@ -167,6 +174,10 @@ int main(int argc, char *argv[]) {
     << "(wall time: " << elapsed_time.GetWallTime() << "s, "
     << "cpu time: " << elapsed_time.GetCpuTime() << "s)****\n";
 
+  if (!profile_file_name.empty()) {
+    GlobalProfiler().SaveReport(profile_file_name);
+  }
+
   return 0;
 }
 
@@ -174,10 +185,11 @@ void ReportUsage() {
   std::cout
       << "\033[0;36m"
       << "Usage: mhlg\n"
-      << "  -lef         <file.lef>\n"
-      << "  -def         <file.def>\n"
-      << "  -o           <output_name>.def (optional, default output file name dali_out.def)\n"
-      << "  -t           #threads (optional, default 1)\n"
+      << "  --lef        <file.lef>\n"
+      << "  --def        <file.def>\n"
+      << "  --o          <output_name>.def (optional, default output file name dali_out.def)\n"
+      << "  --t          #threads (optional, default 1)\n"
+      << "  --profile    <file.json/file.csv> save wall time, cpu time and memory of each stage (optional)\n"
       << "(flag order does not matter)"
       << "\033[0m\n";
 }
\ No newline at end of file
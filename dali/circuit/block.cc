@@ -24,11 +24,25 @@
 
 namespace dali {
 
+void BlockLoc::Bind(double *x_ptr, double *y_ptr) {
+  DaliExpects(x_ptr != nullptr && y_ptr != nullptr, "Bind to nullptr?");
+  *x_ptr = X();
+  *y_ptr = Y();
+  x_ptr_ = x_ptr;
+  y_ptr_ = y_ptr;
+}
+
+void BlockLoc::Unbind() {
+  x_ = X();
+  y_ = Y();
+  x_ptr_ = &x_;
+  y_ptr_ = &y_;
+}
+
 Block::Block() :
     type_ptr_(nullptr),
     name_id_pair_ptr_(nullptr),
-    llx_(0),
-    lly_(0),
+    loc_(0, 0),
     place_status_(UNPLACED),
     orient_(N),
     aux_ptr_(nullptr),
@@ -44,8 +58,7 @@ Block::Block(
     BlockOrient orient
 ) : type_ptr_(type_ptr),
     name_id_pair_ptr_(name_id_pair_ptr),
-    llx_(llx),
-    lly_(lly),
+    loc_(llx, lly),
     orient_(orient) {
   DaliExpects(name_id_pair_ptr != nullptr, "nullptr for name and index?");
   DaliExpects(type_ptr != nullptr, "nullptr for type");
@@ -68,8 +81,7 @@ Block::Block(
     BlockOrient orient
 ) : type_ptr_(type_ptr),
     name_id_pair_ptr_(name_id_pair_ptr),
-    llx_(llx),
-    lly_(lly),
+    loc_(llx, lly),
     place_status_(place_state),
     orient_(orient) {
   DaliExpects(name_id_pair_ptr != nullptr, "nullptr for name and index?");
@@ -104,8 +116,8 @@ void Block::SetType(BlockType *type_ptr) {
 }
 
 void Block::SetLoc(double lx, double ly) {
-  llx_ = lx;
-  lly_ = ly;
+  loc_.X() = lx;
+  loc_.Y() = ly;
 }
 
 void Block::SetPlacementStatus(PlaceStatus place_status) {
@@ -121,31 +133,31 @@ void Block::SetAux(BlockAux *aux) {
 }
 
 void Block::SwapLoc(Block &blk) {
-  double tmp_x = llx_;
-  double tmp_y = lly_;
-  llx_ = blk.LLX();
-  lly_ = blk.LLY();
+  double tmp_x = loc_.X();
+  double tmp_y = loc_.Y();
+  loc_.X() = blk.LLX();
+  loc_.Y() = blk.LLY();
   blk.SetLLX(tmp_x);
   blk.SetLLY(tmp_y);
 }
 
 void Block::IncreaseX(double displacement, double upper, double lower) {
-  llx_ += displacement;
+  loc_.X() += displacement;
   double real_upper = upper - Width();
-  if (llx_ < lower) {
-    llx_ = lower;
-  } else if (llx_ > real_upper) {
-    llx_ = real_upper;
+  if (loc_.X() < lower) {
+    loc_.X() = lower;
+  } else if (loc_.X() > real_upper) {
+    loc_.X() = real_upper;
   }
 }
 
 void Block::IncreaseY(double displacement, double upper, double lower) {
-  lly_ += displacement;
+  loc_.Y() += displacement;
   double real_upper = upper - Height();
-  if (lly_ < lower) {
-    lly_ = lower;
-  } else if (lly_ > real_upper) {
-    lly_ = real_upper;
+  if (loc_.Y() < lower) {
+    loc_.Y() = lower;
+  } else if (loc_.Y() > real_upper) {
+    loc_.Y() = real_upper;
   }
 }
 
@@ -196,7 +208,7 @@ void Block::Report() {
     << "  block name: " << Name() << "\n"
     << "    block type: " << TypePtr()->Name() << "\n"
     << "    width and height: " << Width() << " " << Height() << "\n"
-    << "    lower left corner: " << llx_ << " " << lly_ << "\n"
+    << "    lower left corner: " << loc_.X() << " " << loc_.Y() << "\n"
     << "    movable: " << IsMovable() << "\n"
     << "    orientation: " << OrientStr(orient_) << "\n"
     << "    assigned primary key: " << Id() << "\n";
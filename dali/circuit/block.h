@@ -47,6 +47,40 @@ namespace dali {
 
 class BlockAux;
 
+/****
+ * The lower left corner of a Block. Coordinates are stored in this object by
+ * default, and can be redirected to an external structure-of-arrays store
+ * (see BlockLocStore), so that hot loops can access locations of all blocks
+ * contiguously. Copying a BlockLoc only copies values, the copy always owns
+ * its coordinates.
+ */
+class BlockLoc {
+ public:
+  BlockLoc(double x, double y) : x_(x), y_(y) {}
+  BlockLoc(BlockLoc const &other) : x_(other.X()), y_(other.Y()) {}
+  BlockLoc &operator=(BlockLoc const &other) {
+    X() = other.X();
+    Y() = other.Y();
+    return *this;
+  }
+
+  double X() const { return *x_ptr_; }
+  double Y() const { return *y_ptr_; }
+  double &X() { return *x_ptr_; }
+  double &Y() { return *y_ptr_; }
+
+  // redirect coordinates to external storage, current values are copied
+  void Bind(double *x_ptr, double *y_ptr);
+  // copy coordinates back from external storage
+  void Unbind();
+  bool IsBound() const { return x_ptr_ != &x_; }
+ private:
+  double x_;
+  double y_;
+  double *x_ptr_ = &x_;
+  double *y_ptr_ = &y_;
+};
+
 class Block {
  public:
   Block();
@@ -95,22 +129,22 @@ class Block {
   int Height() const { return eff_height_; }
 
   // get lower left x coordinate
-  double LLX() const { return llx_; }
+  double LLX() const { return loc_.X(); }
 
   // get lower left y coordinate
-  double LLY() const { return lly_; }
+  double LLY() const { return loc_.Y(); }
 
   // get upper right x coordinate
-  double URX() const { return llx_ + Width(); }
+  double URX() const { return loc_.X() + Width(); }
 
   // get upper right y coordinate
-  double URY() const { return lly_ + Height() + tot_stretch_length; }
+  double URY() const { return loc_.Y() + Height() + tot_stretch_length; }
 
   // get center x coordinate
-  double X() const { return llx_ + Width() / 2.0; }
+  double X() const { return loc_.X() + Width() / 2.0; }
 
   // get center y coordinate
-  double Y() const { return lly_ + Height() / 2.0; }
+  double Y() const { return loc_.Y() + Height() / 2.0; }
 
   // get the indices of nets containing this Block
   std::vector<int> &NetList() { return nets_; }
@@ -160,22 +194,22 @@ class Block {
   void SetLoc(double lx, double ly);
 
   // set the lower left x coordinate
-  void SetLLX(double lx) { llx_ = lx; }
+  void SetLLX(double lx) { loc_.X() = lx; }
 
   // set the lower left y coordinate
-  void SetLLY(double ly) { lly_ = ly; }
+  void SetLLY(double ly) { loc_.Y() = ly; }
 
   // set the upper right x coordinate
-  void SetURX(double ux) { llx_ = ux - Width(); }
+  void SetURX(double ux) { loc_.X() = ux - Width(); }
 
   // set the upper right y coordinate
-  void SetURY(double uy) { lly_ = uy - Height(); }
+  void SetURY(double uy) { loc_.Y() = uy - Height(); }
 
   // set the center x coordinate
-  void SetCenterX(double center_x) { llx_ = center_x - Width() / 2.0; }
+  void SetCenterX(double center_x) { loc_.X() = center_x - Width() / 2.0; }
 
   // set the center y coordinate
-  void SetCenterY(double center_y) { lly_ = center_y - Height() / 2.0; }
+  void SetCenterY(double center_y) { loc_.Y() = center_y - Height() / 2.0; }
 
   // set the placement status of this Block
   void SetPlacementStatus(PlaceStatus place_status);
@@ -191,10 +225,10 @@ class Block {
   void SwapLoc(Block &blk);
 
   // increase x coordinate by a certain amount
-  void IncreaseX(double displacement) { llx_ += displacement; }
+  void IncreaseX(double displacement) { loc_.X() += displacement; }
 
   // increase y coordinate by a certain amount
-  void IncreaseY(double displacement) { lly_ += displacement; }
+  void IncreaseY(double displacement) { loc_.Y() += displacement; }
 
   // increase x coordinate by a certain amount, but the final location is bounded by @param lower, and upper
   void IncreaseX(double displacement, double upper, double lower);
@@ -203,10 +237,18 @@ class Block {
   void IncreaseY(double displacement, double upper, double lower);
 
   // decrease x coordinate by a certain amount
-  void DecreaseX(double displacement) { llx_ -= displacement; }
+  void DecreaseX(double displacement) { loc_.X() -= displacement; }
 
   // decrease y coordinate by a certain amount
-  void DecreaseY(double displacement) { lly_ -= displacement; }
+  void DecreaseY(double displacement) { loc_.Y() -= displacement; }
+
+  // redirect the location of this Block to external storage, see BlockLocStore
+  void BindLoc(double *llx_ptr, double *lly_ptr) {
+    loc_.Bind(llx_ptr, lly_ptr);
+  }
+
+  // make this Block own its location again
+  void UnbindLoc() { loc_.Unbind(); }
 
   // returns whether this Block overlaps with Block @param blk
   bool IsOverlap(const Block &blk) const {
@@ -237,8 +279,7 @@ class Block {
   BlockType *type_ptr_; // type
   // name for finding its index in block_list
   std::pair<const std::string, int> *name_id_pair_ptr_;
-  double llx_; // lower x coordinate, data type double, for global placement
-  double lly_; // lower y coordinate
+  BlockLoc loc_; // lower left corner, data type double, for global placement
   std::vector<int> nets_; // the list of nets connected to this cell
   PlaceStatus place_status_; // placement status, i.e, PLACED, FIXED, UNPLACED
   BlockOrient orient_; // orientation, normally, N or FS
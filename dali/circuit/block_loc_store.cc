@@ -0,0 +1,54 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "block_loc_store.h"
+
+namespace dali {
+
+/****
+ * @brief Copy locations of all blocks to this store, and redirect blocks to
+ * it. If the store is already bound, it is unbound first.
+ *
+ * @param blocks: all blocks of a circuit
+ */
+void BlockLocStore::Bind(std::vector<Block> &blocks) {
+  Unbind();
+  int num_blks = static_cast<int>(blocks.size());
+  llxs_.resize(num_blks);
+  llys_.resize(num_blks);
+  for (int i = 0; i < num_blks; ++i) {
+    blocks[i].BindLoc(&llxs_[i], &llys_[i]);
+  }
+  blocks_ = &blocks;
+}
+
+/****
+ * @brief Copy locations back to blocks, after which blocks own their
+ * locations again.
+ */
+void BlockLocStore::Unbind() {
+  if (blocks_ == nullptr) return;
+  for (auto &block: *blocks_) {
+    block.UnbindLoc();
+  }
+  blocks_ = nullptr;
+}
+
+}
@@ -0,0 +1,82 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef DALI_CIRCUIT_BLOCK_LOC_STORE_H_
+#define DALI_CIRCUIT_BLOCK_LOC_STORE_H_
+
+#include <vector>
+
+#include "block.h"
+
+namespace dali {
+
+/****
+ * This class stores lower left corners of all blocks as two contiguous
+ * arrays. Once bound, Block::LLX()/LLY() and all setters read and write these
+ * arrays, so solvers can work on block locations in place, for example via
+ * Eigen::Map, without copying them back and forth.
+ *
+ * The store is optional. Blocks must not be added while it is bound, because
+ * the arrays are sized for the current block list. The store is bound through
+ * a BlockLocBinding, see below.
+ */
+class BlockLocStore {
+ public:
+  BlockLocStore() = default;
+  // blocks refer to the arrays of this object, so it cannot be copied
+  BlockLocStore(BlockLocStore const &) = delete;
+  BlockLocStore &operator=(BlockLocStore const &) = delete;
+
+  void Bind(std::vector<Block> &blocks);
+  void Unbind();
+  bool IsBound() const { return blocks_ != nullptr; }
+
+  int BlkCnt() const { return static_cast<int>(llxs_.size()); }
+  std::vector<double> &LLXs() { return llxs_; }
+  std::vector<double> &LLYs() { return llys_; }
+ private:
+  std::vector<Block> *blocks_ = nullptr;
+  std::vector<double> llxs_;
+  std::vector<double> llys_;
+};
+
+/****
+ * This class binds a BlockLocStore to blocks for its lifetime. Blocks own
+ * their locations again once it is destroyed, so the store never stays bound
+ * after its user is gone.
+ */
+class BlockLocBinding {
+ public:
+  BlockLocBinding(BlockLocStore &store, std::vector<Block> &blocks)
+      : store_(store) {
+    store_.Bind(blocks);
+  }
+  ~BlockLocBinding() { store_.Unbind(); }
+  BlockLocBinding(BlockLocBinding const &) = delete;
+  BlockLocBinding &operator=(BlockLocBinding const &) = delete;
+
+  BlockLocStore &Store() { return store_; }
+ private:
+  BlockLocStore &store_;
+};
+
+}
+
+#endif //DALI_CIRCUIT_BLOCK_LOC_STORE_H_
@@ -0,0 +1,687 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "bookshelf.h"
+
+#include <cstring>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <tuple>
+
+#include "circuit.h"
+#include "dali/common/logging.h"
+
+namespace dali {
+
+static bool IsBookshelfSpace(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static bool IsKeyword(std::string_view token, std::string_view keyword) {
+  return token.size() == keyword.size()
+      && std::equal(
+          token.begin(), token.end(), keyword.begin(),
+          [](char c0, char c1) {
+            return std::tolower(static_cast<unsigned char>(c0))
+                == std::tolower(static_cast<unsigned char>(c1));
+          }
+      );
+}
+
+bool BookshelfTokenizer::NextLine() {
+  if (is_started_) {
+    cur_ = (line_end_ < end_) ? line_end_ + 1 : end_;
+  }
+  is_started_ = true;
+  while (cur_ < end_) {
+    auto newline = static_cast<char const *>(
+        std::memchr(cur_, '\n', static_cast<size_t>(end_ - cur_))
+    );
+    line_end_ = (newline == nullptr) ? end_ : newline;
+    while (cur_ < line_end_ && IsBookshelfSpace(*cur_)) ++cur_;
+    if (cur_ < line_end_ && *cur_ != '#') return true;
+    cur_ = (line_end_ < end_) ? line_end_ + 1 : end_;
+  }
+  line_end_ = end_;
+  return false;
+}
+
+std::string_view BookshelfTokenizer::Token() {
+  while (cur_ < line_end_ && IsBookshelfSpace(*cur_)) ++cur_;
+  if (cur_ >= line_end_ || *cur_ == '#') return {};
+  char const *begin = cur_;
+  if (*cur_ == ':') {
+    ++cur_;
+  } else {
+    while (cur_ < line_end_ && !IsBookshelfSpace(*cur_)
+        && *cur_ != ':' && *cur_ != '#') {
+      ++cur_;
+    }
+  }
+  return {begin, static_cast<size_t>(cur_ - begin)};
+}
+
+/****
+ * @brief Read all files listed in a .aux file. Names of files in the .aux file
+ * are relative to the directory of this .aux file.
+ *
+ * @param aux_file_name: name of the .aux file
+ * @param num_threads: number of threads for reading .nets files
+ */
+BookshelfReader::BookshelfReader(
+    std::string const &aux_file_name,
+    int num_threads
+) : num_threads_(std::max(num_threads, 1)) {
+  std::string dir;
+  size_t slash_pos = aux_file_name.find_last_of('/');
+  if (slash_pos != std::string::npos) {
+    dir = aux_file_name.substr(0, slash_pos + 1);
+  }
+  std::string scl_file, nodes_file, nets_file, wts_file, pl_file;
+  MappedFile &aux = MapFile(aux_file_name);
+  BookshelfTokenizer tokenizer(aux.Data(), aux.End());
+  while (tokenizer.NextLine()) {
+    // the first two tokens are the type of this benchmark and ':'
+    tokenizer.Token();
+    tokenizer.Token();
+    for (auto token = tokenizer.Token(); !token.empty();
+         token = tokenizer.Token()) {
+      std::string file_name = (token.front() == '/') ?
+                              std::string(token) : dir + std::string(token);
+      size_t dot_pos = file_name.find_last_of('.');
+      std::string extension = (dot_pos == std::string::npos) ?
+                              "" : file_name.substr(dot_pos);
+      if (extension == ".scl") {
+        scl_file = file_name;
+      } else if (extension == ".nodes") {
+        nodes_file = file_name;
+      } else if (extension == ".nets") {
+        nets_file = file_name;
+      } else if (extension == ".wts") {
+        wts_file = file_name;
+      } else if (extension == ".pl") {
+        pl_file = file_name;
+      } else {
+        BOOST_LOG_TRIVIAL(warning)
+          << "Unknown file in " << aux_file_name << ": " << file_name << "\n";
+      }
+    }
+  }
+  DaliExpects(!scl_file.empty() && !nodes_file.empty()
+                  && !nets_file.empty() && !pl_file.empty(),
+              "Need .scl, .nodes, .nets and .pl files in " + aux_file_name);
+
+  ReadScl(scl_file);
+  ReadNodes(nodes_file);
+  ReadNets(nets_file);
+  if (!wts_file.empty()) {
+    ReadWts(wts_file);
+  }
+  ReadPl(pl_file);
+}
+
+int BookshelfReader::NodeId(std::string_view name) const {
+  auto it = node_ids_.find(name);
+  return (it == node_ids_.end()) ? -1 : it->second;
+}
+
+MappedFile &BookshelfReader::MapFile(std::string const &file_name) {
+  BOOST_LOG_TRIVIAL(info) << "Loading Bookshelf file: " << file_name << "\n";
+  files_.emplace_back(std::make_unique<MappedFile>(file_name));
+  return *files_.back();
+}
+
+void BookshelfReader::ReadScl(std::string const &file_name) {
+  MappedFile &file = MapFile(file_name);
+  BookshelfTokenizer tokenizer(file.Data(), file.End());
+  bool is_in_row = false;
+  while (tokenizer.NextLine()) {
+    std::string_view key = tokenizer.Token();
+    if (IsKeyword(key, "CoreRow")) {
+      rows_.emplace_back();
+      is_in_row = true;
+      continue;
+    }
+    if (IsKeyword(key, "End")) {
+      is_in_row = false;
+      continue;
+    }
+    if (!is_in_row) continue;
+    // a line may contain several pairs, e.g., SubrowOrigin : 0 NumSites : 10
+    while (!key.empty()) {
+      tokenizer.Token();
+      std::string_view value = tokenizer.Token();
+      double number = 0;
+      DaliExpects(BookshelfTokenizer::ToNumber(value, number),
+                  "Invalid " << key << " in " << file_name << ": " << value);
+      BookshelfRow &row = rows_.back();
+      if (IsKeyword(key, "Coordinate")) {
+        row.y = number;
+      } else if (IsKeyword(key, "Height")) {
+        row.height = number;
+      } else if (IsKeyword(key, "Sitewidth")) {
+        row.site_width = number;
+      } else if (IsKeyword(key, "Sitespacing")) {
+        row.site_spacing = number;
+      } else if (IsKeyword(key, "SubrowOrigin")) {
+        row.x = number;
+      } else if (IsKeyword(key, "NumSites")) {
+        row.num_sites = static_cast<int>(number);
+      }
+      key = tokenizer.Token();
+    }
+  }
+  DaliExpects(!rows_.empty(), "No row in " + file_name);
+}
+
+void BookshelfReader::ReadNodes(std::string const &file_name) {
+  MappedFile &file = MapFile(file_name);
+  BookshelfTokenizer tokenizer(file.Data(), file.End());
+  while (tokenizer.NextLine()) {
+    std::string_view name = tokenizer.Token();
+    if (name == "UCLA" || name == "NumTerminals") continue;
+    if (name == "NumNodes") {
+      tokenizer.Token();
+      size_t node_count = 0;
+      if (BookshelfTokenizer::ToNumber(tokenizer.Token(), node_count)) {
+        nodes_.reserve(node_count);
+        node_ids_.reserve(node_count);
+      }
+      continue;
+    }
+    BookshelfNode &node = nodes_.emplace_back();
+    node.name = name;
+    DaliExpects(
+        BookshelfTokenizer::ToNumber(tokenizer.Token(), node.width)
+            && BookshelfTokenizer::ToNumber(tokenizer.Token(), node.height),
+        "Invalid size of node " << name << " in " << file_name
+    );
+    std::string_view type = tokenizer.Token();
+    node.is_terminal = (type == "terminal");
+    node.is_terminal_ni = (type == "terminal_NI");
+    bool is_new = node_ids_.emplace(
+        name, static_cast<int>(nodes_.size() - 1)
+    ).second;
+    DaliExpects(is_new, "Node exists: " << name << " in " << file_name);
+  }
+}
+
+/****
+ * @brief Find the first line starting with NetDegree, at or after a given
+ * position of a .nets file.
+ */
+static char const *FindNetStart(
+    char const *file_begin,
+    char const *pos,
+    char const *end
+) {
+  std::string_view text(pos, static_cast<size_t>(end - pos));
+  for (size_t found = text.find("NetDegree"); found != std::string_view::npos;
+       found = text.find("NetDegree", found + 1)) {
+    char const *line_begin = pos + found;
+    while (line_begin > file_begin && IsBookshelfSpace(line_begin[-1])) {
+      --line_begin;
+    }
+    if (line_begin == file_begin || line_begin[-1] == '\n') {
+      return std::max(line_begin, pos);
+    }
+  }
+  return end;
+}
+
+// nets and pins in a part of a .nets file
+struct BookshelfNetChunk {
+  std::vector<BookshelfNet> nets;
+  std::vector<BookshelfNetPin> pins;
+  std::string error;
+};
+
+/****
+ * @brief Read a .nets file. The file is split into chunks at lines starting
+ * with NetDegree, and chunks are parsed in parallel.
+ */
+void BookshelfReader::ReadNets(std::string const &file_name) {
+  MappedFile &file = MapFile(file_name);
+  char const *begin = file.Data();
+  char const *end = file.End();
+  int chunk_count = (num_threads_ > 1) ? num_threads_ * 4 : 1;
+  std::vector<char const *> bounds(1, begin);
+  for (int i = 1; i < chunk_count; ++i) {
+    char const *pos = begin + (end - begin) * i / chunk_count;
+    bounds.push_back(FindNetStart(begin, std::max(pos, bounds.back()), end));
+  }
+  bounds.push_back(end);
+
+  std::vector<BookshelfNetChunk> chunks(chunk_count);
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads_) default(none) shared(chunk_count, chunks, bounds)
+  for (int i = 0; i < chunk_count; ++i) {
+    BookshelfNetChunk &chunk = chunks[i];
+    BookshelfTokenizer tokenizer(bounds[i], bounds[i + 1]);
+    int remaining_pins = 0;
+    while (chunk.error.empty() && tokenizer.NextLine()) {
+      std::string_view token = tokenizer.Token();
+      if (token == "NetDegree") {
+        if (remaining_pins > 0) {
+          chunk.error =
+              "Missing pins of net " + std::string(chunk.nets.back().name);
+          break;
+        }
+        tokenizer.Token();
+        BookshelfNet &net = chunk.nets.emplace_back();
+        if (!BookshelfTokenizer::ToNumber(tokenizer.Token(), net.pin_count)
+            || net.pin_count < 0) {
+          chunk.error = "Invalid NetDegree";
+          break;
+        }
+        net.name = tokenizer.Token();
+        net.first_pin = chunk.pins.size();
+        remaining_pins = net.pin_count;
+        continue;
+      }
+      if (token == "UCLA" || token == "NumNets" || token == "NumPins") {
+        continue;
+      }
+      if (remaining_pins == 0) {
+        chunk.error = "Unexpected line starting with " + std::string(token);
+        break;
+      }
+      BookshelfNetPin &pin = chunk.pins.emplace_back();
+      pin.node_id = NodeId(token);
+      if (pin.node_id < 0) {
+        chunk.error = "Unknown node " + std::string(token);
+        break;
+      }
+      std::string_view direction = tokenizer.Token();
+      pin.direction = direction.empty() ? 'I' : direction[0];
+      if (tokenizer.Token() == ":"
+          && !(BookshelfTokenizer::ToNumber(tokenizer.Token(), pin.offset_x)
+              && BookshelfTokenizer::ToNumber(
+                  tokenizer.Token(), pin.offset_y
+              ))) {
+        chunk.error = "Invalid pin offset of node " + std::string(token);
+        break;
+      }
+      --remaining_pins;
+    }
+    if (chunk.error.empty() && remaining_pins > 0) {
+      chunk.error =
+          "Missing pins of net " + std::string(chunk.nets.back().name);
+    }
+  }
+
+  std::vector<size_t> net_offsets(1, 0);
+  std::vector<size_t> pin_offsets(1, 0);
+  for (auto &chunk : chunks) {
+    DaliExpects(chunk.error.empty(), chunk.error << " in " << file_name);
+    net_offsets.push_back(net_offsets.back() + chunk.nets.size());
+    pin_offsets.push_back(pin_offsets.back() + chunk.pins.size());
+  }
+  nets_.resize(net_offsets.back());
+  net_pins_.resize(pin_offsets.back());
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads_) default(none) shared(chunk_count, chunks, net_offsets, pin_offsets)
+  for (int i = 0; i < chunk_count; ++i) {
+    std::copy(
+        chunks[i].pins.begin(),
+        chunks[i].pins.end(),
+        net_pins_.begin() + static_cast<long>(pin_offsets[i])
+    );
+    for (size_t j = 0; j < chunks[i].nets.size(); ++j) {
+      BookshelfNet &net = nets_[net_offsets[i] + j];
+      net = chunks[i].nets[j];
+      net.first_pin += pin_offsets[i];
+    }
+  }
+}
+
+/****
+ * @brief Read net weights in a .wts file. Weights of other objects, e.g.,
+ * nodes, are ignored.
+ */
+void BookshelfReader::ReadWts(std::string const &file_name) {
+  MappedFile &file = MapFile(file_name);
+  BookshelfTokenizer tokenizer(file.Data(), file.End());
+  std::unordered_map<std::string_view, int> net_ids;
+  while (tokenizer.NextLine()) {
+    std::string_view name = tokenizer.Token();
+    double weight = 0;
+    if (name == "UCLA"
+        || !BookshelfTokenizer::ToNumber(tokenizer.Token(), weight)) {
+      continue;
+    }
+    if (net_ids.empty()) {
+      net_ids.reserve(nets_.size());
+      for (size_t i = 0; i < nets_.size(); ++i) {
+        net_ids.emplace(nets_[i].name, static_cast<int>(i));
+      }
+    }
+    auto it = net_ids.find(name);
+    if (it != net_ids.end()) {
+      nets_[it->second].weight = weight;
+    }
+  }
+}
+
+void BookshelfReader::ReadPl(std::string const &file_name) {
+  size_t unknown_count = 0;
+  // nodes in a .pl file are usually in the same order as in the .nodes file
+  int expected_id = 0;
+  ReadBookshelfPl(
+      file_name,
+      [&](
+          std::string_view name,
+          double x,
+          double y,
+          std::string_view orient,
+          bool is_fixed
+      ) {
+        int id = (expected_id < static_cast<int>(nodes_.size())
+            && nodes_[expected_id].name == name) ? expected_id : NodeId(name);
+        if (id < 0) {
+          ++unknown_count;
+          return;
+        }
+        expected_id = id + 1;
+        BookshelfNode &node = nodes_[id];
+        node.x = x;
+        node.y = y;
+        node.orient = StrToOrient(std::string(orient));
+        node.is_fixed = is_fixed;
+      }
+  );
+  if (unknown_count > 0) {
+    BOOST_LOG_TRIVIAL(warning)
+      << "Skip " << unknown_count << " unknown nodes in " << file_name << "\n";
+  }
+}
+
+void ReadBookshelfPl(
+    std::string const &file_name,
+    std::function<void(
+        std::string_view name,
+        double x,
+        double y,
+        std::string_view orient,
+        bool is_fixed
+    )> const &func
+) {
+  MappedFile file(file_name);
+  BookshelfTokenizer tokenizer(file.Data(), file.End());
+  while (tokenizer.NextLine()) {
+    // a node line has a name, a location and an orientation, other lines,
+    // e.g., headers, are skipped
+    std::string_view name = tokenizer.Token();
+    double x = 0;
+    double y = 0;
+    if (!BookshelfTokenizer::ToNumber(tokenizer.Token(), x)
+        || !BookshelfTokenizer::ToNumber(tokenizer.Token(), y)) {
+      continue;
+    }
+    std::string_view orient;
+    bool is_fixed = false;
+    for (auto token = tokenizer.Token(); !token.empty();
+         token = tokenizer.Token()) {
+      if (token == ":") continue;
+      if (token == "/FIXED" || token == "/FIXED_NI") {
+        is_fixed = true;
+      } else if (orient.empty() && token[0] != '/') {
+        orient = token;
+      }
+    }
+    if (orient.empty()) continue;
+    func(name, x, y, orient, is_fixed);
+  }
+}
+
+// appends the bytes of a value to the signature of a BlockType
+static void AppendBytes(std::string &signature, double value) {
+  signature.append(reinterpret_cast<char const *>(&value), sizeof(value));
+}
+
+/****
+ * @brief Load a placement benchmark in the Bookshelf format into an empty
+ * circuit, without LEF/DEF files.
+ *
+ * One unit in Bookshelf files is one micron and one DEF distance unit in this
+ * circuit. The grid value along X is the site width, and the grid value along
+ * Y is 1. Bookshelf nodes have no masters, so nodes with the same size and the
+ * same pin offsets share a BlockType. Terminals are FIXED blocks, and other
+ * nodes are UNPLACED blocks at their locations in the .pl file.
+ *
+ * @param aux_file_name: name of the .aux file
+ */
+void Circuit::LoadBookshelf(std::string const &aux_file_name) {
+  DaliExpects(design_.blocks_.empty() && !tech_.is_grid_set_,
+              "Cannot load Bookshelf files into a non-empty circuit");
+  BookshelfReader reader(aux_file_name, num_threads_);
+
+  // 1. rows and placement region
+  auto &rows = reader.Rows();
+  double row_height = rows[0].height;
+  double left = rows[0].x;
+  double right = rows[0].x;
+  double bottom = rows[0].y;
+  double top = rows[0].y;
+  for (auto &row : rows) {
+    DaliExpects(row.height == row_height,
+                "Rows with different heights are not supported");
+    left = std::min(left, row.x);
+    right = std::max(right, row.x + row.num_sites * row.site_spacing);
+    bottom = std::min(bottom, row.y);
+    top = std::max(top, row.y + row.height);
+  }
+  SetDatabaseMicrons(1);
+  SetManufacturingGrid(1);
+  SetGridValue(rows[0].site_width, 1);
+  SetRowHeight(row_height);
+  SetUnitsDistanceMicrons(1);
+  SetDieArea(
+      static_cast<int>(std::round(left)),
+      static_cast<int>(std::round(bottom)),
+      static_cast<int>(std::round(right)),
+      static_cast<int>(std::round(top))
+  );
+
+  // 2. distinct pins of each node, sorted by offsets and directions
+  auto &nodes = reader.Nodes();
+  auto &net_pins = reader.NetPins();
+  int nodes_count = static_cast<int>(nodes.size());
+  std::vector<size_t> node_pin_offsets(nodes.size() + 1, 0);
+  for (auto &pin : net_pins) {
+    ++node_pin_offsets[pin.node_id + 1];
+  }
+  for (size_t i = 0; i < nodes.size(); ++i) {
+    node_pin_offsets[i + 1] += node_pin_offsets[i];
+  }
+  std::vector<size_t> node_pins(net_pins.size());
+  std::vector<size_t> cursors(
+      node_pin_offsets.begin(), node_pin_offsets.end() - 1
+  );
+  for (size_t i = 0; i < net_pins.size(); ++i) {
+    node_pins[cursors[net_pins[i].node_id]++] = i;
+  }
+  auto pin_key = [&net_pins](size_t pin_id) {
+    BookshelfNetPin const &pin = net_pins[pin_id];
+    return std::make_tuple(pin.offset_x, pin.offset_y, pin.direction == 'O');
+  };
+#pragma omp parallel for schedule(dynamic, 256) num_threads(num_threads_) default(none) shared(nodes_count, node_pins, node_pin_offsets, net_pins, pin_key)
+  for (int i = 0; i < nodes_count; ++i) {
+    auto first = node_pins.begin() + static_cast<long>(node_pin_offsets[i]);
+    auto last = node_pins.begin() + static_cast<long>(node_pin_offsets[i + 1]);
+    std::sort(first, last, [&pin_key](size_t pin0, size_t pin1) {
+      return pin_key(pin0) < pin_key(pin1);
+    });
+    int pin_id = 0;
+    for (auto it = first; it != last; ++it) {
+      if (it != first && pin_key(*it) != pin_key(*(it - 1))) ++pin_id;
+      net_pins[*it].pin_id = pin_id;
+    }
+  }
+
+  // 3. BlockTypes, nodes with the same size and pins share a BlockType
+  std::unordered_map<std::string, BlockType *> signature_types;
+  std::vector<BlockType *> node_types(nodes.size(), nullptr);
+  std::string signature;
+  for (int i = 0; i < nodes_count; ++i) {
+    BookshelfNode &node = nodes[i];
+    signature.clear();
+    AppendBytes(signature, node.width);
+    AppendBytes(signature, node.height);
+    for (size_t j = node_pin_offsets[i]; j < node_pin_offsets[i + 1]; ++j) {
+      BookshelfNetPin &pin = net_pins[node_pins[j]];
+      bool is_duplicate = j > node_pin_offsets[i]
+          && net_pins[node_pins[j - 1]].pin_id == pin.pin_id;
+      if (is_duplicate) continue;
+      AppendBytes(signature, pin.offset_x);
+      AppendBytes(signature, pin.offset_y);
+      signature.push_back(pin.direction == 'O' ? 'O' : 'I');
+    }
+    auto ret = signature_types.emplace(signature, nullptr);
+    if (ret.second) {
+      std::string type_name =
+          "BOOKSHELF_TYPE_" + std::to_string(signature_types.size() - 1);
+      int gridded_width = 0;
+      int gridded_height = 0;
+      BlockTypeSizeMicrometerToGridValue(
+          type_name, node.width, node.height, gridded_width, gridded_height
+      );
+      BlockType *type_ptr =
+          AddBlockTypeWithGridUnit(type_name, gridded_width, gridded_height);
+      // Bookshelf has no well information, legalizers need a well region
+      BlockTypeWell *well_ptr = AddBlockTypeWell(type_ptr);
+      int np_edge = gridded_height / 2;
+      well_ptr->AddPwellRect(0, 0, gridded_width, np_edge);
+      well_ptr->AddNwellRect(0, np_edge, gridded_width, gridded_height);
+      for (size_t j = node_pin_offsets[i]; j < node_pin_offsets[i + 1]; ++j) {
+        BookshelfNetPin &pin = net_pins[node_pins[j]];
+        if (pin.pin_id < static_cast<int>(type_ptr->PinList().size())) continue;
+        Pin *pin_ptr = type_ptr->AddPin(
+            "p" + std::to_string(pin.pin_id), pin.direction != 'O'
+        );
+        pin_ptr->SetOffset(
+            (node.width / 2.0 + pin.offset_x) / GridValueX(),
+            (node.height / 2.0 + pin.offset_y) / GridValueY()
+        );
+      }
+      ret.first->second = type_ptr;
+    }
+    node_types[i] = ret.first->second;
+  }
+
+  // 4. blocks, in the order of the .nodes file
+  auto &nets = reader.Nets();
+  SetListCapacity(nodes_count, 0, static_cast<int>(nets.size()));
+  for (int i = 0; i < nodes_count; ++i) {
+    BookshelfNode &node = nodes[i];
+    bool is_fixed = node.is_terminal || node.is_terminal_ni || node.is_fixed;
+    AddBlock(
+        std::string(node.name),
+        node_types[i],
+        node.x / GridValueX(),
+        node.y / GridValueY(),
+        is_fixed ? FIXED : UNPLACED,
+        node.orient,
+        !node.is_terminal_ni
+    );
+  }
+
+  // 5. nets, pins are added in parallel, and net lists of blocks afterwards
+  auto &blocks = design_.blocks_;
+  for (int i = 0; i < nodes_count; ++i) {
+    blocks[i].NetList().reserve(node_pin_offsets[i + 1] - node_pin_offsets[i]);
+  }
+  int first_net_id = static_cast<int>(design_.nets_.size());
+  for (size_t i = 0; i < nets.size(); ++i) {
+    std::string net_name = nets[i].name.empty() ?
+                           "__net_" + std::to_string(i) :
+                           std::string(nets[i].name);
+    AddNet(net_name, nets[i].pin_count, nets[i].weight);
+  }
+  int nets_count = static_cast<int>(nets.size());
+#pragma omp parallel for schedule(dynamic, 64) num_threads(num_threads_) default(none) shared(nets_count, nets, net_pins, blocks, first_net_id)
+  for (int i = 0; i < nets_count; ++i) {
+    Net &net = design_.nets_[first_net_id + i];
+    size_t end = nets[i].first_pin + nets[i].pin_count;
+    for (size_t j = nets[i].first_pin; j < end; ++j) {
+      Block &blk = blocks[net_pins[j].node_id];
+      Pin *pin = &(blk.TypePtr()->PinList()[net_pins[j].pin_id]);
+      net.AppendBlkPinPair(&blk, pin);
+    }
+  }
+  for (int i = 0; i < nets_count; ++i) {
+    int net_id = design_.nets_[first_net_id + i].Id();
+    size_t end = nets[i].first_pin + nets[i].pin_count;
+    for (size_t j = nets[i].first_pin; j < end; ++j) {
+      blocks[net_pins[j].node_id].NetList().push_back(net_id);
+    }
+  }
+  design_.pin_table_.Invalidate();
+  UpdateTotalBlkArea();
+}
+
+/****
+ * @brief Load locations of blocks from a .pl file. Blocks marked /FIXED become
+ * FIXED blocks.
+ *
+ * @param name_of_file: name of the .pl file
+ * @param is_prior_placement: if true, UNPLACED blocks in this file become
+ * PLACED blocks, e.g., for incremental placement
+ */
+void Circuit::LoadBookshelfPl(
+    std::string const &name_of_file,
+    bool is_prior_placement
+) {
+  bool is_fixed_blk_added = false;
+  ReadBookshelfPl(
+      name_of_file,
+      [this, is_prior_placement, &is_fixed_blk_added](
+          std::string_view name,
+          double x,
+          double y,
+          [[maybe_unused]] std::string_view orient,
+          bool is_fixed
+      ) {
+        std::string blk_name(name);
+        if (!IsBlockExisting(blk_name)) return;
+        double lx = x / GridValueX() / design_.distance_microns_;
+        double ly = y / GridValueY() / design_.distance_microns_;
+        Block *blk_ptr = GetBlockPtr(blk_name);
+        blk_ptr->SetLoc(lx, ly);
+        if (is_fixed && blk_ptr->IsMovable()) {
+          // keep statistics of movable blocks consistent
+          --design_.tot_mov_blk_num_;
+          design_.tot_mov_blk_area_ -= blk_ptr->Area();
+          design_.tot_mov_width_ -= blk_ptr->Width();
+          design_.tot_mov_height_ -= blk_ptr->Height();
+          ++design_.tot_fixed_blk_num_;
+          blk_ptr->SetPlacementStatus(FIXED);
+          is_fixed_blk_added = true;
+        } else if (is_prior_placement && blk_ptr->Status() == UNPLACED) {
+          blk_ptr->SetPlacementStatus(PLACED);
+        }
+      }
+  );
+  if (is_fixed_blk_added) {
+    UpdateTotalBlkArea();
+  }
+}
+
+}
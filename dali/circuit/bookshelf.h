@@ -0,0 +1,169 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef DALI_CIRCUIT_BOOKSHELF_H_
+#define DALI_CIRCUIT_BOOKSHELF_H_
+
+#include <charconv>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "dali/common/mapped_file.h"
+#include "enums.h"
+
+/****
+ * This header file contains a reader of placement benchmarks in the Bookshelf
+ * format (.aux, .nodes, .nets, .wts, .pl, and .scl files), see
+ * Circuit::LoadBookshelf().
+ *
+ * Files are mapped into memory and split into tokens in place, names are
+ * std::string_view pointing into mapped files, so they are valid as long as
+ * the BookshelfReader is alive.
+ * ****/
+
+namespace dali {
+
+/****
+ * A tokenizer for a Bookshelf file in memory. Tokens are separated by white
+ * spaces, a ':' is a token by itself, and everything after a '#' in a line is
+ * a comment.
+ * ****/
+class BookshelfTokenizer {
+ public:
+  BookshelfTokenizer(char const *begin, char const *end)
+      : cur_(begin), end_(end), line_end_(begin) {}
+
+  // move to the next line containing tokens, return false at the end
+  bool NextLine();
+
+  // the next token in the current line, empty if there is no more token
+  std::string_view Token();
+
+  // convert a token to a number, return false if it is not a number
+  template<typename T>
+  static bool ToNumber(std::string_view token, T &value) {
+    if (!token.empty() && token[0] == '+') token.remove_prefix(1);
+    char const *last = token.data() + token.size();
+    auto ret = std::from_chars(token.data(), last, value);
+    return !token.empty() && ret.ec == std::errc() && ret.ptr == last;
+  }
+ private:
+  char const *cur_;
+  char const *end_;
+  char const *line_end_;
+  bool is_started_ = false;
+};
+
+// a row in .scl files
+struct BookshelfRow {
+  double y = 0;
+  double height = 0;
+  double site_width = 1;
+  double site_spacing = 1;
+  double x = 0;
+  int num_sites = 0;
+};
+
+// a node in .nodes files, together with its location in .pl files
+struct BookshelfNode {
+  std::string_view name;
+  double width = 0;
+  double height = 0;
+  bool is_terminal = false;
+  bool is_terminal_ni = false;
+  double x = 0;
+  double y = 0;
+  BlockOrient orient = N;
+  bool is_fixed = false;
+};
+
+// a pin of a net in .nets files, offsets are from the center of its node
+struct BookshelfNetPin {
+  int node_id = -1;
+  char direction = 'I';
+  double offset_x = 0;
+  double offset_y = 0;
+  int pin_id = -1; // index of this pin in the BlockType of its node
+};
+
+// a net in .nets files, its pins are [first_pin, first_pin + pin_count)
+struct BookshelfNet {
+  std::string_view name;
+  size_t first_pin = 0;
+  int pin_count = 0;
+  double weight = -1; // from .wts files, negative if not given
+};
+
+/****
+ * This class reads all files in a Bookshelf .aux file. Nodes are in the order
+ * of .nodes files, nets and net pins are in the order of .nets files.
+ * ****/
+class BookshelfReader {
+ public:
+  BookshelfReader(std::string const &aux_file_name, int num_threads);
+
+  std::vector<BookshelfRow> &Rows() { return rows_; }
+  std::vector<BookshelfNode> &Nodes() { return nodes_; }
+  std::vector<BookshelfNet> &Nets() { return nets_; }
+  std::vector<BookshelfNetPin> &NetPins() { return net_pins_; }
+
+  // the index of a node with a given name, -1 if not found
+  int NodeId(std::string_view name) const;
+ private:
+  int num_threads_ = 1;
+  std::vector<std::unique_ptr<MappedFile>> files_;
+  std::vector<BookshelfRow> rows_;
+  std::vector<BookshelfNode> nodes_;
+  std::unordered_map<std::string_view, int> node_ids_;
+  std::vector<BookshelfNet> nets_;
+  std::vector<BookshelfNetPin> net_pins_;
+
+  MappedFile &MapFile(std::string const &file_name);
+  void ReadScl(std::string const &file_name);
+  void ReadNodes(std::string const &file_name);
+  void ReadNets(std::string const &file_name);
+  void ReadWts(std::string const &file_name);
+  void ReadPl(std::string const &file_name);
+};
+
+/****
+ * @brief Call a function for each node location in a .pl file.
+ *
+ * @param file_name: name of the .pl file
+ * @param func: called with name, x, y, orientation and whether fixed
+ */
+void ReadBookshelfPl(
+    std::string const &file_name,
+    std::function<void(
+        std::string_view name,
+        double x,
+        double y,
+        std::string_view orient,
+        bool is_fixed
+    )> const &func
+);
+
+}
+
+#endif //DALI_CIRCUIT_BOOKSHELF_H_
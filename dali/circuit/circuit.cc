@@ -28,6 +28,7 @@
 #include <algorithm>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <string>
 
 #include "dali/common/elapsed_time.h"
@@ -61,6 +62,17 @@ void Circuit::InitializeFromPhyDB(phydb::PhyDB *phy_db_ptr) {
   elapsed_time.PrintTimeElapsed();
 }
 
+void Circuit::SetNumThreads(int num_threads) {
+  if (num_threads < 1) {
+    DaliWarning(
+        "Number of threads ("
+            << num_threads << ") for circuit is less than 1, using 1 instead"
+    );
+    num_threads = 1;
+  }
+  num_threads_ = num_threads;
+}
+
 int Circuit::Micron2DatabaseUnit(double x) const {
   return int(std::ceil(x * DatabaseMicrons()));
 }
@@ -692,6 +704,7 @@ Net *Circuit::AddNet(std::string const &net_name, int capacity, double weight) {
     weight = constants_.normal_net_weight;
   }
   design_.nets_.emplace_back(name_id_pair_ptr, capacity, weight);
+  design_.pin_table_.Invalidate();
   return &design_.nets_.back();
 }
 
@@ -707,6 +720,7 @@ void Circuit::AddIoPinToNet(
     Block *blk_ptr = GetBlockPtr(iopin_name);
     Pin *pin = &(blk_ptr->TypePtr()->PinList()[0]);
     io_net->AddBlkPinPair(blk_ptr, pin);
+    design_.pin_table_.Invalidate();
   }
 }
 
@@ -719,6 +733,7 @@ void Circuit::AddBlkPinToNet(
   Pin *pin = blk_ptr->TypePtr()->GetPinPtr(pin_name);
   Net *net = GetNetPtr(net_name);
   net->AddBlkPinPair(blk_ptr, pin);
+  design_.pin_table_.Invalidate();
 }
 
 void Circuit::ReportNetList() {
@@ -1190,32 +1205,102 @@ void Circuit::NetSortBlkPin() {
   for (auto &net : design_.nets_) {
     net.SortBlkPinList();
   }
+  design_.pin_table_.Invalidate();
+}
+
+void Circuit::UpdatePinTable() {
+  if (design_.pin_table_.IsBuilt()) {
+    design_.pin_table_.RefreshOffsets();
+  } else {
+    design_.pin_table_.Build(design_.nets_, design_.blocks_);
+  }
+}
+
+NetPinTable const &Circuit::PinTable() const {
+  DaliExpects(design_.pin_table_.IsBuilt(), "Pin table is not built");
+  return design_.pin_table_;
+}
+
+std::unique_ptr<BlockLocBinding> Circuit::BindBlockLocStore() {
+  DaliExpects(!design_.loc_store_.IsBound(),
+              "Block location store is already bound");
+  return std::make_unique<BlockLocBinding>(
+      design_.loc_store_, design_.blocks_
+  );
+}
+
+/****
+ * @brief Returns the span of a net in the x direction by visiting pins of its
+ * blocks directly, used when the pin table is not up to date.
+ */
+static void NetPinSpanX(Net &net, double &min_x, double &max_x) {
+  min_x = DBL_MAX;
+  max_x = -DBL_MAX;
+  for (auto &blk_pin : net.BlockPins()) {
+    double pin_x = blk_pin.AbsX();
+    min_x = std::min(min_x, pin_x);
+    max_x = std::max(max_x, pin_x);
+  }
+}
+
+static void NetPinSpanY(Net &net, double &min_y, double &max_y) {
+  min_y = DBL_MAX;
+  max_y = -DBL_MAX;
+  for (auto &blk_pin : net.BlockPins()) {
+    double pin_y = blk_pin.AbsY();
+    min_y = std::min(min_y, pin_y);
+    max_y = std::max(max_y, pin_y);
+  }
 }
 
+/****
+ * @brief Returns the weighted HPWL in the x direction. This function does not
+ * modify the circuit, so it can be called by multiple threads. The pin table
+ * is used if it is up to date, otherwise, pins are visited through nets.
+ */
 double Circuit::WeightedHPWLX() {
+  NetPinTable const &pin_table = design_.pin_table_;
+  bool is_pin_table_up_to_date = pin_table.IsUpToDate();
   double hpwl_x = 0;
-  for (auto &net : design_.nets_) {
-    hpwl_x += net.WeightedHPWLX();
+  int num_nets = static_cast<int>(design_.nets_.size());
+  for (int i = 0; i < num_nets; ++i) {
+    Net &net = design_.nets_[i];
+    if (net.PinCnt() <= 1) continue;
+    double min_x, max_x;
+    if (is_pin_table_up_to_date) {
+      pin_table.NetSpanX(i, min_x, max_x);
+    } else {
+      NetPinSpanX(net, min_x, max_x);
+    }
+    hpwl_x += (max_x - min_x) * net.Weight();
   }
   return hpwl_x * GridValueX();
 }
 
+/****
+ * @brief Returns the weighted HPWL in the y direction, see WeightedHPWLX().
+ */
 double Circuit::WeightedHPWLY() {
-  double hpwly = 0;
-  for (auto &net : design_.nets_) {
-    hpwly += net.WeightedHPWLY();
+  NetPinTable const &pin_table = design_.pin_table_;
+  bool is_pin_table_up_to_date = pin_table.IsUpToDate();
+  double hpwl_y = 0;
+  int num_nets = static_cast<int>(design_.nets_.size());
+  for (int i = 0; i < num_nets; ++i) {
+    Net &net = design_.nets_[i];
+    if (net.PinCnt() <= 1) continue;
+    double min_y, max_y;
+    if (is_pin_table_up_to_date) {
+      pin_table.NetSpanY(i, min_y, max_y);
+    } else {
+      NetPinSpanY(net, min_y, max_y);
+    }
+    hpwl_y += (max_y - min_y) * net.Weight();
   }
-  return hpwly * GridValueY();
+  return hpwl_y * GridValueY();
 }
 
 double Circuit::WeightedHPWL() {
-  double hpwl_x = 0;
-  double hpwl_y = 0;
-  for (auto &net : design_.nets_) {
-    hpwl_x += net.WeightedHPWLX();
-    hpwl_y += net.WeightedHPWLY();
-  }
-  return hpwl_x * GridValueX() + hpwl_y * GridValueY();
+  return WeightedHPWLX() + WeightedHPWLY();
 }
 
 void Circuit::ReportHPWL() {
@@ -1477,7 +1562,7 @@ void Circuit::GenLongNetTable(std::string const &name_of_file) {
   ost.close();
 }
 
-void Circuit::SaveCell(std::ofstream &ost, Block &blk) const {
+void Circuit::SaveCell(TextBuffer &ost, Block &blk) const {
   ost << "- "
       << blk.Name() << " "
       << blk.TypeName() << " + "
@@ -1490,7 +1575,7 @@ void Circuit::SaveCell(std::ofstream &ost, Block &blk) const {
 }
 
 void Circuit::SaveNormalCells(
-    std::ofstream &ost,
+    TextBuffer &ost,
     std::unordered_set<PlaceStatus> *filter_out
 ) {
   for (auto &blk : design_.blocks_) {
@@ -1503,14 +1588,14 @@ void Circuit::SaveNormalCells(
   }
 }
 
-void Circuit::SaveWellTapCells(std::ofstream &ost) {
+void Circuit::SaveWellTapCells(TextBuffer &ost) {
   for (auto &blk : design_.welltaps_) {
     SaveCell(ost, blk);
   }
 }
 
 void Circuit::SaveCircuitWellCoverCell(
-    std::ofstream &ost,
+    TextBuffer &ost,
     std::string const &base_name
 ) const {
   ost << "- " << "npwells" << " "
@@ -1525,7 +1610,7 @@ void Circuit::SaveCircuitWellCoverCell(
 }
 
 void Circuit::SaveCircuitPpnpCoverCell(
-    std::ofstream &ost,
+    TextBuffer &ost,
     std::string const &base_name
 ) const {
   ost << "- " << "ppnps" << " "
@@ -1539,7 +1624,7 @@ void Circuit::SaveCircuitPpnpCoverCell(
       << " ;\n";
 }
 
-void Circuit::ExportNormalCells(std::ofstream &ost) {
+void Circuit::ExportNormalCells(TextBuffer &ost) {
   //count the number of normal cells
   size_t cell_count = 0;
   for (auto &block : design_.blocks_) { // skip dummy cells for I/O pins
@@ -1553,7 +1638,7 @@ void Circuit::ExportNormalCells(std::ofstream &ost) {
   ost << "END COMPONENTS\n\n";
 }
 
-void Circuit::ExportWellTapCells(std::ofstream &ost) {
+void Circuit::ExportWellTapCells(TextBuffer &ost) {
   size_t cell_count = design_.welltaps_.size();
   ost << "COMPONENTS " << cell_count << " ;\n";
   SaveWellTapCells(ost);
@@ -1561,7 +1646,7 @@ void Circuit::ExportWellTapCells(std::ofstream &ost) {
 }
 
 void Circuit::ExportNormalAndWellTapCells(
-    std::ofstream &ost,
+    TextBuffer &ost,
     std::string const &base_name
 ) {
   size_t cell_count = 0;
@@ -1579,7 +1664,7 @@ void Circuit::ExportNormalAndWellTapCells(
 }
 
 void Circuit::ExportNormalWellTapAndCoverCells(
-    std::ofstream &ost,
+    TextBuffer &ost,
     std::string const &base_name
 ) {
   size_t cell_count = 0;
@@ -1598,7 +1683,7 @@ void Circuit::ExportNormalWellTapAndCoverCells(
 }
 
 void Circuit::ExportCellsExcept(
-    std::ofstream &ost,
+    TextBuffer &ost,
     std::unordered_set<PlaceStatus> *filter_out
 ) {
   size_t cell_count = 0;
@@ -1615,7 +1700,7 @@ void Circuit::ExportCellsExcept(
 }
 
 void Circuit::ExportCells(
-    std::ofstream &ost,
+    TextBuffer &ost,
     std::string const &base_name,
     int mode
 ) {
@@ -1654,7 +1739,7 @@ void Circuit::ExportCells(
 }
 
 void Circuit::SaveIoPin(
-    std::ofstream &ost,
+    TextBuffer &ost,
     IoPin &iopin,
     bool after_io_place
 ) const {
@@ -1694,7 +1779,7 @@ void Circuit::SaveIoPin(
   ost << " ;\n";
 }
 
-void Circuit::ExportIoPinsInfoAfterIoPlacement(std::ofstream &ost) {
+void Circuit::ExportIoPinsInfoAfterIoPlacement(TextBuffer &ost) {
   ost << "PINS " << design_.iopins_.size() << " ;\n";
   DaliExpects(!tech_.metal_list_.empty(),
               "Need metal layer info to generate PIN location\n");
@@ -1705,7 +1790,7 @@ void Circuit::ExportIoPinsInfoAfterIoPlacement(std::ofstream &ost) {
   ost << "END PINS\n\n";
 }
 
-void Circuit::ExportIoPinsInfoBeforeIoPlacement(std::ofstream &ost) {
+void Circuit::ExportIoPinsInfoBeforeIoPlacement(TextBuffer &ost) {
   ost << "PINS " << design_.iopins_.size() << " ;\n";
   DaliExpects(!tech_.metal_list_.empty(),
               "Need metal layer info to generate PIN location\n");
@@ -1716,7 +1801,7 @@ void Circuit::ExportIoPinsInfoBeforeIoPlacement(std::ofstream &ost) {
   ost << "END PINS\n\n";
 }
 
-void Circuit::ExportIoPins(std::ofstream &ost, int mode) {
+void Circuit::ExportIoPins(TextBuffer &ost, int mode) {
   switch (mode) {
     case 0: { // no IOPINs are saved
       ost << "PINS 0 ;\n";
@@ -1736,7 +1821,7 @@ void Circuit::ExportIoPins(std::ofstream &ost, int mode) {
   }
 }
 
-void Circuit::ExportAllNets(std::ofstream &ost) {
+void Circuit::ExportAllNets(TextBuffer &ost) {
   ost << "NETS " << design_.nets_.size() << " ;\n";
   for (auto &net : design_.nets_) {
     ost << "- " << net.Name() << "\n";
@@ -1756,7 +1841,7 @@ void Circuit::ExportAllNets(std::ofstream &ost) {
   ost << "END NETS\n\n";
 }
 
-void Circuit::ExportPowerNetsForWellTapCells(std::ofstream &ost) {
+void Circuit::ExportPowerNetsForWellTapCells(TextBuffer &ost) {
   ost << "\nNETS 2 ;\n";
   // GND
   ost << "- ggnndd\n";
@@ -1775,7 +1860,7 @@ void Circuit::ExportPowerNetsForWellTapCells(std::ofstream &ost) {
   ost << "END NETS\n\n";
 }
 
-void Circuit::ExportNets(std::ofstream &ost, int mode) {
+void Circuit::ExportNets(TextBuffer &ost, int mode) {
   switch (mode) {
     case 0: { // no nets are saved
       ost << "NETS 0 ;\n";
@@ -1833,19 +1918,53 @@ void Circuit::SaveDefFile(
     std::string const &base_name,
     std::string const &name_padding,
     std::string const &def_file_name,
-    [[maybe_unused]]int save_floorplan,
+    int save_floorplan,
     int save_cell,
     int save_iopin,
     int save_net
 ) {
-  std::string file_name = base_name + name_padding + ".def";
-  BOOST_LOG_TRIVIAL(info) << "Writing DEF file: " << file_name << "\n";
-  std::ofstream ost(file_name.c_str());
-  DaliExpects(ost.is_open(), "Cannot open file " + file_name);
+  SaveDefFiles(
+      base_name,
+      def_file_name,
+      {{name_padding, save_floorplan, save_cell, save_iopin, save_net}}
+  );
+}
+
+/****
+ * @brief Copy lines of a DEF file before the first line containing
+ * COMPONENTS, and optionally, lines after the first line containing
+ * END COMPONENTS. Only complete lines are copied.
+ *
+ * @param def_file_name: name of the DEF file
+ * @param head: lines before COMPONENTS
+ * @param tail: lines after END COMPONENTS, skipped if nullptr
+ */
+static void ReadDefFileAroundComponents(
+    std::string const &def_file_name,
+    TextBuffer &head,
+    TextBuffer *tail
+) {
   std::ifstream ist(def_file_name.c_str());
   DaliExpects(ist.is_open(), "Cannot open file " + def_file_name);
+  std::string line;
+  while (getline(ist, line)) {
+    if (ist.eof() || line.find("COMPONENTS") != std::string::npos) break;
+    head << line << '\n';
+  }
+  if (tail == nullptr) return;
+  while (getline(ist, line)) {
+    if (ist.eof() || line.find("END COMPONENTS") != std::string::npos) break;
+  }
+  std::string rest(
+      (std::istreambuf_iterator<char>(ist)),
+      std::istreambuf_iterator<char>()
+  );
+  // an incomplete last line is dropped
+  rest.resize(rest.find_last_of('\n') + 1);
+  *tail << rest;
+}
 
-  // title of this DEF file
+void Circuit::ExportDefTitle(TextBuffer &ost) const {
   using std::chrono::system_clock;
   system_clock::time_point today = system_clock::now();
   std::time_t tt = system_clock::to_time_t(today);
@@ -1854,24 +1973,92 @@ void Circuit::SaveDefFile(
       << "\n";
   ost << "#  time: " << ctime(&tt);
   ost << "##################################################\n";
+}
 
-  std::string line;
-  // 1. floor-plan
-  while (true) {
-    getline(ist, line);
-    if (line.find("COMPONENTS") != std::string::npos || ist.eof()) {
-      break;
+/****
+ * @brief Save placement to several DEF files, e.g., the DEF file for routing
+ * and the DEF file with well fillings.
+ *
+ * Everything before COMPONENTS in the input DEF file is read once, and each
+ * COMPONENTS, PINS and NETS section is generated once and shared by all DEF
+ * files saving it with the same option. Sections and files are generated and
+ * written in parallel using num_threads_ threads.
+ *
+ * @param base_name: output DEF file names are base_name + name_padding + ".def"
+ * @param def_file_name: input DEF file
+ * @param options: name padding and save options of each output DEF file
+ */
+void Circuit::SaveDefFiles(
+    std::string const &base_name,
+    std::string const &def_file_name,
+    std::vector<DefFileOption> const &options
+) {
+  // check options here, so that no error is raised in parallel regions
+  for (auto &option : options) {
+    DaliExpects(option.save_cell >= 0 && option.save_cell <= 5,
+                "Unknown option, allowed value: 0-5");
+    DaliExpects(option.save_iopin >= 0 && option.save_iopin <= 2,
+                "Unknown option, allowed value: 0-2\n");
+    DaliExpects(option.save_iopin == 0 || !tech_.metal_list_.empty(),
+                "Need metal layer info to generate PIN location\n");
+    DaliExpects(option.save_net >= 0 && option.save_net <= 3,
+                "Unknown option, allowed value: 0-3\n");
+    DaliExpects(option.save_net != 2, "This part has not been implemented\n");
+  }
+
+  // 1. floor-plan, the same for all DEF files
+  TextBuffer head;
+  ExportDefTitle(head);
+  ReadDefFileAroundComponents(def_file_name, head, nullptr);
+  TextBuffer end;
+  end << "END DESIGN\n";
+
+  // 2. COMPONENT, 3. PIN, 4. NET, each pair is {section, save option}
+  std::vector<std::pair<int, int>> section_keys;
+  std::vector<std::vector<TextBuffer const *>> file_buffers(options.size());
+  std::vector<std::vector<int>> file_sections(options.size());
+  for (size_t i = 0; i < options.size(); ++i) {
+    int modes[3] = {
+        options[i].save_cell, options[i].save_iopin, options[i].save_net
+    };
+    for (int section = 0; section < 3; ++section) {
+      std::pair<int, int> key(section, modes[section]);
+      auto it = std::find(section_keys.begin(), section_keys.end(), key);
+      file_sections[i].push_back(
+          static_cast<int>(it - section_keys.begin())
+      );
+      if (it == section_keys.end()) section_keys.push_back(key);
+    }
+  }
+  std::vector<TextBuffer> sections(section_keys.size());
+  int sections_count = static_cast<int>(sections.size());
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads_) default(none) shared(sections_count, sections, section_keys, base_name)
+  for (int i = 0; i < sections_count; ++i) {
+    int mode = section_keys[i].second;
+    switch (section_keys[i].first) {
+      case 0: ExportCells(sections[i], base_name, mode);
+        break;
+      case 1: ExportIoPins(sections[i], mode);
+        break;
+      default: ExportNets(sections[i], mode);
     }
-    ost << line << "\n";
   }
-  // 2. COMPONENT
-  ExportCells(ost, base_name, save_cell);
-  // 3. PIN
-  ExportIoPins(ost, save_iopin);
-  // 4. NET
-  ExportNets(ost, save_net);
 
-  ost << "END DESIGN\n";
+  std::vector<std::string> file_names;
+  for (size_t i = 0; i < options.size(); ++i) {
+    file_names.push_back(base_name + options[i].name_padding + ".def");
+    BOOST_LOG_TRIVIAL(info) << "Writing DEF file: " << file_names[i] << "\n";
+    file_buffers[i].push_back(&head);
+    for (auto &section_id : file_sections[i]) {
+      file_buffers[i].push_back(&sections[section_id]);
+    }
+    file_buffers[i].push_back(&end);
+  }
+  int files_count = static_cast<int>(options.size());
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads_) default(none) shared(files_count, file_names, file_buffers)
+  for (int i = 0; i < files_count; ++i) {
+    WriteTextFile(file_names[i], file_buffers[i]);
+  }
 }
 
 void Circuit::SaveDefFileComponent(
@@ -1880,61 +2067,34 @@ void Circuit::SaveDefFileComponent(
 ) {
   std::string file_name = name_of_file;
   BOOST_LOG_TRIVIAL(info) << "Writing DEF file: " << file_name << "\n";
-  std::ofstream ost(file_name.c_str());
-  DaliExpects(ost.is_open(), "Cannot open file " + file_name);
-  std::ifstream ist(def_file_name.c_str());
-  DaliExpects(ist.is_open(), "Cannot open file " + def_file_name);
 
-  // title of this DEF file
-  using std::chrono::system_clock;
-  system_clock::time_point today = system_clock::now();
-  std::time_t tt = system_clock::to_time_t(today);
-  ost << "##################################################\n";
-  ost << "#  created by: Dali, build time: " << __DATE__ << " " << __TIME__
-      << "\n";
-  ost << "#  time: " << ctime(&tt);
-  ost << "##################################################\n";
-
-  std::string line;
-  // copy everything before COMPONENTS
-  while (true) {
-    getline(ist, line);
-    if (line.find("COMPONENTS") != std::string::npos || ist.eof()) {
-      break;
-    }
-    ost << line << "\n";
-  }
+  // copy everything before COMPONENTS and after END COMPONENTS
+  TextBuffer head;
+  TextBuffer tail;
+  ExportDefTitle(head);
+  ReadDefFileAroundComponents(def_file_name, head, &tail);
   // COMPONENT
-  ExportCells(ost, "", 1);
+  TextBuffer components;
+  ExportCells(components, "", 1);
 
-  // copy everything after END COMPONENTS
-  while (true) {
-    getline(ist, line);
-    if (line.find("END COMPONENTS") != std::string::npos || ist.eof()) {
-      break;
-    }
-  }
-  while (true) {
-    getline(ist, line);
-    if (ist.eof()) {
-      break;
-    }
-    ost << line << "\n";
-  }
+  WriteTextFile(file_name, {&head, &components, &tail});
 }
 
 void Circuit::SaveBookshelfNode(std::string const &name_of_file) {
   std::ofstream ost(name_of_file.c_str());
   DaliExpects(ost.is_open(), "Cannot open file " + name_of_file);
   ost << "# this line is here just for ntuplace to recognize this file \n\n";
-  ost << "NumNodes : \t\t" << design_.tot_mov_blk_num_ << "\n"
+  ost << "NumNodes : \t\t" << design_.blocks_.size() << "\n"
       << "NumTerminals : \t\t"
       << design_.blocks_.size() - design_.tot_mov_blk_num_ << "\n";
   for (auto &block : design_.blocks_) {
     ost << "\t" << block.Name()
         << "\t" << block.Width() * design_.distance_microns_ * GridValueX()
-        << "\t" << block.Height() * design_.distance_microns_ * GridValueY()
-        << "\n";
+        << "\t" << block.Height() * design_.distance_microns_ * GridValueY();
+    if (!block.IsMovable()) {
+      ost << "\tterminal";
+    }
+    ost << "\n";
   }
 }
 
@@ -1979,24 +2139,51 @@ void Circuit::SaveBookshelfPl(std::string const &name_of_file) {
     ost << block.Name()
         << "\t" << int(block.LLX() * design_.distance_microns_ * GridValueX())
         << "\t" << int(block.LLY() * design_.distance_microns_ * GridValueY());
+    ost << "\t:\t" << OrientStr(block.Orient());
     if (block.IsMovable()) {
-      ost << "\t:\tN\n";
+      ost << "\n";
     } else {
-      ost << "\t:\tN\t/FIXED\n";
+      ost << "\t/FIXED\n";
     }
   }
   ost.close();
 }
 
+/****
+ * @brief Save rows covering the placement region to a .scl file. One site is
+ * one grid along X.
+ */
 void Circuit::SaveBookshelfScl(std::string const &name_of_file) {
   std::ofstream ost(name_of_file.c_str());
   DaliExpects(ost.is_open(), "Cannot open file " + name_of_file);
-  DaliExpects(false, "This part is to be implemented");
+  double factor_x = design_.distance_microns_ * GridValueX();
+  double factor_y = design_.distance_microns_ * GridValueY();
+  int row_height = RowHeightGridUnit();
+  int row_count = (RegionURY() - RegionLLY()) / row_height;
+  ost << "# this line is here just for ntuplace to recognize this file \n\n";
+  ost << "NumRows : " << row_count << "\n\n";
+  for (int i = 0; i < row_count; ++i) {
+    ost << "CoreRow Horizontal\n"
+        << "  Coordinate    :   "
+        << (RegionLLY() + i * row_height) * factor_y << "\n"
+        << "  Height        :   " << row_height * factor_y << "\n"
+        << "  Sitewidth     :   " << factor_x << "\n"
+        << "  Sitespacing   :   " << factor_x << "\n"
+        << "  Siteorient    :   1\n"
+        << "  Sitesymmetry  :   1\n"
+        << "  SubrowOrigin  :   " << RegionLLX() * factor_x
+        << "  NumSites  :  " << RegionURX() - RegionLLX() << "\n"
+        << "End\n";
+  }
 }
 
 void Circuit::SaveBookshelfWts(std::string const &name_of_file) {
   std::ofstream ost(name_of_file.c_str());
   DaliExpects(ost.is_open(), "Cannot open file " + name_of_file);
+  ost << "# this line is here just for ntuplace to recognize this file \n\n";
+  for (auto &net : design_.nets_) {
+    ost << "\t" << net.Name() << "\t" << net.Weight() << "\n";
+  }
 }
 
 void Circuit::SaveBookshelfAux(std::string const &name_of_file) {
@@ -2011,32 +2198,6 @@ void Circuit::SaveBookshelfAux(std::string const &name_of_file) {
       << name_of_file << ".scl";
 }
 
-void Circuit::LoadBookshelfPl(std::string const &name_of_file) {
-  std::ifstream ist(name_of_file.c_str());
-  DaliExpects(ist.is_open(), "Cannot open file " + name_of_file);
-
-  std::string line;
-  std::vector<std::string> res;
-  double lx = 0;
-  double ly = 0;
-
-  while (!ist.eof()) {
-    getline(ist, line);
-    StrTokenize(line, res);
-    if (res.size() >= 4) {
-      if (IsBlockExisting(res[0])) {
-        try {
-          lx = std::stod(res[1]) / GridValueX() / design_.distance_microns_;
-          ly = std::stod(res[2]) / GridValueY() / design_.distance_microns_;
-          GetBlockPtr(res[0])->SetLoc(lx, ly);
-        } catch (...) {
-          DaliExpects(false, "Invalid stod conversion:\n\t" + line);
-        }
-      }
-    }
-  }
-}
-
 void Circuit::CreateFakeWellForStandardCell() {
   tech_.CreateFakeWellForStandardCell(phy_db_ptr_);
 }
@@ -2173,6 +2334,8 @@ void Circuit::AddBlock(
               "Cannot add new Block, because net_list now is not empty");
   DaliExpects(design_.blocks_.size() < design_.blocks_.capacity(),
               "Cannot add new Block, because block list is full");
+  DaliExpects(!design_.loc_store_.IsBound(),
+              "Cannot add new Block, because block locations are bound to a store");
   DaliExpects(!IsBlockExisting(block_name),
               "Block exists, cannot create this block again: " + block_name);
   int id = static_cast<int>(design_.blk_name_id_map_.size());
@@ -2186,6 +2349,7 @@ void Circuit::AddBlock(
   design_.blocks_.emplace_back(
       block_type_ptr, name_id_pair_ptr, llx, lly, place_status, orient
   );
+  design_.pin_table_.Invalidate();
 
   if (!is_real_cel) return;
   // update statistics of blocks
@@ -2438,6 +2602,7 @@ void Circuit::LoadDesign(phydb::PhyDB *phy_db_ptr) {
   SetDieArea(die_area.LLX(), die_area.LLY(), die_area.URX(), die_area.URY());
 
   // 3. load all components
+  int first_blk_id = (int) design_.blocks_.size();
   for (auto &comp : components) {
     std::string blk_name(comp.GetName());
     std::string blk_type_name(comp.GetMacro()->GetName());
@@ -2452,32 +2617,134 @@ void Circuit::LoadDesign(phydb::PhyDB *phy_db_ptr) {
   }
 
   // 4. load all IOPINs
+  int first_iopin_id = (int) design_.iopins_.size();
   for (auto &iopin : iopins) {
     AddIoPinFromPhyDB(iopin);
   }
 
   // 5. load all NETs
+  LoadNets(phy_db_ptr, first_blk_id, first_iopin_id);
+}
+
+/****
+ * @brief Check if pins of the BlockType of each block created from a component
+ * in PhyDB are in the same order as pins of the macro of this component.
+ *
+ * Only macros referenced by components are checked, each of them once, so
+ * unused macros in LEF do not disable loading nets by indices.
+ *
+ * @param phy_db_ptr: the PhyDB to load from
+ * @param first_blk_id: index of the Block of the first component
+ */
+bool Circuit::IsPinOrderSameAsPhyDB(
+    phydb::PhyDB *phy_db_ptr,
+    int first_blk_id
+) {
+  auto &components = phy_db_ptr->GetDesignPtr()->GetComponentsRef();
+  std::unordered_set<phydb::Macro *> checked_macros;
+  int components_count = (int) components.size();
+  for (int i = 0; i < components_count; ++i) {
+    phydb::Macro *macro = components[i].GetMacro();
+    if (!checked_macros.insert(macro).second) continue;
+    auto &pins = design_.blocks_[first_blk_id + i].TypePtr()->PinList();
+    auto &macro_pins = macro->GetPinsRef();
+    if (pins.size() != macro_pins.size()) return false;
+    for (size_t j = 0; j < pins.size(); ++j) {
+      if (pins[j].Name() != macro_pins[j].GetName()) return false;
+    }
+  }
+  return true;
+}
+
+/****
+ * @brief Load NETs from PhyDB in bulk.
+ *
+ * Blocks are created in the same order as components in PhyDB, and pins of a
+ * BlockType are created in the same order as pins of its macro, so a net pin
+ * in PhyDB is mapped to a block pin by indices, without looking up any name.
+ * The net list of each block is sized in a counting pass, block pins of nets
+ * are filled concurrently, and then net lists of blocks are filled in the
+ * order of nets, the same as adding nets one by one.
+ *
+ * @param phy_db_ptr: the PhyDB to load from
+ * @param first_blk_id: index of the Block of the first component
+ * @param first_iopin_id: index of the IoPin of the first IOPIN
+ */
+void Circuit::LoadNets(
+    phydb::PhyDB *phy_db_ptr,
+    int first_blk_id,
+    int first_iopin_id
+) {
+  auto &phy_db_design = *(phy_db_ptr->GetDesignPtr());
+  auto &components = phy_db_design.GetComponentsRef();
+  auto &iopins = phy_db_design.GetIoPinsRef();
+  auto &nets = phy_db_design.GetNetsRef();
+  int nets_count = (int) nets.size();
+  int first_net_id = (int) design_.nets_.size();
+
+  // create NETs with exact capacities, and connect IOPINs to them
   for (auto &net : nets) {
-    std::string net_name(net.GetName());
-    auto &net_pins = net.GetPinsRef();
     std::vector<int> &iopin_ids = net.GetIoPinIdsRef();
-    int net_capacity = int(net_pins.size() + iopin_ids.size());
+    int net_capacity = (int) net.GetPinsRef().size();
+    for (int &id : iopin_ids) {
+      if (design_.iopins_[first_iopin_id + id].IsPrePlaced()) {
+        ++net_capacity;
+      }
+    }
+    std::string net_name(net.GetName());
     AddNet(net_name, net_capacity, design_.normal_signal_weight_);
-
     for (int &id : iopin_ids) {
       AddIoPinToNet(iopins[id].GetName(), net_name);
     }
-    int sz = (int) net_pins.size();
-    for (int i = 0; i < sz; ++i) {
-      int comp_id = net_pins[i].InstanceId();
-      std::string comp_name =
-          phy_db_ptr_->GetDesignPtr()->GetComponentsRef()[comp_id].GetName();
-      int pin_id = net_pins[i].PinId();
-      std::string pin_name =
-          phy_db_ptr_->GetDesignPtr()->GetComponentsRef()[comp_id].GetMacro()->GetPinsRef()[pin_id].GetName();
-      AddBlkPinToNet(comp_name, pin_name, net_name);
+  }
+
+  if (!IsPinOrderSameAsPhyDB(phy_db_ptr, first_blk_id)) {
+    BOOST_LOG_TRIVIAL(info)
+      << "Pins of BlockTypes differ from macros in PhyDB, loading nets by names\n";
+    for (auto &net : nets) {
+      std::string net_name(net.GetName());
+      for (auto &net_pin : net.GetPinsRef()) {
+        auto &comp = components[net_pin.InstanceId()];
+        std::string comp_name(comp.GetName());
+        std::string pin_name(
+            comp.GetMacro()->GetPinsRef()[net_pin.PinId()].GetName()
+        );
+        AddBlkPinToNet(comp_name, pin_name, net_name);
+      }
+    }
+    return;
+  }
+
+  auto &blocks = design_.blocks_;
+  std::vector<int> blk_net_counts(blocks.size(), 0);
+  for (auto &net : nets) {
+    for (auto &net_pin : net.GetPinsRef()) {
+      ++blk_net_counts[first_blk_id + net_pin.InstanceId()];
+    }
+  }
+  int blks_count = (int) blocks.size();
+  for (int i = 0; i < blks_count; ++i) {
+    auto &net_list = blocks[i].NetList();
+    net_list.reserve(net_list.size() + blk_net_counts[i]);
+  }
+
+#pragma omp parallel for schedule(dynamic, 64) num_threads(num_threads_) default(none) shared(nets_count, nets, blocks, first_blk_id, first_net_id)
+  for (int i = 0; i < nets_count; ++i) {
+    Net &net = design_.nets_[first_net_id + i];
+    for (auto &net_pin : nets[i].GetPinsRef()) {
+      Block &blk = blocks[first_blk_id + net_pin.InstanceId()];
+      Pin *pin = &(blk.TypePtr()->PinList()[net_pin.PinId()]);
+      net.AppendBlkPinPair(&blk, pin);
+    }
+  }
+
+  for (int i = 0; i < nets_count; ++i) {
+    int net_id = design_.nets_[first_net_id + i].Id();
+    for (auto &net_pin : nets[i].GetPinsRef()) {
+      blocks[first_blk_id + net_pin.InstanceId()].NetList().push_back(net_id);
     }
   }
+  design_.pin_table_.Invalidate();
 }
 
 void Circuit::LoadCell(phydb::PhyDB *phy_db_ptr) {
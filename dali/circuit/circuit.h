@@ -21,6 +21,7 @@
 #ifndef DALI_CIRCUIT_CIRCUIT_H_
 #define DALI_CIRCUIT_CIRCUIT_H_
 
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -30,13 +31,16 @@
 
 #include "block.h"
 #include "block_type.h"
+#include "bookshelf.h"
 #include "dali/common/helper.h"
 #include "dali/common/logging.h"
+#include "dali/common/text_buffer.h"
 #include "design.h"
 #include "enums.h"
 #include "iopin.h"
 #include "layer.h"
 #include "net.h"
+#include "snapshot.h"
 #include "tech.h"
 
 namespace dali {
@@ -49,6 +53,19 @@ struct CircuitConstants {
   double epsilon = 1e-6;
 };
 
+/****
+ * Name padding and save options of a DEF file saved by
+ * Circuit::SaveDefFiles(), see Circuit::SaveDefFile() for the meaning of
+ * each option.
+ */
+struct DefFileOption {
+  std::string name_padding;
+  int save_floorplan = 1;
+  int save_cell = 1;
+  int save_iopin = 1;
+  int save_net = 1;
+};
+
 /****
  * The class Circuit is an abstract of a circuit graph.
  * It contains two main parts:
@@ -81,6 +98,9 @@ class Circuit {
   // initialize data structure from a PhyDB, which should live longer than Circuit!
   void InitializeFromPhyDB(phydb::PhyDB *phy_db_ptr);
 
+  // set the number of threads used when loading NETs from PhyDB
+  void SetNumThreads(int num_threads);
+
   // convert length from um to database unit
   int Micron2DatabaseUnit(double x) const;
 
@@ -469,10 +489,23 @@ class Circuit {
   // sort block pais in nets
   void NetSortBlkPin();
 
+  // build the flattened pin table, or refresh pin offsets if orientations of some blocks changed
+  // needs to be called before phases reading the pin table, it is never called implicitly
+  void UpdatePinTable();
+
+  // get the flattened pin table, UpdatePinTable() needs to be called before this function
+  NetPinTable const &PinTable() const;
+
+  // move locations of all blocks to contiguous arrays, see BlockLocStore
+  // locations move back to Block objects when the returned binding is destroyed
+  std::unique_ptr<BlockLocBinding> BindBlockLocStore();
+
   // returns HPWL in the x direction, considering cell pin offsets, unit in micron
+  // read-only, faster if the pin table is up to date
   double WeightedHPWLX();
 
   // returns HPWL in the y direction, considering cell pin offsets, unit in micron
+  // read-only, faster if the pin table is up to date
   double WeightedHPWLY();
 
   // returns total HPWL, considering cell pin offsets, unit in micron
@@ -542,6 +575,13 @@ class Circuit {
       int save_net
   );
 
+  // save placement to several DEF files, the input DEF file is read only once
+  void SaveDefFiles(
+      std::string const &base_name,
+      std::string const &def_file_name,
+      std::vector<DefFileOption> const &options
+  );
+
   // save all components to a DEF file
   void SaveDefFileComponent(
       std::string const &name_of_file,
@@ -561,7 +601,18 @@ class Circuit {
 
   void SaveBookshelfAux(std::string const &name_of_file);
 
-  void LoadBookshelfPl(std::string const &name_of_file);
+  void LoadBookshelfPl(
+      std::string const &name_of_file,
+      bool is_prior_placement = false
+  );
+
+  // load .nodes, .nets, .wts, .pl, and .scl files listed in a .aux file
+  void LoadBookshelf(std::string const &aux_file_name);
+
+  /**** Save and load results in the binary snapshot format ****/
+  void SaveSnapshot(std::string const &file_name);
+
+  void LoadSnapshot(std::string const &file_name);
 
   /**** for standard cells ****/
   void CreateFakeWellForStandardCell();
@@ -571,6 +622,7 @@ class Circuit {
   Design design_; // information in DEF
   phydb::PhyDB *phy_db_ptr_ = nullptr;
   CircuitConstants constants_;
+  int num_threads_ = 1;
 
   void LoadImaginaryCellFile();
 
@@ -628,50 +680,75 @@ class Circuit {
   // load information in DEF
   void LoadDesign(phydb::PhyDB *phy_db_ptr);
 
+  // whether pins of BlockTypes used by components are in the same order as
+  // pins of their macros
+  bool IsPinOrderSameAsPhyDB(phydb::PhyDB *phy_db_ptr, int first_blk_id);
+
+  // load NETs in DEF, using indices of components and macro pins in PhyDB
+  void LoadNets(phydb::PhyDB *phy_db_ptr, int first_blk_id, int first_iopin_id);
+
+  // load everything in a snapshot into an empty circuit
+  void LoadSnapshotCircuit(SnapshotReader const &reader);
+
+  // load nets in a snapshot, using indices of blocks, pins and I/O pins
+  void LoadSnapshotNets(SnapshotReader const &reader);
+
+  // replace well-tap cells with those in a snapshot
+  void LoadSnapshotWellTaps(
+      SnapshotReader const &reader,
+      std::vector<BlockType *> &type_ptrs
+  );
+
+  // load placement results in a snapshot of this circuit
+  void LoadSnapshotPlacement(SnapshotReader const &reader);
+
   // load information in CELL
   void LoadCell(phydb::PhyDB *phy_db_ptr);
 
+  // export the title of a DEF file
+  void ExportDefTitle(TextBuffer &ost) const;
+
   // export cells/components to an output stream
-  void SaveCell(std::ofstream &ost, Block &blk) const;
+  void SaveCell(TextBuffer &ost, Block &blk) const;
   void SaveNormalCells(
-      std::ofstream &ost,
+      TextBuffer &ost,
       std::unordered_set<PlaceStatus> *filter_out = nullptr
   );
-  void SaveWellTapCells(std::ofstream &ost);
+  void SaveWellTapCells(TextBuffer &ost);
   void SaveCircuitWellCoverCell(
-      std::ofstream &ost,
+      TextBuffer &ost,
       std::string const &base_name
   ) const;
   void SaveCircuitPpnpCoverCell(
-      std::ofstream &ost,
+      TextBuffer &ost,
       std::string const &base_name
   ) const;
-  void ExportNormalCells(std::ofstream &ost);
-  void ExportWellTapCells(std::ofstream &ost);
+  void ExportNormalCells(TextBuffer &ost);
+  void ExportWellTapCells(TextBuffer &ost);
   void ExportNormalAndWellTapCells(
-      std::ofstream &ost,
+      TextBuffer &ost,
       std::string const &base_name
   );
   void ExportNormalWellTapAndCoverCells(
-      std::ofstream &ost,
+      TextBuffer &ost,
       std::string const &base_name
   );
   void ExportCellsExcept(
-      std::ofstream &ost,
+      TextBuffer &ost,
       std::unordered_set<PlaceStatus> *filter_out = nullptr
   );
   void ExportCells(
-      std::ofstream &ost,
+      TextBuffer &ost,
       std::string const &base_name,
       int mode
   );
-  void SaveIoPin(std::ofstream &ost, IoPin &iopin, bool after_io_place) const;
-  void ExportIoPinsInfoAfterIoPlacement(std::ofstream &ost);
-  void ExportIoPinsInfoBeforeIoPlacement(std::ofstream &ost);
-  void ExportIoPins(std::ofstream &ost, int mode);
-  void ExportAllNets(std::ofstream &ost);
-  void ExportPowerNetsForWellTapCells(std::ofstream &ost);
-  void ExportNets(std::ofstream &ost, int mode);
+  void SaveIoPin(TextBuffer &ost, IoPin &iopin, bool after_io_place) const;
+  void ExportIoPinsInfoAfterIoPlacement(TextBuffer &ost);
+  void ExportIoPinsInfoBeforeIoPlacement(TextBuffer &ost);
+  void ExportIoPins(TextBuffer &ost, int mode);
+  void ExportAllNets(TextBuffer &ost);
+  void ExportPowerNetsForWellTapCells(TextBuffer &ost);
+  void ExportNets(TextBuffer &ost, int mode);
 };
 
 }
@@ -27,8 +27,10 @@
 #include <vector>
 
 #include "block.h"
+#include "block_loc_store.h"
 #include "iopin.h"
 #include "net.h"
+#include "pin_table.h"
 
 namespace dali {
 
@@ -147,6 +149,10 @@ class Design {
   int net_count_limit_ = 0;
   std::unordered_map<std::string, int> net_name_id_map_;
   NetHistogram net_histogram_;
+  // flattened block pins of all nets
+  NetPinTable pin_table_;
+  // optional contiguous storage of block locations
+  BlockLocStore loc_store_;
 
   /****statistical data of the circuit****/
   unsigned long tot_width_ = 0;
@@ -0,0 +1,234 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "incremental_hpwl.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include <omp.h>
+
+namespace dali {
+
+/****
+ * @brief Index nets by blocks using the flattened pin table of a Circuit.
+ * Circuit::UpdatePinTable() must be called before this function, and the
+ * netlist must not change afterwards.
+ *
+ * @param ckt_ptr: the circuit to evaluate
+ */
+void IncrementalHpwl::Initialize(Circuit *ckt_ptr) {
+  DaliExpects(ckt_ptr != nullptr, "Circuit is a nullptr?");
+  ckt_ptr_ = ckt_ptr;
+  NetPinTable const &pin_table = ckt_ptr_->PinTable();
+  std::vector<Net> &nets = ckt_ptr_->Nets();
+  int num_blks = static_cast<int>(ckt_ptr_->Blocks().size());
+  int num_nets = pin_table.NetCnt();
+
+  net_weights_.resize(num_nets);
+  for (int i = 0; i < num_nets; ++i) {
+    net_weights_[i] = nets[i].Weight();
+  }
+
+  // a net with a single pin has no wirelength, and a block may appear
+  // multiple times in a net, which is harmless
+  blk_net_offsets_.assign(num_blks + 1, 0);
+  for (int i = 0; i < num_blks; ++i) {
+    blk_net_offsets_[i + 1] = blk_net_offsets_[i];
+    for (int k = pin_table.BlkPinBegin(i); k < pin_table.BlkPinEnd(i); ++k) {
+      int net_id = pin_table.PinNetId(pin_table.BlkPins()[k]);
+      if (pin_table.NetPinEnd(net_id) - pin_table.NetPinBegin(net_id) > 1) {
+        ++blk_net_offsets_[i + 1];
+      }
+    }
+  }
+  blk_nets_.resize(blk_net_offsets_[num_blks]);
+  int cursor = 0;
+  for (int i = 0; i < num_blks; ++i) {
+    for (int k = pin_table.BlkPinBegin(i); k < pin_table.BlkPinEnd(i); ++k) {
+      int net_id = pin_table.PinNetId(pin_table.BlkPins()[k]);
+      if (pin_table.NetPinEnd(net_id) - pin_table.NetPinBegin(net_id) > 1) {
+        blk_nets_[cursor++] = net_id;
+      }
+    }
+  }
+
+  Reset();
+}
+
+/****
+ * @brief Set the distance a block needs to move before its nets are
+ * recomputed. A non-zero threshold trades accuracy for speed, the error of
+ * each pin is bounded by the threshold.
+ *
+ * @param threshold_x: threshold in the x direction, in grid units
+ * @param threshold_y: threshold in the y direction, in grid units
+ */
+void IncrementalHpwl::SetMoveThresholds(double threshold_x, double threshold_y) {
+  DaliExpects(threshold_x >= 0 && threshold_y >= 0, "Negative threshold?");
+  cache_x_.move_threshold = threshold_x;
+  cache_y_.move_threshold = threshold_y;
+}
+
+/****
+ * @brief Drop all cached values.
+ */
+void IncrementalHpwl::Reset() {
+  cache_x_.is_valid = false;
+  cache_y_.is_valid = false;
+}
+
+double IncrementalHpwl::WeightedHPWLX(int num_threads) {
+  return Evaluate(cache_x_, true, num_threads) * ckt_ptr_->GridValueX();
+}
+
+double IncrementalHpwl::WeightedHPWLY(int num_threads) {
+  return Evaluate(cache_y_, false, num_threads) * ckt_ptr_->GridValueY();
+}
+
+/****
+ * @brief Update cached net HPWLs in one direction and return the sum.
+ *
+ * @param cache: cached states of this direction
+ * @param is_x_direction: true for x, false for y
+ * @param num_threads: number of threads
+ * @return the weighted HPWL in grid units
+ */
+double IncrementalHpwl::Evaluate(
+    AxisCache &cache,
+    bool is_x_direction,
+    int num_threads
+) {
+  DaliExpects(ckt_ptr_ != nullptr, "IncrementalHpwl is not initialized");
+  DaliExpects(num_threads >= 1, "Number of threads less than 1?");
+  std::vector<Block> &blocks = ckt_ptr_->Blocks();
+  NetPinTable const &pin_table = ckt_ptr_->PinTable();
+  std::vector<double> const &pin_offsets =
+      is_x_direction ? pin_table.PinOffsetsX() : pin_table.PinOffsetsY();
+  std::vector<int> const &pin_blk_ids = pin_table.PinBlkIds();
+  int num_blks = static_cast<int>(blocks.size());
+  int num_nets = static_cast<int>(net_weights_.size());
+  int num_groups = (num_nets + kGroupSize - 1) / kGroupSize;
+
+  // pin offsets changed, cached values are no longer valid
+  if (cache.pin_table_version != pin_table.Version()) {
+    cache.is_valid = false;
+    cache.pin_table_version = pin_table.Version();
+  }
+  if (!cache.is_valid) {
+    cache.blk_locs.resize(num_blks);
+    cache.net_hpwls.resize(num_nets);
+    cache.is_net_dirty.assign(num_nets, 0);
+    cache.group_sums.resize(num_groups);
+    cache.is_group_dirty.assign(num_groups, 1);
+  }
+  if (static_cast<int>(cache.dirty_nets.size()) < num_threads) {
+    cache.dirty_nets.resize(num_threads);
+  }
+
+  std::vector<double> &blk_locs = cache.blk_locs;
+  std::vector<unsigned char> &is_net_dirty = cache.is_net_dirty;
+  std::vector<unsigned char> &is_group_dirty = cache.is_group_dirty;
+  bool is_valid = cache.is_valid;
+  double move_threshold = cache.move_threshold;
+  // computes the HPWL of a net using cached block locations
+  auto update_net = [&](int net_id) {
+    int pin_begin = pin_table.NetPinBegin(net_id);
+    int pin_end = pin_table.NetPinEnd(net_id);
+    if (pin_end - pin_begin <= 1) {
+      cache.net_hpwls[net_id] = 0;
+      return;
+    }
+    double max_loc = -DBL_MAX;
+    double min_loc = DBL_MAX;
+    for (int k = pin_begin; k < pin_end; ++k) {
+      double pin_loc = pin_offsets[k] + blk_locs[pin_blk_ids[k]];
+      max_loc = std::max(max_loc, pin_loc);
+      min_loc = std::min(min_loc, pin_loc);
+    }
+    cache.net_hpwls[net_id] = (max_loc - min_loc) * net_weights_[net_id];
+  };
+
+#pragma omp parallel num_threads(num_threads)
+  {
+    std::vector<int> &dirty_nets = cache.dirty_nets[omp_get_thread_num()];
+    dirty_nets.clear();
+    if (is_valid) {
+      // find nets connected to blocks moved beyond the threshold
+#pragma omp for schedule(static)
+      for (int i = 0; i < num_blks; ++i) {
+        double loc = is_x_direction ? blocks[i].LLX() : blocks[i].LLY();
+        if (std::fabs(loc - blk_locs[i]) <= move_threshold) continue;
+        blk_locs[i] = loc;
+        for (int k = blk_net_offsets_[i]; k < blk_net_offsets_[i + 1]; ++k) {
+          int net_id = blk_nets_[k];
+          unsigned char was_dirty;
+#pragma omp atomic capture
+          {
+            was_dirty = is_net_dirty[net_id];
+            is_net_dirty[net_id] = 1;
+          }
+          if (!was_dirty) {
+            dirty_nets.push_back(net_id);
+          }
+        }
+      }
+      for (int net_id: dirty_nets) {
+        update_net(net_id);
+        is_net_dirty[net_id] = 0;
+#pragma omp atomic write
+        is_group_dirty[net_id / kGroupSize] = 1;
+      }
+#pragma omp barrier
+    } else {
+#pragma omp for schedule(static)
+      for (int i = 0; i < num_blks; ++i) {
+        blk_locs[i] = is_x_direction ? blocks[i].LLX() : blocks[i].LLY();
+      }
+#pragma omp for schedule(static)
+      for (int i = 0; i < num_nets; ++i) {
+        update_net(i);
+      }
+    }
+
+    // recompute partial sums of groups containing updated nets
+#pragma omp for schedule(static)
+    for (int g = 0; g < num_groups; ++g) {
+      if (!is_group_dirty[g]) continue;
+      is_group_dirty[g] = 0;
+      double sum = 0;
+      int net_end = std::min(num_nets, (g + 1) * kGroupSize);
+      for (int i = g * kGroupSize; i < net_end; ++i) {
+        sum += cache.net_hpwls[i];
+      }
+      cache.group_sums[g] = sum;
+    }
+  }
+  cache.is_valid = true;
+
+  double hpwl = 0;
+  for (auto &group_sum: cache.group_sums) {
+    hpwl += group_sum;
+  }
+  return hpwl;
+}
+
+}
@@ -0,0 +1,88 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef DALI_CIRCUIT_INCREMENTAL_HPWL_H_
+#define DALI_CIRCUIT_INCREMENTAL_HPWL_H_
+
+#include <vector>
+
+#include "circuit.h"
+
+namespace dali {
+
+/****
+ * This class evaluates the weighted HPWL of a Circuit incrementally.
+ *
+ * Nets are evaluated over the flattened pin table of the Circuit, so
+ * evaluating a net does not go through Block and Pin pointers. The weighted
+ * HPWL of each net is cached together with the block locations
+ * used to compute it. In each evaluation, only nets connected to blocks which
+ * moved more than a threshold since the last update are recomputed, and the
+ * total is reduced over fixed-size groups of nets, so the result does not
+ * depend on the number of threads.
+ *
+ * With a zero threshold, the result equals Circuit::WeightedHPWLX/Y() up to
+ * the rounding of the summation. Cached values are dropped automatically if
+ * pin offsets in the pin table change.
+ */
+class IncrementalHpwl {
+ public:
+  IncrementalHpwl() = default;
+  void Initialize(Circuit *ckt_ptr);
+  void SetMoveThresholds(double threshold_x, double threshold_y);
+  void Reset();
+
+  // returns HPWL in the x direction, considering cell pin offsets, unit in micron
+  double WeightedHPWLX(int num_threads = 1);
+
+  // returns HPWL in the y direction, considering cell pin offsets, unit in micron
+  double WeightedHPWLY(int num_threads = 1);
+ private:
+  Circuit *ckt_ptr_ = nullptr;
+
+  std::vector<double> net_weights_;
+  // nets connected to each block in compressed format
+  std::vector<int> blk_net_offsets_;
+  std::vector<int> blk_nets_;
+
+  // cached states in one direction
+  struct AxisCache {
+    bool is_valid = false;
+    unsigned long pin_table_version = 0;
+    double move_threshold = 0;
+    // block locations when their nets were last updated
+    std::vector<double> blk_locs;
+    std::vector<double> net_hpwls;
+    std::vector<unsigned char> is_net_dirty;
+    // partial sums of net HPWLs, one per group of nets
+    std::vector<double> group_sums;
+    std::vector<unsigned char> is_group_dirty;
+    // nets to be updated, found by each thread
+    std::vector<std::vector<int>> dirty_nets;
+  };
+  static constexpr int kGroupSize = 4096;
+  AxisCache cache_x_;
+  AxisCache cache_y_;
+  double Evaluate(AxisCache &cache, bool is_x_direction, int num_threads);
+};
+
+}
+
+#endif //DALI_CIRCUIT_INCREMENTAL_HPWL_H_
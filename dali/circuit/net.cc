@@ -25,6 +25,7 @@
 #include <algorithm>
 
 #include "dali/common/misc.h"
+#include "pin_table.h"
 
 namespace dali {
 
@@ -52,6 +53,13 @@ int Net::Id() const {
 }
 
 void Net::AddBlkPinPair(Block *block_ptr, Pin *pin_ptr) {
+  AppendBlkPinPair(block_ptr, pin_ptr);
+  // because net list is stored as a vector, so the location of a net will change, thus here, we have to use Num() to
+  // find a net, although a pointer to this net is more convenient.
+  block_ptr->NetList().push_back(Id());
+}
+
+void Net::AppendBlkPinPair(Block *block_ptr, Pin *pin_ptr) {
   if (blk_pins_.size() < blk_pins_.capacity()) {
     blk_pins_.emplace_back(block_ptr, pin_ptr);
     if (!(pin_ptr->IsInput()))
@@ -59,9 +67,6 @@ void Net::AddBlkPinPair(Block *block_ptr, Pin *pin_ptr) {
     if (!block_ptr->IsMovable()) {
       ++cnt_fixed_;
     }
-    // because net list is stored as a vector, so the location of a net will change, thus here, we have to use Num() to
-    // find a net, although a pointer to this net is more convenient.
-    block_ptr->NetList().push_back(Id());
     int p_minus_one = int(blk_pins_.size()) - 1;
     inv_p_ = p_minus_one > 0 ? 1.0 * weight_ / p_minus_one : 0;
   } else {
@@ -274,6 +279,16 @@ void Net::UpdateMaxMinIndex() {
   UpdateMaxMinIdY();
 }
 
+void Net::UpdateMaxMinIdX(NetPinTable const &pin_table) {
+  if (blk_pins_.empty()) return;
+  pin_table.MaxMinPinIdX(Id(), max_x_pin_id_, min_x_pin_id_);
+}
+
+void Net::UpdateMaxMinIdY(NetPinTable const &pin_table) {
+  if (blk_pins_.empty()) return;
+  pin_table.MaxMinPinIdY(Id(), max_y_pin_id_, min_y_pin_id_);
+}
+
 int Net::MaxBlkPinIdX() const {
   return max_x_pin_id_;
 }
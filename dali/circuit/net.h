@@ -34,6 +34,7 @@ namespace dali {
 
 class NetAux;
 class IoPin;
+class NetPinTable;
 
 /****
  * This is a class for nets. When initializing a net, its capacity and weight need
@@ -57,6 +58,10 @@ class Net {
   // add block/pin pair to this net
   void AddBlkPinPair(Block *block_ptr, Pin *pin_ptr);
 
+  // add block/pin pair to this net without updating the net list of the block,
+  // so that pins can be added to different nets concurrently
+  void AppendBlkPinPair(Block *block_ptr, Pin *pin_ptr);
+
   std::vector<NetPin> &BlockPins();
 
   // add an I/O pin to this net
@@ -100,6 +105,12 @@ class Net {
   // find the indices for pins in both directions
   void UpdateMaxMinIndex();
 
+  // find the indices for pins with maximum x location and minimum x location using the flattened pin table
+  void UpdateMaxMinIdX(NetPinTable const &pin_table);
+
+  // find the indices for pins with maximum y location and minimum y location using the flattened pin table
+  void UpdateMaxMinIdY(NetPinTable const &pin_table);
+
   // get the index of the BlockPin pair with the maximum x location
   int MaxBlkPinIdX() const;
 
@@ -0,0 +1,230 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "pin_table.h"
+
+#include <cfloat>
+
+#include "net.h"
+
+namespace dali {
+
+/****
+ * @brief Flatten block pins of all nets. The table keeps a pointer to the
+ * block list, so it must be invalidated when blocks or nets are added.
+ *
+ * @param nets: all nets of a circuit
+ * @param blocks: all blocks of a circuit
+ */
+void NetPinTable::Build(std::vector<Net> &nets, std::vector<Block> &blocks) {
+  blocks_ = &blocks;
+  int num_nets = static_cast<int>(nets.size());
+  int num_blks = static_cast<int>(blocks.size());
+
+  size_t num_pins = 0;
+  for (auto &net: nets) {
+    num_pins += net.PinCnt();
+  }
+  net_pin_offsets_.assign(num_nets + 1, 0);
+  pin_blk_ids_.clear();
+  pin_blk_ids_.reserve(num_pins);
+  pin_net_ids_.clear();
+  pin_net_ids_.reserve(num_pins);
+  pin_ptrs_.clear();
+  pin_ptrs_.reserve(num_pins);
+  pin_offsets_x_.clear();
+  pin_offsets_x_.reserve(num_pins);
+  pin_offsets_y_.clear();
+  pin_offsets_y_.reserve(num_pins);
+  for (int i = 0; i < num_nets; ++i) {
+    for (auto &blk_pin: nets[i].BlockPins()) {
+      pin_blk_ids_.push_back(blk_pin.BlkId());
+      pin_net_ids_.push_back(i);
+      pin_ptrs_.push_back(blk_pin.PinPtr());
+      pin_offsets_x_.push_back(blk_pin.OffsetX());
+      pin_offsets_y_.push_back(blk_pin.OffsetY());
+    }
+    net_pin_offsets_[i + 1] = static_cast<int>(pin_blk_ids_.size());
+  }
+
+  // index pins by blocks using a counting sort
+  blk_pin_offsets_.assign(num_blks + 1, 0);
+  for (int blk_id: pin_blk_ids_) {
+    ++blk_pin_offsets_[blk_id + 1];
+  }
+  for (int i = 0; i < num_blks; ++i) {
+    blk_pin_offsets_[i + 1] += blk_pin_offsets_[i];
+  }
+  blk_pins_.resize(pin_blk_ids_.size());
+  std::vector<int> cursor(blk_pin_offsets_.begin(), blk_pin_offsets_.end() - 1);
+  int pin_cnt = PinCnt();
+  for (int k = 0; k < pin_cnt; ++k) {
+    blk_pins_[cursor[pin_blk_ids_[k]]++] = k;
+  }
+
+  blk_orients_.resize(num_blks);
+  for (int i = 0; i < num_blks; ++i) {
+    blk_orients_[i] = blocks[i].Orient();
+  }
+  is_built_ = true;
+  ++version_;
+}
+
+/****
+ * @brief Check whether the table is built for the current block list, and
+ * offsets are resolved for the current orientations of all blocks. This
+ * function does not modify the table, so it can be called by multiple threads.
+ */
+bool NetPinTable::IsUpToDate() const {
+  if (!is_built_) return false;
+  if (blocks_->size() != blk_orients_.size()) return false;
+  int num_blks = static_cast<int>(blk_orients_.size());
+  for (int i = 0; i < num_blks; ++i) {
+    if ((*blocks_)[i].Orient() != blk_orients_[i]) return false;
+  }
+  return true;
+}
+
+/****
+ * @brief Resolve pin offsets again for blocks whose orientations changed
+ * since the last call.
+ *
+ * @return true if any offset is updated
+ */
+bool NetPinTable::RefreshOffsets() {
+  DaliExpects(is_built_, "NetPinTable is not built");
+  bool is_changed = false;
+  int num_blks = static_cast<int>(blk_orients_.size());
+  for (int i = 0; i < num_blks; ++i) {
+    BlockOrient orient = (*blocks_)[i].Orient();
+    if (orient == blk_orients_[i]) continue;
+    blk_orients_[i] = orient;
+    for (int k = blk_pin_offsets_[i]; k < blk_pin_offsets_[i + 1]; ++k) {
+      int pin = blk_pins_[k];
+      pin_offsets_x_[pin] = pin_ptrs_[pin]->OffsetX(orient);
+      pin_offsets_y_[pin] = pin_ptrs_[pin]->OffsetY(orient);
+    }
+    is_changed = true;
+  }
+  if (is_changed) {
+    ++version_;
+  }
+  return is_changed;
+}
+
+void NetPinTable::NetSpanX(int net_id, double &min_x, double &max_x) const {
+  double lo = DBL_MAX;
+  double hi = -DBL_MAX;
+  Block const *blocks = blocks_->data();
+  int const *blk_ids = pin_blk_ids_.data();
+  double const *offsets = pin_offsets_x_.data();
+  int pin_end = net_pin_offsets_[net_id + 1];
+#pragma omp simd reduction(min:lo) reduction(max:hi)
+  for (int k = net_pin_offsets_[net_id]; k < pin_end; ++k) {
+    double loc = offsets[k] + blocks[blk_ids[k]].LLX();
+    lo = loc < lo ? loc : lo;
+    hi = loc > hi ? loc : hi;
+  }
+  min_x = lo;
+  max_x = hi;
+}
+
+void NetPinTable::NetSpanY(int net_id, double &min_y, double &max_y) const {
+  double lo = DBL_MAX;
+  double hi = -DBL_MAX;
+  Block const *blocks = blocks_->data();
+  int const *blk_ids = pin_blk_ids_.data();
+  double const *offsets = pin_offsets_y_.data();
+  int pin_end = net_pin_offsets_[net_id + 1];
+#pragma omp simd reduction(min:lo) reduction(max:hi)
+  for (int k = net_pin_offsets_[net_id]; k < pin_end; ++k) {
+    double loc = offsets[k] + blocks[blk_ids[k]].LLY();
+    lo = loc < lo ? loc : lo;
+    hi = loc > hi ? loc : hi;
+  }
+  min_y = lo;
+  max_y = hi;
+}
+
+/****
+ * @brief Find pins with the maximum and the minimum location in a net. The
+ * extreme values are found by a vectorized reduction first, then the first
+ * pins reaching them are located, which gives the same result as a
+ * sequential scan with strict comparisons.
+ */
+void NetPinTable::MaxMinPinId(
+    int net_id,
+    std::vector<double> const &pin_offsets,
+    bool is_x_direction,
+    int &max_pin_id,
+    int &min_pin_id
+) const {
+  int pin_begin = net_pin_offsets_[net_id];
+  int pin_end = net_pin_offsets_[net_id + 1];
+  max_pin_id = 0;
+  min_pin_id = 0;
+  if (pin_end - pin_begin <= 1) return;
+
+  double min_loc, max_loc;
+  if (is_x_direction) {
+    NetSpanX(net_id, min_loc, max_loc);
+  } else {
+    NetSpanY(net_id, min_loc, max_loc);
+  }
+  // if all pins are at the same location, max id must differ from min id
+  if (max_loc == min_loc) {
+    max_pin_id = 0;
+    min_pin_id = 1;
+    return;
+  }
+  bool is_max_found = false;
+  bool is_min_found = false;
+  for (int k = pin_begin; k < pin_end; ++k) {
+    Block const &block = (*blocks_)[pin_blk_ids_[k]];
+    double loc = pin_offsets[k] + (is_x_direction ? block.LLX() : block.LLY());
+    if (!is_max_found && loc == max_loc) {
+      max_pin_id = k - pin_begin;
+      is_max_found = true;
+    }
+    if (!is_min_found && loc == min_loc) {
+      min_pin_id = k - pin_begin;
+      is_min_found = true;
+    }
+    if (is_max_found && is_min_found) break;
+  }
+}
+
+void NetPinTable::MaxMinPinIdX(
+    int net_id,
+    int &max_pin_id,
+    int &min_pin_id
+) const {
+  MaxMinPinId(net_id, pin_offsets_x_, true, max_pin_id, min_pin_id);
+}
+
+void NetPinTable::MaxMinPinIdY(
+    int net_id,
+    int &max_pin_id,
+    int &min_pin_id
+) const {
+  MaxMinPinId(net_id, pin_offsets_y_, false, max_pin_id, min_pin_id);
+}
+
+}
@@ -0,0 +1,125 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2021 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef DALI_CIRCUIT_PIN_TABLE_H_
+#define DALI_CIRCUIT_PIN_TABLE_H_
+
+#include <vector>
+
+#include "block.h"
+#include "enums.h"
+
+namespace dali {
+
+class Net;
+
+/****
+ * This class is a flattened copy of block pins of all nets, stored as
+ * structure-of-arrays in compressed-row format:
+ *   pins of net i are in [NetPinBegin(i), NetPinEnd(i)), in the same order as
+ *   Net::BlockPins(), and for each pin, the block index, the net index, and
+ *   offsets resolved for the current orientation of its block are stored in
+ *   contiguous arrays.
+ * Pins of each block are also indexed, so that offsets can be refreshed when
+ * orientations of some blocks change.
+ *
+ * The table is not refreshed automatically. Adding blocks or nets invalidates
+ * it, and changing the orientation of a block makes it stale until
+ * RefreshOffsets() is called, which IsUpToDate() detects without modifying
+ * the table.
+ *
+ * Hot loops evaluating bounding boxes of nets can run over these arrays
+ * instead of chasing Block and Pin pointers in NetPin.
+ */
+class NetPinTable {
+ public:
+  NetPinTable() = default;
+
+  void Build(std::vector<Net> &nets, std::vector<Block> &blocks);
+  bool IsBuilt() const { return is_built_; }
+  void Invalidate() { is_built_ = false; }
+  bool IsUpToDate() const;
+  bool RefreshOffsets();
+  // increases every time the table is built or offsets change
+  unsigned long Version() const { return version_; }
+
+  int NetCnt() const { return static_cast<int>(net_pin_offsets_.size()) - 1; }
+  int PinCnt() const { return static_cast<int>(pin_blk_ids_.size()); }
+  int NetPinBegin(int net_id) const { return net_pin_offsets_[net_id]; }
+  int NetPinEnd(int net_id) const { return net_pin_offsets_[net_id + 1]; }
+  int PinBlkId(int pin) const { return pin_blk_ids_[pin]; }
+  int PinNetId(int pin) const { return pin_net_ids_[pin]; }
+  double PinOffsetX(int pin) const { return pin_offsets_x_[pin]; }
+  double PinOffsetY(int pin) const { return pin_offsets_y_[pin]; }
+  std::vector<int> const &PinBlkIds() const { return pin_blk_ids_; }
+  std::vector<int> const &PinNetIds() const { return pin_net_ids_; }
+  std::vector<double> const &PinOffsetsX() const { return pin_offsets_x_; }
+  std::vector<double> const &PinOffsetsY() const { return pin_offsets_y_; }
+  std::vector<Pin *> const &PinPtrs() const { return pin_ptrs_; }
+  int BlkPinBegin(int blk_id) const { return blk_pin_offsets_[blk_id]; }
+  int BlkPinEnd(int blk_id) const { return blk_pin_offsets_[blk_id + 1]; }
+  // indices of pins in this table, grouped by blocks
+  std::vector<int> const &BlkPins() const { return blk_pins_; }
+
+  // absolute location of a pin
+  double PinAbsX(int pin) const {
+    return pin_offsets_x_[pin] + (*blocks_)[pin_blk_ids_[pin]].LLX();
+  }
+  double PinAbsY(int pin) const {
+    return pin_offsets_y_[pin] + (*blocks_)[pin_blk_ids_[pin]].LLY();
+  }
+
+  // bounding box of a net in one direction
+  void NetSpanX(int net_id, double &min_x, double &max_x) const;
+  void NetSpanY(int net_id, double &min_y, double &max_y) const;
+
+  // indices of pins with the maximum and minimum location, relative to the
+  // first pin of the net, ties are broken by the smallest index
+  void MaxMinPinIdX(int net_id, int &max_pin_id, int &min_pin_id) const;
+  void MaxMinPinIdY(int net_id, int &max_pin_id, int &min_pin_id) const;
+ private:
+  bool is_built_ = false;
+  unsigned long version_ = 0;
+  std::vector<Block> *blocks_ = nullptr;
+
+  std::vector<int> net_pin_offsets_;
+  std::vector<int> pin_blk_ids_;
+  std::vector<int> pin_net_ids_;
+  std::vector<Pin *> pin_ptrs_;
+  std::vector<double> pin_offsets_x_;
+  std::vector<double> pin_offsets_y_;
+
+  std::vector<int> blk_pin_offsets_;
+  std::vector<int> blk_pins_;
+  // orientations of blocks when offsets were resolved
+  std::vector<BlockOrient> blk_orients_;
+
+  void MaxMinPinId(
+      int net_id,
+      std::vector<double> const &pin_offsets,
+      bool is_x_direction,
+      int &max_pin_id,
+      int &min_pin_id
+  ) const;
+};
+
+}
+
+#endif //DALI_CIRCUIT_PIN_TABLE_H_
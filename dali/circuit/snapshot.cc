@@ -0,0 +1,697 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#include "circuit.h"
+
+namespace dali {
+
+constexpr uint64_t kSnapshotAlignment = 8;
+
+static uint64_t AlignSnapshotOffset(uint64_t offset) {
+  return (offset + kSnapshotAlignment - 1) / kSnapshotAlignment
+      * kSnapshotAlignment;
+}
+
+SnapshotStr SnapshotWriter::AddStr(std::string const &str) {
+  SnapshotStr ret{strings_.size(), str.size()};
+  strings_.append(str);
+  return ret;
+}
+
+void SnapshotWriter::AddSection(uint32_t id, void const *data, uint64_t size) {
+  ids_.push_back(id);
+  data_.push_back(static_cast<char const *>(data));
+  sizes_.push_back(size);
+}
+
+void SnapshotWriter::Write(std::string const &file_name) {
+  AddSection(kSnapshotStrings, strings_.data(), strings_.size());
+
+  SnapshotHeader header{};
+  std::memcpy(header.magic, kSnapshotMagic, sizeof(header.magic));
+  header.version = kSnapshotVersion;
+  header.byte_order_mark = kSnapshotByteOrderMark;
+  header.section_count = static_cast<uint32_t>(ids_.size());
+
+  std::vector<SnapshotSection> sections(ids_.size());
+  uint64_t offset = sizeof(SnapshotHeader)
+      + sections.size() * sizeof(SnapshotSection);
+  for (size_t i = 0; i < sections.size(); ++i) {
+    offset = AlignSnapshotOffset(offset);
+    sections[i].id = ids_[i];
+    sections[i].padding = 0;
+    sections[i].offset = offset;
+    sections[i].size = sizes_[i];
+    offset += sizes_[i];
+  }
+
+  std::ofstream ost(file_name, std::ios::binary | std::ios::trunc);
+  DaliExpects(ost.is_open(), "Cannot open file " << file_name);
+  ost.write(reinterpret_cast<char const *>(&header), sizeof(header));
+  ost.write(
+      reinterpret_cast<char const *>(sections.data()),
+      static_cast<std::streamsize>(sections.size() * sizeof(SnapshotSection))
+  );
+  uint64_t pos = sizeof(SnapshotHeader)
+      + sections.size() * sizeof(SnapshotSection);
+  char const zeros[kSnapshotAlignment] = {};
+  for (size_t i = 0; i < sections.size(); ++i) {
+    ost.write(zeros, static_cast<std::streamsize>(sections[i].offset - pos));
+    ost.write(data_[i], static_cast<std::streamsize>(sizes_[i]));
+    pos = sections[i].offset + sizes_[i];
+  }
+  DaliExpects(ost.good(), "Failed to write file " << file_name);
+}
+
+SnapshotReader::SnapshotReader(std::string const &file_name)
+    : file_(file_name) {
+  DaliExpects(file_.Size() >= sizeof(SnapshotHeader),
+              "Not a Dali snapshot: " << file_name);
+  char const *data = file_.Data();
+  SnapshotHeader header{};
+  std::memcpy(&header, data, sizeof(header));
+  DaliExpects(
+      std::memcmp(header.magic, kSnapshotMagic, sizeof(header.magic)) == 0,
+      "Not a Dali snapshot: " << file_name
+  );
+  DaliExpects(header.byte_order_mark == kSnapshotByteOrderMark,
+              "Snapshot saved with a different byte order: " << file_name);
+  DaliExpects(header.version == kSnapshotVersion,
+              "Unsupported snapshot version " << header.version
+                                              << ": " << file_name);
+  uint64_t size = file_.Size();
+  uint64_t table_end = sizeof(SnapshotHeader)
+      + uint64_t(header.section_count) * sizeof(SnapshotSection);
+  DaliExpects(table_end <= size, "Truncated snapshot: " << file_name);
+  sections_.resize(header.section_count);
+  std::memcpy(
+      sections_.data(),
+      data + sizeof(SnapshotHeader),
+      sections_.size() * sizeof(SnapshotSection)
+  );
+  for (auto &section : sections_) {
+    DaliExpects(section.offset % kSnapshotAlignment == 0
+                    && section.offset >= table_end
+                    && section.offset <= size
+                    && section.size <= size - section.offset,
+                "Corrupted section " << section.id
+                                     << " in snapshot " << file_name);
+  }
+  strings_ = Section(kSnapshotStrings, strings_size_);
+}
+
+std::string SnapshotReader::Str(SnapshotStr const &str) const {
+  DaliExpects(str.offset <= strings_size_
+                  && str.length <= strings_size_ - str.offset,
+              "Corrupted name in snapshot " << file_.FileName());
+  return std::string(strings_ + str.offset, str.length);
+}
+
+char const *SnapshotReader::Section(uint32_t id, uint64_t &size) const {
+  for (auto &section : sections_) {
+    if (section.id == id) {
+      size = section.size;
+      return file_.Data() + section.offset;
+    }
+  }
+  size = 0;
+  return nullptr;
+}
+
+/****
+ * @brief Save BlockTypes, wells, metal layers, blocks, I/O pins, nets and
+ * well-tap cells to a binary snapshot.
+ *
+ * Locations are stored as two arrays of doubles, so they can be restored by
+ * copying memory. Auxiliary data of blocks and nets, cell stretching from well
+ * legalization, and shapes of I/O pins are not saved.
+ *
+ * @param file_name: name of the snapshot file
+ */
+void Circuit::SaveSnapshot(std::string const &file_name) {
+  BOOST_LOG_TRIVIAL(info) << "Saving snapshot: " << file_name << "\n";
+  SnapshotWriter writer;
+
+  SnapshotTech tech{};
+  tech.manufacturing_grid = tech_.manufacturing_grid_;
+  tech.grid_value_x = tech_.grid_value_x_;
+  tech.grid_value_y = tech_.grid_value_y_;
+  tech.row_height = tech_.row_height_;
+  tech.same_diff_spacing = tech_.same_diff_spacing_;
+  tech.any_diff_spacing = tech_.any_diff_spacing_;
+  WellLayer *well_layers[2] = {&tech_.nwell_layer_, &tech_.pwell_layer_};
+  double *well_params[2] = {tech.n_well_params, tech.p_well_params};
+  for (int i = 0; i < 2; ++i) {
+    well_params[i][0] = well_layers[i]->Width();
+    well_params[i][1] = well_layers[i]->Spacing();
+    well_params[i][2] = well_layers[i]->OppositeSpacing();
+    well_params[i][3] = well_layers[i]->MaxPlugDist();
+    well_params[i][4] = well_layers[i]->Overhang();
+  }
+  tech.database_microns = tech_.database_microns_;
+  tech.is_grid_set = tech_.is_grid_set_;
+  tech.is_row_height_set = tech_.row_height_set_;
+  tech.is_n_well_set = tech_.n_set_;
+  tech.is_p_well_set = tech_.p_set_;
+  writer.AddSection(kSnapshotTech, &tech, sizeof(tech));
+
+  SnapshotDesign design{};
+  design.name = writer.AddStr(design_.name_);
+  design.reset_signal_weight = design_.reset_signal_weight_;
+  design.normal_signal_weight = design_.normal_signal_weight_;
+  design.distance_microns = design_.distance_microns_;
+  design.region_left = design_.region_left_;
+  design.region_right = design_.region_right_;
+  design.region_bottom = design_.region_bottom_;
+  design.region_top = design_.region_top_;
+  design.is_die_area_set = design_.die_area_set_;
+  design.die_area_offset_x = design_.die_area_offset_x_;
+  design.die_area_offset_x_residual = design_.die_area_offset_x_residual_;
+  design.die_area_offset_y = design_.die_area_offset_y_;
+  design.die_area_offset_y_residual = design_.die_area_offset_y_residual_;
+  writer.AddSection(kSnapshotDesign, &design, sizeof(design));
+
+  std::vector<SnapshotMetalLayer> metals;
+  metals.reserve(tech_.metal_list_.size());
+  for (auto &metal : tech_.metal_list_) {
+    SnapshotMetalLayer rec{};
+    rec.name = writer.AddStr(metal.Name());
+    rec.width = metal.Width();
+    rec.spacing = metal.Spacing();
+    rec.min_area = metal.MinArea();
+    rec.pitch_x = metal.PitchX();
+    rec.pitch_y = metal.PitchY();
+    rec.direction = metal.Direction();
+    metals.push_back(rec);
+  }
+  writer.AddSection(kSnapshotMetalLayers, metals);
+
+  // BlockTypes are sorted by names, so the same circuit gives the same file
+  std::vector<BlockType *> types;
+  for (auto &[name, type_ptr] : tech_.block_type_map_) {
+    if (type_ptr == tech_.io_dummy_blk_type_ptr_) continue;
+    types.push_back(type_ptr);
+  }
+  std::sort(
+      types.begin(),
+      types.end(),
+      [](BlockType const *type0, BlockType const *type1) {
+        return type0->Name() < type1->Name();
+      }
+  );
+  std::unordered_map<BlockType const *, int> type_ids;
+  std::vector<SnapshotBlockType> type_recs;
+  std::vector<SnapshotPin> pins;
+  std::vector<SnapshotWellRegion> well_regions;
+  for (auto &type_ptr : types) {
+    type_ids[type_ptr] = static_cast<int>(type_recs.size());
+    SnapshotBlockType rec{};
+    rec.name = writer.AddStr(type_ptr->Name());
+    rec.width = type_ptr->Width();
+    rec.height = type_ptr->Height();
+    rec.first_pin = static_cast<int32_t>(pins.size());
+    rec.pin_count = static_cast<int32_t>(type_ptr->PinList().size());
+    for (auto &pin : type_ptr->PinList()) {
+      SnapshotPin pin_rec{};
+      pin_rec.name = writer.AddStr(pin.Name());
+      pin_rec.offset_x = pin.OffsetX();
+      pin_rec.offset_y = pin.OffsetY();
+      pin_rec.bbox_width = 2 * pin.HalfBboxWidth();
+      pin_rec.bbox_height = 2 * pin.HalfBboxHeight();
+      pin_rec.is_input = pin.IsInput();
+      pins.push_back(pin_rec);
+    }
+    rec.first_well_region = static_cast<int32_t>(well_regions.size());
+    rec.well_region_count = -1;
+    BlockTypeWell *well_ptr = type_ptr->WellPtr();
+    if (well_ptr != nullptr) {
+      rec.well_region_count = well_ptr->RegionCount();
+      for (int i = 0; i < well_ptr->RegionCount(); ++i) {
+        RectI &n_rect = well_ptr->NwellRect(i);
+        RectI &p_rect = well_ptr->PwellRect(i);
+        well_regions.push_back(
+            {
+                {n_rect.LLX(), n_rect.LLY(), n_rect.URX(), n_rect.URY()},
+                {p_rect.LLX(), p_rect.LLY(), p_rect.URX(), p_rect.URY()}
+            }
+        );
+      }
+    }
+    auto &taps = tech_.well_tap_cell_ptrs_;
+    rec.is_well_tap = std::find(taps.begin(), taps.end(), type_ptr)
+        != taps.end();
+    type_recs.push_back(rec);
+  }
+  writer.AddSection(kSnapshotBlockTypes, type_recs);
+  writer.AddSection(kSnapshotPins, pins);
+  writer.AddSection(kSnapshotWellRegions, well_regions);
+
+  size_t blk_count = design_.blocks_.size();
+  std::vector<SnapshotBlock> blocks(blk_count);
+  std::vector<double> llxs(blk_count);
+  std::vector<double> llys(blk_count);
+  for (size_t i = 0; i < blk_count; ++i) {
+    Block &blk = design_.blocks_[i];
+    blocks[i].name = writer.AddStr(blk.Name());
+    blocks[i].type_id = (blk.TypePtr() == tech_.io_dummy_blk_type_ptr_) ?
+                        -1 : type_ids[blk.TypePtr()];
+    blocks[i].place_status = blk.Status();
+    blocks[i].orient = blk.Orient();
+    blocks[i].padding = 0;
+    llxs[i] = blk.LLX();
+    llys[i] = blk.LLY();
+  }
+  writer.AddSection(kSnapshotBlocks, blocks);
+  writer.AddSection(kSnapshotBlockLLXs, llxs);
+  writer.AddSection(kSnapshotBlockLLYs, llys);
+
+  std::vector<SnapshotIoPin> iopins;
+  iopins.reserve(design_.iopins_.size());
+  for (auto &iopin : design_.iopins_) {
+    SnapshotIoPin rec{};
+    rec.name = writer.AddStr(iopin.Name());
+    rec.x = iopin.X();
+    rec.y = iopin.Y();
+    rec.is_pre_placed = iopin.IsPrePlaced();
+    rec.place_status = iopin.GetPlaceStatus();
+    rec.signal_use = iopin.SigUse();
+    rec.signal_direction = iopin.SigDirection();
+    rec.layer_id = (iopin.LayerPtr() == nullptr) ? -1 : iopin.LayerPtr()->Id();
+    rec.orient = iopin.GetOrient();
+    iopins.push_back(rec);
+  }
+  writer.AddSection(kSnapshotIoPins, iopins);
+
+  std::vector<SnapshotNet> nets;
+  std::vector<SnapshotNetPin> net_pins;
+  std::vector<int32_t> net_iopins;
+  nets.reserve(design_.nets_.size());
+  for (auto &net : design_.nets_) {
+    SnapshotNet rec{};
+    rec.name = writer.AddStr(net.Name());
+    rec.weight = net.Weight();
+    rec.first_pin = static_cast<int64_t>(net_pins.size());
+    rec.first_iopin = static_cast<int64_t>(net_iopins.size());
+    rec.pin_count = static_cast<int32_t>(net.BlockPins().size());
+    rec.iopin_count = static_cast<int32_t>(net.IoPinPtrs().size());
+    for (auto &net_pin : net.BlockPins()) {
+      net_pins.push_back({net_pin.BlkPtr()->Id(), net_pin.PinPtr()->Id()});
+    }
+    for (auto &iopin_ptr : net.IoPinPtrs()) {
+      net_iopins.push_back(iopin_ptr->Id());
+    }
+    nets.push_back(rec);
+  }
+  writer.AddSection(kSnapshotNets, nets);
+  writer.AddSection(kSnapshotNetPins, net_pins);
+  writer.AddSection(kSnapshotNetIoPins, net_iopins);
+
+  std::vector<SnapshotWellTap> well_taps;
+  well_taps.reserve(design_.welltaps_.size());
+  for (auto &tap : design_.welltaps_) {
+    SnapshotWellTap rec{};
+    rec.name = writer.AddStr(tap.Name());
+    rec.llx = tap.LLX();
+    rec.lly = tap.LLY();
+    rec.type_id = type_ids[tap.TypePtr()];
+    rec.place_status = tap.Status();
+    rec.orient = tap.Orient();
+    well_taps.push_back(rec);
+  }
+  writer.AddSection(kSnapshotWellTaps, well_taps);
+
+  writer.Write(file_name);
+}
+
+/****
+ * @brief Load a binary snapshot saved by SaveSnapshot().
+ *
+ * If this circuit is empty, everything in the snapshot is loaded. Otherwise,
+ * this circuit must be the one which the snapshot is saved from, and only
+ * placement status, locations and orientations of blocks and I/O pins, and
+ * well-tap cells are restored.
+ *
+ * @param file_name: name of the snapshot file
+ */
+void Circuit::LoadSnapshot(std::string const &file_name) {
+  BOOST_LOG_TRIVIAL(info) << "Loading snapshot: " << file_name << "\n";
+  SnapshotReader reader(file_name);
+  if (design_.blocks_.empty() && design_.iopins_.empty()
+      && design_.nets_.empty()) {
+    LoadSnapshotCircuit(reader);
+  } else {
+    LoadSnapshotPlacement(reader);
+  }
+}
+
+void Circuit::LoadSnapshotCircuit(SnapshotReader const &reader) {
+  DaliExpects(tech_.block_type_map_.size() == 1 && tech_.metal_list_.empty(),
+              "Cannot load a snapshot into a circuit with BlockTypes");
+
+  auto &tech = reader.Record<SnapshotTech>(kSnapshotTech);
+  tech_.manufacturing_grid_ = tech.manufacturing_grid;
+  tech_.database_microns_ = tech.database_microns;
+  tech_.is_grid_set_ = tech.is_grid_set;
+  tech_.grid_value_x_ = tech.grid_value_x;
+  tech_.grid_value_y_ = tech.grid_value_y;
+  tech_.row_height_ = tech.row_height;
+  tech_.row_height_set_ = tech.is_row_height_set;
+  if (tech.is_n_well_set) {
+    double const *n_params = tech.n_well_params;
+    SetNwellParams(
+        n_params[0], n_params[1], n_params[2], n_params[3], n_params[4]
+    );
+  }
+  if (tech.is_p_well_set) {
+    double const *p_params = tech.p_well_params;
+    SetPwellParams(
+        p_params[0], p_params[1], p_params[2], p_params[3], p_params[4]
+    );
+  }
+  tech_.same_diff_spacing_ = tech.same_diff_spacing;
+  tech_.any_diff_spacing_ = tech.any_diff_spacing;
+
+  auto &design = reader.Record<SnapshotDesign>(kSnapshotDesign);
+  design_.name_ = reader.Str(design.name);
+  design_.reset_signal_weight_ = design.reset_signal_weight;
+  design_.normal_signal_weight_ = design.normal_signal_weight;
+  design_.distance_microns_ = design.distance_microns;
+  design_.region_left_ = design.region_left;
+  design_.region_right_ = design.region_right;
+  design_.region_bottom_ = design.region_bottom;
+  design_.region_top_ = design.region_top;
+  design_.die_area_set_ = design.is_die_area_set;
+  design_.die_area_offset_x_ = design.die_area_offset_x;
+  design_.die_area_offset_x_residual_ = design.die_area_offset_x_residual;
+  design_.die_area_offset_y_ = design.die_area_offset_y;
+  design_.die_area_offset_y_residual_ = design.die_area_offset_y_residual;
+
+  size_t metal_count = 0;
+  auto metals = reader.Records<SnapshotMetalLayer>(
+      kSnapshotMetalLayers, metal_count
+  );
+  tech_.metal_list_.reserve(metal_count);
+  for (size_t i = 0; i < metal_count; ++i) {
+    AddMetalLayer(
+        reader.Str(metals[i].name),
+        metals[i].width,
+        metals[i].spacing,
+        metals[i].min_area,
+        metals[i].pitch_x,
+        metals[i].pitch_y,
+        MetalDirection(metals[i].direction)
+    );
+  }
+
+  size_t type_count = 0, pin_count = 0, region_count = 0;
+  auto types = reader.Records<SnapshotBlockType>(
+      kSnapshotBlockTypes, type_count
+  );
+  auto pins = reader.Records<SnapshotPin>(kSnapshotPins, pin_count);
+  auto regions = reader.Records<SnapshotWellRegion>(
+      kSnapshotWellRegions, region_count
+  );
+  std::vector<BlockType *> type_ptrs(type_count, nullptr);
+  for (size_t i = 0; i < type_count; ++i) {
+    auto &type = types[i];
+    std::string type_name = reader.Str(type.name);
+    type_ptrs[i] = type.is_well_tap ?
+                   AddWellTapBlockTypeWithGridUnit(
+                       type_name, type.width, type.height
+                   ) :
+                   AddBlockTypeWithGridUnit(type_name, type.width, type.height);
+    DaliExpects(type.first_pin >= 0 && type.pin_count >= 0
+                    && size_t(type.first_pin) + type.pin_count <= pin_count,
+                "Corrupted pins of BlockType " << type_name);
+    for (int j = type.first_pin; j < type.first_pin + type.pin_count; ++j) {
+      Pin *pin = type_ptrs[i]->AddPin(reader.Str(pins[j].name), pins[j].is_input);
+      pin->SetOffset(pins[j].offset_x, pins[j].offset_y);
+      pin->SetBoundingBoxSize(pins[j].bbox_width, pins[j].bbox_height);
+    }
+    if (type.well_region_count < 0) continue;
+    DaliExpects(type.first_well_region >= 0
+                    && size_t(type.first_well_region) + type.well_region_count
+                        <= region_count,
+                "Corrupted well of BlockType " << type_name);
+    BlockTypeWell *well_ptr = AddBlockTypeWell(type_ptrs[i]);
+    int end = type.first_well_region + type.well_region_count;
+    for (int j = type.first_well_region; j < end; ++j) {
+      int32_t const *n = regions[j].n_rect;
+      int32_t const *p = regions[j].p_rect;
+      well_ptr->AddNwellRect(n[0], n[1], n[2], n[3]);
+      well_ptr->AddPwellRect(p[0], p[1], p[2], p[3]);
+    }
+  }
+
+  size_t blk_count = 0, llx_count = 0, lly_count = 0, iopin_count = 0;
+  size_t net_count = 0;
+  auto blocks = reader.Records<SnapshotBlock>(kSnapshotBlocks, blk_count);
+  auto llxs = reader.Records<double>(kSnapshotBlockLLXs, llx_count);
+  auto llys = reader.Records<double>(kSnapshotBlockLLYs, lly_count);
+  auto iopins = reader.Records<SnapshotIoPin>(kSnapshotIoPins, iopin_count);
+  reader.Records<SnapshotNet>(kSnapshotNets, net_count);
+  DaliExpects(llx_count == blk_count && lly_count == blk_count,
+              "Corrupted block locations in snapshot");
+  size_t io_blk_count = 0;
+  for (size_t i = 0; i < blk_count; ++i) {
+    if (blocks[i].type_id < 0) ++io_blk_count;
+  }
+  SetListCapacity(
+      static_cast<int>(blk_count - io_blk_count),
+      static_cast<int>(iopin_count),
+      static_cast<int>(net_count)
+  );
+
+  // blocks of placed I/O pins are created together with I/O pins, and they
+  // are after all other blocks, the same as loading from PhyDB
+  for (size_t i = 0; i < blk_count - io_blk_count; ++i) {
+    auto &blk = blocks[i];
+    DaliExpects(blk.type_id >= 0 && size_t(blk.type_id) < type_count,
+                "Blocks of I/O pins must be after other blocks in snapshot");
+    AddBlock(
+        reader.Str(blk.name),
+        type_ptrs[blk.type_id],
+        llxs[i],
+        llys[i],
+        PlaceStatus(blk.place_status),
+        BlockOrient(blk.orient)
+    );
+  }
+  for (size_t i = 0; i < iopin_count; ++i) {
+    auto &rec = iopins[i];
+    std::string iopin_name = reader.Str(rec.name);
+    IoPin *iopin = nullptr;
+    if (rec.is_pre_placed) {
+      iopin = AddPlacedIOPin(iopin_name, rec.x, rec.y);
+      iopin->SetInitPlaceStatus(PLACED);
+    } else {
+      iopin = AddUnplacedIoPin(iopin_name);
+    }
+    iopin->SetLoc(rec.x, rec.y, PlaceStatus(rec.place_status));
+    iopin->SetSigUse(SignalUse(rec.signal_use));
+    iopin->SetSigDirection(SignalDirection(rec.signal_direction));
+    iopin->SetOrient(BlockOrient(rec.orient));
+    if (rec.layer_id >= 0) {
+      DaliExpects(size_t(rec.layer_id) < metal_count,
+                  "Corrupted metal layer of IOPIN " << iopin_name);
+      iopin->SetLayerPtr(&tech_.metal_list_[rec.layer_id]);
+    }
+  }
+  DaliExpects(design_.blocks_.size() == blk_count,
+              "Blocks of I/O pins do not match I/O pins in snapshot");
+  for (size_t i = 0; i < blk_count; ++i) {
+    design_.blocks_[i].SetLoc(llxs[i], llys[i]);
+  }
+
+  LoadSnapshotNets(reader);
+  LoadSnapshotWellTaps(reader, type_ptrs);
+  UpdateTotalBlkArea();
+}
+
+/****
+ * @brief Create nets in a snapshot. Block pins of nets are filled in parallel,
+ * and net lists of blocks are filled afterwards in the order of nets, the
+ * same as LoadNets().
+ */
+void Circuit::LoadSnapshotNets(SnapshotReader const &reader) {
+  size_t net_count = 0, pin_count = 0, iopin_count = 0;
+  auto nets = reader.Records<SnapshotNet>(kSnapshotNets, net_count);
+  auto net_pins = reader.Records<SnapshotNetPin>(kSnapshotNetPins, pin_count);
+  auto net_iopins = reader.Records<int32_t>(kSnapshotNetIoPins, iopin_count);
+
+  auto &blocks = design_.blocks_;
+  auto &iopins = design_.iopins_;
+  int blks_count = static_cast<int>(blocks.size());
+  std::vector<int> blk_net_counts(blocks.size(), 0);
+  int first_net_id = static_cast<int>(design_.nets_.size());
+  for (size_t i = 0; i < net_count; ++i) {
+    auto &rec = nets[i];
+    std::string net_name = reader.Str(rec.name);
+    DaliExpects(rec.first_pin >= 0 && rec.pin_count >= 0
+                    && uint64_t(rec.first_pin) + rec.pin_count <= pin_count
+                    && rec.first_iopin >= 0 && rec.iopin_count >= 0
+                    && uint64_t(rec.first_iopin) + rec.iopin_count
+                        <= iopin_count,
+                "Corrupted pins of net " << net_name);
+    Net *net = AddNet(net_name, rec.pin_count, rec.weight);
+    for (int64_t j = rec.first_iopin; j < rec.first_iopin + rec.iopin_count;
+         ++j) {
+      DaliExpects(net_iopins[j] >= 0 && size_t(net_iopins[j]) < iopins.size(),
+                  "Corrupted IOPIN of net " << net_name);
+      IoPin *iopin = &iopins[net_iopins[j]];
+      iopin->SetNetPtr(net);
+      net->AddIoPin(iopin);
+    }
+    for (int64_t j = rec.first_pin; j < rec.first_pin + rec.pin_count; ++j) {
+      int blk_id = net_pins[j].blk_id;
+      DaliExpects(blk_id >= 0 && blk_id < blks_count
+                      && net_pins[j].pin_id >= 0
+                      && size_t(net_pins[j].pin_id)
+                          < blocks[blk_id].TypePtr()->PinList().size(),
+                  "Corrupted block pin of net " << net_name);
+      ++blk_net_counts[blk_id];
+    }
+  }
+  for (int i = 0; i < blks_count; ++i) {
+    auto &net_list = blocks[i].NetList();
+    net_list.reserve(net_list.size() + blk_net_counts[i]);
+  }
+
+  int nets_count = static_cast<int>(net_count);
+#pragma omp parallel for schedule(dynamic, 64) num_threads(num_threads_) default(none) shared(nets_count, nets, net_pins, blocks, first_net_id)
+  for (int i = 0; i < nets_count; ++i) {
+    Net &net = design_.nets_[first_net_id + i];
+    int64_t end = nets[i].first_pin + nets[i].pin_count;
+    for (int64_t j = nets[i].first_pin; j < end; ++j) {
+      Block &blk = blocks[net_pins[j].blk_id];
+      Pin *pin = &(blk.TypePtr()->PinList()[net_pins[j].pin_id]);
+      net.AppendBlkPinPair(&blk, pin);
+    }
+  }
+
+  for (int i = 0; i < nets_count; ++i) {
+    int net_id = design_.nets_[first_net_id + i].Id();
+    int64_t end = nets[i].first_pin + nets[i].pin_count;
+    for (int64_t j = nets[i].first_pin; j < end; ++j) {
+      blocks[net_pins[j].blk_id].NetList().push_back(net_id);
+    }
+  }
+  design_.pin_table_.Invalidate();
+}
+
+/****
+ * @brief Replace well-tap cells with those in a snapshot.
+ *
+ * @param type_ptrs: BlockTypes in the order of the snapshot, a BlockType is
+ * looked up by its name if its pointer is nullptr
+ */
+void Circuit::LoadSnapshotWellTaps(
+    SnapshotReader const &reader,
+    std::vector<BlockType *> &type_ptrs
+) {
+  size_t type_count = 0, tap_count = 0;
+  auto types = reader.Records<SnapshotBlockType>(
+      kSnapshotBlockTypes, type_count
+  );
+  auto taps = reader.Records<SnapshotWellTap>(kSnapshotWellTaps, tap_count);
+  type_ptrs.resize(type_count, nullptr);
+
+  auto &tap_cell_list = design_.welltaps_;
+  tap_cell_list.clear();
+  design_.tap_name_id_map_.clear();
+  tap_cell_list.reserve(tap_count);
+  for (size_t i = 0; i < tap_count; ++i) {
+    auto &rec = taps[i];
+    DaliExpects(rec.type_id >= 0 && size_t(rec.type_id) < type_count,
+                "Corrupted well-tap cell in snapshot");
+    if (type_ptrs[rec.type_id] == nullptr) {
+      type_ptrs[rec.type_id] =
+          GetBlockTypePtr(reader.Str(types[rec.type_id].name));
+    }
+    tap_cell_list.emplace_back();
+    auto &tap_cell = tap_cell_list.back();
+    tap_cell.SetPlacementStatus(PlaceStatus(rec.place_status));
+    tap_cell.SetType(type_ptrs[rec.type_id]);
+    int map_size = static_cast<int>(design_.tap_name_id_map_.size());
+    auto ret = design_.tap_name_id_map_.insert(
+        std::pair<std::string, int>(reader.Str(rec.name), map_size)
+    );
+    tap_cell.SetNameNumPair(&(*ret.first));
+    tap_cell.SetLoc(rec.llx, rec.lly);
+    tap_cell.SetOrient(BlockOrient(rec.orient));
+  }
+}
+
+/****
+ * @brief Restore placement status, locations and orientations of blocks and
+ * I/O pins, and well-tap cells, from a snapshot of this circuit.
+ *
+ * Block locations are copied as two arrays when they are bound to a store.
+ */
+void Circuit::LoadSnapshotPlacement(SnapshotReader const &reader) {
+  size_t blk_count = 0, llx_count = 0, lly_count = 0;
+  size_t iopin_count = 0, net_count = 0;
+  auto blocks = reader.Records<SnapshotBlock>(kSnapshotBlocks, blk_count);
+  auto llxs = reader.Records<double>(kSnapshotBlockLLXs, llx_count);
+  auto llys = reader.Records<double>(kSnapshotBlockLLYs, lly_count);
+  auto iopins = reader.Records<SnapshotIoPin>(kSnapshotIoPins, iopin_count);
+  reader.Records<SnapshotNet>(kSnapshotNets, net_count);
+  DaliExpects(blk_count == design_.blocks_.size()
+                  && llx_count == blk_count && lly_count == blk_count
+                  && iopin_count == design_.iopins_.size()
+                  && net_count == design_.nets_.size(),
+              "Snapshot is not saved from this circuit");
+
+  for (size_t i = 0; i < blk_count; ++i) {
+    Block &blk = design_.blocks_[i];
+    blk.SetPlacementStatus(PlaceStatus(blocks[i].place_status));
+    blk.SetOrient(BlockOrient(blocks[i].orient));
+  }
+  if (design_.loc_store_.IsBound()) {
+    std::memcpy(
+        design_.loc_store_.LLXs().data(), llxs, blk_count * sizeof(double)
+    );
+    std::memcpy(
+        design_.loc_store_.LLYs().data(), llys, blk_count * sizeof(double)
+    );
+  } else {
+    for (size_t i = 0; i < blk_count; ++i) {
+      design_.blocks_[i].SetLoc(llxs[i], llys[i]);
+    }
+  }
+
+  for (size_t i = 0; i < iopin_count; ++i) {
+    IoPin &iopin = design_.iopins_[i];
+    iopin.SetLoc(iopins[i].x, iopins[i].y, PlaceStatus(iopins[i].place_status));
+    iopin.SetOrient(BlockOrient(iopins[i].orient));
+  }
+
+  std::vector<BlockType *> type_ptrs;
+  LoadSnapshotWellTaps(reader, type_ptrs);
+}
+
+}
@@ -0,0 +1,271 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef DALI_CIRCUIT_SNAPSHOT_H_
+#define DALI_CIRCUIT_SNAPSHOT_H_
+
+#include <cstdint>
+
+#include <string>
+#include <vector>
+
+#include "dali/common/logging.h"
+#include "dali/common/mapped_file.h"
+
+/****
+ * This header file defines the binary snapshot format of a Circuit, see
+ * Circuit::SaveSnapshot() and Circuit::LoadSnapshot().
+ *
+ * A snapshot starts with a SnapshotHeader, followed by a table of
+ * SnapshotSection, followed by sections. Each section is an array of one of
+ * the record types below, starting at an 8-byte aligned offset, so that a
+ * memory-mapped snapshot can be read in place. All names are stored in the
+ * string section, and records refer to them by SnapshotStr. Numbers are in
+ * the byte order of the machine which saves the snapshot, and a snapshot from
+ * a machine with a different byte order is rejected.
+ * ****/
+
+namespace dali {
+
+constexpr char kSnapshotMagic[8] = {'D', 'A', 'L', 'I', 'S', 'N', 'A', 'P'};
+constexpr uint32_t kSnapshotVersion = 1;
+constexpr uint32_t kSnapshotByteOrderMark = 0x01020304;
+
+enum SnapshotSectionId : uint32_t {
+  kSnapshotStrings = 1,     // char
+  kSnapshotTech = 2,        // SnapshotTech, one record
+  kSnapshotDesign = 3,      // SnapshotDesign, one record
+  kSnapshotMetalLayers = 4, // SnapshotMetalLayer
+  kSnapshotBlockTypes = 5,  // SnapshotBlockType
+  kSnapshotPins = 6,        // SnapshotPin, pins of all BlockTypes
+  kSnapshotWellRegions = 7, // SnapshotWellRegion, wells of all BlockTypes
+  kSnapshotBlocks = 8,      // SnapshotBlock
+  kSnapshotBlockLLXs = 9,   // double, lower left x of each block
+  kSnapshotBlockLLYs = 10,  // double, lower left y of each block
+  kSnapshotIoPins = 11,     // SnapshotIoPin
+  kSnapshotNets = 12,       // SnapshotNet
+  kSnapshotNetPins = 13,    // SnapshotNetPin, block pins of all nets
+  kSnapshotNetIoPins = 14,  // int32_t, I/O pin indices of all nets
+  kSnapshotWellTaps = 15,   // SnapshotWellTap
+};
+
+struct SnapshotHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t byte_order_mark;
+  uint32_t section_count;
+  uint32_t padding;
+};
+
+struct SnapshotSection {
+  uint32_t id;
+  uint32_t padding;
+  uint64_t offset; // in bytes, from the beginning of the snapshot
+  uint64_t size; // in bytes
+};
+
+struct SnapshotStr {
+  uint64_t offset; // in bytes, from the beginning of the string section
+  uint64_t length;
+};
+
+struct SnapshotTech {
+  double manufacturing_grid;
+  double grid_value_x;
+  double grid_value_y;
+  double row_height;
+  double same_diff_spacing;
+  double any_diff_spacing;
+  // width, spacing, opposite spacing, max plug distance and overhang
+  double n_well_params[5];
+  double p_well_params[5];
+  int32_t database_microns;
+  int32_t is_grid_set;
+  int32_t is_row_height_set;
+  int32_t is_n_well_set;
+  int32_t is_p_well_set;
+  int32_t padding;
+};
+
+struct SnapshotDesign {
+  SnapshotStr name;
+  double reset_signal_weight;
+  double normal_signal_weight;
+  int32_t distance_microns;
+  int32_t region_left;
+  int32_t region_right;
+  int32_t region_bottom;
+  int32_t region_top;
+  int32_t is_die_area_set;
+  int32_t die_area_offset_x;
+  int32_t die_area_offset_x_residual;
+  int32_t die_area_offset_y;
+  int32_t die_area_offset_y_residual;
+};
+
+struct SnapshotMetalLayer {
+  SnapshotStr name;
+  double width;
+  double spacing;
+  double min_area;
+  double pitch_x;
+  double pitch_y;
+  int32_t direction;
+  int32_t padding;
+};
+
+struct SnapshotBlockType {
+  SnapshotStr name;
+  int32_t width; // grid unit
+  int32_t height; // grid unit
+  int32_t first_pin;
+  int32_t pin_count;
+  int32_t first_well_region;
+  int32_t well_region_count; // -1 if this BlockType has no well
+  int32_t is_well_tap;
+  int32_t padding;
+};
+
+struct SnapshotPin {
+  SnapshotStr name;
+  double offset_x; // offsets in orientation N, grid unit
+  double offset_y;
+  double bbox_width;
+  double bbox_height;
+  int32_t is_input;
+  int32_t padding;
+};
+
+struct SnapshotWellRegion {
+  int32_t n_rect[4]; // llx, lly, urx, ury, grid unit
+  int32_t p_rect[4];
+};
+
+// the type of a block created for a placed I/O pin is -1, such blocks are
+// created again when I/O pins are loaded
+struct SnapshotBlock {
+  SnapshotStr name;
+  int32_t type_id;
+  int32_t place_status;
+  int32_t orient;
+  int32_t padding;
+};
+
+struct SnapshotIoPin {
+  SnapshotStr name;
+  double x;
+  double y;
+  int32_t is_pre_placed;
+  int32_t place_status;
+  int32_t signal_use;
+  int32_t signal_direction;
+  int32_t layer_id; // -1 if no metal layer
+  int32_t orient;
+};
+
+struct SnapshotNet {
+  SnapshotStr name;
+  double weight;
+  int64_t first_pin;
+  int64_t first_iopin;
+  int32_t pin_count;
+  int32_t iopin_count;
+};
+
+struct SnapshotNetPin {
+  int32_t blk_id;
+  int32_t pin_id;
+};
+
+struct SnapshotWellTap {
+  SnapshotStr name;
+  double llx;
+  double lly;
+  int32_t type_id;
+  int32_t place_status;
+  int32_t orient;
+  int32_t padding;
+};
+
+/****
+ * This class collects sections and writes them to a snapshot file. Sections
+ * are not copied, so they need to live until Write() returns.
+ */
+class SnapshotWriter {
+ public:
+  // add a name to the string section, and return the reference to it
+  SnapshotStr AddStr(std::string const &str);
+
+  template<typename T>
+  void AddSection(uint32_t id, std::vector<T> const &records) {
+    AddSection(id, records.data(), records.size() * sizeof(T));
+  }
+  void AddSection(uint32_t id, void const *data, uint64_t size);
+
+  void Write(std::string const &file_name);
+ private:
+  std::string strings_;
+  std::vector<uint32_t> ids_;
+  std::vector<char const *> data_;
+  std::vector<uint64_t> sizes_;
+};
+
+/****
+ * This class maps a snapshot file into memory, and checks its header and
+ * section table. Records are read in place.
+ */
+class SnapshotReader {
+ public:
+  explicit SnapshotReader(std::string const &file_name);
+
+  // records in a section, count is 0 if this section does not exist
+  template<typename T>
+  T const *Records(uint32_t id, size_t &count) const {
+    uint64_t size = 0;
+    char const *data = Section(id, size);
+    DaliExpects(size % sizeof(T) == 0,
+                "Corrupted section " << id << " in snapshot " << file_.FileName());
+    count = static_cast<size_t>(size / sizeof(T));
+    return reinterpret_cast<T const *>(data);
+  }
+
+  // the only record in a section
+  template<typename T>
+  T const &Record(uint32_t id) const {
+    size_t count = 0;
+    T const *records = Records<T>(id, count);
+    DaliExpects(count == 1,
+                "Missing section " << id << " in snapshot " << file_.FileName());
+    return records[0];
+  }
+
+  std::string Str(SnapshotStr const &str) const;
+ private:
+  char const *Section(uint32_t id, uint64_t &size) const;
+
+  MappedFile file_;
+  std::vector<SnapshotSection> sections_;
+  char const *strings_ = nullptr;
+  uint64_t strings_size_ = 0;
+};
+
+}
+
+#endif //DALI_CIRCUIT_SNAPSHOT_H_
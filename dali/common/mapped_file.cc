@@ -0,0 +1,54 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "logging.h"
+
+namespace dali {
+
+MappedFile::MappedFile(std::string const &file_name) : file_name_(file_name) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  DaliExpects(fd >= 0, "Cannot open file " << file_name);
+  struct stat file_stat{};
+  DaliExpects(fstat(fd, &file_stat) == 0, "Cannot stat file " << file_name);
+  size_ = static_cast<uint64_t>(file_stat.st_size);
+  if (size_ == 0) {
+    close(fd);
+    return;
+  }
+  void *addr = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  DaliExpects(addr != MAP_FAILED, "Cannot map file " << file_name);
+  data_ = static_cast<char *>(addr);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+}
+
+} // dali
@@ -0,0 +1,53 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef DALI_COMMON_MAPPED_FILE_H_
+#define DALI_COMMON_MAPPED_FILE_H_
+
+#include <cstdint>
+
+#include <string>
+
+namespace dali {
+
+/****
+ * A read-only file mapped into memory. The mapping is released when this
+ * object is destroyed.
+ * ****/
+class MappedFile {
+ public:
+  explicit MappedFile(std::string const &file_name);
+  ~MappedFile();
+  MappedFile(MappedFile const &) = delete;
+  MappedFile &operator=(MappedFile const &) = delete;
+
+  std::string const &FileName() const { return file_name_; }
+  char const *Data() const { return data_; }
+  char const *End() const { return data_ + size_; }
+  uint64_t Size() const { return size_; }
+ private:
+  std::string file_name_;
+  char *data_ = nullptr;
+  uint64_t size_ = 0;
+};
+
+} // dali
+
+#endif //DALI_COMMON_MAPPED_FILE_H_
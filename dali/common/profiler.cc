@@ -0,0 +1,294 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "profiler.h"
+
+#include <fstream>
+
+#include "logging.h"
+#include "memory.h"
+
+namespace dali {
+
+/****
+ * @brief Enter a stage under the current stage. Use ProfileScope if the stage
+ * ends in the same scope.
+ *
+ * @param name: name of this stage, it should not contain '/'
+ * @return the id of this stage, for EndStage()
+ */
+int Profiler::BeginStage(std::string const &name) {
+  int stage_id = FindOrAddStage(CurrentStage(), name);
+  ++stages_[stage_id].call_cnt;
+  OpenStage &open_stage = open_stages_.emplace_back();
+  open_stage.stage = stage_id;
+  open_stage.start_rss = getCurrentRSS();
+  open_stage.elapsed_time.RecordStartTime();
+  return stage_id;
+}
+
+/****
+ * @brief Leave a stage. Stages entered after it and not left yet are left as
+ * well. Nothing happens if this stage is not entered.
+ *
+ * @param stage_id: the return value of BeginStage()
+ */
+void Profiler::EndStage(int stage_id) {
+  bool is_open = false;
+  for (auto &open_stage : open_stages_) {
+    is_open = is_open || open_stage.stage == stage_id;
+  }
+  if (!is_open) return;
+
+  size_t cur_rss = getCurrentRSS();
+  size_t peak_rss = getPeakRSS();
+  while (true) {
+    OpenStage &open_stage = open_stages_.back();
+    open_stage.elapsed_time.RecordEndTime();
+    ProfileStage &stage = stages_[open_stage.stage];
+    stage.wall_time += open_stage.elapsed_time.GetWallTime();
+    stage.cpu_time += open_stage.elapsed_time.GetCpuTime();
+    stage.rss_delta += static_cast<long long>(cur_rss)
+        - static_cast<long long>(open_stage.start_rss);
+    stage.peak_rss = peak_rss;
+    int ended_stage = open_stage.stage;
+    open_stages_.pop_back();
+    if (ended_stage == stage_id) break;
+  }
+}
+
+/****
+ * @brief Add wall time measured elsewhere, e.g., accumulated over iterations
+ * or in OpenMP parallel regions, to a sub-stage of the current stage.
+ *
+ * @param path: path of the sub-stage relative to the current stage, e.g.,
+ * "hpwl optimization/cg solver x"
+ * @param wall_time: wall time in seconds
+ */
+void Profiler::AddTime(std::string const &path, double wall_time) {
+  int stage_id = CurrentStage();
+  size_t begin = 0;
+  while (begin <= path.size()) {
+    size_t end = path.find('/', begin);
+    if (end == std::string::npos) end = path.size();
+    stage_id = FindOrAddStage(stage_id, path.substr(begin, end - begin));
+    begin = end + 1;
+  }
+  stages_[stage_id].wall_time += wall_time;
+}
+
+/****
+ * @brief Add a value to a counter of the current stage, e.g., the number of
+ * iterations.
+ */
+void Profiler::AddCount(std::string const &name, long long count) {
+  int stage_id = CurrentStage();
+  DaliExpects(stage_id >= 0, "No stage for counter " << name);
+  auto &counters = stages_[stage_id].counters;
+  for (auto &counter : counters) {
+    if (counter.first == name) {
+      counter.second += count;
+      return;
+    }
+  }
+  counters.emplace_back(name, count);
+}
+
+/****
+ * @brief Record the lower and upper bounds of HPWL in an iteration of the
+ * current stage.
+ */
+void Profiler::RecordHpwl(
+    int iteration,
+    double lower_bound,
+    double upper_bound
+) {
+  ProfileIteration &record = iterations_.emplace_back();
+  record.stage = CurrentStage();
+  record.iteration = iteration;
+  record.lower_bound = lower_bound;
+  record.upper_bound = upper_bound;
+}
+
+void Profiler::Clear() {
+  stages_.clear();
+  open_stages_.clear();
+  iterations_.clear();
+}
+
+/****
+ * @brief Save the report in the CSV format if the file name ends with ".csv",
+ * otherwise in the JSON format. Stages not left yet are left first.
+ */
+void Profiler::SaveReport(std::string const &file_name) {
+  std::string csv_extension = ".csv";
+  bool is_csv = file_name.size() >= csv_extension.size()
+      && file_name.compare(
+          file_name.size() - csv_extension.size(),
+          csv_extension.size(),
+          csv_extension
+      ) == 0;
+  if (is_csv) {
+    SaveCsv(file_name);
+  } else {
+    SaveJson(file_name);
+  }
+}
+
+static void WriteJsonString(std::ofstream &ost, std::string const &str) {
+  ost << "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\') ost << "\\";
+    ost << c;
+  }
+  ost << "\"";
+}
+
+/****
+ * @brief Save the report in the JSON format: an array of stages, and an array
+ * of iterations with HPWL bounds.
+ */
+void Profiler::SaveJson(std::string const &file_name) {
+  EndAllStages();
+  std::ofstream ost(file_name.c_str());
+  DaliExpects(ost.is_open(), "Cannot open file " + file_name);
+  ost.precision(12);
+  ost << "{\n  \"stages\": [";
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    ProfileStage &stage = stages_[i];
+    ost << (i == 0 ? "\n" : ",\n") << "    {\"path\": ";
+    WriteJsonString(ost, stage.path);
+    ost << ", \"name\": ";
+    WriteJsonString(ost, stage.name);
+    ost << ", \"depth\": " << stage.depth
+        << ", \"calls\": " << stage.call_cnt
+        << ", \"wall_time\": " << stage.wall_time
+        << ", \"cpu_time\": " << stage.cpu_time
+        << ", \"rss_delta\": " << stage.rss_delta
+        << ", \"peak_rss\": " << stage.peak_rss
+        << ", \"counters\": {";
+    for (size_t j = 0; j < stage.counters.size(); ++j) {
+      if (j > 0) ost << ", ";
+      WriteJsonString(ost, stage.counters[j].first);
+      ost << ": " << stage.counters[j].second;
+    }
+    ost << "}}";
+  }
+  ost << "\n  ],\n  \"iterations\": [";
+  for (size_t i = 0; i < iterations_.size(); ++i) {
+    ProfileIteration &record = iterations_[i];
+    ost << (i == 0 ? "\n" : ",\n") << "    {\"stage\": ";
+    WriteJsonString(ost, record.stage < 0 ? "" : stages_[record.stage].path);
+    ost << ", \"iteration\": " << record.iteration
+        << ", \"lower_bound_hpwl\": " << record.lower_bound
+        << ", \"upper_bound_hpwl\": " << record.upper_bound << "}";
+  }
+  ost << "\n  ]\n}\n";
+  BOOST_LOG_TRIVIAL(info) << "Profiling report saved to " << file_name << "\n";
+}
+
+static void WriteCsvString(std::ofstream &ost, std::string const &str) {
+  if (str.find_first_of(",\"\n") == std::string::npos) {
+    ost << str;
+    return;
+  }
+  ost << "\"";
+  for (char c : str) {
+    if (c == '"') ost << "\"";
+    ost << c;
+  }
+  ost << "\"";
+}
+
+/****
+ * @brief Save the report in the CSV format, one metric per line. The iteration
+ * column is empty for metrics of a whole stage.
+ */
+void Profiler::SaveCsv(std::string const &file_name) {
+  EndAllStages();
+  std::ofstream ost(file_name.c_str());
+  DaliExpects(ost.is_open(), "Cannot open file " + file_name);
+  ost.precision(12);
+  ost << "stage,iteration,metric,value\n";
+  for (auto &stage : stages_) {
+    std::vector<std::pair<std::string, double>> metrics = {
+        {"calls", stage.call_cnt},
+        {"wall_time", stage.wall_time},
+        {"cpu_time", stage.cpu_time},
+        {"rss_delta", static_cast<double>(stage.rss_delta)},
+        {"peak_rss", static_cast<double>(stage.peak_rss)}
+    };
+    for (auto &counter : stage.counters) {
+      metrics.emplace_back(counter.first, counter.second);
+    }
+    for (auto &metric : metrics) {
+      WriteCsvString(ost, stage.path);
+      ost << ",,";
+      WriteCsvString(ost, metric.first);
+      ost << "," << metric.second << "\n";
+    }
+  }
+  for (auto &record : iterations_) {
+    std::string path = record.stage < 0 ? "" : stages_[record.stage].path;
+    WriteCsvString(ost, path);
+    ost << "," << record.iteration << ",lower_bound_hpwl,"
+        << record.lower_bound << "\n";
+    WriteCsvString(ost, path);
+    ost << "," << record.iteration << ",upper_bound_hpwl,"
+        << record.upper_bound << "\n";
+  }
+  BOOST_LOG_TRIVIAL(info) << "Profiling report saved to " << file_name << "\n";
+}
+
+int Profiler::CurrentStage() const {
+  return open_stages_.empty() ? -1 : open_stages_.back().stage;
+}
+
+int Profiler::FindOrAddStage(int parent, std::string const &name) {
+  for (size_t i = 0; i < stages_.size(); ++i) {
+    if (stages_[i].parent == parent && stages_[i].name == name) {
+      return static_cast<int>(i);
+    }
+  }
+  ProfileStage &stage = stages_.emplace_back();
+  stage.name = name;
+  stage.parent = parent;
+  if (parent >= 0) {
+    ProfileStage &parent_stage = stages_[parent];
+    stage.path = parent_stage.path + "/" + name;
+    stage.depth = parent_stage.depth + 1;
+  } else {
+    stage.path = name;
+  }
+  return static_cast<int>(stages_.size() - 1);
+}
+
+void Profiler::EndAllStages() {
+  if (!open_stages_.empty()) {
+    EndStage(open_stages_.front().stage);
+  }
+}
+
+Profiler &GlobalProfiler() {
+  static Profiler profiler;
+  return profiler;
+}
+
+} // dali
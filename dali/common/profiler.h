@@ -0,0 +1,127 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef DALI_COMMON_PROFILER_H_
+#define DALI_COMMON_PROFILER_H_
+
+#include <cstddef>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "elapsed_time.h"
+
+namespace dali {
+
+/****
+ * A stage in a profiling report. Stages form a tree, and the path of a stage
+ * is the names of its ancestors and itself joined by '/'. A stage entered
+ * several times under the same parent is one stage with accumulated values.
+ * ****/
+struct ProfileStage {
+  std::string name;
+  std::string path;
+  int parent = -1;
+  int depth = 0;
+  int call_cnt = 0; // 0 if timed elsewhere, see Profiler::AddTime()
+  double wall_time = 0; // seconds
+  double cpu_time = 0; // seconds, CPU time of all threads
+  long long rss_delta = 0; // bytes, change of the resident set size
+  size_t peak_rss = 0; // bytes, peak resident set size when it ends
+  std::vector<std::pair<std::string, long long>> counters;
+};
+
+// HPWL bounds of an iteration of a stage, e.g., global placement
+struct ProfileIteration {
+  int stage = -1;
+  int iteration = 0;
+  double lower_bound = 0;
+  double upper_bound = 0;
+};
+
+/****
+ * This class collects per-stage metrics of a placement flow: wall time, CPU
+ * time and memory of hierarchical stages, counters of stages, and HPWL bounds
+ * of iterations. Reports are saved in the JSON or the CSV format.
+ *
+ * Stages are entered and left by the thread running the flow, not inside
+ * OpenMP parallel regions. Timers accumulated in parallel regions can be
+ * added afterwards using AddTime().
+ * ****/
+class Profiler {
+ public:
+  Profiler() = default;
+
+  int BeginStage(std::string const &name);
+  void EndStage(int stage_id);
+  void AddTime(std::string const &path, double wall_time);
+  void AddCount(std::string const &name, long long count);
+  void RecordHpwl(int iteration, double lower_bound, double upper_bound);
+
+  std::vector<ProfileStage> const &Stages() const { return stages_; }
+  std::vector<ProfileIteration> const &Iterations() const {
+    return iterations_;
+  }
+  void Clear();
+
+  void SaveReport(std::string const &file_name);
+  void SaveJson(std::string const &file_name);
+  void SaveCsv(std::string const &file_name);
+ private:
+  // a stage which is entered but not left yet
+  struct OpenStage {
+    int stage = -1;
+    ElapsedTime elapsed_time;
+    size_t start_rss = 0;
+  };
+  std::vector<ProfileStage> stages_;
+  std::vector<OpenStage> open_stages_;
+  std::vector<ProfileIteration> iterations_;
+
+  int CurrentStage() const;
+  int FindOrAddStage(int parent, std::string const &name);
+  void EndAllStages();
+};
+
+// the profiler shared by all stages of a placement flow
+Profiler &GlobalProfiler();
+
+/****
+ * A stage of the global profiler living as long as this object, e.g.,
+ *   {
+ *     ProfileScope scope("upward-downward legalization");
+ *     ...
+ *   }
+ * ****/
+class ProfileScope {
+ public:
+  explicit ProfileScope(std::string const &name)
+      : stage_(GlobalProfiler().BeginStage(name)) {}
+  ~ProfileScope() { GlobalProfiler().EndStage(stage_); }
+  ProfileScope(ProfileScope const &) = delete;
+  ProfileScope &operator=(ProfileScope const &) = delete;
+ private:
+  int stage_;
+};
+
+} // dali
+
+#endif //DALI_COMMON_PROFILER_H_
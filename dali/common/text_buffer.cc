@@ -0,0 +1,53 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "text_buffer.h"
+
+#include <fstream>
+
+#include "logging.h"
+
+namespace dali {
+
+TextBuffer &TextBuffer::operator<<(double value) {
+  char buf[32];
+  auto ret = std::to_chars(
+      buf, buf + sizeof(buf), value, std::chars_format::general, 6
+  );
+  data_.append(buf, ret.ptr);
+  return *this;
+}
+
+void WriteTextFile(
+    std::string const &file_name,
+    std::vector<TextBuffer const *> const &buffers
+) {
+  std::ofstream ost(file_name.c_str(), std::ios::binary | std::ios::trunc);
+  DaliExpects(ost.is_open(), "Cannot open file " + file_name);
+  for (auto &buffer : buffers) {
+    ost.write(
+        buffer->Str().data(),
+        static_cast<std::streamsize>(buffer->Size())
+    );
+  }
+  DaliExpects(ost.good(), "Failed to write file " + file_name);
+}
+
+} // dali
@@ -0,0 +1,75 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef DALI_COMMON_TEXT_BUFFER_H_
+#define DALI_COMMON_TEXT_BUFFER_H_
+
+#include <charconv>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace dali {
+
+/****
+ * An in-memory text buffer with an std::ostream-like interface. Numbers are
+ * formatted by std::to_chars, and a double is formatted in the same way as
+ * an std::ostream with default flags, i.e., "%g" with precision 6. Files are
+ * written by appending buffers to a file in large blocks, see WriteTextFile().
+ * ****/
+class TextBuffer {
+ public:
+  TextBuffer &operator<<(std::string const &str) {
+    data_.append(str);
+    return *this;
+  }
+  TextBuffer &operator<<(char const *str) {
+    data_.append(str);
+    return *this;
+  }
+  TextBuffer &operator<<(char c) {
+    data_.push_back(c);
+    return *this;
+  }
+  template<typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+  TextBuffer &operator<<(T value) {
+    char buf[24];
+    auto ret = std::to_chars(buf, buf + sizeof(buf), value);
+    data_.append(buf, ret.ptr);
+    return *this;
+  }
+  TextBuffer &operator<<(double value);
+
+  std::string const &Str() const { return data_; }
+  size_t Size() const { return data_.size(); }
+  void Reserve(size_t capacity) { data_.reserve(capacity); }
+ private:
+  std::string data_;
+};
+
+// write the content of buffers to a file, one after another
+void WriteTextFile(
+    std::string const &file_name,
+    std::vector<TextBuffer const *> const &buffers
+);
+
+} // dali
+
+#endif //DALI_COMMON_TEXT_BUFFER_H_
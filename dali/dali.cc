@@ -383,32 +383,14 @@ void Dali::ExportToDEF(
     std::string const &input_def_file_full_name,
     std::string const &output_def_name
 ) {
-  circuit_.SaveDefFile(
+  circuit_.SaveDefFiles(
       output_def_name,
-      "",
       input_def_file_full_name,
-      1,
-      1,
-      2,
-      1
-  );
-  circuit_.SaveDefFile(
-      output_def_name,
-      "_io",
-      input_def_file_full_name,
-      1,
-      1,
-      1,
-      1
-  );
-  circuit_.SaveDefFile(
-      output_def_name,
-      "_filling",
-      input_def_file_full_name,
-      1,
-      4,
-      2,
-      1
+      {
+          {"", 1, 1, 2, 1},
+          {"_io", 1, 1, 1, 1},
+          {"_filling", 1, 4, 2, 1}
+      }
   );
   circuit_.InitNetFanoutHistogram();
   circuit_.ReportNetFanoutHistogram();
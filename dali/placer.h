@@ -30,6 +30,7 @@
 /****Legalizer****/
 #include "dali/placer/legalizer/LGTetris.h"
 #include "dali/placer/legalizer/LGTetrisEx.h"
+#include "dali/placer/legalizer/LGAbacus.h"
 
 /****Well Legalizer****/
 #include "dali/placer/well_legalizer/stdclusterwelllegalizer.h"
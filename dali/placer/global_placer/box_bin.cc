@@ -41,11 +41,11 @@ BoxBin::BoxBin() {
   top = 0;
 }
 
-void BoxBin::update_all_terminal(std::vector<std::vector<GridBin> > &grid_bin_matrix) {
+void BoxBin::update_all_terminal(GridBinMesh &grid_bin_mesh) {
   GridBin *bin;
   for (int x = ll_index.x; x <= ur_index.x; x++) {
     for (int y = ll_index.y; y <= ur_index.y; y++) {
-      bin = &grid_bin_matrix[x][y];
+      bin = &grid_bin_mesh[x][y];
       if (!bin->IsAllFixedBlk()) {
         all_terminal = false;
         return;
@@ -80,47 +80,14 @@ void BoxBin::update_cell_area() {
   }
 }
 
-void BoxBin::update_cell_area_white_space(std::vector<std::vector<GridBin> > &grid_bin_matrix) {
-  total_cell_area = 0;
-  total_white_space = 0;
-  for (int x = ll_index.x; x <= ur_index.x; x++) {
-    for (int y = ll_index.y; y <= ur_index.y; y++) {
-      total_white_space += grid_bin_matrix[x][y].white_space;
-      total_cell_area += grid_bin_matrix[x][y].cell_area;
-    }
-  }
+void BoxBin::update_cell_area_white_space(GridBinMesh &grid_bin_mesh) {
+  total_white_space = grid_bin_mesh.WhiteSpace(ll_index, ur_index);
+  total_cell_area = grid_bin_mesh.CellArea(ll_index, ur_index);
   filling_rate = double(total_cell_area) / double(total_white_space);
 }
 
-void BoxBin::UpdateCellAreaWhiteSpaceFillingRate(
-    std::vector<std::vector<unsigned long long>> &grid_bin_white_space_LUT,
-    std::vector<std::vector<GridBin>> &grid_bin_matrix
-) {
-  if (ll_index.x == 0) {
-    if (ll_index.y == 0) {
-      total_white_space = grid_bin_white_space_LUT[ur_index.x][ur_index.y];
-    } else {
-      total_white_space = grid_bin_white_space_LUT[ur_index.x][ur_index.y]
-          - grid_bin_white_space_LUT[ur_index.x][ll_index.y - 1];
-    }
-  } else {
-    if (ll_index.y == 0) {
-      total_white_space = grid_bin_white_space_LUT[ur_index.x][ur_index.y]
-          - grid_bin_white_space_LUT[ll_index.x - 1][ur_index.y];
-    } else {
-      total_white_space = grid_bin_white_space_LUT[ur_index.x][ur_index.y]
-          - grid_bin_white_space_LUT[ur_index.x][ll_index.y - 1]
-          - grid_bin_white_space_LUT[ll_index.x - 1][ur_index.y]
-          + grid_bin_white_space_LUT[ll_index.x - 1][ll_index.y - 1];
-    }
-  }
-  total_cell_area = 0;
-  for (int x = ll_index.x; x <= ur_index.x; x++) {
-    for (int y = ll_index.y; y <= ur_index.y; y++) {
-      total_cell_area += grid_bin_matrix[x][y].cell_area;
-    }
-  }
-  filling_rate = double(total_cell_area) / double(total_white_space);
+void BoxBin::UpdateCellAreaWhiteSpaceFillingRate(GridBinMesh &grid_bin_mesh) {
+  update_cell_area_white_space(grid_bin_mesh);
 }
 
 void BoxBin::ExpandBox(int grid_cnt_x, int grid_cnt_y) {
@@ -184,25 +151,26 @@ bool BoxBin::write_cell_region(std::string const &NameOfFile) {
   return true;
 }
 
-void BoxBin::UpdateCellList(std::vector<std::vector<GridBin> > &grid_bin_matrix) {
+void BoxBin::UpdateCellList(GridBinMesh &grid_bin_mesh) {
   cell_list.clear();
   for (int x = ll_index.x; x <= ur_index.x; x++) {
     for (int y = ll_index.y; y <= ur_index.y; y++) {
-      for (auto &blk_ptr : grid_bin_matrix[x][y].cell_list) {
+      for (auto &blk_ptr : grid_bin_mesh[x][y].cell_list) {
         cell_list.push_back(blk_ptr);
       }
-      grid_bin_matrix[x][y].cell_list.clear();
-      grid_bin_matrix[x][y].cell_area = 0;
-      grid_bin_matrix[x][y].over_fill = false;
+      grid_bin_mesh[x][y].cell_list.clear();
+      grid_bin_mesh[x][y].cell_area = 0;
+      grid_bin_mesh[x][y].over_fill = false;
     }
   }
+  grid_bin_mesh.MarkCellAreaChanged(ll_index, ur_index);
 }
 
-void BoxBin::update_boundaries(std::vector<std::vector<GridBin> > &grid_bin_matrix) {
-  left = grid_bin_matrix[ll_index.x][ll_index.y].left;
-  bottom = grid_bin_matrix[ll_index.x][ll_index.y].bottom;
-  right = grid_bin_matrix[ur_index.x][ur_index.y].right;
-  top = grid_bin_matrix[ur_index.x][ur_index.y].top;
+void BoxBin::update_boundaries(GridBinMesh &grid_bin_mesh) {
+  left = grid_bin_mesh[ll_index.x][ll_index.y].left;
+  bottom = grid_bin_mesh[ll_index.x][ll_index.y].bottom;
+  right = grid_bin_mesh[ur_index.x][ur_index.y].right;
+  top = grid_bin_mesh[ur_index.x][ur_index.y].top;
 }
 
 void BoxBin::UpdateWhiteSpaceAndFixedblocks(
@@ -329,34 +297,7 @@ bool BoxBin::write_cell_in_box(
   return true;
 }
 
-unsigned long long BoxBin::white_space_LUT(
-    std::vector<std::vector<unsigned long long>> &grid_bin_white_space_LUT,
-    GridBinIndex &ll,
-    GridBinIndex &ur
-) {
-  unsigned long long white_space;
-  if (ll.x == 0) {
-    if (ll.y == 0) {
-      white_space = grid_bin_white_space_LUT[ur.x][ur.y];
-    } else {
-      white_space = grid_bin_white_space_LUT[ur.x][ur.y]
-          - grid_bin_white_space_LUT[ur.x][ll.y - 1];
-    }
-  } else {
-    if (ll.y == 0) {
-      white_space = grid_bin_white_space_LUT[ur.x][ur.y]
-          - grid_bin_white_space_LUT[ll.x - 1][ur.y];
-    } else {
-      white_space = grid_bin_white_space_LUT[ur.x][ur.y]
-          - grid_bin_white_space_LUT[ur.x][ll.y - 1]
-          - grid_bin_white_space_LUT[ll.x - 1][ur.y]
-          + grid_bin_white_space_LUT[ll.x - 1][ll.y - 1];
-    }
-  }
-  return white_space;
-}
-
-bool BoxBin::update_cut_index_white_space(std::vector<std::vector<unsigned long long>> &grid_bin_white_space_LUT) {
+bool BoxBin::update_cut_index_white_space(GridBinMesh &grid_bin_mesh) {
   double error, minimum_error = 1;
   unsigned long long white_space_low;
   int index_give_minimum_error;
@@ -370,8 +311,7 @@ bool BoxBin::update_cut_index_white_space(std::vector<std::vector<unsigned long
     for (cut_ur_index.y = ll_index.y; cut_ur_index.y < ur_index.y - 1;
          cut_ur_index.y++) {
       //BOOST_LOG_TRIVIAL(info)   << cut_ur_index.y << "\n";
-      white_space_low =
-          white_space_LUT(grid_bin_white_space_LUT, ll_index, cut_ur_index);
+      white_space_low = grid_bin_mesh.WhiteSpace(ll_index, cut_ur_index);
       error =
           std::fabs(double(white_space_low) / double(total_white_space) - 0.5);
       if (error < minimum_error) index_give_minimum_error = cut_ur_index.y;
@@ -379,7 +319,7 @@ bool BoxBin::update_cut_index_white_space(std::vector<std::vector<unsigned long
     }
     if (cut_ur_index.y != index_give_minimum_error) {
       cut_ur_index.y = index_give_minimum_error;
-      //white_space_low = white_space_LUT(grid_bin_white_space_LUT, ll_index_, cut_ur_index);
+      //white_space_low = grid_bin_mesh.WhiteSpace(ll_index_, cut_ur_index);
     }
     cut_ll_index.y = cut_ur_index.y + 1;
     return true;
@@ -393,8 +333,7 @@ bool BoxBin::update_cut_index_white_space(std::vector<std::vector<unsigned long
     for (cut_ur_index.x = ll_index.x; cut_ur_index.x < ur_index.x - 1;
          cut_ur_index.x++) {
       //BOOST_LOG_TRIVIAL(info)   << cut_ur_index.x << "\n";
-      white_space_low =
-          white_space_LUT(grid_bin_white_space_LUT, ll_index, cut_ur_index);
+      white_space_low = grid_bin_mesh.WhiteSpace(ll_index, cut_ur_index);
       error =
           std::fabs(double(white_space_low) / double(total_white_space) - 0.5);
       if (error < minimum_error) index_give_minimum_error = cut_ur_index.x;
@@ -402,7 +341,7 @@ bool BoxBin::update_cut_index_white_space(std::vector<std::vector<unsigned long
     }
     if (cut_ur_index.x != index_give_minimum_error) {
       cut_ur_index.x = index_give_minimum_error;
-      //white_space_low = white_space_LUT(grid_bin_white_space_LUT, ll_index_, cut_ur_index);
+      //white_space_low = grid_bin_mesh.WhiteSpace(ll_index_, cut_ur_index);
     }
     cut_ll_index.x = cut_ur_index.x + 1;
     return true;
@@ -76,8 +76,8 @@ class BoxBin {
    * if there is no terminal in the grid bin, do not have to further split the box into smaller boxs,
    * otherwise split the box into smaller boxes, until there is no terminals in any boxes*/
   std::vector<Block *> fixed_blocks;
-  void UpdateFixedBlkList(std::vector<std::vector<GridBin> > &grid_bin_matrix) {
-    fixed_blocks = grid_bin_matrix[ll_index.x][ll_index.y].fixed_blocks;
+  void UpdateFixedBlkList(GridBinMesh &grid_bin_mesh) {
+    fixed_blocks = grid_bin_mesh[ll_index.x][ll_index.y].fixed_blocks;
   };
   /* UpdateFixedBlkList can only be called when the box is a grid_bin_box */
   bool IsContainFixedBlk() const { return !fixed_blocks.empty(); };
@@ -93,30 +93,22 @@ class BoxBin {
   int right;
   int bottom;
   int top;
-  void update_boundaries(std::vector<std::vector<GridBin> > &grid_bin_matrix);
+  void update_boundaries(GridBinMesh &grid_bin_mesh);
   /* update_white_space can only be called when left, right, bottom, top are updated */
   void UpdateWhiteSpaceAndFixedblocks(std::vector<Block *> &box_fixed_blocks);
 
-  void update_all_terminal(std::vector<std::vector<GridBin>> &grid_bin_matrix);
+  void update_all_terminal(GridBinMesh &grid_bin_mesh);
   void update_cell_area();
-  void update_cell_area_white_space(std::vector<std::vector<GridBin>> &grid_bin_matrix);
-  void UpdateCellAreaWhiteSpaceFillingRate(
-      std::vector<std::vector<unsigned long long> > &grid_bin_white_space_LUT,
-      std::vector<std::vector<GridBin>> &grid_bin_matrix
-  );
+  void update_cell_area_white_space(GridBinMesh &grid_bin_mesh);
+  void UpdateCellAreaWhiteSpaceFillingRate(GridBinMesh &grid_bin_mesh);
   void ExpandBox(int grid_cnt_x, int grid_cnt_y);
   bool write_box_boundary(std::string const &NameOfFile);
   bool write_cell_region(std::string const &NameOfFile = "first_cell_bounding_box.txt");
-  static unsigned long long white_space_LUT(
-      std::vector<std::vector<unsigned long long>> &grid_bin_white_space_LUT,
-      GridBinIndex &ll,
-      GridBinIndex &ur
-  );
-  void UpdateCellList(std::vector<std::vector<GridBin>> &grid_bin_matrix);
+  void UpdateCellList(GridBinMesh &grid_bin_mesh);
   bool write_cell_in_box(
       std::string const &NameOfFile
   );
-  bool update_cut_index_white_space(std::vector<std::vector<unsigned long long>> &grid_bin_white_space_LUT);
+  bool update_cut_index_white_space(GridBinMesh &grid_bin_mesh);
   bool update_cut_point_cell_list_low_high(
       unsigned long long &box1_total_white_space,
       unsigned long long &box2_total_white_space
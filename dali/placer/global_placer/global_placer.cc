@@ -50,13 +50,47 @@ void GlobalPlacer::SetShouldSaveIntermediateResult(bool should_save_intermediate
 }
 
 /****
- * @brief Load a configuration file for this placer.
+ * @brief Set the linear solver backend used by the HPWL optimizer.
+ *
+ * @param linear_solver_type: the linear solver backend.
+ */
+void GlobalPlacer::SetLinearSolverType(LinearSolverType linear_solver_type) {
+  linear_solver_type_ = linear_solver_type;
+}
+
+/****
+ * @brief Enable or disable incremental global placement. In the incremental
+ * mode, the current locations of PLACED blocks are the prior placement, and
+ * UNPLACED movable blocks are changed blocks. Blocks in the prior placement
+ * are strongly anchored to their locations, and cell overlap is only removed
+ * near changed blocks. If there is no prior placement, the global placement
+ * starts from scratch.
+ *
+ * @param is_incremental: true to enable the incremental mode.
+ */
+void GlobalPlacer::SetIncremental(bool is_incremental) {
+  is_incremental_ = is_incremental;
+}
+
+/****
+ * @brief Load a configuration file for this placer. Supported entries:
+ *   dali.global_placer.linear_solver: diagonal, ic0, amg, or fused
+ *   dali.global_placer.incremental: 0 or 1
  *
  * @param config_file: name of the configuration file.
  */
 void GlobalPlacer::LoadConf(std::string const &config_file) {
   config_read(config_file.c_str());
-  DaliFatal("This function is not fully implemented");
+  std::string linear_solver_key = "dali.global_placer.linear_solver";
+  if (config_exists(linear_solver_key.c_str())) {
+    SetLinearSolverType(
+        StrToLinearSolverType(config_get_string(linear_solver_key.c_str()))
+    );
+  }
+  std::string incremental_key = "dali.global_placer.incremental";
+  if (config_exists(incremental_key.c_str())) {
+    SetIncremental(config_get_int(incremental_key.c_str()) != 0);
+  }
 }
 
 /****
@@ -66,11 +100,16 @@ void GlobalPlacer::LoadConf(std::string const &config_file) {
 void GlobalPlacer::InitializeOptimizerAndLegalizer() {
   delete optimizer_;
   optimizer_ = new B2BHpwlOptimizer(ckt_ptr_, num_threads_);
+  optimizer_->SetLinearSolverType(linear_solver_type_);
   optimizer_->SetShouldSaveIntermediateResult(should_save_intermediate_result_);
   optimizer_->Initialize();
+  if (!anchor_weight_factors_.empty()) {
+    optimizer_->SetAnchorWeightFactors(anchor_weight_factors_);
+  }
 
   delete legalizer_;
   legalizer_ = new LookAheadLegalizer(ckt_ptr_);
+  legalizer_->SetNumThreads(num_threads_);
   legalizer_->SetShouldSaveIntermediateResult(should_save_intermediate_result_);
   legalizer_->Initialize(PlacementDensity());
 }
@@ -82,10 +121,12 @@ void GlobalPlacer::CloseOptimizerAndLegalizer() {
   if (optimizer_ != nullptr) {
     optimizer_->Close();
     delete optimizer_;
+    optimizer_ = nullptr;
   }
   if (legalizer_ != nullptr) {
     legalizer_->Close();
     delete legalizer_;
+    legalizer_ = nullptr;
   }
 }
 
@@ -120,6 +161,95 @@ void GlobalPlacer::InitializeBlockLocation() {
   delete initializer;
 }
 
+/****
+ * @brief Put each changed block at the average location of its neighbors
+ * which already have locations, i.e., unchanged blocks, fixed blocks, and
+ * changed blocks seeded before it. A changed block without such neighbors is
+ * put at the center of the placement region.
+ */
+void GlobalPlacer::SeedChangedBlocks() {
+  std::vector<Block> &blocks = ckt_ptr_->Blocks();
+  std::vector<Net> &nets = ckt_ptr_->Nets();
+  std::vector<bool> is_seeded(blocks.size(), true);
+  int sz = static_cast<int>(blocks.size());
+  for (int i = 0; i < sz; ++i) {
+    if (is_blk_changed_[i]) is_seeded[i] = false;
+  }
+  double center_x = (RegionLeft() + RegionRight()) / 2.0;
+  double center_y = (RegionBottom() + RegionTop()) / 2.0;
+  for (int i = 0; i < sz; ++i) {
+    if (!is_blk_changed_[i]) continue;
+    Block &blk = blocks[i];
+    double sum_x = 0;
+    double sum_y = 0;
+    int neighbor_cnt = 0;
+    for (int net_id : blk.NetList()) {
+      Net &net = nets[net_id];
+      if (net.PinCnt() > seed_net_size_threshold_) continue;
+      for (auto &blk_pin : net.BlockPins()) {
+        int blk_id = blk_pin.BlkPtr()->Id();
+        if (blk_id == i || !is_seeded[blk_id]) continue;
+        sum_x += blk_pin.AbsX();
+        sum_y += blk_pin.AbsY();
+        ++neighbor_cnt;
+      }
+    }
+    double x = center_x;
+    double y = center_y;
+    if (neighbor_cnt > 0) {
+      x = sum_x / neighbor_cnt;
+      y = sum_y / neighbor_cnt;
+    }
+    x = std::max(x, RegionLeft() + blk.Width() / 2.0);
+    x = std::min(x, RegionRight() - blk.Width() / 2.0);
+    y = std::max(y, RegionBottom() + blk.Height() / 2.0);
+    y = std::min(y, RegionTop() - blk.Height() / 2.0);
+    blk.SetCenterX(x);
+    blk.SetCenterY(y);
+    is_seeded[i] = true;
+  }
+}
+
+/****
+ * @brief Initialize block locations for incremental placement. Movable blocks
+ * with the PLACED status keep their prior locations, and they are strongly
+ * anchored. UNPLACED movable blocks are changed blocks, and they are seeded
+ * near their neighbors.
+ *
+ * @return true if there is a prior placement, false if all movable blocks are
+ * UNPLACED.
+ */
+bool GlobalPlacer::InitializeIncrementalPlacement() {
+  std::vector<Block> &blocks = ckt_ptr_->Blocks();
+  int sz = static_cast<int>(blocks.size());
+  is_blk_changed_.assign(sz, false);
+  changed_blk_cnt_ = 0;
+  for (int i = 0; i < sz; ++i) {
+    if (blocks[i].IsMovable() && blocks[i].Status() == UNPLACED) {
+      is_blk_changed_[i] = true;
+      ++changed_blk_cnt_;
+    }
+  }
+  if (changed_blk_cnt_ == ckt_ptr_->TotMovBlkCnt()) {
+    BOOST_LOG_TRIVIAL(info)
+      << "  no prior placement, skip incremental placement\n";
+    is_blk_changed_.clear();
+    return false;
+  }
+  BOOST_LOG_TRIVIAL(info)
+    << "  incremental placement, changed blocks: " << changed_blk_cnt_
+    << " out of " << ckt_ptr_->TotMovBlkCnt() << "\n";
+
+  SeedChangedBlocks();
+  anchor_weight_factors_.assign(sz, 1);
+  for (int i = 0; i < sz; ++i) {
+    if (!is_blk_changed_[i]) {
+      anchor_weight_factors_[i] = unchanged_anchor_weight_factor_;
+    }
+  }
+  return true;
+}
+
 /****
  * @brief The entry point of global placement.
  * @return A boolean value indicating whether global placement can be
@@ -130,16 +260,49 @@ bool GlobalPlacer::StartPlacement() {
   PrintStartStatement("global placement");
 
   SanityCheck();
-  InitializeBlockLocation();
+  // changed blocks of a previous run must not leak into this one
+  is_blk_changed_.clear();
+  changed_blk_cnt_ = 0;
+  bool is_incremental = is_incremental_ && InitializeIncrementalPlacement();
+  if (is_incremental && changed_blk_cnt_ == 0) {
+    BOOST_LOG_TRIVIAL(info) << "  no changed blocks, skip global placement\n";
+    PrintEndStatement("Global placement", true);
+    return true;
+  }
+  if (!is_incremental) {
+    InitializeBlockLocation();
+  }
   InitializeOptimizerAndLegalizer();
-  for (cur_iter_ = 0; cur_iter_ < max_iter_; ++cur_iter_) {
+  int start_iter = 0;
+  if (is_incremental) {
+    // leave enough iterations to refine the prior placement
+    start_iter = std::min(warm_start_iter_, max_iter_ / 2);
+    if (start_iter > 0) {
+      optimizer_->WarmStart(start_iter);
+    }
+  }
+  int end_iter = max_iter_;
+  if (is_incremental) {
+    std::vector<bool> is_blk_unchanged(is_blk_changed_.size());
+    for (size_t i = 0; i < is_blk_changed_.size(); ++i) {
+      is_blk_unchanged[i] = !is_blk_changed_[i];
+    }
+    optimizer_->PinAnchors(is_blk_unchanged);
+    legalizer_->SetActiveBlocks(is_blk_changed_, changed_bin_halo_);
+    end_iter = std::min(end_iter, start_iter + incremental_max_iter_);
+  }
+  for (cur_iter_ = start_iter; cur_iter_ < end_iter; ++cur_iter_) {
     optimizer_->SetIteration(cur_iter_);
-    optimizer_->OptimizeHpwl();
-    legalizer_->RemoveCellOverlap();
+    double lower_bound = optimizer_->OptimizeHpwl();
+    double upper_bound = legalizer_->RemoveCellOverlap();
+    GlobalProfiler().RecordHpwl(cur_iter_, lower_bound, upper_bound);
     PrintHpwl();
     if (IsPlacementConverge()) break;
   }
   UpdateMovableBlkPlacementStatus();
+  GlobalProfiler().AddCount(
+      "iterations", std::min(cur_iter_ + 1, end_iter) - start_iter
+  );
 
   PrintEndStatement("Global placement", true);
   CloseOptimizerAndLegalizer();
@@ -199,11 +362,20 @@ bool GlobalPlacer::IsSeriesConverge(
  * Stopping criteria (POLAR, option 2):
  *    the gap between lower bound wire-length and upper bound wire-length is
  *    less than 8%
+ * In the incremental mode, most blocks are already spread, so the placement
+ * converges once the upper-bound solution stops improving.
  * ****/
 bool GlobalPlacer::IsPlacementConverge() {
   bool res;
   auto &lower_bound_hpwl = optimizer_->GetHpwls();
   auto &upper_bound_hpwl = legalizer_->GetHpwls();
+  if (!is_blk_changed_.empty()) {
+    return IsSeriesConverge(
+        upper_bound_hpwl,
+        3,
+        simpl_LAL_converge_criterion_
+    );
+  }
   if (convergence_criteria_ == 1) {
     // (a) and (b) requires at least 10 iterations
     if (lower_bound_hpwl.size() <= 10) {
@@ -264,6 +436,12 @@ void GlobalPlacer::PrintEndStatement(
     std::string const &name_of_process,
     bool is_success
 ) {
+  // the optimizer and the legalizer do not exist if global placement is
+  // skipped
+  if (optimizer_ == nullptr || legalizer_ == nullptr) {
+    Placer::PrintEndStatement(name_of_process, is_success);
+    return;
+  }
   BOOST_LOG_TRIVIAL(debug)
     << "  Iterative look-ahead legalization complete\n";
   BOOST_LOG_TRIVIAL(debug)
@@ -275,6 +453,8 @@ void GlobalPlacer::PrintEndStatement(
   BOOST_LOG_TRIVIAL(debug)
     << "cg time: " << optimizer_->GetTime()
     << "s, lal time: " << legalizer_->GetTime() << "s\n";
+  optimizer_->ReportProfile();
+  legalizer_->ReportProfile();
   Placer::PrintEndStatement(name_of_process, is_success);
 }
 
@@ -37,12 +37,15 @@ class GlobalPlacer : public Placer {
 
   void SetMaxIteration(int max_iter);
   void SetShouldSaveIntermediateResult(bool should_save_intermediate_result);
+  void SetLinearSolverType(LinearSolverType linear_solver_type);
+  void SetIncremental(bool is_incremental);
   void LoadConf(std::string const &config_file) override;
 
   void InitializeOptimizerAndLegalizer();
   void CloseOptimizerAndLegalizer();
 
   void InitializeBlockLocation();
+  bool InitializeIncrementalPlacement();
 
   bool StartPlacement() override;
  protected:
@@ -56,7 +59,27 @@ class GlobalPlacer : public Placer {
   // save intermediate result for debugging and/or visualization
   bool should_save_intermediate_result_ = false;
 
+  /**** incremental global placement ****/
+  bool is_incremental_ = false;
+  // movable blocks without a prior location, i.e., UNPLACED blocks
+  std::vector<bool> is_blk_changed_;
+  int changed_blk_cnt_ = 0;
+  // anchor weight factor of each block, empty if all factors are 1
+  std::vector<double> anchor_weight_factors_;
+  // anchor weight factor of blocks keeping their prior locations
+  double unchanged_anchor_weight_factor_ = 1000;
+  // the global placement continues from this iteration
+  int warm_start_iter_ = 30;
+  // cell overlap is only removed within this amount of grid bins of changed
+  // blocks
+  int changed_bin_halo_ = 1;
+  // the incremental mode runs at most this amount of iterations
+  int incremental_max_iter_ = 10;
+  // nets with more pins than this value are not used to seed changed blocks
+  size_t seed_net_size_threshold_ = 100;
+
   bool IsBlockListOrNetListEmpty() const;
+  void SeedChangedBlocks();
   static bool IsSeriesConverge(
       std::vector<double> &data,
       int window_size,
@@ -70,6 +93,7 @@ class GlobalPlacer : public Placer {
   ) override;
 
   RandomInitializerType initializer_type_ = RandomInitializerType::UNIFORM;
+  LinearSolverType linear_solver_type_ = LinearSolverType::DIAGONAL;
   HpwlOptimizer *optimizer_ = nullptr;
   RoughLegalizer *legalizer_ = nullptr;
 };
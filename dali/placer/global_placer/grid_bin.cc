@@ -77,4 +77,113 @@ void GridBin::Report() {
                           << "  over fill:   " << over_fill << "\n";
 }
 
+void GridBinMesh::Init(int cnt_x, int cnt_y) {
+  DaliExpects(cnt_x > 0 && cnt_y > 0, "Empty grid bin mesh?");
+  cnt_x_ = cnt_x;
+  cnt_y_ = cnt_y;
+  bins_.assign(static_cast<size_t>(cnt_x) * cnt_y, GridBin());
+  white_space_prefix_sum_.assign(
+      static_cast<size_t>(cnt_x + 1) * (cnt_y + 1), 0
+  );
+  cell_area_prefix_sum_.assign(
+      static_cast<size_t>(cnt_x + 1) * (cnt_y + 1), 0
+  );
+  changed_windows_.clear();
+}
+
+void GridBinMesh::Clear() {
+  cnt_x_ = 0;
+  cnt_y_ = 0;
+  bins_.clear();
+  white_space_prefix_sum_.clear();
+  cell_area_prefix_sum_.clear();
+  changed_windows_.clear();
+}
+
+void GridBinMesh::BuildPrefixSum(
+    std::vector<unsigned long long> &prefix_sum,
+    unsigned long long GridBin::*attribute
+) {
+  int stride = cnt_y_ + 1;
+  for (int x = 0; x < cnt_x_; ++x) {
+    unsigned long long const *prev_column = prefix_sum.data() + x * stride;
+    unsigned long long *column = prefix_sum.data() + (x + 1) * stride;
+    GridBin const *bin_column = bins_.data() + x * cnt_y_;
+    unsigned long long column_sum = 0;
+    for (int y = 0; y < cnt_y_; ++y) {
+      column_sum += bin_column[y].*attribute;
+      column[y + 1] = prev_column[y + 1] + column_sum;
+    }
+  }
+}
+
+void GridBinMesh::UpdateWhiteSpacePrefixSum() {
+  BuildPrefixSum(white_space_prefix_sum_, &GridBin::white_space);
+}
+
+/****
+ * @brief take a snapshot of cell areas of all grid bins, and forget all
+ * previously changed windows.
+ */
+void GridBinMesh::UpdateCellAreaPrefixSum() {
+  BuildPrefixSum(cell_area_prefix_sum_, &GridBin::cell_area);
+  changed_windows_.clear();
+}
+
+/****
+ * @brief record that cell areas of grid bins in a window might be changed
+ * after the last snapshot.
+ */
+void GridBinMesh::MarkCellAreaChanged(
+    GridBinIndex const &ll,
+    GridBinIndex const &ur
+) {
+  changed_windows_.emplace_back(ll, ur);
+}
+
+unsigned long long GridBinMesh::WindowSum(
+    std::vector<unsigned long long> const &prefix_sum,
+    GridBinIndex const &ll,
+    GridBinIndex const &ur
+) const {
+  int stride = cnt_y_ + 1;
+  return prefix_sum[(ur.x + 1) * stride + ur.y + 1]
+      - prefix_sum[(ur.x + 1) * stride + ll.y]
+      - prefix_sum[ll.x * stride + ur.y + 1]
+      + prefix_sum[ll.x * stride + ll.y];
+}
+
+unsigned long long GridBinMesh::WhiteSpace(
+    GridBinIndex const &ll,
+    GridBinIndex const &ur
+) const {
+  return WindowSum(white_space_prefix_sum_, ll, ur);
+}
+
+unsigned long long GridBinMesh::CellArea(
+    GridBinIndex const &ll,
+    GridBinIndex const &ur
+) const {
+  bool is_stale = false;
+  for (auto &window : changed_windows_) {
+    if (ll.x <= window.second.x && window.first.x <= ur.x
+        && ll.y <= window.second.y && window.first.y <= ur.y) {
+      is_stale = true;
+      break;
+    }
+  }
+  if (!is_stale) {
+    return WindowSum(cell_area_prefix_sum_, ll, ur);
+  }
+
+  unsigned long long cell_area = 0;
+  for (int x = ll.x; x <= ur.x; ++x) {
+    GridBin const *bin_column = bins_.data() + x * cnt_y_;
+    for (int y = ll.y; y <= ur.y; ++y) {
+      cell_area += bin_column[y].cell_area;
+    }
+  }
+  return cell_area;
+}
+
 }
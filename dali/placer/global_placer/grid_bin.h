@@ -21,6 +21,7 @@
 #ifndef DALI_PLACER_GLOBAL_PLACER_GRID_BIN_H_
 #define DALI_PLACER_GLOBAL_PLACER_GRID_BIN_H_
 
+#include <utility>
 #include <vector>
 
 #include "dali/circuit/block.h"
@@ -64,6 +65,64 @@ class GridBin {
   void Report();
 };
 
+/****
+ * A matrix of grid bins stored in a flat vector in column-major order, bins
+ * in the same column are contiguous in memory. mesh[x][y] returns the bin in
+ * column x and row y.
+ *
+ * Prefix sums of white space and cell area are cached, such that the total
+ * white space or cell area in a window of bins can be found in constant time.
+ * The cell area prefix sum is a snapshot; windows whose cell area changed
+ * after the snapshot are recorded, and queries overlapping with them fall
+ * back to summing cell areas of bins directly.
+ */
+class GridBinMesh {
+ public:
+  void Init(int cnt_x, int cnt_y);
+  void Clear();
+  int CntX() const { return cnt_x_; }
+  int CntY() const { return cnt_y_; }
+  GridBin *operator[](int x) { return bins_.data() + x * cnt_y_; }
+  GridBin const *operator[](int x) const { return bins_.data() + x * cnt_y_; }
+  std::vector<GridBin> &Bins() { return bins_; }
+  int BinId(int x, int y) const { return x * cnt_y_ + y; }
+  std::vector<std::pair<GridBinIndex, GridBinIndex>> const &ChangedWindows() const {
+    return changed_windows_;
+  }
+
+  void UpdateWhiteSpacePrefixSum();
+  void UpdateCellAreaPrefixSum();
+  void MarkCellAreaChanged(GridBinIndex const &ll, GridBinIndex const &ur);
+  unsigned long long WhiteSpace(
+      GridBinIndex const &ll,
+      GridBinIndex const &ur
+  ) const;
+  unsigned long long CellArea(
+      GridBinIndex const &ll,
+      GridBinIndex const &ur
+  ) const;
+ private:
+  int cnt_x_ = 0;
+  int cnt_y_ = 0;
+  std::vector<GridBin> bins_;
+  // prefix sums padded with a leading row and column of zeros,
+  // entry (x, y) is the sum of all bins in [0, x) * [0, y)
+  std::vector<unsigned long long> white_space_prefix_sum_;
+  std::vector<unsigned long long> cell_area_prefix_sum_;
+  // windows whose cell area may differ from cell_area_prefix_sum_
+  std::vector<std::pair<GridBinIndex, GridBinIndex>> changed_windows_;
+
+  void BuildPrefixSum(
+      std::vector<unsigned long long> &prefix_sum,
+      unsigned long long GridBin::*attribute
+  );
+  unsigned long long WindowSum(
+      std::vector<unsigned long long> const &prefix_sum,
+      GridBinIndex const &ll,
+      GridBinIndex const &ur
+  ) const;
+};
+
 }
 
 #endif //DALI_PLACER_GLOBAL_PLACER_GRID_BIN_H_
@@ -24,6 +24,7 @@
 #include <cfloat>
 
 #include "dali/common/elapsed_time.h"
+#include "dali/common/profiler.h"
 #include "dali/common/logging.h"
 
 namespace dali {
@@ -52,6 +53,49 @@ void B2BHpwlOptimizer::UpdateEpsilon() {
   height_epsilon_ = ckt_ptr_->AveMovBlkHeight() * epsilon_factor_;
 }
 
+/****
+ * @brief Create linear solvers for x and y using the selected backend
+ */
+void B2BHpwlOptimizer::InitializeLinearSolvers() {
+  BOOST_LOG_TRIVIAL(info)
+    << "Linear solver: " << LinearSolverTypeStr(linear_solver_type_) << "\n";
+  solver_x_ = CreateLinearSolver(linear_solver_type_);
+  solver_x_->SetMaxIterations(cg_iteration_);
+  solver_x_->SetTolerance(cg_tolerance_);
+  solver_y_ = CreateLinearSolver(linear_solver_type_);
+  solver_y_->SetMaxIterations(cg_iteration_);
+  solver_y_->SetTolerance(cg_tolerance_);
+}
+
+/****
+ * @brief Move block locations to the contiguous store of the circuit, and let
+ * vx and vy be views of it. Linear solvers then update block locations in
+ * place, and no copy between vx/vy and blocks is needed. Locations move back
+ * to blocks when this optimizer is closed or destroyed.
+ */
+void B2BHpwlOptimizer::MapBlockLocations() {
+  loc_binding_.reset();
+  loc_binding_ = ckt_ptr_->BindBlockLocStore();
+  BlockLocStore &loc_store = loc_binding_->Store();
+  EgId eigen_sz = static_cast<EgId>(loc_store.BlkCnt());
+  new(&vx) Eigen::Map<Eigen::VectorXd>(loc_store.LLXs().data(), eigen_sz);
+  new(&vy) Eigen::Map<Eigen::VectorXd>(loc_store.LLYs().data(), eigen_sz);
+}
+
+/****
+ * @brief Initialize the engine evaluating the weighted HPWL in the inner loop
+ * of the linear solver. A block moving less than a small fraction of the
+ * average movable cell size does not trigger the update of its nets.
+ */
+void B2BHpwlOptimizer::InitializeIncrementalHpwl() {
+  ckt_ptr_->UpdatePinTable();
+  incremental_hpwl_.Initialize(ckt_ptr_);
+  incremental_hpwl_.SetMoveThresholds(
+      ckt_ptr_->AveMovBlkWidth() * hpwl_move_threshold_factor_,
+      ckt_ptr_->AveMovBlkHeight() * hpwl_move_threshold_factor_
+  );
+}
+
 /****
  * @brief Initialize variables for the conjugate gradient linear solver
  */
@@ -71,21 +115,18 @@ void B2BHpwlOptimizer::Initialize() {
   Ax_row_size.assign(sz, 0);
 
   EgId eigen_sz = static_cast<EgId>(ckt_ptr_->Blocks().size());
-  vx.resize(eigen_sz);
-  vy.resize(eigen_sz);
+  MapBlockLocations();
   bx.resize(eigen_sz);
   by.resize(eigen_sz);
   Ax.resize(eigen_sz, eigen_sz);
   Ay.resize(eigen_sz, eigen_sz);
   x_anchor.resize(eigen_sz);
   y_anchor.resize(eigen_sz);
-  x_anchor_weight.resize(eigen_sz);
-  y_anchor_weight.resize(eigen_sz);
+  x_anchor_weight.setOnes(eigen_sz);
+  y_anchor_weight.setOnes(eigen_sz);
 
-  cg_x_.setMaxIterations(cg_iteration_);
-  cg_x_.setTolerance(cg_tolerance_);
-  cg_y_.setMaxIterations(cg_iteration_);
-  cg_y_.setTolerance(cg_tolerance_);
+  InitializeLinearSolvers();
+  InitializeIncrementalHpwl();
 
   size_t coefficient_size = 0;
   auto &nets = ckt_ptr_->Nets();
@@ -104,6 +145,21 @@ void B2BHpwlOptimizer::Initialize() {
   Ax.reserve(static_cast<EgId>(coefficient_size));
   coefficients_y_.reserve(coefficient_size);
   Ay.reserve(static_cast<EgId>(coefficient_size));
+
+  // each net owns a group of entries in the matrix, whose positions are reused
+  // as long as the max and min pins of this net do not change
+  std::vector<int> capacities(nets.size(), 0);
+  for (size_t i = 0; i < nets.size(); ++i) {
+    size_t net_sz = nets[i].PinCnt();
+    if (net_sz > 1 && net_sz < net_ignore_threshold_) {
+      capacities[i] = static_cast<int>((2 * (net_sz - 2) + 1) * 4);
+    }
+  }
+  int eigen_sz_int = static_cast<int>(eigen_sz);
+  assembler_x_.Initialize(eigen_sz_int, 1);
+  assembler_x_.InitializeGroups(capacities);
+  assembler_y_.Initialize(eigen_sz_int, 1);
+  assembler_y_.InitializeGroups(capacities);
 }
 
 void B2BHpwlOptimizer::BuildProblemX() {
@@ -115,84 +171,107 @@ void B2BHpwlOptimizer::BuildProblemX() {
   size_t coefficients_capacity = coefficients_x_.capacity();
   coefficients_x_.resize(0);
   int sz = static_cast<int>(bx.size());
-  for (int i = 0; i < sz; ++i) {
-    bx[i] = 0;
-  }
 
   double center_weight = 0.03 / std::sqrt(sz);
   double weight_center_x =
       (ckt_ptr_->RegionLLX() + ckt_ptr_->RegionURX()) / 2.0 * center_weight;
   //double decay_length = decay_factor * ckt_ptr_->AveBlkHeight();
 
-  for (auto &net : nets) {
-    if (net.PinCnt() <= 1 || net.PinCnt() >= net_ignore_threshold_) continue;
-    double inv_p = net.InvP();
-    net.UpdateMaxMinIdX();
-    int max_pin_index = net.MaxBlkPinIdX();
-    int min_pin_index = net.MinBlkPinIdX();
-
-    int blk_num_max = net.BlockPins()[max_pin_index].BlkId();
-    double pin_loc_max = net.BlockPins()[max_pin_index].AbsX();
-    bool is_movable_max = net.BlockPins()[max_pin_index].BlkPtr()->IsMovable();
-    double offset_max = net.BlockPins()[max_pin_index].OffsetX();
-
-    int blk_num_min = net.BlockPins()[min_pin_index].BlkId();
-    double pin_loc_min = net.BlockPins()[min_pin_index].AbsX();
-    bool is_movable_min = net.BlockPins()[min_pin_index].BlkPtr()->IsMovable();
-    double offset_min = net.BlockPins()[min_pin_index].OffsetX();
-
-    for (auto &pair : net.BlockPins()) {
-      int blk_num = pair.BlkId();
-      double pin_loc = pair.AbsX();
-      bool is_movable = pair.BlkPtr()->IsMovable();
-      double offset = pair.OffsetX();
+  // each chunk of nets has its own buffers, which are merged in chunk order
+  int num_chunks = num_threads_x_;
+  PartitionNets(num_chunks, net_chunk_bounds_x_);
+  assembler_x_.Initialize(sz, num_chunks);
+  NetPinTable const &pin_table = ckt_ptr_->PinTable();
+#pragma omp parallel num_threads(num_chunks) default(none) shared(nets, blocks, pin_table, num_chunks)
+  {
+    int num_threads = omp_get_num_threads();
+    for (int chunk = omp_get_thread_num(); chunk < num_chunks;
+         chunk += num_threads) {
+      for (size_t net_id = net_chunk_bounds_x_[chunk];
+           net_id < net_chunk_bounds_x_[chunk + 1]; ++net_id) {
+        Net &net = nets[net_id];
+        if (net.PinCnt() <= 1 || net.PinCnt() >= net_ignore_threshold_) continue;
+        double inv_p = net.InvP();
+        net.UpdateMaxMinIdX(pin_table);
+        int max_pin_index = net.MaxBlkPinIdX();
+        int min_pin_index = net.MinBlkPinIdX();
+        int pin_begin = pin_table.NetPinBegin(static_cast<int>(net_id));
+        int pin_end = pin_table.NetPinEnd(static_cast<int>(net_id));
+
+        int blk_num_max = pin_table.PinBlkId(pin_begin + max_pin_index);
+        double offset_max = pin_table.PinOffsetX(pin_begin + max_pin_index);
+        double pin_loc_max = offset_max + blocks[blk_num_max].LLX();
+        bool is_movable_max = blocks[blk_num_max].IsMovable();
+
+        int blk_num_min = pin_table.PinBlkId(pin_begin + min_pin_index);
+        double offset_min = pin_table.PinOffsetX(pin_begin + min_pin_index);
+        double pin_loc_min = offset_min + blocks[blk_num_min].LLX();
+        bool is_movable_min = blocks[blk_num_min].IsMovable();
+        assembler_x_.BeginGroup(
+            chunk,
+            static_cast<int>(net_id),
+            max_pin_index,
+            min_pin_index
+        );
 
-      if (blk_num != blk_num_max) {
-        double distance = std::fabs(pin_loc - pin_loc_max);
-        double weight = inv_p / (distance + width_epsilon_);
-        //weight_adjust = base_factor + adjust_factor * (1 - exp(-distance / decay_length));
-        //weight *= weight_adjust;
-        if (!is_movable && is_movable_max) {
-          bx[blk_num_max] += (pin_loc - offset_max) * weight;
-          coefficients_x_.emplace_back(blk_num_max, blk_num_max, weight);
-        } else if (is_movable && !is_movable_max) {
-          bx[blk_num] += (pin_loc_max - offset) * weight;
-          coefficients_x_.emplace_back(blk_num, blk_num, weight);
-        } else if (is_movable && is_movable_max) {
-          coefficients_x_.emplace_back(blk_num, blk_num, weight);
-          coefficients_x_.emplace_back(blk_num_max, blk_num_max, weight);
-          coefficients_x_.emplace_back(blk_num, blk_num_max, -weight);
-          coefficients_x_.emplace_back(blk_num_max, blk_num, -weight);
-          double offset_diff = (offset_max - offset) * weight;
-          bx[blk_num] += offset_diff;
-          bx[blk_num_max] -= offset_diff;
-        }
-      }
+        for (int pin = pin_begin; pin < pin_end; ++pin) {
+          int blk_num = pin_table.PinBlkId(pin);
+          double offset = pin_table.PinOffsetX(pin);
+          double pin_loc = offset + blocks[blk_num].LLX();
+          bool is_movable = blocks[blk_num].IsMovable();
+
+          if (blk_num != blk_num_max) {
+            double distance = std::fabs(pin_loc - pin_loc_max);
+            double weight = inv_p / (distance + width_epsilon_);
+            //weight_adjust = base_factor + adjust_factor * (1 - exp(-distance / decay_length));
+            //weight *= weight_adjust;
+            if (!is_movable && is_movable_max) {
+              assembler_x_.AddRhs(chunk, blk_num_max, (pin_loc - offset_max) * weight);
+              assembler_x_.AddCoefficient(chunk, blk_num_max, blk_num_max, weight);
+            } else if (is_movable && !is_movable_max) {
+              assembler_x_.AddRhs(chunk, blk_num, (pin_loc_max - offset) * weight);
+              assembler_x_.AddCoefficient(chunk, blk_num, blk_num, weight);
+            } else if (is_movable && is_movable_max) {
+              assembler_x_.AddCoefficient(chunk, blk_num, blk_num, weight);
+              assembler_x_.AddCoefficient(chunk, blk_num_max, blk_num_max, weight);
+              assembler_x_.AddCoefficient(chunk, blk_num, blk_num_max, -weight);
+              assembler_x_.AddCoefficient(chunk, blk_num_max, blk_num, -weight);
+              double offset_diff = (offset_max - offset) * weight;
+              assembler_x_.AddRhs(chunk, blk_num, offset_diff);
+              assembler_x_.AddRhs(chunk, blk_num_max, -offset_diff);
+            }
+          }
 
-      if ((blk_num != blk_num_max) && (blk_num != blk_num_min)) {
-        double distance = std::fabs(pin_loc - pin_loc_min);
-        double weight = inv_p / (distance + width_epsilon_);
-        //weight_adjust = adjust_factor * (1 - exp(-distance / decay_length));
-        //weight *= weight_adjust;
-        if (!is_movable && is_movable_min) {
-          bx[blk_num_min] += (pin_loc - offset_min) * weight;
-          coefficients_x_.emplace_back(blk_num_min, blk_num_min, weight);
-        } else if (is_movable && !is_movable_min) {
-          bx[blk_num] += (pin_loc_min - offset) * weight;
-          coefficients_x_.emplace_back(blk_num, blk_num, weight);
-        } else if (is_movable && is_movable_min) {
-          coefficients_x_.emplace_back(blk_num, blk_num, weight);
-          coefficients_x_.emplace_back(blk_num_min, blk_num_min, weight);
-          coefficients_x_.emplace_back(blk_num, blk_num_min, -weight);
-          coefficients_x_.emplace_back(blk_num_min, blk_num, -weight);
-          double offset_diff = (offset_min - offset) * weight;
-          bx[blk_num] += offset_diff;
-          bx[blk_num_min] -= offset_diff;
+          if ((blk_num != blk_num_max) && (blk_num != blk_num_min)) {
+            double distance = std::fabs(pin_loc - pin_loc_min);
+            double weight = inv_p / (distance + width_epsilon_);
+            //weight_adjust = adjust_factor * (1 - exp(-distance / decay_length));
+            //weight *= weight_adjust;
+            if (!is_movable && is_movable_min) {
+              assembler_x_.AddRhs(chunk, blk_num_min, (pin_loc - offset_min) * weight);
+              assembler_x_.AddCoefficient(chunk, blk_num_min, blk_num_min, weight);
+            } else if (is_movable && !is_movable_min) {
+              assembler_x_.AddRhs(chunk, blk_num, (pin_loc_min - offset) * weight);
+              assembler_x_.AddCoefficient(chunk, blk_num, blk_num, weight);
+            } else if (is_movable && is_movable_min) {
+              assembler_x_.AddCoefficient(chunk, blk_num, blk_num, weight);
+              assembler_x_.AddCoefficient(chunk, blk_num_min, blk_num_min, weight);
+              assembler_x_.AddCoefficient(chunk, blk_num, blk_num_min, -weight);
+              assembler_x_.AddCoefficient(chunk, blk_num_min, blk_num, -weight);
+              double offset_diff = (offset_min - offset) * weight;
+              assembler_x_.AddRhs(chunk, blk_num, offset_diff);
+              assembler_x_.AddRhs(chunk, blk_num_min, -offset_diff);
+            }
+          }
         }
+        assembler_x_.EndGroup(chunk);
       }
     }
   }
+  assembler_x_.MergeRhs(bx);
 
+  // entries below are appended after all net entries, the matrix itself is
+  // merged right before solving because anchors may still be added
   for (int i = 0; i < sz; ++i) {
     if (blocks[i].IsFixed()) {
       coefficients_x_.emplace_back(i, i, 1);
@@ -226,85 +305,107 @@ void B2BHpwlOptimizer::BuildProblemY() {
   size_t coefficients_capacity = coefficients_y_.capacity();
   coefficients_y_.resize(0);
   int sz = static_cast<int>(by.size());
-  for (int i = 0; i < sz; ++i) {
-    by[i] = 0;
-  }
 
   double center_weight = 0.03 / std::sqrt(sz);
   double weight_center_y =
       (ckt_ptr_->RegionLLY() + ckt_ptr_->RegionURY()) / 2.0 * center_weight;
   //double decay_length = decay_factor * ckt_ptr_->AveBlkHeight();
 
-  for (auto &net : nets) {
-    if (net.PinCnt() <= 1 || net.PinCnt() >= net_ignore_threshold_) continue;
-    double inv_p = net.InvP();
-    net.UpdateMaxMinIdY();
-    int max_pin_index = net.MaxBlkPinIdY();
-    int min_pin_index = net.MinBlkPinIdY();
-
-    int blk_num_max = net.BlockPins()[max_pin_index].BlkId();
-    double pin_loc_max = net.BlockPins()[max_pin_index].AbsY();
-    bool is_movable_max = net.BlockPins()[max_pin_index].BlkPtr()->IsMovable();
-    double offset_max = net.BlockPins()[max_pin_index].OffsetY();
-
-    int blk_num_min = net.BlockPins()[min_pin_index].BlkId();
-    double pin_loc_min = net.BlockPins()[min_pin_index].AbsY();
-    bool is_movable_min = net.BlockPins()[min_pin_index].BlkPtr()->IsMovable();
-    double offset_min = net.BlockPins()[min_pin_index].OffsetY();
-
-    for (auto &pair : net.BlockPins()) {
-      int blk_num = pair.BlkId();
-      double pin_loc = pair.AbsY();
-      bool is_movable = pair.BlkPtr()->IsMovable();
-      double offset = pair.OffsetY();
+  // each chunk of nets has its own buffers, which are merged in chunk order
+  int num_chunks = num_threads_y_;
+  PartitionNets(num_chunks, net_chunk_bounds_y_);
+  assembler_y_.Initialize(sz, num_chunks);
+  NetPinTable const &pin_table = ckt_ptr_->PinTable();
+#pragma omp parallel num_threads(num_chunks) default(none) shared(nets, blocks, pin_table, num_chunks)
+  {
+    int num_threads = omp_get_num_threads();
+    for (int chunk = omp_get_thread_num(); chunk < num_chunks;
+         chunk += num_threads) {
+      for (size_t net_id = net_chunk_bounds_y_[chunk];
+           net_id < net_chunk_bounds_y_[chunk + 1]; ++net_id) {
+        Net &net = nets[net_id];
+        if (net.PinCnt() <= 1 || net.PinCnt() >= net_ignore_threshold_) continue;
+        double inv_p = net.InvP();
+        net.UpdateMaxMinIdY(pin_table);
+        int max_pin_index = net.MaxBlkPinIdY();
+        int min_pin_index = net.MinBlkPinIdY();
+        int pin_begin = pin_table.NetPinBegin(static_cast<int>(net_id));
+        int pin_end = pin_table.NetPinEnd(static_cast<int>(net_id));
+
+        int blk_num_max = pin_table.PinBlkId(pin_begin + max_pin_index);
+        double offset_max = pin_table.PinOffsetY(pin_begin + max_pin_index);
+        double pin_loc_max = offset_max + blocks[blk_num_max].LLY();
+        bool is_movable_max = blocks[blk_num_max].IsMovable();
+
+        int blk_num_min = pin_table.PinBlkId(pin_begin + min_pin_index);
+        double offset_min = pin_table.PinOffsetY(pin_begin + min_pin_index);
+        double pin_loc_min = offset_min + blocks[blk_num_min].LLY();
+        bool is_movable_min = blocks[blk_num_min].IsMovable();
+        assembler_y_.BeginGroup(
+            chunk,
+            static_cast<int>(net_id),
+            max_pin_index,
+            min_pin_index
+        );
 
-      if (blk_num != blk_num_max) {
-        double distance = std::fabs(pin_loc - pin_loc_max);
-        double weight = inv_p / (distance + height_epsilon_);
-        //weight_adjust = base_factor + adjust_factor * (1 - exp(-distance / decay_length));
-        //weight *= weight_adjust;
-        if (!is_movable && is_movable_max) {
-          by[blk_num_max] += (pin_loc - offset_max) * weight;
-          coefficients_y_.emplace_back(blk_num_max, blk_num_max, weight);
-        } else if (is_movable && !is_movable_max) {
-          by[blk_num] += (pin_loc_max - offset) * weight;
-          coefficients_y_.emplace_back(blk_num, blk_num, weight);
-        } else if (is_movable && is_movable_max) {
-          coefficients_y_.emplace_back(blk_num, blk_num, weight);
-          coefficients_y_.emplace_back(blk_num_max, blk_num_max, weight);
-          coefficients_y_.emplace_back(blk_num, blk_num_max, -weight);
-          coefficients_y_.emplace_back(blk_num_max, blk_num, -weight);
-          double offset_diff = (offset_max - offset) * weight;
-          by[blk_num] += offset_diff;
-          by[blk_num_max] -= offset_diff;
-        }
-      }
+        for (int pin = pin_begin; pin < pin_end; ++pin) {
+          int blk_num = pin_table.PinBlkId(pin);
+          double offset = pin_table.PinOffsetY(pin);
+          double pin_loc = offset + blocks[blk_num].LLY();
+          bool is_movable = blocks[blk_num].IsMovable();
+
+          if (blk_num != blk_num_max) {
+            double distance = std::fabs(pin_loc - pin_loc_max);
+            double weight = inv_p / (distance + height_epsilon_);
+            //weight_adjust = base_factor + adjust_factor * (1 - exp(-distance / decay_length));
+            //weight *= weight_adjust;
+            if (!is_movable && is_movable_max) {
+              assembler_y_.AddRhs(chunk, blk_num_max, (pin_loc - offset_max) * weight);
+              assembler_y_.AddCoefficient(chunk, blk_num_max, blk_num_max, weight);
+            } else if (is_movable && !is_movable_max) {
+              assembler_y_.AddRhs(chunk, blk_num, (pin_loc_max - offset) * weight);
+              assembler_y_.AddCoefficient(chunk, blk_num, blk_num, weight);
+            } else if (is_movable && is_movable_max) {
+              assembler_y_.AddCoefficient(chunk, blk_num, blk_num, weight);
+              assembler_y_.AddCoefficient(chunk, blk_num_max, blk_num_max, weight);
+              assembler_y_.AddCoefficient(chunk, blk_num, blk_num_max, -weight);
+              assembler_y_.AddCoefficient(chunk, blk_num_max, blk_num, -weight);
+              double offset_diff = (offset_max - offset) * weight;
+              assembler_y_.AddRhs(chunk, blk_num, offset_diff);
+              assembler_y_.AddRhs(chunk, blk_num_max, -offset_diff);
+            }
+          }
 
-      if ((blk_num != blk_num_max) && (blk_num != blk_num_min)) {
-        double distance = std::fabs(pin_loc - pin_loc_min);
-        double weight = inv_p / (distance + height_epsilon_);
-        //weight_adjust = adjust_factor * (1 - exp(-distance / decay_length));
-        //weight *= weight_adjust;
-        if (!is_movable && is_movable_min) {
-          by[blk_num_min] += (pin_loc - offset_min) * weight;
-          coefficients_y_.emplace_back(blk_num_min, blk_num_min, weight);
-        } else if (is_movable && !is_movable_min) {
-          by[blk_num] += (pin_loc_min - offset) * weight;
-          coefficients_y_.emplace_back(blk_num, blk_num, weight);
-        } else if (is_movable && is_movable_min) {
-          coefficients_y_.emplace_back(blk_num, blk_num, weight);
-          coefficients_y_.emplace_back(blk_num_min, blk_num_min, weight);
-          coefficients_y_.emplace_back(blk_num, blk_num_min, -weight);
-          coefficients_y_.emplace_back(blk_num_min, blk_num, -weight);
-          double offset_diff = (offset_min - offset) * weight;
-          by[blk_num] += offset_diff;
-          by[blk_num_min] -= offset_diff;
+          if ((blk_num != blk_num_max) && (blk_num != blk_num_min)) {
+            double distance = std::fabs(pin_loc - pin_loc_min);
+            double weight = inv_p / (distance + height_epsilon_);
+            //weight_adjust = adjust_factor * (1 - exp(-distance / decay_length));
+            //weight *= weight_adjust;
+            if (!is_movable && is_movable_min) {
+              assembler_y_.AddRhs(chunk, blk_num_min, (pin_loc - offset_min) * weight);
+              assembler_y_.AddCoefficient(chunk, blk_num_min, blk_num_min, weight);
+            } else if (is_movable && !is_movable_min) {
+              assembler_y_.AddRhs(chunk, blk_num, (pin_loc_min - offset) * weight);
+              assembler_y_.AddCoefficient(chunk, blk_num, blk_num, weight);
+            } else if (is_movable && is_movable_min) {
+              assembler_y_.AddCoefficient(chunk, blk_num, blk_num, weight);
+              assembler_y_.AddCoefficient(chunk, blk_num_min, blk_num_min, weight);
+              assembler_y_.AddCoefficient(chunk, blk_num, blk_num_min, -weight);
+              assembler_y_.AddCoefficient(chunk, blk_num_min, blk_num, -weight);
+              double offset_diff = (offset_min - offset) * weight;
+              assembler_y_.AddRhs(chunk, blk_num, offset_diff);
+              assembler_y_.AddRhs(chunk, blk_num_min, -offset_diff);
+            }
+          }
         }
+        assembler_y_.EndGroup(chunk);
       }
-
     }
   }
-  // add the diagonal non-zero element for fixed blocks
+  assembler_y_.MergeRhs(by);
+
+  // entries below are appended after all net entries, the matrix itself is
+  // merged right before solving because anchors may still be added
   for (int i = 0; i < sz; ++i) {
     if (blocks[i].IsFixed()) {
       coefficients_y_.emplace_back(i, i, 1);
@@ -388,27 +489,40 @@ bool B2BHpwlOptimizer::IsSeriesOscillate(
   return is_oscillate;
 }
 
-double B2BHpwlOptimizer::OptimizeQuadraticMetricX(double cg_stop_criterion) {
+/****
+ * @brief Merge buffered coefficients into Ax.
+ *
+ * @return true if the sparsity pattern of Ax is different from last time
+ */
+bool B2BHpwlOptimizer::MergeProblemX() {
   ElapsedTime elapsed_time;
   elapsed_time.RecordStartTime();
-  Ax.setFromTriplets(coefficients_x_.begin(), coefficients_x_.end());
+  assembler_x_.MergeMatrix(coefficients_x_, Ax);
+  ++tot_matrix_merge_cnt_x;
+  if (assembler_x_.IsLastMergeRebuild()) {
+    ++tot_matrix_rebuild_cnt_x;
+  }
+  if (assembler_x_.IsLastMergePatch()) {
+    ++tot_matrix_patch_cnt_x;
+  }
   elapsed_time.RecordEndTime();
   tot_matrix_from_triplets_x += elapsed_time.GetWallTime();
+  return assembler_x_.IsLastMergeRebuild()
+      || assembler_x_.IsLastMergePatch();
+}
 
-  int sz = static_cast<int>(vx.size());
-  std::vector<Block> &blocks = ckt_ptr_->Blocks();
+double B2BHpwlOptimizer::OptimizeQuadraticMetricX(double cg_stop_criterion) {
+  bool is_structure_changed = MergeProblemX();
+  ElapsedTime elapsed_time;
 
   elapsed_time.RecordStartTime();
   std::vector<double> eval_history;
   int max_rounds = cg_iteration_max_num_ / cg_iteration_;
-  cg_x_.compute(Ax); // Ax * vx = bx
+  solver_x_->Compute(Ax, is_structure_changed); // Ax * vx = bx
   for (int i = 0; i < max_rounds; ++i) {
-    vx = cg_x_.solveWithGuess(bx, vx);
-//#pragma omp for
-    for (int num = 0; num < sz; ++num) {
-      blocks[num].SetLLX(vx[num]);
-    }
-    double evaluate_result = ckt_ptr_->WeightedHPWLX();
+    // vx is a view of block locations, so blocks are updated in place
+    solver_x_->SolveWithGuess(bx, vx);
+    double evaluate_result = incremental_hpwl_.WeightedHPWLX(num_threads_x_);
     eval_history.push_back(evaluate_result);
     //BOOST_LOG_TRIVIAL(info)  <<"  %d WeightedHPWLX: %e\n", i, evaluate_result);
     if (eval_history.size() >= 3) {
@@ -428,14 +542,6 @@ double B2BHpwlOptimizer::OptimizeQuadraticMetricX(double cg_stop_criterion) {
   elapsed_time.RecordEndTime();
   tot_cg_solver_time_x += elapsed_time.GetWallTime();
 
-  elapsed_time.RecordStartTime();
-//#pragma omp for
-  for (int num = 0; num < sz; ++num) {
-    blocks[num].SetLLX(vx[num]);
-  }
-  elapsed_time.RecordEndTime();
-  tot_loc_update_time_x += elapsed_time.GetWallTime();
-
   DaliExpects(
       !eval_history.empty(),
       "Cannot return a valid value because the result is not evaluated!"
@@ -443,27 +549,40 @@ double B2BHpwlOptimizer::OptimizeQuadraticMetricX(double cg_stop_criterion) {
   return eval_history.back();
 }
 
-double B2BHpwlOptimizer::OptimizeQuadraticMetricY(double cg_stop_criterion) {
+/****
+ * @brief Merge buffered coefficients into Ay.
+ *
+ * @return true if the sparsity pattern of Ay is different from last time
+ */
+bool B2BHpwlOptimizer::MergeProblemY() {
   ElapsedTime elapsed_time;
   elapsed_time.RecordStartTime();
-  Ay.setFromTriplets(coefficients_y_.begin(), coefficients_y_.end());
+  assembler_y_.MergeMatrix(coefficients_y_, Ay);
+  ++tot_matrix_merge_cnt_y;
+  if (assembler_y_.IsLastMergeRebuild()) {
+    ++tot_matrix_rebuild_cnt_y;
+  }
+  if (assembler_y_.IsLastMergePatch()) {
+    ++tot_matrix_patch_cnt_y;
+  }
   elapsed_time.RecordEndTime();
   tot_matrix_from_triplets_y += elapsed_time.GetWallTime();
+  return assembler_y_.IsLastMergeRebuild()
+      || assembler_y_.IsLastMergePatch();
+}
 
-  int sz = static_cast<int>(vy.size());
-  std::vector<Block> &block_list = ckt_ptr_->Blocks();
+double B2BHpwlOptimizer::OptimizeQuadraticMetricY(double cg_stop_criterion) {
+  bool is_structure_changed = MergeProblemY();
+  ElapsedTime elapsed_time;
 
   elapsed_time.RecordStartTime();
   std::vector<double> eval_history;
   int max_rounds = cg_iteration_max_num_ / cg_iteration_;
-  cg_y_.compute(Ay);
+  solver_y_->Compute(Ay, is_structure_changed);
   for (int i = 0; i < max_rounds; ++i) {
-    vy = cg_y_.solveWithGuess(by, vy);
-//#pragma omp for
-    for (int num = 0; num < sz; ++num) {
-      block_list[num].SetLLY(vy[num]);
-    }
-    double evaluate_result = ckt_ptr_->WeightedHPWLY();
+    // vy is a view of block locations, so blocks are updated in place
+    solver_y_->SolveWithGuess(by, vy);
+    double evaluate_result = incremental_hpwl_.WeightedHPWLY(num_threads_y_);
     eval_history.push_back(evaluate_result);
     //BOOST_LOG_TRIVIAL(info)  <<"  %d WeightedHPWLY: %e\n", i, evaluate_result);
     if (eval_history.size() >= 3) {
@@ -483,17 +602,93 @@ double B2BHpwlOptimizer::OptimizeQuadraticMetricY(double cg_stop_criterion) {
   elapsed_time.RecordEndTime();
   tot_cg_solver_time_y += elapsed_time.GetWallTime();
 
+  DaliExpects(!eval_history.empty(),
+              "Cannot return a valid value because the result is not evaluated!");
+  return eval_history.back();
+}
+
+/****
+ * @brief Solve the quadratic problems in x and y together. The stopping rule
+ * of each direction is the same as OptimizeQuadraticMetricX/Y(), and a
+ * direction drops out of the fused solve once it stops.
+ *
+ * @param cg_stop_criterion: stop criterion of the weighted HPWL sequence
+ * @param is_x_active: whether the problem in x is solved
+ * @param is_y_active: whether the problem in y is solved
+ * @param evaluate_result_x: the weighted HPWL in x after solving
+ * @param evaluate_result_y: the weighted HPWL in y after solving
+ */
+void B2BHpwlOptimizer::OptimizeQuadraticMetricXY(
+    double cg_stop_criterion,
+    bool is_x_active,
+    bool is_y_active,
+    double &evaluate_result_x,
+    double &evaluate_result_y
+) {
+  auto *pcg_x = dynamic_cast<PcgSolver *>(solver_x_.get());
+  auto *pcg_y = dynamic_cast<PcgSolver *>(solver_y_.get());
+  DaliExpects(
+      pcg_x != nullptr && pcg_y != nullptr,
+      "The fused solve requires PcgSolver for both x and y"
+  );
+  if (is_x_active) {
+    pcg_x->Compute(Ax, MergeProblemX()); // Ax * vx = bx
+  }
+  if (is_y_active) {
+    pcg_y->Compute(Ay, MergeProblemY()); // Ay * vy = by
+  }
+
+  ElapsedTime elapsed_time;
   elapsed_time.RecordStartTime();
-//#pragma omp for
-  for (int num = 0; num < sz; ++num) {
-    block_list[num].SetLLY(vy[num]);
+  std::vector<double> eval_history_x;
+  std::vector<double> eval_history_y;
+  auto is_solve_stopped = [&](std::vector<double> &eval_history) {
+    if (eval_history.size() < 3) return false;
+    bool is_converge = IsSeriesConverge(eval_history, 3, cg_stop_criterion);
+    bool is_oscillate = IsSeriesOscillate(eval_history, 5);
+    if (is_oscillate && !is_converge) {
+      BOOST_LOG_TRIVIAL(trace) << "oscillation detected\n";
+    }
+    return is_converge || is_oscillate;
+  };
+  int max_rounds = cg_iteration_max_num_ / cg_iteration_;
+  for (int i = 0; i < max_rounds && (is_x_active || is_y_active); ++i) {
+    std::vector<PcgSolver *> solvers;
+    std::vector<Eigen::VectorXd const *> bs;
+    std::vector<Eigen::Ref<Eigen::VectorXd>> xs;
+    if (is_x_active) {
+      solvers.push_back(pcg_x);
+      bs.push_back(&bx);
+      xs.emplace_back(vx);
+    }
+    if (is_y_active) {
+      solvers.push_back(pcg_y);
+      bs.push_back(&by);
+      xs.emplace_back(vy);
+    }
+    PcgSolver::SolveWithGuess(solvers, bs, xs, num_threads_);
+
+    if (is_x_active) {
+      eval_history_x.push_back(incremental_hpwl_.WeightedHPWLX(num_threads_));
+      is_x_active = !is_solve_stopped(eval_history_x);
+    }
+    if (is_y_active) {
+      eval_history_y.push_back(incremental_hpwl_.WeightedHPWLY(num_threads_));
+      is_y_active = !is_solve_stopped(eval_history_y);
+    }
   }
+  BOOST_LOG_TRIVIAL(trace)
+    << "      Metric optimization in XY, sequence: "
+    << eval_history_x << ", " << eval_history_y << "\n";
   elapsed_time.RecordEndTime();
-  tot_loc_update_time_y += elapsed_time.GetWallTime();
+  tot_cg_solver_time_xy += elapsed_time.GetWallTime();
 
-  DaliExpects(!eval_history.empty(),
-              "Cannot return a valid value because the result is not evaluated!");
-  return eval_history.back();
+  if (!eval_history_x.empty()) {
+    evaluate_result_x = eval_history_x.back();
+  }
+  if (!eval_history_y.empty()) {
+    evaluate_result_y = eval_history_y.back();
+  }
 }
 
 void B2BHpwlOptimizer::PullBlockBackToRegion() {
@@ -503,49 +698,38 @@ void B2BHpwlOptimizer::PullBlockBackToRegion() {
   double region_urx = ckt_ptr_->RegionURX();
   double region_lly = ckt_ptr_->RegionLLY();
   double region_ury = ckt_ptr_->RegionURY();
-#pragma omp parallel num_threads(omp_get_max_threads()) default(none) shared(block_list, sz, region_llx, region_urx, region_lly, region_ury)
-  {
-#pragma omp for
-    for (int i = 0; i < sz; ++i) {
-      if (block_list[i].IsMovable()) {
-        if (vx[i] < region_llx) {
-          vx[i] = region_llx;
-        }
-        double blk_hi_bound_x = region_urx - block_list[i].Width();
-        if (vx[i] > blk_hi_bound_x) {
-          vx[i] = blk_hi_bound_x;
-        }
-
-        if (vy[i] < region_lly) {
-          vy[i] = region_lly;
-        }
-        double blk_hi_bound_y = region_ury - block_list[i].Height();
-        if (vy[i] > blk_hi_bound_y) {
-          vy[i] = blk_hi_bound_y;
-        }
+  // vx and vy are views of block locations, so blocks are clamped in place
+#pragma omp parallel for num_threads(omp_get_max_threads()) default(none) shared(block_list, sz, region_llx, region_urx, region_lly, region_ury)
+  for (int i = 0; i < sz; ++i) {
+    if (block_list[i].IsMovable()) {
+      if (vx[i] < region_llx) {
+        vx[i] = region_llx;
+      }
+      double blk_hi_bound_x = region_urx - block_list[i].Width();
+      if (vx[i] > blk_hi_bound_x) {
+        vx[i] = blk_hi_bound_x;
       }
-    }
 
-#pragma omp for
-    for (int i = 0; i < sz; ++i) {
-      block_list[i].SetLoc(vx[i], vy[i]);
+      if (vy[i] < region_lly) {
+        vy[i] = region_lly;
+      }
+      double blk_hi_bound_y = region_ury - block_list[i].Height();
+      if (vy[i] > blk_hi_bound_y) {
+        vy[i] = blk_hi_bound_y;
+      }
     }
   }
 }
 
 void B2BHpwlOptimizer::UpdateAnchorLocation() {
   if (cur_iter_ == 0) return;
-  std::vector<Block> &block_list = ckt_ptr_->Blocks();
-  int sz = static_cast<int>(block_list.size());
-
-  for (int i = 0; i < sz; ++i) {
-    double tmp_loc_x = x_anchor[i];
-    x_anchor[i] = block_list[i].LLX();
-    block_list[i].SetLLX(tmp_loc_x);
-
-    double tmp_loc_y = y_anchor[i];
-    y_anchor[i] = block_list[i].LLY();
-    block_list[i].SetLLY(tmp_loc_y);
+  // vx and vy are views of block locations
+  vx.swap(x_anchor);
+  vy.swap(y_anchor);
+  size_t pinned_cnt = pinned_anchor_blk_ids_.size();
+  for (size_t k = 0; k < pinned_cnt; ++k) {
+    x_anchor[pinned_anchor_blk_ids_[k]] = pinned_anchor_x_[k];
+    y_anchor[pinned_anchor_blk_ids_[k]] = pinned_anchor_y_[k];
   }
 
   x_anchor_set = true;
@@ -571,8 +755,9 @@ void B2BHpwlOptimizer::UpdateMaxMinX() {
   std::vector<Net> &net_list = ckt_ptr_->Nets();
   size_t sz = net_list.size();
 //#pragma omp parallel for
+  NetPinTable const &pin_table = ckt_ptr_->PinTable();
   for (size_t i = 0; i < sz; ++i) {
-    net_list[i].UpdateMaxMinIdX();
+    net_list[i].UpdateMaxMinIdX(pin_table);
   }
 }
 
@@ -580,8 +765,9 @@ void B2BHpwlOptimizer::UpdateMaxMinY() {
   std::vector<Net> &net_list = ckt_ptr_->Nets();
   size_t sz = net_list.size();
 //#pragma omp parallel for
+  NetPinTable const &pin_table = ckt_ptr_->PinTable();
   for (size_t i = 0; i < sz; ++i) {
-    net_list[i].UpdateMaxMinIdY();
+    net_list[i].UpdateMaxMinIdY(pin_table);
   }
 }
 
@@ -602,7 +788,8 @@ void B2BHpwlOptimizer::BuildProblemWithAnchorX() {
     if (block_list[i].IsFixed()) continue;
     pin_loc0 = block_list[i].LLX();
     pin_loc1 = x_anchor[i];
-    weight = alpha / (std::fabs(pin_loc0 - pin_loc1) + width_epsilon_);
+    weight = alpha * x_anchor_weight[i]
+        / (std::fabs(pin_loc0 - pin_loc1) + width_epsilon_);
     bx[i] += pin_loc1 * weight;
     coefficients_x_.emplace_back(T(i, i, weight));
   }
@@ -626,7 +813,8 @@ void B2BHpwlOptimizer::BuildProblemWithAnchorY() {
     if (block_list[i].IsFixed()) continue;
     pin_loc0 = block_list[i].LLY();
     pin_loc1 = y_anchor[i];
-    weight = alpha / (std::fabs(pin_loc0 - pin_loc1) + width_epsilon_);
+    weight = alpha * y_anchor_weight[i]
+        / (std::fabs(pin_loc0 - pin_loc1) + width_epsilon_);
     by[i] += pin_loc1 * weight;
     coefficients_y_.emplace_back(T(i, i, weight));
   }
@@ -635,32 +823,48 @@ void B2BHpwlOptimizer::BuildProblemWithAnchorY() {
 }
 
 void B2BHpwlOptimizer::BackUpBlockLocation() {
-  std::vector<Block> &block_list = ckt_ptr_->Blocks();
-  int sz = static_cast<int>(block_list.size());
-//#pragma omp for
-  for (int i = 0; i < sz; ++i) {
-    x_anchor[i] = block_list[i].LLX();
-    y_anchor[i] = block_list[i].LLY();
+  // vx and vy are views of block locations
+  x_anchor = vx;
+  y_anchor = vy;
+}
+
+/****
+ * @brief Split nets into @param num_chunks contiguous chunks with roughly the
+ * same number of pins. The partition only depends on the netlist and the
+ * number of chunks, so it is computed once and cached in @param chunk_bounds.
+ */
+void B2BHpwlOptimizer::PartitionNets(
+    int num_chunks,
+    std::vector<size_t> &chunk_bounds
+) {
+  if (static_cast<int>(chunk_bounds.size()) == num_chunks + 1) return;
+  std::vector<Net> &nets = ckt_ptr_->Nets();
+  size_t tot_pin_cnt = 0;
+  for (auto &net : nets) {
+    tot_pin_cnt += net.PinCnt();
+  }
+  chunk_bounds.assign(num_chunks + 1, nets.size());
+  chunk_bounds[0] = 0;
+  size_t accumulated_pin_cnt = 0;
+  int chunk = 1;
+  for (size_t i = 0; i < nets.size() && chunk < num_chunks; ++i) {
+    accumulated_pin_cnt += nets[i].PinCnt();
+    while (chunk < num_chunks
+        && accumulated_pin_cnt * num_chunks >= tot_pin_cnt * chunk) {
+      chunk_bounds[chunk++] = i + 1;
+    }
   }
 }
 
 void B2BHpwlOptimizer::OptimizeHpwlXWithAnchor(int num_threads) {
   Eigen::setNbThreads(num_threads);
+  num_threads_x_ = num_threads;
+  solver_x_->SetNumThreads(num_threads);
   BOOST_LOG_TRIVIAL(trace)
     << "threads in branch x: " << num_threads
     << " actual number of threads: " << omp_get_max_threads()
     << " Eigen threads: " << Eigen::nbThreads() << "\n";
 
-  std::vector<Block> &block_list = ckt_ptr_->Blocks();
-  int sz = static_cast<int>(block_list.size());
-#pragma omp parallel num_threads(num_threads) default(none) shared(block_list, sz)
-  {
-#pragma omp for
-    for (int i = 0; i < sz; ++i) {
-      vx[i] = block_list[i].LLX();
-    }
-  }
-
   std::vector<double> eval_history_x;
   int b2b_update_it_x = 0;
   for (b2b_update_it_x = 0; b2b_update_it_x < b2b_update_max_iteration_;
@@ -696,22 +900,14 @@ void B2BHpwlOptimizer::OptimizeHpwlXWithAnchor(int num_threads) {
 }
 
 void B2BHpwlOptimizer::OptimizeHpwlYWithAnchor(int num_threads) {
+  num_threads_y_ = num_threads;
+  solver_y_->SetNumThreads(num_threads);
   BOOST_LOG_TRIVIAL(trace)
     << "threads in branch y: "
     << omp_get_max_threads()
     << " Eigen threads: " << Eigen::nbThreads()
     << "\n";
 
-  std::vector<Block> &block_list = ckt_ptr_->Blocks();
-  int sz = static_cast<int>(block_list.size());
-#pragma omp parallel num_threads(num_threads) default(none) shared(block_list, sz)
-  {
-#pragma omp for
-    for (int i = 0; i < sz; ++i) {
-      vy[i] = block_list[i].LLY();
-    }
-  }
-
   std::vector<double> eval_history_y;
   int b2b_update_it_y = 0;
   for (b2b_update_it_y = 0;
@@ -747,8 +943,149 @@ void B2BHpwlOptimizer::OptimizeHpwlYWithAnchor(int num_threads) {
   lower_bound_hpwl_y_.push_back(eval_history_y.back());
 }
 
+/****
+ * @brief Optimize x and y in lock-step using all threads. Both problems are
+ * built one after another, and then solved together by the fused solver.
+ * Each direction stops updating its net model once it converges.
+ */
+void B2BHpwlOptimizer::OptimizeHpwlXYWithAnchor(int num_threads) {
+  num_threads_x_ = num_threads;
+  num_threads_y_ = num_threads;
+  solver_x_->SetNumThreads(num_threads);
+  solver_y_->SetNumThreads(num_threads);
+  BOOST_LOG_TRIVIAL(trace)
+    << "threads in branch xy: " << num_threads << "\n";
+
+  auto is_net_model_update_stopped = [&](
+      std::vector<double> &eval_history,
+      std::string const &direction
+  ) {
+    if (eval_history.size() < 3) return false;
+    bool is_converge = IsSeriesConverge(
+        eval_history,
+        3,
+        net_model_update_stop_criterion_
+    );
+    bool is_oscillate = IsSeriesOscillate(eval_history, 5);
+    if (is_oscillate && !is_converge) {
+      BOOST_LOG_TRIVIAL(trace)
+        << "Net model update oscillation detected " << direction << "\n";
+    }
+    return is_converge || is_oscillate;
+  };
+
+  std::vector<double> eval_history_x;
+  std::vector<double> eval_history_y;
+  bool is_x_stopped = false;
+  bool is_y_stopped = false;
+  int b2b_update_it = 0;
+  for (b2b_update_it = 0;
+       b2b_update_it < b2b_update_max_iteration_;
+       ++b2b_update_it) {
+    BOOST_LOG_TRIVIAL(trace) << "    Iterative net model update\n";
+    if (!is_x_stopped) {
+      BuildProblemWithAnchorX();
+    }
+    if (!is_y_stopped) {
+      BuildProblemWithAnchorY();
+    }
+    double evaluate_result_x = 0;
+    double evaluate_result_y = 0;
+    OptimizeQuadraticMetricXY(
+        cg_stop_criterion_,
+        !is_x_stopped,
+        !is_y_stopped,
+        evaluate_result_x,
+        evaluate_result_y
+    );
+    if (!is_x_stopped) {
+      eval_history_x.push_back(evaluate_result_x);
+      is_x_stopped = is_net_model_update_stopped(eval_history_x, "X");
+    }
+    if (!is_y_stopped) {
+      eval_history_y.push_back(evaluate_result_y);
+      is_y_stopped = is_net_model_update_stopped(eval_history_y, "Y");
+    }
+    if (is_x_stopped && is_y_stopped) {
+      break;
+    }
+  }
+  BOOST_LOG_TRIVIAL(trace)
+    << "  Optimization summary XY, iterations: " << b2b_update_it
+    << ", " << eval_history_x << ", " << eval_history_y << "\n";
+  DaliExpects(
+      !eval_history_x.empty() && !eval_history_y.empty(),
+      "Cannot return a valid value because the result is not evaluated!");
+  lower_bound_hpwl_x_.push_back(eval_history_x.back());
+  lower_bound_hpwl_y_.push_back(eval_history_y.back());
+}
+
+/****
+ * @brief Scale the anchor weight of each block by a factor, for example,
+ * blocks keeping their prior locations in incremental placement need stronger
+ * anchors.
+ *
+ * @param factors: the anchor weight factor of each block
+ */
+void B2BHpwlOptimizer::SetAnchorWeightFactors(
+    std::vector<double> const &factors
+) {
+  DaliExpects(
+      static_cast<EgId>(factors.size()) == x_anchor_weight.size(),
+      "The number of anchor weight factors is different from the number of blocks"
+  );
+  for (size_t i = 0; i < factors.size(); ++i) {
+    x_anchor_weight[i] = factors[i];
+    y_anchor_weight[i] = factors[i];
+  }
+}
+
+/****
+ * @brief Pin anchors of some blocks at their current locations. Anchors of
+ * these blocks are not moved to the result of look-ahead legalization in later
+ * iterations, so these blocks do not drift away from their current locations,
+ * for example, blocks keeping their prior locations in incremental placement.
+ *
+ * @param is_anchor_pinned: a flag for each block
+ */
+void B2BHpwlOptimizer::PinAnchors(std::vector<bool> const &is_anchor_pinned) {
+  DaliExpects(
+      static_cast<EgId>(is_anchor_pinned.size()) == vx.size(),
+      "The number of pinned anchor flags is different from the number of blocks"
+  );
+  pinned_anchor_blk_ids_.clear();
+  pinned_anchor_x_.clear();
+  pinned_anchor_y_.clear();
+  for (size_t i = 0; i < is_anchor_pinned.size(); ++i) {
+    if (!is_anchor_pinned[i]) continue;
+    pinned_anchor_blk_ids_.push_back(static_cast<int>(i));
+    pinned_anchor_x_.push_back(vx[i]);
+    pinned_anchor_y_.push_back(vy[i]);
+  }
+}
+
+/****
+ * @brief Continue from the current block locations instead of a random
+ * placement. The anchor weight is accumulated as if start_iter iterations had
+ * been done, and anchors are placed at the current block locations, so the
+ * next call of OptimizeHpwl() with iteration start_iter does not collapse the
+ * existing placement.
+ *
+ * @param start_iter: the iteration the optimization continues from
+ */
+void B2BHpwlOptimizer::WarmStart(int start_iter) {
+  DaliExpects(start_iter > 0, "Warm start needs a positive iteration");
+  alpha = 0;
+  for (cur_iter_ = 0; cur_iter_ < start_iter; ++cur_iter_) {
+    UpdateAnchorAlpha();
+  }
+  BackUpBlockLocation();
+}
+
 double B2BHpwlOptimizer::OptimizeHpwl() {
   omp_set_dynamic(0);
+  // x and y are optimized in two threads, each of them spawns its own team
+  omp_set_max_active_levels(2);
   int avail_threads_num = num_threads_ / 2;
   if (avail_threads_num == 0) {
     avail_threads_num = 1;
@@ -756,19 +1093,25 @@ double B2BHpwlOptimizer::OptimizeHpwl() {
   ElapsedTime elapsed_time;
   elapsed_time.RecordStartTime();
 
+  // orientations of blocks may be changed by the legalizer
+  ckt_ptr_->UpdatePinTable();
   UpdateAnchorLocation();
   UpdateAnchorAlpha();
   //UpdateAnchorNetWeight();
   BOOST_LOG_TRIVIAL(trace) << "alpha: " << alpha << "\n";
   BOOST_LOG_TRIVIAL(trace) << "OpenMP threads, " << num_threads_ << "\n";
 
+  if (linear_solver_type_ == LinearSolverType::FUSED) {
+    OptimizeHpwlXYWithAnchor(num_threads_);
+  } else {
 #pragma omp parallel num_threads(std::min(num_threads_, 2)) default(none) shared(avail_threads_num)
-  {
-    if (omp_get_thread_num() == 0) {
-      OptimizeHpwlXWithAnchor(avail_threads_num);
-    }
-    if (omp_get_thread_num() == 1 || omp_get_num_threads() == 1) {
-      OptimizeHpwlYWithAnchor(avail_threads_num);
+    {
+      if (omp_get_thread_num() == 0) {
+        OptimizeHpwlXWithAnchor(avail_threads_num);
+      }
+      if (omp_get_thread_num() == 1 || omp_get_num_threads() == 1) {
+        OptimizeHpwlYWithAnchor(avail_threads_num);
+      }
     }
   }
 
@@ -792,7 +1135,36 @@ double B2BHpwlOptimizer::GetTime() {
   return tot_cg_time;
 }
 
+/****
+ * @brief Add timers of this optimizer to the current stage of the global
+ * profiler. Problems in x and y are built and solved concurrently, so the
+ * sum of their time can be larger than the total time.
+ */
+void B2BHpwlOptimizer::ReportProfile() {
+  Profiler &profiler = GlobalProfiler();
+  profiler.AddTime("hpwl optimization", tot_cg_time);
+  profiler.AddTime("hpwl optimization/build problem x", tot_triplets_time_x);
+  profiler.AddTime("hpwl optimization/build problem y", tot_triplets_time_y);
+  profiler.AddTime(
+      "hpwl optimization/matrix from triplets x", tot_matrix_from_triplets_x
+  );
+  profiler.AddTime(
+      "hpwl optimization/matrix from triplets y", tot_matrix_from_triplets_y
+  );
+  if (linear_solver_type_ == LinearSolverType::FUSED) {
+    profiler.AddTime("hpwl optimization/cg solver xy", tot_cg_solver_time_xy);
+  } else {
+    profiler.AddTime("hpwl optimization/cg solver x", tot_cg_solver_time_x);
+    profiler.AddTime("hpwl optimization/cg solver y", tot_cg_solver_time_y);
+  }
+  profiler.AddCount("matrix rebuilds x", tot_matrix_rebuild_cnt_x);
+  profiler.AddCount("matrix rebuilds y", tot_matrix_rebuild_cnt_y);
+  profiler.AddCount("matrix patches x", tot_matrix_patch_cnt_x);
+  profiler.AddCount("matrix patches y", tot_matrix_patch_cnt_y);
+}
+
 void B2BHpwlOptimizer::Close() {
+  loc_binding_.reset();
   BOOST_LOG_TRIVIAL(debug)
     << "total triplets time: "
     << tot_triplets_time_x << "s, "
@@ -803,25 +1175,30 @@ void B2BHpwlOptimizer::Close() {
     << tot_matrix_from_triplets_x << "s, "
     << tot_matrix_from_triplets_y << "s, "
     << tot_matrix_from_triplets_x + tot_matrix_from_triplets_y << "s\n";
+  BOOST_LOG_TRIVIAL(debug)
+    << "matrix structure rebuilt/patched/total: "
+    << tot_matrix_rebuild_cnt_x << "/" << tot_matrix_patch_cnt_x << "/"
+    << tot_matrix_merge_cnt_x << ", "
+    << tot_matrix_rebuild_cnt_y << "/" << tot_matrix_patch_cnt_y << "/"
+    << tot_matrix_merge_cnt_y << "\n";
   BOOST_LOG_TRIVIAL(debug)
     << "total cg solver time: "
     << tot_cg_solver_time_x << "s, "
     << tot_cg_solver_time_y << "s, "
     << tot_cg_solver_time_x + tot_cg_solver_time_y << "s\n";
-  BOOST_LOG_TRIVIAL(debug)
-    << "total loc update time: "
-    << tot_loc_update_time_x << "s, "
-    << tot_loc_update_time_y << "s, "
-    << tot_loc_update_time_x + tot_loc_update_time_y << "s\n";
+  if (linear_solver_type_ == LinearSolverType::FUSED) {
+    BOOST_LOG_TRIVIAL(debug)
+      << "total fused cg solver time: " << tot_cg_solver_time_xy << "s\n";
+  }
   double tot_time_x = tot_triplets_time_x + tot_matrix_from_triplets_x
-      + tot_cg_solver_time_x + tot_loc_update_time_x;
+      + tot_cg_solver_time_x;
   double tot_time_y = tot_triplets_time_y + tot_matrix_from_triplets_y
-      + tot_cg_solver_time_y + tot_loc_update_time_y;
+      + tot_cg_solver_time_y;
   BOOST_LOG_TRIVIAL(debug)
     << "total x/y time: "
     << tot_time_x << "s, "
     << tot_time_y << "s, "
-    << tot_time_x + tot_time_y << "s\n";
+    << tot_time_x + tot_time_y + tot_cg_solver_time_xy << "s\n";
 }
 
 void StarHpwlOptimizer::BuildProblemX() {
@@ -1303,21 +1680,18 @@ void StarHpwlHpwlOptimizer::Initialize() {
   Ax_row_size.assign(sz, 0);
 
   EgId eigen_sz = static_cast<EgId>(ckt_ptr_->Blocks().size());
-  vx.resize(eigen_sz);
-  vy.resize(eigen_sz);
+  MapBlockLocations();
   bx.resize(eigen_sz);
   by.resize(eigen_sz);
   Ax.resize(eigen_sz, eigen_sz);
   Ay.resize(eigen_sz, eigen_sz);
   x_anchor.resize(eigen_sz);
   y_anchor.resize(eigen_sz);
-  x_anchor_weight.resize(eigen_sz);
-  y_anchor_weight.resize(eigen_sz);
+  x_anchor_weight.setOnes(eigen_sz);
+  y_anchor_weight.setOnes(eigen_sz);
 
-  cg_x_.setMaxIterations(cg_iteration_);
-  cg_x_.setTolerance(cg_tolerance_);
-  cg_y_.setMaxIterations(cg_iteration_);
-  cg_y_.setTolerance(cg_tolerance_);
+  InitializeLinearSolvers();
+  InitializeIncrementalHpwl();
 
   size_t coefficient_size = 0;
   auto &nets = ckt_ptr_->Nets();
@@ -1632,7 +2006,8 @@ void StarHpwlHpwlOptimizer::BuildProblemWithAnchorX() {
     if (block_list[i].IsFixed()) continue;
     pin_loc0 = block_list[i].LLX();
     pin_loc1 = x_anchor[i];
-    weight = alpha / (std::fabs(pin_loc0 - pin_loc1) + width_epsilon_);
+    weight = alpha * x_anchor_weight[i]
+        / (std::fabs(pin_loc0 - pin_loc1) + width_epsilon_);
     bx[i] += pin_loc1 * weight;
     SpMat_diag_x[i].valueRef() += weight;
   }
@@ -1656,7 +2031,8 @@ void StarHpwlHpwlOptimizer::BuildProblemWithAnchorY() {
     if (block_list[i].IsFixed()) continue;
     pin_loc0 = block_list[i].LLY();
     pin_loc1 = y_anchor[i];
-    weight = alpha / (std::fabs(pin_loc0 - pin_loc1) + width_epsilon_);
+    weight = alpha * y_anchor_weight[i]
+        / (std::fabs(pin_loc0 - pin_loc1) + width_epsilon_);
     by[i] += pin_loc1 * weight;
     SpMat_diag_y[i].valueRef() += weight;
   }
@@ -1664,102 +2040,16 @@ void StarHpwlHpwlOptimizer::BuildProblemWithAnchorY() {
   tot_triplets_time_y += elapsed_time.GetWallTime();
 }
 
-double StarHpwlHpwlOptimizer::OptimizeQuadraticMetricX(double cg_stop_criterion) {
-  ElapsedTime elapsed_time;
-  elapsed_time.RecordStartTime();
-
-  int sz = vx.size();
-  std::vector<Block> &blocks = ckt_ptr_->Blocks();
-
-  std::vector<double> eval_history;
-  int max_rounds = cg_iteration_max_num_ / cg_iteration_;
-  cg_x_.compute(Ax); // Ax * vx = bx
-  for (int i = 0; i < max_rounds; ++i) {
-    vx = cg_x_.solveWithGuess(bx, vx);
-    for (int num = 0; num < sz; ++num) {
-      blocks[num].SetLLX(vx[num]);
-    }
-    double evaluate_result = ckt_ptr_->WeightedHPWLX();
-    eval_history.push_back(evaluate_result);
-    //BOOST_LOG_TRIVIAL(info)  <<"  %d WeightedHPWLX: %e\n", i, evaluate_result);
-    if (eval_history.size() >= 3) {
-      bool is_converge =
-          IsSeriesConverge(eval_history, 3, cg_stop_criterion);
-      bool is_oscillate = IsSeriesOscillate(eval_history, 5);
-      if (is_converge) {
-        break;
-      }
-      if (is_oscillate) {
-        BOOST_LOG_TRIVIAL(trace) << "oscillation detected\n";
-        break;
-      }
-    }
-  }
-  BOOST_LOG_TRIVIAL(trace)
-    << "      Metric optimization in X, sequence: " << eval_history << "\n";
-  elapsed_time.RecordEndTime();
-  tot_cg_solver_time_x += elapsed_time.GetWallTime();
-
-  elapsed_time.RecordStartTime();
-  for (int num = 0; num < sz; ++num) {
-    blocks[num].SetLLX(vx[num]);
-  }
-  elapsed_time.RecordEndTime();
-  tot_loc_update_time_x += elapsed_time.GetWallTime();
-
-  DaliExpects(
-      !eval_history.empty(),
-      "Cannot return a valid value because the result is not evaluated!"
-  );
-  return eval_history.back();
+/****
+ * @brief Ax is updated in place when building the problem, and its sparsity
+ * pattern is fixed after InitializeDriverLoadPairs().
+ */
+bool StarHpwlHpwlOptimizer::MergeProblemX() {
+  return false;
 }
 
-double StarHpwlHpwlOptimizer::OptimizeQuadraticMetricY(double cg_stop_criterion) {
-  ElapsedTime elapsed_time;
-  elapsed_time.RecordStartTime();
-
-  int sz = vx.size();
-  std::vector<Block> &block_list = ckt_ptr_->Blocks();
-
-  std::vector<double> eval_history;
-  int max_rounds = cg_iteration_max_num_ / cg_iteration_;
-  cg_y_.compute(Ay);
-  for (int i = 0; i < max_rounds; ++i) {
-    vy = cg_y_.solveWithGuess(by, vy);
-    for (int num = 0; num < sz; ++num) {
-      block_list[num].SetLLY(vy[num]);
-    }
-    double evaluate_result = ckt_ptr_->WeightedHPWLY();
-    eval_history.push_back(evaluate_result);
-    //BOOST_LOG_TRIVIAL(info)  <<"  %d WeightedHPWLY: %e\n", i, evaluate_result);
-    if (eval_history.size() >= 3) {
-      bool is_converge =
-          IsSeriesConverge(eval_history, 3, cg_stop_criterion);
-      bool is_oscillate = IsSeriesOscillate(eval_history, 5);
-      if (is_converge) {
-        break;
-      }
-      if (is_oscillate) {
-        BOOST_LOG_TRIVIAL(trace) << "oscillation detected\n";
-        break;
-      }
-    }
-  }
-  BOOST_LOG_TRIVIAL(trace) << "      Metric optimization in Y, sequence: "
-                           << eval_history << "\n";
-  elapsed_time.RecordEndTime();
-  tot_cg_solver_time_y += elapsed_time.GetWallTime();
-
-  elapsed_time.RecordStartTime();
-  for (int num = 0; num < sz; ++num) {
-    block_list[num].SetLLY(vy[num]);
-  }
-  elapsed_time.RecordEndTime();
-  tot_loc_update_time_y += elapsed_time.GetWallTime();
-
-  DaliExpects(!eval_history.empty(),
-              "Cannot return a valid value because the result is not evaluated!");
-  return eval_history.back();
+bool StarHpwlHpwlOptimizer::MergeProblemY() {
+  return false;
 }
 
 void StarHpwlHpwlOptimizer::UpdateAnchorAlpha() {
@@ -20,6 +20,7 @@
  ******************************************************************************/
 #ifndef DALI_PLACER_GLOBAL_PLACER_HPWL_OPTIMIZER_H_
 #define DALI_PLACER_GLOBAL_PLACER_HPWL_OPTIMIZER_H_
+#include <memory>
 #include <vector>
 
 #include <Eigen/IterativeLinearSolvers>
@@ -27,6 +28,9 @@
 
 #include "blkpairnets.h"
 #include "dali/circuit/circuit.h"
+#include "dali/circuit/incremental_hpwl.h"
+#include "linear_solver.h"
+#include "parallel_assembler.h"
 
 namespace dali {
 
@@ -45,9 +49,17 @@ class HpwlOptimizer {
   virtual ~HpwlOptimizer() = default;
   virtual void Initialize() = 0;
   void SetNumThreads(int num_threads) { num_threads_ = num_threads; }
+  void SetLinearSolverType(LinearSolverType linear_solver_type) {
+    linear_solver_type_ = linear_solver_type;
+  }
   void SetIteration(int cur_iter) { cur_iter_ = cur_iter; }
+  virtual void SetAnchorWeightFactors(std::vector<double> const &factors) = 0;
+  virtual void PinAnchors(std::vector<bool> const &is_anchor_pinned) = 0;
+  virtual void WarmStart(int start_iter) = 0;
   virtual double OptimizeHpwl() = 0;
   virtual double GetTime() = 0;
+  // add accumulated timers and counters to the global profiler
+  virtual void ReportProfile() = 0;
   virtual void Close() = 0;
   std::vector<double> &GetHpwls() { return lower_bound_hpwl_; }
   std::vector<double> &GetHpwlsX() { return lower_bound_hpwl_x_; }
@@ -57,6 +69,7 @@ class HpwlOptimizer {
   Circuit *ckt_ptr_ = nullptr;
   int cur_iter_ = 0;
   int num_threads_ = 1;
+  LinearSolverType linear_solver_type_ = LinearSolverType::DIAGONAL;
   std::vector<double> lower_bound_hpwl_;
   std::vector<double> lower_bound_hpwl_x_;
   std::vector<double> lower_bound_hpwl_y_;
@@ -75,6 +88,9 @@ class B2BHpwlOptimizer : public HpwlOptimizer {
   ~B2BHpwlOptimizer() override = default;
 
   void UpdateEpsilon();
+  void InitializeLinearSolvers();
+  void MapBlockLocations();
+  void InitializeIncrementalHpwl();
   void Initialize() override;
 
   virtual void BuildProblemX();
@@ -85,8 +101,17 @@ class B2BHpwlOptimizer : public HpwlOptimizer {
       double tolerance
   );
   bool IsSeriesOscillate(std::vector<double> &data, int window_size);
-  virtual double OptimizeQuadraticMetricX(double cg_stop_criterion);
-  virtual double OptimizeQuadraticMetricY(double cg_stop_criterion);
+  virtual bool MergeProblemX();
+  virtual bool MergeProblemY();
+  double OptimizeQuadraticMetricX(double cg_stop_criterion);
+  double OptimizeQuadraticMetricY(double cg_stop_criterion);
+  void OptimizeQuadraticMetricXY(
+      double cg_stop_criterion,
+      bool is_x_active,
+      bool is_y_active,
+      double &evaluate_result_x,
+      double &evaluate_result_y
+  );
   void PullBlockBackToRegion();
 
   void UpdateAnchorLocation();
@@ -96,11 +121,17 @@ class B2BHpwlOptimizer : public HpwlOptimizer {
   virtual void BuildProblemWithAnchorX();
   virtual void BuildProblemWithAnchorY();
   void BackUpBlockLocation();
+  void PartitionNets(int num_chunks, std::vector<size_t> &chunk_bounds);
   void OptimizeHpwlXWithAnchor(int num_threads);
   void OptimizeHpwlYWithAnchor(int num_threads);
+  void OptimizeHpwlXYWithAnchor(int num_threads);
+  void SetAnchorWeightFactors(std::vector<double> const &factors) override;
+  void PinAnchors(std::vector<bool> const &is_anchor_pinned) override;
+  void WarmStart(int start_iter) override;
   double OptimizeHpwl() override;
 
   double GetTime() override;
+  void ReportProfile() override;
   void Close() override;
  protected:
   /**** parameters for CG solver optimization configuration ****/
@@ -114,6 +145,9 @@ class B2BHpwlOptimizer : public HpwlOptimizer {
   double cg_stop_criterion_ = 0.0025;
   // stop update net model if the cost change is less than this value for 3 iterations
   double net_model_update_stop_criterion_ = 0.01;
+  // nets of a block are re-evaluated only if it moves more than this factor times the average movable cell size
+  double hpwl_move_threshold_factor_ = 0.001;
+  IncrementalHpwl incremental_hpwl_;
 
   /**** two small positive numbers used to avoid divergence when calculating net weights ****/
   double epsilon_factor_ = 1.5;
@@ -127,7 +161,9 @@ class B2BHpwlOptimizer : public HpwlOptimizer {
   std::vector<std::vector<D>> ADx;
   std::vector<std::vector<D>> ADy;
 
-  Eigen::VectorXd vx, vy;
+  // views of block locations in the BlockLocStore of the circuit
+  Eigen::Map<Eigen::VectorXd> vx{nullptr, 0};
+  Eigen::Map<Eigen::VectorXd> vy{nullptr, 0};
   Eigen::VectorXd bx, by;
   SpMat Ax;
   SpMat Ay;
@@ -135,15 +171,31 @@ class B2BHpwlOptimizer : public HpwlOptimizer {
   Eigen::VectorXd x_anchor_weight, y_anchor_weight;
   bool x_anchor_set = false;
   bool y_anchor_set = false;
+  // blocks whose anchors stay at the locations given by PinAnchors()
+  std::vector<int> pinned_anchor_blk_ids_;
+  std::vector<double> pinned_anchor_x_;
+  std::vector<double> pinned_anchor_y_;
   std::vector<T> coefficients_x_;
   std::vector<T> coefficients_y_;
-  Eigen::ConjugateGradient<SpMat, Eigen::Lower | Eigen::Upper> cg_x_;
-  Eigen::ConjugateGradient<SpMat, Eigen::Lower | Eigen::Upper> cg_y_;
+  std::unique_ptr<LinearSolver> solver_x_;
+  std::unique_ptr<LinearSolver> solver_y_;
+  // block locations are in the store of the circuit while this is alive
+  std::unique_ptr<BlockLocBinding> loc_binding_;
   std::vector<std::vector<BlkPairNets *>> pair_connect;
   std::vector<BlkPairNets> diagonal_pair;
   std::vector<SpMat::InnerIterator> SpMat_diag_x;
   std::vector<SpMat::InnerIterator> SpMat_diag_y;
 
+  /**** multi-threaded assembly of the linear system ****/
+  // number of threads used to build and solve the problem in x and y
+  int num_threads_x_ = 1;
+  int num_threads_y_ = 1;
+  // nets are split into contiguous chunks, one chunk per thread
+  std::vector<size_t> net_chunk_bounds_x_;
+  std::vector<size_t> net_chunk_bounds_y_;
+  ParallelAssembler assembler_x_;
+  ParallelAssembler assembler_y_;
+
   int b2b_update_max_iteration_ = 50;
   size_t net_ignore_threshold_ = 100;
 
@@ -151,10 +203,16 @@ class B2BHpwlOptimizer : public HpwlOptimizer {
   double tot_triplets_time_y = 0;
   double tot_matrix_from_triplets_x = 0;
   double tot_matrix_from_triplets_y = 0;
+  int tot_matrix_merge_cnt_x = 0;
+  int tot_matrix_merge_cnt_y = 0;
+  int tot_matrix_rebuild_cnt_x = 0;
+  int tot_matrix_rebuild_cnt_y = 0;
+  int tot_matrix_patch_cnt_x = 0;
+  int tot_matrix_patch_cnt_y = 0;
   double tot_cg_solver_time_x = 0;
   double tot_cg_solver_time_y = 0;
-  double tot_loc_update_time_x = 0;
-  double tot_loc_update_time_y = 0;
+  // time of solving x and y together using the fused solver
+  double tot_cg_solver_time_xy = 0;
   double tot_cg_time = 0;
 
   /**** anchor weight ****/
@@ -202,8 +260,8 @@ class StarHpwlHpwlOptimizer : public B2BHpwlOptimizer {
   void BuildProblemWithAnchorX() override;
   void BuildProblemWithAnchorY() override;
 
-  double OptimizeQuadraticMetricX(double cg_stop_criterion) override;
-  double OptimizeQuadraticMetricY(double cg_stop_criterion) override;
+  bool MergeProblemX() override;
+  bool MergeProblemY() override;
 
   void UpdateAnchorAlpha() override;
  private:
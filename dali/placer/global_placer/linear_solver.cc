@@ -0,0 +1,361 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "linear_solver.h"
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+
+#include <omp.h>
+
+#include "dali/common/logging.h"
+
+namespace dali {
+
+LinearSolverType StrToLinearSolverType(std::string const &str_solver_type) {
+  LinearSolverType solver_type = LinearSolverType::DIAGONAL;
+  if (str_solver_type == "diagonal") {
+    solver_type = LinearSolverType::DIAGONAL;
+  } else if (str_solver_type == "ic0") {
+    solver_type = LinearSolverType::IC0;
+  } else if (str_solver_type == "amg") {
+    solver_type = LinearSolverType::AMG;
+  } else if (str_solver_type == "fused") {
+    solver_type = LinearSolverType::FUSED;
+  } else {
+    DaliExpects(false, "Unknown linear solver type: " + str_solver_type);
+  }
+  return solver_type;
+}
+
+std::string LinearSolverTypeStr(LinearSolverType solver_type) {
+  std::string s;
+  switch (solver_type) {
+    case LinearSolverType::DIAGONAL: { s = "diagonal"; }
+      break;
+    case LinearSolverType::IC0: { s = "ic0"; }
+      break;
+    case LinearSolverType::AMG: { s = "amg"; }
+      break;
+    case LinearSolverType::FUSED: { s = "fused"; }
+      break;
+    default: {
+      DaliExpects(false, "Unknown linear solver type");
+    }
+  }
+  return s;
+}
+
+void LinearSolver::SetMaxIterations(int max_iterations) {
+  DaliExpects(max_iterations >= 1, "Max iterations less than 1?");
+  max_iterations_ = max_iterations;
+}
+
+void LinearSolver::SetTolerance(double tolerance) {
+  DaliExpects(tolerance >= 0, "Negative tolerance?");
+  tolerance_ = tolerance;
+}
+
+void LinearSolver::SetNumThreads(int num_threads) {
+  DaliExpects(num_threads >= 1, "Number of threads less than 1?");
+  num_threads_ = num_threads;
+}
+
+void EigenCgSolver::Compute(
+    SpMat const &A,
+    [[maybe_unused]] bool is_structure_changed
+) {
+  cg_.setMaxIterations(max_iterations_);
+  cg_.setTolerance(tolerance_);
+  cg_.compute(A);
+}
+
+void EigenCgSolver::SolveWithGuess(
+    Eigen::VectorXd const &b,
+    Eigen::Ref<Eigen::VectorXd> x
+) {
+  x = cg_.solveWithGuess(b, x);
+}
+
+PcgSolver::PcgSolver(std::unique_ptr<Preconditioner> preconditioner)
+    : preconditioner_(std::move(preconditioner)) {
+  DaliExpects(preconditioner_ != nullptr, "Preconditioner is a nullptr?");
+}
+
+void PcgSolver::SetNumThreads(int num_threads) {
+  LinearSolver::SetNumThreads(num_threads);
+  preconditioner_->SetNumThreads(num_threads);
+}
+
+void PcgSolver::Compute(SpMat const &A, bool is_structure_changed) {
+  A_ = &A;
+  int sz = static_cast<int>(A.rows());
+  residual_.resize(sz);
+  p_.resize(sz);
+  z_.resize(sz);
+  tmp_.resize(sz);
+  partial_sums_.assign(NumBlocks(), 0);
+  preconditioner_->Compute(A, is_structure_changed);
+}
+
+int PcgSolver::NumBlocks() const {
+  return static_cast<int>((A_->rows() + kBlockSize - 1) / kBlockSize);
+}
+
+double PcgSolver::SumPartials() const {
+  double sum = 0;
+  for (auto &partial_sum: partial_sums_) {
+    sum += partial_sum;
+  }
+  return sum;
+}
+
+void PcgSolver::SolveWithGuess(
+    Eigen::VectorXd const &b,
+    Eigen::Ref<Eigen::VectorXd> x
+) {
+  std::vector<Eigen::Ref<Eigen::VectorXd>> xs{x};
+  SolveWithGuess({this}, {&b}, xs, num_threads_);
+}
+
+/****
+ * @brief Solve several systems in lock-step. Each system follows exactly the
+ * iteration of Eigen::ConjugateGradient, and drops out once its residual
+ * falls below the tolerance.
+ *
+ * @param solvers: solvers whose Compute() has been called
+ * @param bs: right-hand sides
+ * @param xs: initial guesses, overwritten by solutions
+ * @param num_threads: number of threads for the fused loops
+ */
+void PcgSolver::SolveWithGuess(
+    std::vector<PcgSolver *> const &solvers,
+    std::vector<Eigen::VectorXd const *> const &bs,
+    std::vector<Eigen::Ref<Eigen::VectorXd>> &xs,
+    int num_threads
+) {
+  DaliExpects(
+      solvers.size() == bs.size() && solvers.size() == xs.size(),
+      "Numbers of solvers, right-hand sides and solutions do not match"
+  );
+  int num_systems = static_cast<int>(solvers.size());
+
+  // runs kernel(system, row_begin, row_end, block) over row blocks of all
+  // active systems using one team of threads
+  std::vector<std::pair<int, int>> work_items;
+  auto for_each_block = [&](std::function<void(int, int, int, int)> const &kernel) {
+    work_items.clear();
+    for (int s = 0; s < num_systems; ++s) {
+      if (!solvers[s]->is_active_) continue;
+      int num_blocks = solvers[s]->NumBlocks();
+      for (int block = 0; block < num_blocks; ++block) {
+        work_items.emplace_back(s, block);
+      }
+    }
+    int num_items = static_cast<int>(work_items.size());
+#pragma omp parallel for num_threads(num_threads) schedule(static)
+    for (int k = 0; k < num_items; ++k) {
+      int s = work_items[k].first;
+      int block = work_items[k].second;
+      int row_begin = block * kBlockSize;
+      int row_end = std::min(
+          row_begin + kBlockSize,
+          static_cast<int>(solvers[s]->A_->rows())
+      );
+      kernel(s, row_begin, row_end, block);
+    }
+  };
+  auto spmv = [&](int s, int i, auto const &v) {
+    SpMat const &A = *solvers[s]->A_;
+    double sum = 0;
+    for (int k = A.outerIndexPtr()[i]; k < A.outerIndexPtr()[i + 1]; ++k) {
+      sum += A.valuePtr()[k] * v[A.innerIndexPtr()[k]];
+    }
+    return sum;
+  };
+
+  // initial residual r = b - A * x, and the squared norm of b
+  std::vector<double> rhs_norm2(num_systems, 0);
+  for (int s = 0; s < num_systems; ++s) {
+    DaliExpects(solvers[s]->A_ != nullptr, "Compute() is not called?");
+    solvers[s]->is_active_ = true;
+  }
+  for_each_block([&](int s, int row_begin, int row_end, int block) {
+    PcgSolver &solver = *solvers[s];
+    Eigen::VectorXd const &b = *bs[s];
+    double sum = 0;
+    for (int i = row_begin; i < row_end; ++i) {
+      sum += b[i] * b[i];
+    }
+    solver.partial_sums_[block] = sum;
+  });
+  for (int s = 0; s < num_systems; ++s) {
+    rhs_norm2[s] = solvers[s]->SumPartials();
+  }
+  for_each_block([&](int s, int row_begin, int row_end, int block) {
+    PcgSolver &solver = *solvers[s];
+    Eigen::VectorXd const &b = *bs[s];
+    Eigen::Ref<Eigen::VectorXd> const &x = xs[s];
+    double sum = 0;
+    for (int i = row_begin; i < row_end; ++i) {
+      double r = b[i] - spmv(s, i, x);
+      solver.residual_[i] = r;
+      sum += r * r;
+    }
+    solver.partial_sums_[block] = sum;
+  });
+  for (int s = 0; s < num_systems; ++s) {
+    PcgSolver &solver = *solvers[s];
+    if (rhs_norm2[s] == 0) {
+      xs[s].setZero();
+      solver.is_active_ = false;
+      continue;
+    }
+    solver.threshold_ = std::max(
+        solver.tolerance_ * solver.tolerance_ * rhs_norm2[s],
+        std::numeric_limits<double>::min()
+    );
+    if (solver.SumPartials() < solver.threshold_) {
+      solver.is_active_ = false;
+      continue;
+    }
+    solver.preconditioner_->Apply(solver.residual_, solver.z_);
+  }
+  for_each_block([&](int s, int row_begin, int row_end, int block) {
+    PcgSolver &solver = *solvers[s];
+    double sum = 0;
+    for (int i = row_begin; i < row_end; ++i) {
+      solver.p_[i] = solver.z_[i];
+      sum += solver.residual_[i] * solver.z_[i];
+    }
+    solver.partial_sums_[block] = sum;
+  });
+  int max_iterations = 0;
+  for (int s = 0; s < num_systems; ++s) {
+    if (!solvers[s]->is_active_) continue;
+    solvers[s]->abs_new_ = solvers[s]->SumPartials();
+    max_iterations = std::max(max_iterations, solvers[s]->max_iterations_);
+  }
+
+  for (int iter = 0; iter < max_iterations; ++iter) {
+    bool is_any_active = false;
+    for (int s = 0; s < num_systems; ++s) {
+      if (solvers[s]->is_active_ && iter >= solvers[s]->max_iterations_) {
+        solvers[s]->is_active_ = false;
+      }
+      is_any_active = is_any_active || solvers[s]->is_active_;
+    }
+    if (!is_any_active) break;
+
+    // tmp = A * p, alpha = r.z / p.tmp
+    for_each_block([&](int s, int row_begin, int row_end, int block) {
+      PcgSolver &solver = *solvers[s];
+      double sum = 0;
+      for (int i = row_begin; i < row_end; ++i) {
+        double t = spmv(s, i, solver.p_);
+        solver.tmp_[i] = t;
+        sum += solver.p_[i] * t;
+      }
+      solver.partial_sums_[block] = sum;
+    });
+    for (int s = 0; s < num_systems; ++s) {
+      if (!solvers[s]->is_active_) continue;
+      solvers[s]->alpha_ = solvers[s]->abs_new_ / solvers[s]->SumPartials();
+    }
+
+    // x += alpha * p, r -= alpha * tmp
+    for_each_block([&](int s, int row_begin, int row_end, int block) {
+      PcgSolver &solver = *solvers[s];
+      Eigen::Ref<Eigen::VectorXd> &x = xs[s];
+      double alpha = solver.alpha_;
+      double sum = 0;
+      for (int i = row_begin; i < row_end; ++i) {
+        x[i] += alpha * solver.p_[i];
+        double r = solver.residual_[i] - alpha * solver.tmp_[i];
+        solver.residual_[i] = r;
+        sum += r * r;
+      }
+      solver.partial_sums_[block] = sum;
+    });
+    for (int s = 0; s < num_systems; ++s) {
+      PcgSolver &solver = *solvers[s];
+      if (!solver.is_active_) continue;
+      if (solver.SumPartials() < solver.threshold_) {
+        solver.is_active_ = false;
+        continue;
+      }
+      solver.preconditioner_->Apply(solver.residual_, solver.z_);
+    }
+
+    // beta = r.z / previous r.z, p = z + beta * p
+    for_each_block([&](int s, int row_begin, int row_end, int block) {
+      PcgSolver &solver = *solvers[s];
+      double sum = 0;
+      for (int i = row_begin; i < row_end; ++i) {
+        sum += solver.residual_[i] * solver.z_[i];
+      }
+      solver.partial_sums_[block] = sum;
+    });
+    for (int s = 0; s < num_systems; ++s) {
+      PcgSolver &solver = *solvers[s];
+      if (!solver.is_active_) continue;
+      double abs_old = solver.abs_new_;
+      solver.abs_new_ = solver.SumPartials();
+      solver.beta_ = solver.abs_new_ / abs_old;
+    }
+    for_each_block([&](int s, int row_begin, int row_end, int) {
+      PcgSolver &solver = *solvers[s];
+      double beta = solver.beta_;
+      for (int i = row_begin; i < row_end; ++i) {
+        solver.p_[i] = solver.z_[i] + beta * solver.p_[i];
+      }
+    });
+  }
+
+  for (int s = 0; s < num_systems; ++s) {
+    solvers[s]->is_active_ = false;
+  }
+}
+
+std::unique_ptr<LinearSolver> CreateLinearSolver(LinearSolverType solver_type) {
+  switch (solver_type) {
+    case LinearSolverType::DIAGONAL: {
+      return std::make_unique<EigenCgSolver>();
+    }
+    case LinearSolverType::IC0: {
+      return std::make_unique<PcgSolver>(std::make_unique<Ic0Preconditioner>());
+    }
+    case LinearSolverType::AMG: {
+      return std::make_unique<PcgSolver>(std::make_unique<AmgPreconditioner>());
+    }
+    case LinearSolverType::FUSED: {
+      return std::make_unique<PcgSolver>(
+          std::make_unique<JacobiPreconditioner>()
+      );
+    }
+    default: {
+      DaliFatal("Unknown linear solver type");
+    }
+  }
+  return nullptr;
+}
+
+}
@@ -0,0 +1,151 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef DALI_PLACER_GLOBAL_PLACER_LINEAR_SOLVER_H_
+#define DALI_PLACER_GLOBAL_PLACER_LINEAR_SOLVER_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <Eigen/IterativeLinearSolvers>
+#include <Eigen/Sparse>
+
+#include "preconditioner.h"
+
+/****
+ * This header file contains linear solvers for the quadratic placement
+ * problem Ax = b. See each class for more information.
+ */
+
+namespace dali {
+
+/****
+ * This class contains possible linear solver backends which users can choose
+ * from.
+ *   DIAGONAL: Eigen conjugate gradient with the diagonal preconditioner
+ *   IC0: conjugate gradient with an incomplete Cholesky preconditioner
+ *   AMG: conjugate gradient with an algebraic multigrid preconditioner
+ *   FUSED: Jacobi preconditioned conjugate gradient, solving x and y in
+ *   lock-step with all threads
+ */
+enum class LinearSolverType {
+  DIAGONAL = 0,
+  IC0 = 1,
+  AMG = 2,
+  FUSED = 3
+};
+
+LinearSolverType StrToLinearSolverType(std::string const &str_solver_type);
+std::string LinearSolverTypeStr(LinearSolverType solver_type);
+
+/****
+ * This is an abstract class defining the interface of all linear solvers.
+ * Each call of SolveWithGuess() runs at most a fixed amount of iterations
+ * starting from the given initial guess.
+ */
+class LinearSolver {
+ public:
+  LinearSolver() = default;
+  virtual ~LinearSolver() = default;
+  void SetMaxIterations(int max_iterations);
+  void SetTolerance(double tolerance);
+  virtual void SetNumThreads(int num_threads);
+  // @param is_structure_changed: if false, only values of A are different
+  // from the last call, and setup work depending on the structure is reused
+  virtual void Compute(SpMat const &A, bool is_structure_changed) = 0;
+  // @param x: the initial guess, overwritten by the solution, it can be a
+  // view of memory not owned by Eigen, e.g., a BlockLocStore
+  virtual void SolveWithGuess(
+      Eigen::VectorXd const &b,
+      Eigen::Ref<Eigen::VectorXd> x
+  ) = 0;
+ protected:
+  int max_iterations_ = 10;
+  double tolerance_ = 1e-35;
+  int num_threads_ = 1;
+};
+
+/****
+ * The default solver, which is a thin wrapper of Eigen::ConjugateGradient.
+ */
+class EigenCgSolver : public LinearSolver {
+ public:
+  void Compute(SpMat const &A, bool is_structure_changed) override;
+  void SolveWithGuess(
+      Eigen::VectorXd const &b,
+      Eigen::Ref<Eigen::VectorXd> x
+  ) override;
+ private:
+  Eigen::ConjugateGradient<SpMat, Eigen::Lower | Eigen::Upper> cg_;
+};
+
+/****
+ * A preconditioned conjugate gradient solver using OpenMP. The iteration is
+ * the same as Eigen::ConjugateGradient. Inner products are reduced over
+ * fixed-size row blocks in a fixed order, so the result does not depend on
+ * the number of threads.
+ *
+ * Several systems can be solved in lock-step by one team of threads, see
+ * SolveWithGuess(solvers, bs, xs, num_threads). Each parallel loop then
+ * iterates over row blocks of all systems, which halves the number of
+ * parallel regions and keeps all threads busy when solving x and y together.
+ */
+class PcgSolver : public LinearSolver {
+ public:
+  explicit PcgSolver(std::unique_ptr<Preconditioner> preconditioner);
+  void SetNumThreads(int num_threads) override;
+  void Compute(SpMat const &A, bool is_structure_changed) override;
+  void SolveWithGuess(
+      Eigen::VectorXd const &b,
+      Eigen::Ref<Eigen::VectorXd> x
+  ) override;
+  static void SolveWithGuess(
+      std::vector<PcgSolver *> const &solvers,
+      std::vector<Eigen::VectorXd const *> const &bs,
+      std::vector<Eigen::Ref<Eigen::VectorXd>> &xs,
+      int num_threads
+  );
+ private:
+  // rows of a block for inner products
+  static constexpr int kBlockSize = 4096;
+  SpMat const *A_ = nullptr;
+  std::unique_ptr<Preconditioner> preconditioner_;
+  int NumBlocks() const;
+  // work vectors and partial sums of inner products, one per block
+  Eigen::VectorXd residual_;
+  Eigen::VectorXd p_;
+  Eigen::VectorXd z_;
+  Eigen::VectorXd tmp_;
+  std::vector<double> partial_sums_;
+  double SumPartials() const;
+  // states of the current solve
+  bool is_active_ = false;
+  double threshold_ = 0;
+  double abs_new_ = 0;
+  double alpha_ = 0;
+  double beta_ = 0;
+};
+
+std::unique_ptr<LinearSolver> CreateLinearSolver(LinearSolverType solver_type);
+
+}
+
+#endif //DALI_PLACER_GLOBAL_PLACER_LINEAR_SOLVER_H_
@@ -0,0 +1,539 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "parallel_assembler.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include <omp.h>
+
+#include "dali/common/logging.h"
+
+namespace dali {
+
+/****
+ * @brief Set the dimension of the linear system and the number of chunks.
+ * Buffers are only reallocated when either of them changes, otherwise they
+ * are cleared and their capacity is kept for the next assembly. The existing
+ * matrix structure stays valid as long as the dimension does not change.
+ *
+ * @param dim: the number of rows (and columns) of the linear system
+ * @param num_chunks: the number of chunks the input is split into
+ */
+void ParallelAssembler::Initialize(int dim, int num_chunks) {
+  DaliExpects(dim >= 0, "Negative dimension?");
+  DaliExpects(num_chunks >= 1, "Number of chunks less than 1?");
+  if (dim == dim_ && num_chunks == num_chunks_) {
+    Clear();
+    return;
+  }
+  if (dim != dim_) {
+    is_pattern_valid_ = false;
+  }
+  dim_ = dim;
+  num_chunks_ = num_chunks;
+  rows_per_block_ = std::max(1, (dim_ + num_chunks_ - 1) / num_chunks_);
+
+  coefficients_.assign(
+      num_chunks_,
+      std::vector<std::vector<Entry>>(num_chunks_)
+  );
+  rhs_.assign(
+      num_chunks_,
+      std::vector<std::vector<std::pair<int, double>>>(num_chunks_)
+  );
+  tail_.assign(num_chunks_, std::vector<Entry>());
+  row_blocks_.assign(num_chunks_, RowBlockBuffer());
+  chunk_states_.assign(num_chunks_, ChunkState());
+}
+
+/****
+ * @brief Reserve slots for groups of entries.
+ *
+ * @param capacities: the maximum number of entries each group can emit
+ */
+void ParallelAssembler::InitializeGroups(std::vector<int> const &capacities) {
+  size_t num_groups = capacities.size();
+  group_offsets_.assign(num_groups + 1, 0);
+  for (size_t i = 0; i < num_groups; ++i) {
+    group_offsets_[i + 1] = group_offsets_[i] + capacities[i];
+  }
+  group_keys_.assign(num_groups, std::make_pair(-1, -1));
+  positions_.assign(group_offsets_[num_groups], -1);
+  is_pattern_valid_ = false;
+}
+
+void ParallelAssembler::Clear() {
+  for (auto &chunk : coefficients_) {
+    for (auto &bucket : chunk) {
+      bucket.clear();
+    }
+  }
+  for (auto &chunk : rhs_) {
+    for (auto &bucket : chunk) {
+      bucket.clear();
+    }
+  }
+  for (auto &state : chunk_states_) {
+    state.slot = -1;
+    state.slot_end = -1;
+    state.is_key_changed = false;
+    state.missing_entries.clear();
+  }
+}
+
+/****
+ * @brief Start emitting entries for a group. Entries of a group only depend
+ * on its key, so if the key is the same as last time, positions of these
+ * entries in the matrix are known.
+ */
+void ParallelAssembler::BeginGroup(int chunk, int group, int key0, int key1) {
+  ChunkState &state = chunk_states_[chunk];
+  state.slot = group_offsets_[group];
+  state.slot_end = group_offsets_[group + 1];
+  auto key = std::make_pair(key0, key1);
+  state.is_key_changed = !is_pattern_valid_ || group_keys_[group] != key;
+  group_keys_[group] = key;
+}
+
+void ParallelAssembler::EndGroup(int chunk) {
+  ChunkState &state = chunk_states_[chunk];
+  state.slot = -1;
+  state.slot_end = -1;
+}
+
+void ParallelAssembler::AddCoefficient(
+    int chunk,
+    int row,
+    int col,
+    double value
+) {
+  ChunkState &state = chunk_states_[chunk];
+  int slot = -1;
+  if (state.slot >= 0) {
+    slot = state.slot++;
+    DaliExpects(slot < state.slot_end, "Group capacity exceeded");
+    if (state.is_key_changed) {
+      // this group has a new key, look up its entries in the current structure
+      int pos = FindPosition(row, col);
+      positions_[slot] = pos;
+      if (pos < 0 && is_pattern_valid_) {
+        state.missing_entries.emplace_back(row, col);
+      }
+    }
+  } else if (is_pattern_valid_ && FindPosition(row, col) < 0) {
+    state.missing_entries.emplace_back(row, col);
+  }
+  coefficients_[chunk][RowBlock(row)].emplace_back(row, col, slot, value);
+}
+
+/****
+ * @brief Returns the position of the given entry in valuePtr() of the current
+ * matrix structure, or -1 if the entry does not exist.
+ */
+int ParallelAssembler::FindPosition(int row, int col) const {
+  if (!is_pattern_valid_) return -1;
+  int const *inner_index = pattern_->innerIndexPtr();
+  int const *begin = inner_index + pattern_->outerIndexPtr()[row];
+  int const *end = inner_index + pattern_->outerIndexPtr()[row + 1];
+  int const *it = std::lower_bound(begin, end, col);
+  if (it == end || *it != col) return -1;
+  return static_cast<int>(it - inner_index);
+}
+
+/****
+ * @brief Sum up right-hand-side contributions of all chunks into @param b.
+ * Each row block is handled by one thread, and contributions to a row are
+ * added in chunk order.
+ */
+void ParallelAssembler::MergeRhs(Eigen::VectorXd &b) {
+  DaliExpects(b.size() == dim_, "Right-hand-side vector size mismatch");
+#pragma omp parallel for num_threads(num_chunks_) schedule(static, 1)
+  for (int block = 0; block < num_chunks_; ++block) {
+    int lo = block * rows_per_block_;
+    int hi = std::min(dim_, lo + rows_per_block_);
+    for (int i = lo; i < hi; ++i) {
+      b[i] = 0;
+    }
+    for (int chunk = 0; chunk < num_chunks_; ++chunk) {
+      for (auto &[row, value] : rhs_[chunk][block]) {
+        b[row] += value;
+      }
+    }
+  }
+}
+
+/****
+ * @brief Build the compressed-row matrix @param A from entries of all chunks
+ * followed by entries in @param tail. Duplicated entries are summed up.
+ *
+ * If the structure built last time contains all entries, only values are
+ * rewritten. If some entries are missing, the existing structure is patched.
+ * The structure is only built from scratch when it does not exist yet.
+ */
+void ParallelAssembler::MergeMatrix(
+    std::vector<Eigen::Triplet<double>> const &tail,
+    SpMat &A
+) {
+  DaliExpects(A.rows() == dim_ && A.cols() == dim_, "Matrix size mismatch");
+  for (auto &bucket : tail_) {
+    bucket.clear();
+  }
+  for (auto &triplet : tail) {
+    tail_[RowBlock(triplet.row())].emplace_back(
+        triplet.row(), triplet.col(), -1, triplet.value()
+    );
+  }
+
+  bool is_rebuild = !is_pattern_valid_ || pattern_ != &A;
+  is_last_merge_patch_ = false;
+  if (!is_rebuild) {
+    std::vector<std::vector<std::pair<int, int>>> missing(num_chunks_ + 1);
+    for (int chunk = 0; chunk < num_chunks_; ++chunk) {
+      missing[chunk].swap(chunk_states_[chunk].missing_entries);
+    }
+#pragma omp parallel for num_threads(num_chunks_) schedule(static, 1)
+    for (int block = 0; block < num_chunks_; ++block) {
+      for (auto &entry : tail_[block]) {
+        if (FindPosition(entry.row, entry.col) < 0) {
+          chunk_states_[block].missing_entries.emplace_back(entry.row, entry.col);
+        }
+      }
+    }
+    for (int block = 0; block < num_chunks_; ++block) {
+      auto &tail_missing = chunk_states_[block].missing_entries;
+      missing[num_chunks_].insert(
+          missing[num_chunks_].end(), tail_missing.begin(), tail_missing.end()
+      );
+      tail_missing.clear();
+    }
+    std::vector<std::pair<int, int>> missing_entries;
+    for (auto &entries : missing) {
+      missing_entries.insert(
+          missing_entries.end(), entries.begin(), entries.end()
+      );
+    }
+    if (!missing_entries.empty()) {
+      PatchStructure(missing_entries);
+      is_last_merge_patch_ = true;
+    }
+  }
+  if (!is_rebuild) {
+    std::vector<char> is_refreshed(num_chunks_, 0);
+#pragma omp parallel for num_threads(num_chunks_) schedule(static, 1)
+    for (int block = 0; block < num_chunks_; ++block) {
+      is_refreshed[block] = RefreshRowBlock(block);
+    }
+    for (auto refreshed : is_refreshed) {
+      is_rebuild = is_rebuild || !refreshed;
+    }
+  }
+  if (is_rebuild) {
+    RebuildMatrix(A);
+  }
+  is_last_merge_rebuild_ = is_rebuild;
+}
+
+/****
+ * @brief Insert missing entries into the existing structure, and remove
+ * entries no longer used by anyone. Rows are moved to their new places, and
+ * recorded positions are moved accordingly. No sorting is needed, because
+ * existing rows are already sorted. Values are left for RefreshRowBlock() to
+ * fill.
+ *
+ * @param missing_entries: (row, column) of entries not in the structure
+ */
+void ParallelAssembler::PatchStructure(
+    std::vector<std::pair<int, int>> &missing_entries
+) {
+  std::sort(missing_entries.begin(), missing_entries.end());
+  missing_entries.erase(
+      std::unique(missing_entries.begin(), missing_entries.end()),
+      missing_entries.end()
+  );
+  int num_missing = static_cast<int>(missing_entries.size());
+
+  SpMat &A = *pattern_;
+  int old_nnz = static_cast<int>(A.nonZeros());
+  old_outer_index_.assign(A.outerIndexPtr(), A.outerIndexPtr() + dim_ + 1);
+  old_inner_index_.assign(A.innerIndexPtr(), A.innerIndexPtr() + old_nnz);
+  // position_map_ first marks entries still in use, then maps them to their
+  // new positions, and entries not in use are mapped to -1
+  position_map_.assign(old_nnz, -1);
+  std::vector<int> missing_offsets(num_chunks_ + 1, 0);
+  std::vector<int> block_nnz(num_chunks_ + 1, 0);
+#pragma omp parallel for num_threads(num_chunks_) schedule(static, 1)
+  for (int block = 0; block < num_chunks_; ++block) {
+    int lo = block * rows_per_block_;
+    int hi = std::min(dim_, lo + rows_per_block_);
+    if (lo >= hi) continue;
+    for (int chunk = 0; chunk < num_chunks_; ++chunk) {
+      for (auto &entry : coefficients_[chunk][block]) {
+        int pos = entry.slot >= 0 ?
+                  positions_[entry.slot] : FindPosition(entry.row, entry.col);
+        if (pos >= 0) {
+          position_map_[pos] = 0;
+        }
+      }
+    }
+    for (auto &entry : tail_[block]) {
+      int pos = FindPosition(entry.row, entry.col);
+      if (pos >= 0) {
+        position_map_[pos] = 0;
+      }
+    }
+    int used_cnt = 0;
+    for (int row = lo; row < hi; ++row) {
+      position_map_[FindPosition(row, row)] = 0;
+    }
+    for (int pos = old_outer_index_[lo]; pos < old_outer_index_[hi]; ++pos) {
+      used_cnt += position_map_[pos] + 1;
+    }
+    missing_offsets[block] = static_cast<int>(
+        std::lower_bound(
+            missing_entries.begin(),
+            missing_entries.end(),
+            std::make_pair(lo, INT_MIN)
+        ) - missing_entries.begin()
+    );
+    block_nnz[block + 1] = used_cnt;
+  }
+  missing_offsets[num_chunks_] = num_missing;
+  for (int block = 0; block < num_chunks_; ++block) {
+    // blocks without rows do not set their offsets in the loop above
+    if (block * rows_per_block_ >= dim_) {
+      missing_offsets[block] = num_missing;
+    }
+  }
+  for (int block = 0; block < num_chunks_; ++block) {
+    block_nnz[block + 1] += block_nnz[block]
+        + missing_offsets[block + 1] - missing_offsets[block];
+  }
+
+  int nnz = block_nnz[num_chunks_];
+  A.resizeNonZeros(nnz);
+  int *outer_index = A.outerIndexPtr();
+  int *inner_index = A.innerIndexPtr();
+#pragma omp parallel for num_threads(num_chunks_) schedule(static, 1)
+  for (int block = 0; block < num_chunks_; ++block) {
+    int lo = block * rows_per_block_;
+    int hi = std::min(dim_, lo + rows_per_block_);
+    int new_pos = block_nnz[block];
+    int k = missing_offsets[block];
+    for (int row = lo; row < hi; ++row) {
+      outer_index[row] = new_pos;
+      int pos = old_outer_index_[row];
+      int pos_end = old_outer_index_[row + 1];
+      while (pos < pos_end
+          || (k < num_missing && missing_entries[k].first == row)) {
+        bool is_insert = k < num_missing && missing_entries[k].first == row
+            && (pos >= pos_end || missing_entries[k].second < old_inner_index_[pos]);
+        if (is_insert) {
+          inner_index[new_pos++] = missing_entries[k++].second;
+        } else {
+          if (position_map_[pos] >= 0) {
+            inner_index[new_pos] = old_inner_index_[pos];
+            position_map_[pos] = new_pos++;
+          }
+          ++pos;
+        }
+      }
+    }
+  }
+  outer_index[dim_] = nnz;
+
+  int num_slots = static_cast<int>(positions_.size());
+#pragma omp parallel for num_threads(num_chunks_)
+  for (int slot = 0; slot < num_slots; ++slot) {
+    if (positions_[slot] >= 0) {
+      positions_[slot] = position_map_[positions_[slot]];
+    }
+  }
+}
+
+/****
+ * @brief Rewrite values of rows in the given row block, assuming the matrix
+ * structure does not change.
+ *
+ * @return false if an entry cannot be found in the current structure.
+ */
+bool ParallelAssembler::RefreshRowBlock(int block) {
+  int lo = block * rows_per_block_;
+  int hi = std::min(dim_, lo + rows_per_block_);
+  if (lo >= hi) return true;
+  int const *outer_index = pattern_->outerIndexPtr();
+  double *values = pattern_->valuePtr();
+  std::fill(values + outer_index[lo], values + outer_index[hi], 0.0);
+  for (int chunk = 0; chunk < num_chunks_; ++chunk) {
+    for (auto &entry : coefficients_[chunk][block]) {
+      int pos = entry.slot >= 0 ? positions_[entry.slot] : -1;
+      if (pos < 0) {
+        // entries just inserted into the structure, or not in any group
+        pos = FindPosition(entry.row, entry.col);
+        if (pos < 0) return false;
+        if (entry.slot >= 0) {
+          positions_[entry.slot] = pos;
+        }
+      }
+      values[pos] += entry.value;
+    }
+  }
+  for (auto &entry : tail_[block]) {
+    int pos = FindPosition(entry.row, entry.col);
+    if (pos < 0) return false;
+    values[pos] += entry.value;
+  }
+  return true;
+}
+
+/****
+ * @brief Build the matrix structure and values from scratch, and record
+ * positions of all entries emitted by groups.
+ */
+void ParallelAssembler::RebuildMatrix(SpMat &A) {
+  // positions not emitted this time become invalid
+  std::fill(positions_.begin(), positions_.end(), -1);
+#pragma omp parallel for num_threads(num_chunks_) schedule(static, 1)
+  for (int block = 0; block < num_chunks_; ++block) {
+    BuildRowBlock(block);
+  }
+
+  std::vector<int> block_offsets(num_chunks_ + 1, 0);
+  for (int block = 0; block < num_chunks_; ++block) {
+    block_offsets[block + 1] = block_offsets[block]
+        + static_cast<int>(row_blocks_[block].out_cols.size());
+  }
+  int nnz = block_offsets[num_chunks_];
+  A.makeCompressed();
+  A.resizeNonZeros(nnz);
+  int *outer_index = A.outerIndexPtr();
+  int *inner_index = A.innerIndexPtr();
+  double *values = A.valuePtr();
+
+#pragma omp parallel for num_threads(num_chunks_) schedule(static, 1)
+  for (int block = 0; block < num_chunks_; ++block) {
+    RowBlockBuffer &buffer = row_blocks_[block];
+    int lo = block * rows_per_block_;
+    int hi = std::min(dim_, lo + rows_per_block_);
+    int offset = block_offsets[block];
+    for (int i = lo; i < hi; ++i) {
+      outer_index[i] = offset + buffer.out_row_ptr[i - lo];
+    }
+    size_t cnt = buffer.out_cols.size();
+    if (cnt > 0) {
+      std::memcpy(inner_index + offset, buffer.out_cols.data(), cnt * sizeof(int));
+      std::memcpy(values + offset, buffer.out_vals.data(), cnt * sizeof(double));
+    }
+    for (auto &entry : buffer.entries) {
+      if (entry.slot >= 0) {
+        positions_[entry.slot] += offset;
+      }
+    }
+  }
+  outer_index[dim_] = nnz;
+
+  pattern_ = &A;
+  is_pattern_valid_ = true;
+}
+
+/****
+ * @brief Build rows in the given row block. Entries are first distributed to
+ * their rows using a stable counting sort, then each row is stably sorted by
+ * column index, and duplicated entries are summed up in their original order.
+ *
+ * Every row gets a diagonal entry, even if its value is zero, so that entries
+ * added to the diagonal later on never change the structure.
+ */
+void ParallelAssembler::BuildRowBlock(int block) {
+  RowBlockBuffer &buffer = row_blocks_[block];
+  int lo = block * rows_per_block_;
+  int hi = std::min(dim_, lo + rows_per_block_);
+  int num_rows = std::max(0, hi - lo);
+
+  buffer.row_ptr.assign(num_rows + 1, 0);
+  for (int chunk = 0; chunk < num_chunks_; ++chunk) {
+    for (auto &entry : coefficients_[chunk][block]) {
+      ++buffer.row_ptr[entry.row - lo + 1];
+    }
+  }
+  for (auto &entry : tail_[block]) {
+    ++buffer.row_ptr[entry.row - lo + 1];
+  }
+  for (int i = 0; i < num_rows; ++i) {
+    buffer.row_ptr[i + 1] += buffer.row_ptr[i];
+  }
+
+  // the output cursor of each row, out_row_ptr is reused as scratch space here
+  buffer.entries.clear();
+  buffer.entries.resize(buffer.row_ptr[num_rows], Entry(0, 0, -1, 0));
+  buffer.out_row_ptr.assign(buffer.row_ptr.begin(), buffer.row_ptr.end());
+  for (int chunk = 0; chunk < num_chunks_; ++chunk) {
+    for (auto &entry : coefficients_[chunk][block]) {
+      buffer.entries[buffer.out_row_ptr[entry.row - lo]++] = entry;
+    }
+  }
+  for (auto &entry : tail_[block]) {
+    buffer.entries[buffer.out_row_ptr[entry.row - lo]++] = entry;
+  }
+
+  buffer.out_cols.clear();
+  buffer.out_vals.clear();
+  auto col_less = [](Entry const &lhs, Entry const &rhs) {
+    return lhs.col < rhs.col;
+  };
+  for (int i = 0; i < num_rows; ++i) {
+    int row = lo + i;
+    int row_begin = static_cast<int>(buffer.out_cols.size());
+    buffer.out_row_ptr[i] = row_begin;
+    auto begin = buffer.entries.begin() + buffer.row_ptr[i];
+    auto end = buffer.entries.begin() + buffer.row_ptr[i + 1];
+    std::stable_sort(begin, end, col_less);
+    bool is_diagonal_added = false;
+    for (auto it = begin; it != end; ++it) {
+      if (!is_diagonal_added && it->col >= row) {
+        if (it->col > row) {
+          buffer.out_cols.push_back(row);
+          buffer.out_vals.push_back(0);
+        }
+        is_diagonal_added = true;
+      }
+      int last = static_cast<int>(buffer.out_cols.size()) - 1;
+      if (last >= row_begin && buffer.out_cols[last] == it->col) {
+        buffer.out_vals[last] += it->value;
+      } else {
+        buffer.out_cols.push_back(it->col);
+        buffer.out_vals.push_back(it->value);
+      }
+      if (it->slot >= 0) {
+        // the offset of this row block is added once all blocks are built
+        positions_[it->slot] = static_cast<int>(buffer.out_cols.size()) - 1;
+      }
+    }
+    if (!is_diagonal_added) {
+      buffer.out_cols.push_back(row);
+      buffer.out_vals.push_back(0);
+    }
+  }
+  buffer.out_row_ptr[num_rows] = static_cast<int>(buffer.out_cols.size());
+}
+
+}
@@ -0,0 +1,138 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef DALI_PLACER_GLOBAL_PLACER_PARALLEL_ASSEMBLER_H_
+#define DALI_PLACER_GLOBAL_PLACER_PARALLEL_ASSEMBLER_H_
+
+#include <utility>
+#include <vector>
+
+#include <Eigen/Sparse>
+
+namespace dali {
+
+// declares a row-major sparse matrix type of double
+typedef Eigen::SparseMatrix<double, Eigen::RowMajor> SpMat;
+
+/****
+ * @brief Assembles a sparse linear system Ax = b using multiple threads.
+ *
+ * The input is split into contiguous chunks, one chunk per thread. Each chunk
+ * has its own buffers for matrix entries and right-hand-side contributions,
+ * and these buffers are further bucketed by the row block the entry falls in.
+ * During the merge, each row block is built by one thread, which visits the
+ * buckets in chunk order. Duplicated entries are thus summed in the same
+ * order as a serial pass over the input would do, so the values are
+ * bit-identical to the ones given by SpMat::setFromTriplets() regardless of
+ * the number of threads. The structure differs in one way: every row has an
+ * explicit diagonal entry, which is zero if nothing is added to it, so that
+ * the position of diagonal entries never changes between two assemblies.
+ *
+ * The compressed-row structure is kept between two assemblies. Entries can be
+ * emitted in groups (e.g., all entries of a net), and each group has a key.
+ * If the key of a group does not change, its entries go to the same places in
+ * valuePtr() as last time, and the merge only rewrites values. Only groups
+ * with a new key look up their entries in the existing structure, and the
+ * structure is patched only if some entries cannot be found.
+ */
+class ParallelAssembler {
+ public:
+  ParallelAssembler() = default;
+
+  void Initialize(int dim, int num_chunks);
+  void InitializeGroups(std::vector<int> const &capacities);
+  int NumChunks() const { return num_chunks_; }
+  void Clear();
+
+  void BeginGroup(int chunk, int group, int key0, int key1);
+  void EndGroup(int chunk);
+  void AddCoefficient(int chunk, int row, int col, double value);
+  void AddRhs(int chunk, int row, double value) {
+    rhs_[chunk][RowBlock(row)].emplace_back(row, value);
+  }
+
+  void MergeRhs(Eigen::VectorXd &b);
+  void MergeMatrix(std::vector<Eigen::Triplet<double>> const &tail, SpMat &A);
+  bool IsLastMergeRebuild() const { return is_last_merge_rebuild_; }
+  bool IsLastMergePatch() const { return is_last_merge_patch_; }
+ private:
+  int dim_ = 0;
+  int num_chunks_ = 0;
+  int rows_per_block_ = 1;
+  int RowBlock(int row) const { return row / rows_per_block_; }
+
+  // a matrix entry, slot is its index in positions_, or -1 if not in a group
+  struct Entry {
+    int row;
+    int col;
+    int slot;
+    double value;
+    Entry(int row_init, int col_init, int slot_init, double value_init)
+        : row(row_init), col(col_init), slot(slot_init), value(value_init) {}
+  };
+  // buffers indexed by [chunk][row block]
+  std::vector<std::vector<std::vector<Entry>>> coefficients_;
+  std::vector<std::vector<std::vector<std::pair<int, double>>>> rhs_;
+  // entries appended after all chunks, indexed by row block
+  std::vector<std::vector<Entry>> tail_;
+
+  /**** persistent compressed-row structure ****/
+  // the matrix built by the last merge, whose structure can be reused
+  SpMat *pattern_ = nullptr;
+  bool is_pattern_valid_ = false;
+  bool is_last_merge_rebuild_ = true;
+  bool is_last_merge_patch_ = false;
+  // each group owns a range of slots in positions_
+  std::vector<int> group_offsets_;
+  std::vector<std::pair<int, int>> group_keys_;
+  // positions in valuePtr() of entries emitted by groups
+  std::vector<int> positions_;
+  // the group each chunk is currently emitting entries for
+  struct ChunkState {
+    int slot = -1;
+    int slot_end = -1;
+    bool is_key_changed = false;
+    // (row, column) of entries not in the current structure
+    std::vector<std::pair<int, int>> missing_entries;
+  };
+  std::vector<ChunkState> chunk_states_;
+  int FindPosition(int row, int col) const;
+
+  // scratch space for building one row block of the compressed-row matrix
+  struct RowBlockBuffer {
+    std::vector<int> row_ptr;
+    std::vector<Entry> entries;
+    std::vector<int> out_row_ptr;
+    std::vector<int> out_cols;
+    std::vector<double> out_vals;
+  };
+  std::vector<RowBlockBuffer> row_blocks_;
+  void BuildRowBlock(int block);
+  bool RefreshRowBlock(int block);
+  void RebuildMatrix(SpMat &A);
+  std::vector<int> old_outer_index_;
+  std::vector<int> old_inner_index_;
+  std::vector<int> position_map_;
+  void PatchStructure(std::vector<std::pair<int, int>> &missing_entries);
+};
+
+}
+
+#endif //DALI_PLACER_GLOBAL_PLACER_PARALLEL_ASSEMBLER_H_
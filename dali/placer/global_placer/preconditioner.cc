@@ -0,0 +1,432 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "preconditioner.h"
+
+#include <cmath>
+
+#include <omp.h>
+
+#include "dali/common/logging.h"
+
+namespace dali {
+
+void ParallelSpMV(
+    SpMat const &A,
+    Eigen::VectorXd const &x,
+    Eigen::VectorXd &y,
+    int num_threads
+) {
+  int sz = static_cast<int>(A.rows());
+  int const *outer_index = A.outerIndexPtr();
+  int const *inner_index = A.innerIndexPtr();
+  double const *values = A.valuePtr();
+#pragma omp parallel for num_threads(num_threads) schedule(static)
+  for (int i = 0; i < sz; ++i) {
+    double sum = 0;
+    for (int k = outer_index[i]; k < outer_index[i + 1]; ++k) {
+      sum += values[k] * x[inner_index[k]];
+    }
+    y[i] = sum;
+  }
+}
+
+void Preconditioner::SetNumThreads(int num_threads) {
+  DaliExpects(num_threads >= 1, "Number of threads less than 1?");
+  num_threads_ = num_threads;
+}
+
+void JacobiPreconditioner::Compute(
+    SpMat const &A,
+    [[maybe_unused]] bool is_structure_changed
+) {
+  int sz = static_cast<int>(A.rows());
+  inv_diag_.resize(sz);
+#pragma omp parallel for num_threads(num_threads_) schedule(static)
+  for (int i = 0; i < sz; ++i) {
+    inv_diag_[i] = 1;
+    for (SpMat::InnerIterator it(A, i); it; ++it) {
+      if (it.index() == i) {
+        if (it.value() != 0) {
+          inv_diag_[i] = 1.0 / it.value();
+        }
+        break;
+      }
+    }
+  }
+}
+
+void JacobiPreconditioner::Apply(
+    Eigen::VectorXd const &r,
+    Eigen::VectorXd &z
+) const {
+  int sz = static_cast<int>(r.size());
+#pragma omp parallel for num_threads(num_threads_) schedule(static)
+  for (int i = 0; i < sz; ++i) {
+    z[i] = inv_diag_[i] * r[i];
+  }
+}
+
+/****
+ * @brief Build the sparsity pattern of L from the lower triangular part of A.
+ * Rows of a compressed-row matrix are sorted, so the diagonal entry is the
+ * last entry of each row of L.
+ */
+void Ic0Preconditioner::AnalyzePattern(SpMat const &A) {
+  int sz = static_cast<int>(A.rows());
+  outer_index_.assign(sz + 1, 0);
+  inner_index_.clear();
+  source_positions_.clear();
+  int const *a_outer_index = A.outerIndexPtr();
+  int const *a_inner_index = A.innerIndexPtr();
+  for (int i = 0; i < sz; ++i) {
+    bool is_diagonal_found = false;
+    for (int k = a_outer_index[i]; k < a_outer_index[i + 1]; ++k) {
+      int col = a_inner_index[k];
+      if (col > i) break;
+      inner_index_.push_back(col);
+      source_positions_.push_back(k);
+      is_diagonal_found = (col == i);
+    }
+    if (!is_diagonal_found) {
+      // a row without diagonal entry, its diagonal in L is set to 1 later
+      inner_index_.push_back(i);
+      source_positions_.push_back(-1);
+    }
+    outer_index_[i + 1] = static_cast<int>(inner_index_.size());
+  }
+  values_.resize(inner_index_.size());
+  work_.resize(sz);
+}
+
+/****
+ * @brief Row-oriented IC(0) factorization. For each entry L_ik in row i,
+ *   L_ik = (a_ik - sum_{j<k} L_ij * L_kj) / L_kk,
+ *   L_ii = sqrt(a_ii - sum_{j<i} L_ij^2).
+ * If a non-positive pivot shows up, the diagonal of A is used instead, which
+ * keeps the preconditioner positive definite.
+ */
+void Ic0Preconditioner::Compute(SpMat const &A, bool is_structure_changed) {
+  if (is_structure_changed
+      || static_cast<int>(outer_index_.size()) != A.rows() + 1) {
+    AnalyzePattern(A);
+  }
+  double const *a_values = A.valuePtr();
+  size_t nnz = values_.size();
+  for (size_t k = 0; k < nnz; ++k) {
+    values_[k] = source_positions_[k] >= 0 ? a_values[source_positions_[k]] : 1;
+  }
+
+  int sz = static_cast<int>(A.rows());
+  for (int i = 0; i < sz; ++i) {
+    int row_begin = outer_index_[i];
+    int diag_pos = outer_index_[i + 1] - 1;
+    for (int p = row_begin; p < diag_pos; ++p) {
+      int k = inner_index_[p];
+      // sparse dot product of row i and row k, both restricted to columns < k
+      double sum = 0;
+      int pi = row_begin;
+      int pk = outer_index_[k];
+      int pk_end = outer_index_[k + 1] - 1;
+      while (pi < p && pk < pk_end) {
+        int ci = inner_index_[pi];
+        int ck = inner_index_[pk];
+        if (ci == ck) {
+          sum += values_[pi++] * values_[pk++];
+        } else if (ci < ck) {
+          ++pi;
+        } else {
+          ++pk;
+        }
+      }
+      values_[p] = (values_[p] - sum) / values_[pk_end];
+    }
+    double diag = values_[diag_pos];
+    double sum = 0;
+    for (int p = row_begin; p < diag_pos; ++p) {
+      sum += values_[p] * values_[p];
+    }
+    double pivot = diag - sum;
+    if (pivot > 0) {
+      values_[diag_pos] = std::sqrt(pivot);
+    } else {
+      values_[diag_pos] = diag > 0 ? std::sqrt(diag) : 1;
+    }
+  }
+}
+
+/****
+ * @brief Solve L * y = r, then L^T * z = y. Both triangular solves are
+ * sequential.
+ */
+void Ic0Preconditioner::Apply(
+    Eigen::VectorXd const &r,
+    Eigen::VectorXd &z
+) const {
+  int sz = static_cast<int>(r.size());
+  for (int i = 0; i < sz; ++i) {
+    double sum = r[i];
+    int diag_pos = outer_index_[i + 1] - 1;
+    for (int p = outer_index_[i]; p < diag_pos; ++p) {
+      sum -= values_[p] * work_[inner_index_[p]];
+    }
+    work_[i] = sum / values_[diag_pos];
+  }
+  for (int i = sz - 1; i >= 0; --i) {
+    int diag_pos = outer_index_[i + 1] - 1;
+    double zi = work_[i] / values_[diag_pos];
+    z[i] = zi;
+    for (int p = outer_index_[i]; p < diag_pos; ++p) {
+      work_[inner_index_[p]] -= values_[p] * zi;
+    }
+  }
+}
+
+SpMat const &AmgPreconditioner::LevelMatrix(size_t level) const {
+  return level == 0 ? *fine_matrix_ : levels_[level].A;
+}
+
+/****
+ * @brief Greedy aggregation based on strong connections.
+ *   1. a row whose strong neighbors are all free forms a new aggregate with
+ *   these neighbors;
+ *   2. a remaining row joins the aggregate of one of its strong neighbors;
+ *   3. rows still left form new aggregates with their free strong neighbors.
+ */
+void AmgPreconditioner::Aggregate(SpMat const &A, Level &level) const {
+  int sz = static_cast<int>(A.rows());
+  Eigen::VectorXd diag = Eigen::VectorXd::Zero(sz);
+  for (int i = 0; i < sz; ++i) {
+    for (SpMat::InnerIterator it(A, i); it; ++it) {
+      if (it.index() == i) {
+        diag[i] = std::fabs(it.value());
+        break;
+      }
+    }
+  }
+  auto is_strong = [&](int i, int j, double value) {
+    return j != i && value < 0
+        && -value >= strength_threshold_ * std::sqrt(diag[i] * diag[j]);
+  };
+
+  std::vector<int> &aggregates = level.aggregates;
+  aggregates.assign(sz, -1);
+  int num_aggregates = 0;
+  for (int i = 0; i < sz; ++i) {
+    if (aggregates[i] >= 0) continue;
+    bool is_free = true;
+    for (SpMat::InnerIterator it(A, i); it; ++it) {
+      int j = static_cast<int>(it.index());
+      if (is_strong(i, j, it.value()) && aggregates[j] >= 0) {
+        is_free = false;
+        break;
+      }
+    }
+    if (!is_free) continue;
+    aggregates[i] = num_aggregates;
+    for (SpMat::InnerIterator it(A, i); it; ++it) {
+      int j = static_cast<int>(it.index());
+      if (is_strong(i, j, it.value())) {
+        aggregates[j] = num_aggregates;
+      }
+    }
+    ++num_aggregates;
+  }
+
+  std::vector<int> tentative(aggregates);
+  for (int i = 0; i < sz; ++i) {
+    if (aggregates[i] >= 0) continue;
+    for (SpMat::InnerIterator it(A, i); it; ++it) {
+      int j = static_cast<int>(it.index());
+      if (is_strong(i, j, it.value()) && tentative[j] >= 0) {
+        aggregates[i] = tentative[j];
+        break;
+      }
+    }
+  }
+
+  for (int i = 0; i < sz; ++i) {
+    if (aggregates[i] >= 0) continue;
+    aggregates[i] = num_aggregates;
+    for (SpMat::InnerIterator it(A, i); it; ++it) {
+      int j = static_cast<int>(it.index());
+      if (is_strong(i, j, it.value()) && aggregates[j] < 0) {
+        aggregates[j] = num_aggregates;
+      }
+    }
+    ++num_aggregates;
+  }
+  level.num_aggregates = num_aggregates;
+
+  // rows in each aggregate, used by the restriction
+  level.member_offsets.assign(num_aggregates + 1, 0);
+  for (int i = 0; i < sz; ++i) {
+    ++level.member_offsets[aggregates[i] + 1];
+  }
+  for (int a = 0; a < num_aggregates; ++a) {
+    level.member_offsets[a + 1] += level.member_offsets[a];
+  }
+  level.members.resize(sz);
+  std::vector<int> cursor(
+      level.member_offsets.begin(), level.member_offsets.end() - 1
+  );
+  for (int i = 0; i < sz; ++i) {
+    level.members[cursor[aggregates[i]]++] = i;
+  }
+}
+
+/****
+ * @brief Build the multigrid hierarchy. The coarse matrix of each level is
+ * the Galerkin product P^T * A * P, where P is the piecewise constant
+ * prolongation defined by aggregates. If the structure of A does not change,
+ * aggregates are reused and only coarse matrices are recomputed.
+ */
+void AmgPreconditioner::Compute(SpMat const &A, bool is_structure_changed) {
+  fine_matrix_ = &A;
+  if (is_structure_changed || !is_aggregated_) {
+    levels_.clear();
+    // references to levels are kept during the setup
+    levels_.reserve(max_num_levels_);
+  }
+  if (levels_.empty()) {
+    levels_.emplace_back();
+    is_aggregated_ = false;
+  }
+
+  size_t level = 0;
+  while (true) {
+    SpMat const &mat = LevelMatrix(level);
+    int sz = static_cast<int>(mat.rows());
+    Level &cur = levels_[level];
+    cur.inv_diag.resize(sz);
+    for (int i = 0; i < sz; ++i) {
+      cur.inv_diag[i] = 1;
+      for (SpMat::InnerIterator it(mat, i); it; ++it) {
+        if (it.index() == i) {
+          if (it.value() != 0) {
+            cur.inv_diag[i] = 1.0 / it.value();
+          }
+          break;
+        }
+      }
+    }
+    cur.b.resize(sz);
+    cur.x.resize(sz);
+    cur.r.resize(sz);
+
+    bool is_coarsest = sz <= coarsest_size_
+        || static_cast<int>(level) + 1 >= max_num_levels_;
+    if (!is_coarsest && !is_aggregated_) {
+      Aggregate(mat, cur);
+      // stop coarsening if aggregation does not reduce the size much
+      is_coarsest = cur.num_aggregates > 0.9 * sz;
+      if (!is_coarsest && levels_.size() == level + 1) {
+        levels_.emplace_back();
+      }
+    } else if (!is_coarsest) {
+      is_coarsest = levels_.size() == level + 1;
+    }
+    if (is_coarsest) {
+      levels_.resize(level + 1);
+      // a row without any connection has a zero diagonal, which is set to 1
+      // to keep the coarsest matrix non-singular
+      Eigen::SparseMatrix<double> coarsest_matrix = mat;
+      for (int i = 0; i < sz; ++i) {
+        if (coarsest_matrix.coeff(i, i) == 0) {
+          coarsest_matrix.coeffRef(i, i) = 1;
+        }
+      }
+      coarsest_solver_.compute(coarsest_matrix);
+      break;
+    }
+
+    std::vector<Eigen::Triplet<double>> triplets;
+    triplets.reserve(mat.nonZeros());
+    for (int i = 0; i < sz; ++i) {
+      for (SpMat::InnerIterator it(mat, i); it; ++it) {
+        triplets.emplace_back(
+            cur.aggregates[i], cur.aggregates[it.index()], it.value()
+        );
+      }
+    }
+    Level &next = levels_[level + 1];
+    next.A.resize(cur.num_aggregates, cur.num_aggregates);
+    next.A.setFromTriplets(triplets.begin(), triplets.end());
+    ++level;
+  }
+  is_aggregated_ = true;
+}
+
+/****
+ * @brief One V-cycle starting from a zero initial guess, solving
+ * A * x = b of the given level approximately.
+ */
+void AmgPreconditioner::VCycle(size_t level) const {
+  Level &cur = levels_[level];
+  if (level + 1 == levels_.size()) {
+    cur.x = coarsest_solver_.solve(cur.b);
+    return;
+  }
+  SpMat const &mat = LevelMatrix(level);
+  int sz = static_cast<int>(mat.rows());
+  double weight = jacobi_weight_;
+
+  // pre-smoothing from zero: x = w * D^-1 * b
+#pragma omp parallel for num_threads(num_threads_) schedule(static)
+  for (int i = 0; i < sz; ++i) {
+    cur.x[i] = weight * cur.inv_diag[i] * cur.b[i];
+  }
+  ParallelSpMV(mat, cur.x, cur.r, num_threads_);
+
+  // restriction of the residual
+  Level &next = levels_[level + 1];
+#pragma omp parallel for num_threads(num_threads_) schedule(static)
+  for (int a = 0; a < cur.num_aggregates; ++a) {
+    double sum = 0;
+    for (int k = cur.member_offsets[a]; k < cur.member_offsets[a + 1]; ++k) {
+      int i = cur.members[k];
+      sum += cur.b[i] - cur.r[i];
+    }
+    next.b[a] = sum;
+  }
+  VCycle(level + 1);
+
+  // prolongation of the correction, followed by post-smoothing
+#pragma omp parallel for num_threads(num_threads_) schedule(static)
+  for (int i = 0; i < sz; ++i) {
+    cur.x[i] += next.x[cur.aggregates[i]];
+  }
+  ParallelSpMV(mat, cur.x, cur.r, num_threads_);
+#pragma omp parallel for num_threads(num_threads_) schedule(static)
+  for (int i = 0; i < sz; ++i) {
+    cur.x[i] += weight * cur.inv_diag[i] * (cur.b[i] - cur.r[i]);
+  }
+}
+
+void AmgPreconditioner::Apply(
+    Eigen::VectorXd const &r,
+    Eigen::VectorXd &z
+) const {
+  levels_[0].b = r;
+  VCycle(0);
+  z = levels_[0].x;
+}
+
+}
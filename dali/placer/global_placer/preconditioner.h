@@ -0,0 +1,137 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef DALI_PLACER_GLOBAL_PLACER_PRECONDITIONER_H_
+#define DALI_PLACER_GLOBAL_PLACER_PRECONDITIONER_H_
+
+#include <vector>
+
+#include <Eigen/Dense>
+#include <Eigen/Sparse>
+#include <Eigen/SparseCholesky>
+
+namespace dali {
+
+// declares a row-major sparse matrix type of double
+typedef Eigen::SparseMatrix<double, Eigen::RowMajor> SpMat;
+
+// computes y = A * x using multiple threads
+void ParallelSpMV(
+    SpMat const &A,
+    Eigen::VectorXd const &x,
+    Eigen::VectorXd &y,
+    int num_threads
+);
+
+/****
+ * This is an abstract class defining the interface of all preconditioners
+ * used by the conjugate gradient solver. A preconditioner approximates the
+ * inverse of a symmetric positive (semi-)definite matrix A.
+ */
+class Preconditioner {
+ public:
+  Preconditioner() = default;
+  virtual ~Preconditioner() = default;
+  void SetNumThreads(int num_threads);
+  // @param is_structure_changed: if false, only values of A are different
+  // from the last call, and setup work depending on the structure is reused
+  virtual void Compute(SpMat const &A, bool is_structure_changed) = 0;
+  // computes z = M^-1 * r
+  virtual void Apply(Eigen::VectorXd const &r, Eigen::VectorXd &z) const = 0;
+ protected:
+  int num_threads_ = 1;
+};
+
+/****
+ * Jacobi preconditioner, the same as Eigen::DiagonalPreconditioner.
+ */
+class JacobiPreconditioner : public Preconditioner {
+ public:
+  void Compute(SpMat const &A, bool is_structure_changed) override;
+  void Apply(Eigen::VectorXd const &r, Eigen::VectorXd &z) const override;
+ private:
+  Eigen::VectorXd inv_diag_;
+};
+
+/****
+ * Incomplete Cholesky factorization with zero fill-in, A ~ L * L^T, where L
+ * has the same sparsity pattern as the lower triangular part of A.
+ */
+class Ic0Preconditioner : public Preconditioner {
+ public:
+  void Compute(SpMat const &A, bool is_structure_changed) override;
+  void Apply(Eigen::VectorXd const &r, Eigen::VectorXd &z) const override;
+ private:
+  // L in compressed-row format, the diagonal entry is the last one of a row
+  std::vector<int> outer_index_;
+  std::vector<int> inner_index_;
+  std::vector<double> values_;
+  // positions of entries of L in valuePtr() of A
+  std::vector<int> source_positions_;
+  mutable Eigen::VectorXd work_;
+  void AnalyzePattern(SpMat const &A);
+};
+
+/****
+ * A simple algebraic multigrid preconditioner based on unsmoothed
+ * aggregation. One V-cycle with a damped Jacobi pre-smoothing and
+ * post-smoothing step is applied each time. The coarsest level is solved
+ * directly.
+ */
+class AmgPreconditioner : public Preconditioner {
+ public:
+  void Compute(SpMat const &A, bool is_structure_changed) override;
+  void Apply(Eigen::VectorXd const &r, Eigen::VectorXd &z) const override;
+ private:
+  struct Level {
+    SpMat A;
+    Eigen::VectorXd inv_diag;
+    // the aggregate each row belongs to, and rows in each aggregate
+    std::vector<int> aggregates;
+    std::vector<int> member_offsets;
+    std::vector<int> members;
+    int num_aggregates = 0;
+    // work vectors of the V-cycle
+    Eigen::VectorXd b;
+    Eigen::VectorXd x;
+    Eigen::VectorXd r;
+  };
+  // the finest level matrix is not copied
+  SpMat const *fine_matrix_ = nullptr;
+  mutable std::vector<Level> levels_;
+  Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> coarsest_solver_;
+  bool is_aggregated_ = false;
+
+  // two off-diagonal entries are strongly connected if
+  // -a_ij >= strength_threshold_ * sqrt(a_ii * a_jj)
+  double strength_threshold_ = 0.08;
+  // stop coarsening if a level has no more than this amount of rows
+  int coarsest_size_ = 500;
+  int max_num_levels_ = 10;
+  double jacobi_weight_ = 2.0 / 3.0;
+
+  SpMat const &LevelMatrix(size_t level) const;
+  void Aggregate(SpMat const &A, Level &level) const;
+  void VCycle(size_t level) const;
+};
+
+}
+
+#endif //DALI_PLACER_GLOBAL_PLACER_PRECONDITIONER_H_
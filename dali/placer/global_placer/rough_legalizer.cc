@@ -20,8 +20,14 @@
  ******************************************************************************/
 #include "rough_legalizer.h"
 
+#include <algorithm>
+#include <list>
+
+#include <omp.h>
+
 #include "dali/common/elapsed_time.h"
 #include "dali/common/logging.h"
+#include "dali/common/profiler.h"
 
 #include "box_bin.h"
 
@@ -36,6 +42,29 @@ void RoughLegalizer::SetShouldSaveIntermediateResult(bool should_save_intermedia
   should_save_intermediate_result_ = should_save_intermediate_result;
 }
 
+/****
+ * @brief Restrict the overlap removal to the neighborhood of some blocks. Only
+ * grid bins within @param bin_halo bins of an active block can be marked as
+ * over-filled, so blocks far away from active blocks are not spread. This is
+ * used by incremental placement, in which only a few blocks are changed.
+ *
+ * @param is_blk_active: a flag for each block, an empty vector means all
+ * blocks are active.
+ * @param bin_halo: the number of grid bins around an active block
+ */
+void RoughLegalizer::SetActiveBlocks(
+    std::vector<bool> const &is_blk_active,
+    int bin_halo
+) {
+  DaliExpects(
+      is_blk_active.empty() || is_blk_active.size() == ckt_ptr_->Blocks().size(),
+      "The number of active block flags does not match the number of blocks"
+  );
+  DaliExpects(bin_halo >= 0, "Negative grid bin halo?");
+  is_blk_active_ = is_blk_active;
+  active_bin_halo_ = bin_halo;
+}
+
 /****
  * @brief determine the grid bin height and width
  * grid_bin_height and grid_bin_width is determined by the following formula:
@@ -56,8 +85,7 @@ void LookAheadLegalizer::InitializeGridBinSize() {
     << "  Global placement bin width, height: "
     << grid_bin_width << "  " << grid_bin_height << "\n";
 
-  std::vector<GridBin> temp_grid_bin_column(grid_cnt_y);
-  grid_bin_mesh.resize(grid_cnt_x, temp_grid_bin_column);
+  grid_bin_mesh.Init(grid_cnt_x, grid_cnt_y);
 }
 
 /****
@@ -192,10 +220,8 @@ void LookAheadLegalizer::InitGridBins() {
   UpdateFixedBlocksInGridBins();
 
   // update white spaces in grid bins
-  for (auto &grid_bin_column : grid_bin_mesh) {
-    for (auto &grid_bin : grid_bin_column) {
-      UpdateWhiteSpaceInGridBin(grid_bin);
-    }
+  for (auto &grid_bin : grid_bin_mesh.Bins()) {
+    UpdateWhiteSpaceInGridBin(grid_bin);
   }
 }
 
@@ -206,38 +232,7 @@ void LookAheadLegalizer::InitGridBins() {
 * when we want to find the white space in a region, the value can be easily extracted from the look-up table
 * ****/
 void LookAheadLegalizer::InitWhiteSpaceLUT() {
-  // this for loop is created to initialize the size of the loop-up table
-  std::vector<unsigned long long> tmp_vector(grid_cnt_y);
-  grid_bin_white_space_LUT.resize(grid_cnt_x, tmp_vector);
-
-  // this for loop is used for computing elements in the look-up table
-  // there are four cases, element at (0,0), elements on the left edge, elements on the right edge, otherwise
-  for (int kx = 0; kx < grid_cnt_x; ++kx) {
-    for (int ky = 0; ky < grid_cnt_y; ++ky) {
-      grid_bin_white_space_LUT[kx][ky] = 0;
-      if (kx == 0) {
-        if (ky == 0) {
-          grid_bin_white_space_LUT[kx][ky] = grid_bin_mesh[0][0].white_space;
-        } else {
-          grid_bin_white_space_LUT[kx][ky] =
-              grid_bin_white_space_LUT[kx][ky - 1]
-                  + grid_bin_mesh[kx][ky].white_space;
-        }
-      } else {
-        if (ky == 0) {
-          grid_bin_white_space_LUT[kx][ky] =
-              grid_bin_white_space_LUT[kx - 1][ky]
-                  + grid_bin_mesh[kx][ky].white_space;
-        } else {
-          grid_bin_white_space_LUT[kx][ky] =
-              grid_bin_white_space_LUT[kx - 1][ky]
-                  + grid_bin_white_space_LUT[kx][ky - 1]
-                  + grid_bin_mesh[kx][ky].white_space
-                  - grid_bin_white_space_LUT[kx - 1][ky - 1];
-        }
-      }
-    }
-  }
+  grid_bin_mesh.UpdateWhiteSpacePrefixSum();
 }
 
 void LookAheadLegalizer::Initialize(double placement_density) {
@@ -248,37 +243,62 @@ void LookAheadLegalizer::Initialize(double placement_density) {
   upper_bound_hpwl_.clear();
   InitGridBins();
   InitWhiteSpaceLUT();
+  blk_bin_ids_.assign(ckt_ptr_->Blocks().size(), -1);
 }
 
 void LookAheadLegalizer::ClearGridBinFlag() {
-  for (auto &bin_column : grid_bin_mesh) {
-    for (auto &bin : bin_column) bin.global_placed = false;
+  for (auto &bin : grid_bin_mesh.Bins()) bin.global_placed = false;
+}
+
+/****
+ * @brief Mark grid bins within active_bin_halo_ bins of the grid bins of active
+ * blocks. This function uses blk_bin_ids_, so it should be called after the
+ * block-to-bin assignment is updated.
+ */
+void LookAheadLegalizer::UpdateActiveGridBins() {
+  is_bin_active_.assign(grid_bin_mesh.Bins().size(), false);
+  int cnt_x = grid_bin_mesh.CntX();
+  int cnt_y = grid_bin_mesh.CntY();
+  int sz = static_cast<int>(is_blk_active_.size());
+  for (int i = 0; i < sz; ++i) {
+    if (!is_blk_active_[i] || blk_bin_ids_[i] < 0) continue;
+    int x = blk_bin_ids_[i] / cnt_y;
+    int y = blk_bin_ids_[i] % cnt_y;
+    int lo_x = std::max(x - active_bin_halo_, 0);
+    int hi_x = std::min(x + active_bin_halo_, cnt_x - 1);
+    int lo_y = std::max(y - active_bin_halo_, 0);
+    int hi_y = std::min(y + active_bin_halo_, cnt_y - 1);
+    for (int m = lo_x; m <= hi_x; ++m) {
+      for (int n = lo_y; n <= hi_y; ++n) {
+        is_bin_active_[grid_bin_mesh.BinId(m, n)] = true;
+      }
+    }
   }
 }
 
 /****
  * this is a member function to update grid bin status, because the cell_list,
  * cell_area and over_fill state can be changed, so we need to update them when necessary
+ *
+ * Only dirty grid bins are rebuilt. A grid bin is dirty if a block moves into
+ * or out of it since the last call, or if its cell_list is changed by the last
+ * round of block spreading. Blocks in a dirty bin are pushed in the order of
+ * their indices, so the result is the same as rebuilding all grid bins.
  * ****/
 void LookAheadLegalizer::UpdateGridBinState() {
   ElapsedTime elapsed_time;
   elapsed_time.RecordStartTime();
 
-  // clean the old data
-  for (auto &grid_bin_column : grid_bin_mesh) {
-    for (auto &grid_bin : grid_bin_column) {
-      grid_bin.cell_list.clear();
-      grid_bin.cell_area = 0;
-      grid_bin.over_fill = false;
-    }
-  }
-
   // for each cell, find the index of the grid bin it should be in.
   // note that in extreme cases, the index might be smaller than 0 or larger
   // than the maximum allowed index, because the cell is on the boundaries,
   // so we need to make some modifications for these extreme cases.
   std::vector<Block> &blocks = ckt_ptr_->Blocks();
   int sz = static_cast<int>(blocks.size());
+  DaliExpects(blk_bin_ids_.size() == blocks.size(),
+              "Block count changes after initialization?");
+  blk_new_bin_ids_.assign(sz, -1);
+  is_bin_dirty_.assign(grid_bin_mesh.Bins().size(), false);
   int x_index = 0;
   int y_index = 0;
 
@@ -293,8 +313,40 @@ void LookAheadLegalizer::UpdateGridBinState() {
     if (x_index > grid_cnt_x - 1) x_index = grid_cnt_x - 1;
     if (y_index < 0) y_index = 0;
     if (y_index > grid_cnt_y - 1) y_index = grid_cnt_y - 1;
-    grid_bin_mesh[x_index][y_index].cell_list.push_back(&(blocks[i]));
-    grid_bin_mesh[x_index][y_index].cell_area += blocks[i].Area();
+    int bin_id = grid_bin_mesh.BinId(x_index, y_index);
+    blk_new_bin_ids_[i] = bin_id;
+    if (bin_id != blk_bin_ids_[i]) {
+      if (blk_bin_ids_[i] >= 0) is_bin_dirty_[blk_bin_ids_[i]] = true;
+      is_bin_dirty_[bin_id] = true;
+    }
+  }
+  for (auto &window : grid_bin_mesh.ChangedWindows()) {
+    for (int x = window.first.x; x <= window.second.x; ++x) {
+      for (int y = window.first.y; y <= window.second.y; ++y) {
+        is_bin_dirty_[grid_bin_mesh.BinId(x, y)] = true;
+      }
+    }
+  }
+
+  // clean the old data in dirty grid bins, and then refill them
+  std::vector<GridBin> &bins = grid_bin_mesh.Bins();
+  int bin_cnt = static_cast<int>(bins.size());
+  for (int k = 0; k < bin_cnt; ++k) {
+    if (!is_bin_dirty_[k]) continue;
+    bins[k].cell_list.clear();
+    bins[k].cell_area = 0;
+  }
+  for (int i = 0; i < sz; i++) {
+    int bin_id = blk_new_bin_ids_[i];
+    if (bin_id < 0 || !is_bin_dirty_[bin_id]) continue;
+    bins[bin_id].cell_list.push_back(&(blocks[i]));
+    bins[bin_id].cell_area += blocks[i].Area();
+  }
+  blk_bin_ids_.swap(blk_new_bin_ids_);
+  grid_bin_mesh.UpdateCellAreaPrefixSum();
+  bool is_restricted = !is_blk_active_.empty();
+  if (is_restricted) {
+    UpdateActiveGridBins();
   }
 
   /**** below is the criterion to decide whether a grid bin is over_filled or not
@@ -305,38 +357,48 @@ void LookAheadLegalizer::UpdateGridBinState() {
    *    the TARGET_FILLING_RATE, then set is to over_fill
    * 3. if this bin is not overfilled, but cells in this bin overlaps with fixed
    *    blocks in this bin, we also mark it as over_fill
+   * the state of a clean grid bin without fixed blocks cannot change, so it
+   * is skipped. If active blocks are set, bins far away from them are never
+   * over_fill.
    * ****/
   //TODO: the third criterion might be changed in the next
   bool over_fill = false;
-  for (auto &grid_bin_column : grid_bin_mesh) {
-    for (auto &grid_bin : grid_bin_column) {
-      if (grid_bin.global_placed) {
-        grid_bin.over_fill = false;
-        continue;
+  for (int k = 0; k < bin_cnt; ++k) {
+    GridBin &grid_bin = bins[k];
+    if (is_restricted && !is_bin_active_[k]) {
+      grid_bin.over_fill = false;
+      continue;
+    }
+    // the state of a clean bin may change if it becomes active
+    if (!is_restricted && !is_bin_dirty_[k] && grid_bin.fixed_blocks.empty()) {
+      continue;
+    }
+    grid_bin.over_fill = false;
+    if (grid_bin.global_placed) {
+      continue;
+    }
+    if (grid_bin.IsAllFixedBlk()) {
+      if (!grid_bin.cell_list.empty()) {
+        grid_bin.over_fill = true;
       }
-      if (grid_bin.IsAllFixedBlk()) {
-        if (!grid_bin.cell_list.empty()) {
-          grid_bin.over_fill = true;
-        }
-      } else {
-        grid_bin.filling_rate =
-            double(grid_bin.cell_area) / double(grid_bin.white_space);
-        if (grid_bin.filling_rate > placement_density_) {
-          grid_bin.over_fill = true;
-        }
+    } else {
+      grid_bin.filling_rate =
+          double(grid_bin.cell_area) / double(grid_bin.white_space);
+      if (grid_bin.filling_rate > placement_density_) {
+        grid_bin.over_fill = true;
       }
-      if (!grid_bin.OverFill()) {
-        for (auto &blk_ptr : grid_bin.cell_list) {
-          for (auto &fixed_blk_ptr : grid_bin.fixed_blocks) {
-            over_fill = blk_ptr->IsOverlap(*fixed_blk_ptr);
-            if (over_fill) {
-              grid_bin.over_fill = true;
-              break;
-            }
+    }
+    if (!grid_bin.OverFill()) {
+      for (auto &blk_ptr : grid_bin.cell_list) {
+        for (auto &fixed_blk_ptr : grid_bin.fixed_blocks) {
+          over_fill = blk_ptr->IsOverlap(*fixed_blk_ptr);
+          if (over_fill) {
+            grid_bin.over_fill = true;
+            break;
           }
-          if (over_fill) break;
-          // two breaks have to be used to break two loops
         }
+        if (over_fill) break;
+        // two breaks have to be used to break two loops
       }
     }
   }
@@ -360,8 +422,8 @@ void LookAheadLegalizer::UpdateClusterList() {
   elapsed_time.RecordStartTime();
   cluster_set.clear();
 
-  int m = (int) grid_bin_mesh.size(); // number of rows
-  int n = (int) grid_bin_mesh[0].size(); // number of columns
+  int m = grid_bin_mesh.CntX(); // number of rows
+  int n = grid_bin_mesh.CntY(); // number of columns
   for (int i = 0; i < m; ++i) {
     for (int j = 0; j < n; ++j)
       grid_bin_mesh[i][j].cluster_visited = false;
@@ -482,76 +544,27 @@ void LookAheadLegalizer::UpdateLargestCluster() {
 
 unsigned long int LookAheadLegalizer::LookUpWhiteSpace(GridBinIndex const &ll_index,
                                                        GridBinIndex const &ur_index) {
-  /****
- * this function is used to return the white space in a region specified by ll_index, and ur_index
- * there are four cases, element at (0,0), elements on the left edge, elements on the right edge, otherwise
- * ****/
-
-  unsigned long int total_white_space;
-  /*if (ll_index.x == 0) {
-  if (ll_index.y == 0) {
-    total_white_space = grid_bin_white_space_LUT[ur_index.x][ur_index.y];
-  } else {
-    total_white_space = grid_bin_white_space_LUT[ur_index.x][ur_index.y]
-        - grid_bin_white_space_LUT[ur_index.x][ll_index.y-1];
-  }
-} else {
-  if (ll_index.y == 0) {
-    total_white_space = grid_bin_white_space_LUT[ur_index.x][ur_index.y]
-        - grid_bin_white_space_LUT[ll_index.x-1][ur_index.y];
-  } else {
-    total_white_space = grid_bin_white_space_LUT[ur_index.x][ur_index.y]
-        - grid_bin_white_space_LUT[ur_index.x][ll_index.y-1]
-        - grid_bin_white_space_LUT[ll_index.x-1][ur_index.y]
-        + grid_bin_white_space_LUT[ll_index.x-1][ll_index.y-1];
-  }
-}*/
-  WindowQuadruple window = {ll_index.x, ll_index.y, ur_index.x, ur_index.y};
-  total_white_space = LookUpWhiteSpace(window);
-  return total_white_space;
+  return grid_bin_mesh.WhiteSpace(ll_index, ur_index);
 }
 
 unsigned long int LookAheadLegalizer::LookUpWhiteSpace(WindowQuadruple &window) {
-  unsigned long int total_white_space;
-  if (window.llx == 0) {
-    if (window.lly == 0) {
-      total_white_space =
-          grid_bin_white_space_LUT[window.urx][window.ury];
-    } else {
-      total_white_space = grid_bin_white_space_LUT[window.urx][window.ury]
-          - grid_bin_white_space_LUT[window.urx][window.lly - 1];
-    }
-  } else {
-    if (window.lly == 0) {
-      total_white_space = grid_bin_white_space_LUT[window.urx][window.ury]
-          - grid_bin_white_space_LUT[window.llx - 1][window.ury];
-    } else {
-      total_white_space = grid_bin_white_space_LUT[window.urx][window.ury]
-          - grid_bin_white_space_LUT[window.urx][window.lly - 1]
-          - grid_bin_white_space_LUT[window.llx - 1][window.ury]
-          + grid_bin_white_space_LUT[window.llx - 1][window.lly - 1];
-    }
-  }
-  return total_white_space;
+  return grid_bin_mesh.WhiteSpace(
+      GridBinIndex(window.llx, window.lly),
+      GridBinIndex(window.urx, window.ury)
+  );
 }
 
-void LookAheadLegalizer::FindMinimumBoxForLargestCluster() {
-  /****
-  * this function find the box for the largest cluster,
-  * such that the total white space in the box is larger than the total cell area
-  * the way to do this is just by expanding the boundaries of the bounding box of the first cluster
-  *
-  * Part 1
-  * find the index of the maximum cluster
-  * ****/
-  ElapsedTime elapsed_time;
-  elapsed_time.RecordStartTime();
-
-  // clear the queue_box_bin
-  while (!queue_box_bin.empty()) queue_box_bin.pop();
-  if (cluster_set.empty()) return;
-
-  // Part 1
+/****
+ * @brief Find the box for the largest cluster, such that the total white space
+ * in the box is larger than the total cell area. The way to do this is just by
+ * expanding the boundaries of the bounding box of the cluster.
+ *
+ * This function does not change any grid bin, and it only reads grid bins
+ * inside the returned box.
+ *
+ * @return the expanded box
+ */
+BoxBin LookAheadLegalizer::ExpandBoxForLargestCluster() {
   BoxBin R;
   R.cut_direction_x = false;
 
@@ -571,8 +584,7 @@ void LookAheadLegalizer::FindMinimumBoxForLargestCluster() {
   while (true) {
     // update cell area, white space, and thus filling rate to determine whether to expand this box or not
     R.total_white_space = LookUpWhiteSpace(R.ll_index, R.ur_index);
-    R.UpdateCellAreaWhiteSpaceFillingRate(grid_bin_white_space_LUT,
-                                          grid_bin_mesh);
+    R.UpdateCellAreaWhiteSpaceFillingRate(grid_bin_mesh);
     if (R.filling_rate > placement_density_) {
       R.ExpandBox(grid_cnt_x, grid_cnt_y);
     } else {
@@ -580,10 +592,19 @@ void LookAheadLegalizer::FindMinimumBoxForLargestCluster() {
     }
     //BOOST_LOG_TRIVIAL(info)   << R.total_white_space << "  " << R.filling_rate << "  " << FillingRate() << "\n";
   }
+  return R;
+}
 
+/****
+ * @brief Move cells in grid bins covered by the box to the box, and mark these
+ * grid bins as roughly legalized.
+ *
+ * @param box: the box returned by ExpandBoxForLargestCluster()
+ */
+void LookAheadLegalizer::CommitBoxForLargestCluster(BoxBin &box) {
+  BoxBin &R = box;
   R.total_white_space = LookUpWhiteSpace(R.ll_index, R.ur_index);
-  R.UpdateCellAreaWhiteSpaceFillingRate(grid_bin_white_space_LUT,
-                                        grid_bin_mesh);
+  R.UpdateCellAreaWhiteSpaceFillingRate(grid_bin_mesh);
   R.UpdateCellList(grid_bin_mesh);
   R.ll_point.x = grid_bin_mesh[R.ll_index.x][R.ll_index.y].left;
   R.ll_point.y = grid_bin_mesh[R.ll_index.x][R.ll_index.y].bottom;
@@ -601,15 +622,27 @@ void LookAheadLegalizer::FindMinimumBoxForLargestCluster() {
       R.UpdateObsBoundary();
     }
   }
-  queue_box_bin.push(R);
-  //BOOST_LOG_TRIVIAL(info)   << "Bounding box total white space: " << queue_box_bin.front().total_white_space << "\n";
-  //BOOST_LOG_TRIVIAL(info)   << "Bounding box total cell area: " << queue_box_bin.front().total_cell_area << "\n";
 
   for (int kx = R.ll_index.x; kx <= R.ur_index.x; ++kx) {
     for (int ky = R.ll_index.y; ky <= R.ur_index.y; ++ky) {
       grid_bin_mesh[kx][ky].global_placed = true;
     }
   }
+}
+
+void LookAheadLegalizer::FindMinimumBoxForLargestCluster() {
+  ElapsedTime elapsed_time;
+  elapsed_time.RecordStartTime();
+
+  // clear the queue_box_bin
+  while (!queue_box_bin.empty()) queue_box_bin.pop();
+  if (cluster_set.empty()) return;
+
+  BoxBin R = ExpandBoxForLargestCluster();
+  CommitBoxForLargestCluster(R);
+  queue_box_bin.push(R);
+  //BOOST_LOG_TRIVIAL(info)   << "Bounding box total white space: " << queue_box_bin.front().total_white_space << "\n";
+  //BOOST_LOG_TRIVIAL(info)   << "Bounding box total cell area: " << queue_box_bin.front().total_cell_area << "\n";
 
   elapsed_time.RecordEndTime();
   find_minimum_box_for_largest_cluster_time_ += elapsed_time.GetWallTime();
@@ -619,8 +652,12 @@ void LookAheadLegalizer::FindMinimumBoxForLargestCluster() {
  *
  *
  * @param box: the BoxBin which needs to be further splitted into two sub-boxes
+ * @param box_queue: the queue sub-boxes are pushed to
  */
-void LookAheadLegalizer::SplitGridBox(BoxBin &box) {
+void LookAheadLegalizer::SplitGridBox(
+    BoxBin &box,
+    std::queue<BoxBin> &box_queue
+) {
   // 1. create two sub-boxes
   BoxBin box1, box2;
   // the first sub-box should have the same lower left corner as the original box
@@ -653,7 +690,7 @@ void LookAheadLegalizer::SplitGridBox(BoxBin &box) {
       box2.cell_list = box.cell_list;
       box2.total_cell_area = box.total_cell_area;
       box2.UpdateObsBoundary();
-      queue_box_bin.push(box2);
+      box_queue.push(box2);
     } else if (
         double(box2.total_white_space) / (double) box.total_white_space <= 0.01
         ) {
@@ -662,7 +699,7 @@ void LookAheadLegalizer::SplitGridBox(BoxBin &box) {
       box1.cell_list = box.cell_list;
       box1.total_cell_area = box.total_cell_area;
       box1.UpdateObsBoundary();
-      queue_box_bin.push(box1);
+      box_queue.push(box1);
     } else {
       box.update_cut_point_cell_list_low_high(
           box1.total_white_space,
@@ -678,8 +715,8 @@ void LookAheadLegalizer::SplitGridBox(BoxBin &box) {
       box2.total_cell_area = box.total_cell_area_high;
       box1.UpdateObsBoundary();
       box2.UpdateObsBoundary();
-      queue_box_bin.push(box1);
-      queue_box_bin.push(box2);
+      box_queue.push(box1);
+      box_queue.push(box2);
     }
   } else {
     //box.Report();
@@ -699,7 +736,7 @@ void LookAheadLegalizer::SplitGridBox(BoxBin &box) {
       box2.cell_list = box.cell_list;
       box2.total_cell_area = box.total_cell_area;
       box2.UpdateObsBoundary();
-      queue_box_bin.push(box2);
+      box_queue.push(box2);
     } else if (
         double(box2.total_white_space) / (double) box.total_white_space <= 0.01
         ) {
@@ -708,7 +745,7 @@ void LookAheadLegalizer::SplitGridBox(BoxBin &box) {
       box1.cell_list = box.cell_list;
       box1.total_cell_area = box.total_cell_area;
       box1.UpdateObsBoundary();
-      queue_box_bin.push(box1);
+      box_queue.push(box1);
     } else {
       box.update_cut_point_cell_list_low_high(
           box1.total_white_space,
@@ -724,8 +761,8 @@ void LookAheadLegalizer::SplitGridBox(BoxBin &box) {
       box2.total_cell_area = box.total_cell_area_high;
       box1.UpdateObsBoundary();
       box2.UpdateObsBoundary();
-      queue_box_bin.push(box1);
-      queue_box_bin.push(box2);
+      box_queue.push(box1);
+      box_queue.push(box2);
     }
   }
 }
@@ -817,7 +854,10 @@ for (auto &cell_id: box.cell_list) {
   }
 }
 
-void LookAheadLegalizer::SplitBox(BoxBin &box) {
+void LookAheadLegalizer::SplitBox(
+    BoxBin &box,
+    std::queue<BoxBin> &box_queue
+) {
   bool flag_bisection_complete;
   int dominating_box_flag; // indicate whether there is a dominating BoxBin
   BoxBin box1, box2;
@@ -827,7 +867,7 @@ void LookAheadLegalizer::SplitBox(BoxBin &box) {
   // cut-line along vertical direction
   if (box.cut_direction_x) {
     flag_bisection_complete =
-        box.update_cut_index_white_space(grid_bin_white_space_LUT);
+        box.update_cut_index_white_space(grid_bin_mesh);
     if (flag_bisection_complete) {
       box1.cut_direction_x = false;
       box2.cut_direction_x = false;
@@ -837,7 +877,7 @@ void LookAheadLegalizer::SplitBox(BoxBin &box) {
       // if bisection fail in one direction, do bisection in the other direction
       box.cut_direction_x = false;
       flag_bisection_complete =
-          box.update_cut_index_white_space(grid_bin_white_space_LUT);
+          box.update_cut_index_white_space(grid_bin_mesh);
       if (flag_bisection_complete) {
         box1.cut_direction_x = false;
         box2.cut_direction_x = false;
@@ -848,7 +888,7 @@ void LookAheadLegalizer::SplitBox(BoxBin &box) {
   } else {
     // cut-line along horizontal direction
     flag_bisection_complete =
-        box.update_cut_index_white_space(grid_bin_white_space_LUT);
+        box.update_cut_index_white_space(grid_bin_mesh);
     if (flag_bisection_complete) {
       box1.cut_direction_x = true;
       box2.cut_direction_x = true;
@@ -857,7 +897,7 @@ void LookAheadLegalizer::SplitBox(BoxBin &box) {
     } else {
       box.cut_direction_x = true;
       flag_bisection_complete =
-          box.update_cut_index_white_space(grid_bin_white_space_LUT);
+          box.update_cut_index_white_space(grid_bin_mesh);
       if (flag_bisection_complete) {
         box1.cut_direction_x = true;
         box2.cut_direction_x = true;
@@ -921,8 +961,8 @@ if ((box2.left < LEFT) || (box2.bottom < BOTTOM)) {
   BOOST_LOG_TRIVIAL(info)   << box2.left << " " << box2.bottom << "\n";
 }*/
 
-    queue_box_bin.push(box1);
-    queue_box_bin.push(box2);
+    box_queue.push(box1);
+    box_queue.push(box2);
     //box1.write_box_boundary("first_bounding_box.txt", grid_bin_width, grid_bin_height, LEFT, BOTTOM);
     //box2.write_box_boundary("first_bounding_box.txt", grid_bin_width, grid_bin_height, LEFT, BOTTOM);
     //box1.write_cell_region("first_cell_bounding_box.txt");
@@ -942,7 +982,7 @@ if ((box2.left < LEFT) || (box2.bottom < BOTTOM)) {
   BOOST_LOG_TRIVIAL(info)   << box2.left << " " << box2.bottom << "\n";
 }*/
 
-    queue_box_bin.push(box2);
+    box_queue.push(box2);
     //box2.write_box_boundary("first_bounding_box.txt", grid_bin_width, grid_bin_height, LEFT, BOTTOM);
     //box2.write_cell_region("first_cell_bounding_box.txt");
   } else {
@@ -960,7 +1000,7 @@ if ((box2.left < LEFT) || (box2.bottom < BOTTOM)) {
   BOOST_LOG_TRIVIAL(info)   << box1.left << " " << box1.bottom << "\n";
 }*/
 
-    queue_box_bin.push(box1);
+    box_queue.push(box1);
     //box1.write_box_boundary("first_bounding_box.txt", grid_bin_width, grid_bin_height, LEFT, BOTTOM);
     //box1.write_cell_region("first_cell_bounding_box.txt");
   }
@@ -985,7 +1025,7 @@ bool LookAheadLegalizer::RecursiveBisectionblockspreading() {
     if (box.ll_index == box.ur_index) {
       //UpdateGridBinBlocks(box);
       if (box.IsContainFixedBlk()) { // if there is a fixed macro inside a box, keep splitting the box
-        SplitGridBox(box);
+        SplitGridBox(box, queue_box_bin);
         queue_box_bin.pop();
         continue;
       }
@@ -994,7 +1034,7 @@ bool LookAheadLegalizer::RecursiveBisectionblockspreading() {
       PlaceBlkInBox(box);
       //RoughLegalBlkInBox(box);
     } else {
-      SplitBox(box);
+      SplitBox(box, queue_box_bin);
     }
     queue_box_bin.pop();
   }
@@ -1004,6 +1044,131 @@ bool LookAheadLegalizer::RecursiveBisectionblockspreading() {
   return true;
 }
 
+/****
+ * @brief Spread cells in a box and all its sub-boxes using a queue owned by
+ * this task. If a box is split into two sub-boxes and both are large enough,
+ * the first one is handed over to a new task. This task returns after all new
+ * tasks it creates finish.
+ *
+ * Sub-boxes created by SplitBox() cover disjoint grid bins, while sub-boxes
+ * created by SplitGridBox() share the same grid bin, so the latter are always
+ * spread by the same task. Each grid bin is thus updated by only one task, and
+ * in the same order as RecursiveBisectionblockspreading() does.
+ *
+ * @param root_box: the box to spread
+ */
+void LookAheadLegalizer::SpreadBoxTask(BoxBin &root_box) {
+  std::queue<BoxBin> box_queue;
+  box_queue.push(std::move(root_box));
+  std::queue<BoxBin> sub_boxes;
+  // boxes handed over to new tasks, which move them out right away, a list
+  // keeps their addresses valid until all these tasks finish
+  std::list<BoxBin> task_boxes;
+  while (!box_queue.empty()) {
+    BoxBin &box = box_queue.front();
+    if (box.ll_index == box.ur_index) {
+      if (box.IsContainFixedBlk()) {
+        SplitGridBox(box, box_queue);
+      } else {
+        PlaceBlkInBox(box);
+      }
+      box_queue.pop();
+      continue;
+    }
+
+    SplitBox(box, sub_boxes);
+    box_queue.pop();
+    if (sub_boxes.size() == 2
+        && sub_boxes.front().cell_list.size() >= min_cells_per_task_
+        && sub_boxes.back().cell_list.size() >= min_cells_per_task_) {
+      task_boxes.push_back(std::move(sub_boxes.front()));
+      sub_boxes.pop();
+      BoxBin &task_box = task_boxes.back();
+#pragma omp task default(none) shared(task_box)
+      SpreadBoxTask(task_box);
+    }
+    while (!sub_boxes.empty()) {
+      box_queue.push(std::move(sub_boxes.front()));
+      sub_boxes.pop();
+    }
+  }
+#pragma omp taskwait
+}
+
+/****
+ * @brief Spread cells in boxes covering disjoint grid bins, one task per box.
+ * Sub-boxes of each box may be spread by more tasks, see SpreadBoxTask().
+ *
+ * @param boxes: boxes returned by CommitBoxForLargestCluster()
+ */
+void LookAheadLegalizer::SpreadBoxesInParallel(std::vector<BoxBin> &boxes) {
+  ElapsedTime elapsed_time;
+  elapsed_time.RecordStartTime();
+
+  int num_boxes = static_cast<int>(boxes.size());
+#pragma omp parallel num_threads(num_threads_) default(none) shared(boxes, num_boxes)
+  {
+#pragma omp single
+    {
+      for (int i = 0; i < num_boxes; ++i) {
+#pragma omp task default(none) firstprivate(i) shared(boxes)
+        SpreadBoxTask(boxes[i]);
+      }
+    }
+  }
+  boxes.clear();
+
+  elapsed_time.RecordEndTime();
+  recursive_bisection_block_spreading_time_ += elapsed_time.GetWallTime();
+}
+
+/****
+ * @brief The task-parallel version of the loop in RemoveCellOverlap().
+ *
+ * Boxes of clusters are found in the same order as the sequential version.
+ * Spreading a box only changes grid bins inside this box, and finding the box
+ * for a cluster only reads grid bins inside the box found. So a box can be
+ * committed without spreading previous boxes as long as it does not overlap
+ * with any of them. Otherwise, pending boxes are spread first, and the box is
+ * found again. The result is therefore the same as the sequential version.
+ */
+void LookAheadLegalizer::ParallelRecursiveBisectionBlockSpreading() {
+  std::vector<BoxBin> pending_boxes;
+  auto is_overlap_with_pending_boxes = [&](BoxBin const &box) {
+    for (auto &pending_box: pending_boxes) {
+      if (box.ll_index.x <= pending_box.ur_index.x
+          && pending_box.ll_index.x <= box.ur_index.x
+          && box.ll_index.y <= pending_box.ur_index.y
+          && pending_box.ll_index.y <= box.ur_index.y) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  while (true) {
+    UpdateLargestCluster();
+    if (cluster_set.empty()) break;
+
+    ElapsedTime elapsed_time;
+    elapsed_time.RecordStartTime();
+    BoxBin box = ExpandBoxForLargestCluster();
+    elapsed_time.RecordEndTime();
+    find_minimum_box_for_largest_cluster_time_ += elapsed_time.GetWallTime();
+
+    if (is_overlap_with_pending_boxes(box)) {
+      SpreadBoxesInParallel(pending_boxes);
+      elapsed_time.RecordStartTime();
+      box = ExpandBoxForLargestCluster();
+      elapsed_time.RecordEndTime();
+      find_minimum_box_for_largest_cluster_time_ += elapsed_time.GetWallTime();
+    }
+    CommitBoxForLargestCluster(box);
+    pending_boxes.push_back(std::move(box));
+  }
+  SpreadBoxesInParallel(pending_boxes);
+}
+
 double LookAheadLegalizer::RemoveCellOverlap() {
   ElapsedTime elapsed_time;
   elapsed_time.RecordStartTime();
@@ -1011,12 +1176,16 @@ double LookAheadLegalizer::RemoveCellOverlap() {
   ClearGridBinFlag();
   UpdateGridBinState();
   UpdateClusterList();
-  do {
-    UpdateLargestCluster();
-    FindMinimumBoxForLargestCluster();
-    RecursiveBisectionblockspreading();
-    //BOOST_LOG_TRIVIAL(info) << "cluster count: " << cluster_set.size() << "\n";
-  } while (!cluster_set.empty());
+  if (num_threads_ > 1) {
+    ParallelRecursiveBisectionBlockSpreading();
+  } else {
+    do {
+      UpdateLargestCluster();
+      FindMinimumBoxForLargestCluster();
+      RecursiveBisectionblockspreading();
+      //BOOST_LOG_TRIVIAL(info) << "cluster count: " << cluster_set.size() << "\n";
+    } while (!cluster_set.empty());
+  }
 
   //LGTetrisEx legalizer_;
   //legalizer_.TakeOver(this);
@@ -1057,9 +1226,32 @@ double LookAheadLegalizer::GetTime() {
   return tot_lal_time;
 }
 
+void LookAheadLegalizer::ReportProfile() {
+  Profiler &profiler = GlobalProfiler();
+  profiler.AddTime("look-ahead legalization", tot_lal_time);
+  profiler.AddTime(
+      "look-ahead legalization/update grid bin state",
+      update_grid_bin_state_time_
+  );
+  profiler.AddTime(
+      "look-ahead legalization/update cluster list",
+      update_cluster_list_time_
+  );
+  profiler.AddTime(
+      "look-ahead legalization/find minimum box",
+      find_minimum_box_for_largest_cluster_time_
+  );
+  profiler.AddTime(
+      "look-ahead legalization/block spreading",
+      recursive_bisection_block_spreading_time_
+  );
+}
+
 void LookAheadLegalizer::Close() {
-  grid_bin_mesh.clear();
-  grid_bin_white_space_LUT.clear();
+  grid_bin_mesh.Clear();
+  blk_bin_ids_.clear();
+  blk_new_bin_ids_.clear();
+  is_bin_dirty_.clear();
 }
 
 } // dali
@@ -36,13 +36,18 @@ class RoughLegalizer {
   virtual void Initialize(double placement_density) = 0;
   virtual double RemoveCellOverlap() = 0;
   virtual double GetTime() = 0;
+  // add accumulated timers to the global profiler
+  virtual void ReportProfile() = 0;
   virtual void Close() = 0;
   std::vector<double> &GetHpwls() { return upper_bound_hpwl_; }
   std::vector<double> &GetHpwlsX() { return upper_bound_hpwl_x_; }
   std::vector<double> &GetHpwlsY() { return upper_bound_hpwl_y_; }
   void SetShouldSaveIntermediateResult(bool should_save_intermediate_result);
+  void SetNumThreads(int num_threads) { num_threads_ = num_threads; }
+  void SetActiveBlocks(std::vector<bool> const &is_blk_active, int bin_halo);
  protected:
   Circuit *ckt_ptr_ = nullptr;
+  int num_threads_ = 1;
   double placement_density_ = 1.0;
   std::vector<double> upper_bound_hpwl_;
   std::vector<double> upper_bound_hpwl_x_;
@@ -51,6 +56,11 @@ class RoughLegalizer {
   // save intermediate result for debugging and/or visualization
   bool should_save_intermediate_result_ = false;
   int cur_iter_ = 0;
+
+  // if not empty, only blocks near active blocks are spread, see
+  // SetActiveBlocks()
+  std::vector<bool> is_blk_active_;
+  int active_bin_halo_ = 0;
 };
 
 class LookAheadLegalizer : public RoughLegalizer {
@@ -67,6 +77,7 @@ class LookAheadLegalizer : public RoughLegalizer {
   void Initialize(double placement_density) override;
 
   void ClearGridBinFlag();
+  void UpdateActiveGridBins();
   void UpdateGridBinState();
   void UpdateClusterArea(GridBinCluster &cluster);
   void UpdateClusterList();
@@ -76,14 +87,20 @@ class LookAheadLegalizer : public RoughLegalizer {
       GridBinIndex const &ur_index
   );
   unsigned long int LookUpWhiteSpace(WindowQuadruple &window);
+  BoxBin ExpandBoxForLargestCluster();
+  void CommitBoxForLargestCluster(BoxBin &box);
   void FindMinimumBoxForLargestCluster();
-  void SplitGridBox(BoxBin &box);
+  void SplitGridBox(BoxBin &box, std::queue<BoxBin> &box_queue);
   void PlaceBlkInBox(BoxBin &box);
-  void SplitBox(BoxBin &box);
+  void SplitBox(BoxBin &box, std::queue<BoxBin> &box_queue);
   bool RecursiveBisectionblockspreading();
+  void SpreadBoxTask(BoxBin &root_box);
+  void SpreadBoxesInParallel(std::vector<BoxBin> &boxes);
+  void ParallelRecursiveBisectionBlockSpreading();
   double RemoveCellOverlap() override;
 
   double GetTime() override;
+  void ReportProfile() override;
   void Close() override;
  private:
   int number_of_cell_in_bin_ = 30;
@@ -94,11 +111,20 @@ class LookAheadLegalizer : public RoughLegalizer {
   int grid_bin_width = 0;
   int grid_cnt_x = 0;
   int grid_cnt_y = 0;
-  std::vector<std::vector<GridBin>> grid_bin_mesh;
-  std::vector<std::vector<unsigned long long>> grid_bin_white_space_LUT;
+  GridBinMesh grid_bin_mesh;
+  // the grid bin each movable block was put in by the last call of
+  // UpdateGridBinState(), only bins gaining or losing blocks are rebuilt
+  std::vector<int> blk_bin_ids_;
+  std::vector<int> blk_new_bin_ids_;
+  std::vector<bool> is_bin_dirty_;
+  // grid bins within active_bin_halo_ bins of an active block
+  std::vector<bool> is_bin_active_;
 
   std::multiset<GridBinCluster, std::greater<>> cluster_set;
   std::queue<BoxBin> queue_box_bin;
+  // in the task-parallel mode, a sub-box with at least this amount of cells
+  // is spread by a new task
+  size_t min_cells_per_task_ = 256;
 
   double update_grid_bin_state_time_ = 0;
   double cluster_overfilled_grid_bin_time_ = 0;
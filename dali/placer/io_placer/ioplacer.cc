@@ -21,6 +21,7 @@
 #include "ioplacer.h"
 
 #include "dali/common/logging.h"
+#include "dali/common/profiler.h"
 #include "dali/common/phydb_helper.h"
 
 #define NUM_OF_PLACE_BOUNDARY 4
@@ -409,6 +410,7 @@ void IoPlacer::AdjustIoPinLocationForPhyDB() {
 }
 
 bool IoPlacer::AutoPlaceIoPin() {
+  ProfileScope scope("io placement");
   PrintHorizontalLine();
   BOOST_LOG_TRIVIAL(info)  << "Start I/O Placement\n";
   if (!CheckConfiguration()) {
@@ -0,0 +1,429 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "LGAbacus.h"
+
+#include <cfloat>
+#include <cmath>
+
+#include <algorithm>
+#include <array>
+
+namespace dali {
+
+// candidate rows of a block are evaluated in batches, a batch has at most
+// this many rows, and the first batch has only one row
+constexpr int kMaxTrialRowBatchSize = 64;
+// batches with fewer rows are evaluated by the calling thread only
+constexpr int kMinParallelTrialRowCount = 8;
+
+AbacusLegalizer::AbacusLegalizer() : LGTetrisEx() {}
+
+/****
+ * @brief Legalize multi-row blocks using Tetris sweeps, and remove the space
+ * taken by them from row segments.
+ *
+ * @param single_row_blks: movable single-row blocks, to be placed by Abacus
+ * @return true if all multi-row blocks are legal
+ */
+bool AbacusLegalizer::LegalizeMultiRowBlocks(
+    std::vector<Block *> &single_row_blks
+) {
+  std::vector<Block *> multi_row_blks;
+  auto &blocks = ckt_ptr_->Blocks();
+  for (auto &blk: blocks) {
+    if (IsDummyBlock(blk)) continue;
+    if (blk.IsFixed()) continue;
+    if (HeightToRow(blk.Height()) > 1) {
+      multi_row_blks.push_back(&blk);
+    } else {
+      single_row_blks.push_back(&blk);
+    }
+  }
+  if (multi_row_blks.empty()) return true;
+
+  BOOST_LOG_TRIVIAL(info)
+    << "Legalizing " << multi_row_blks.size() << " multi-row blocks\n";
+  std::vector<int> row_lo(tot_num_rows_, left_);
+  std::vector<int> row_hi(tot_num_rows_, right_);
+  LGTetrisEx multi_row_legalizer;
+  InitBandLegalizer(
+      multi_row_legalizer, left_, right_, row_lo, row_hi, multi_row_blks
+  );
+  if (!multi_row_legalizer.SweepUntilLegal()) return false;
+
+  for (auto &blk_ptr: multi_row_blks) {
+    int lo_row = LocToRow(static_cast<int>(std::round(blk_ptr->LLY())));
+    int hi_row = lo_row + HeightToRow(blk_ptr->Height()) - 1;
+    lo_row = std::max(lo_row, 0);
+    hi_row = std::min(hi_row, tot_num_rows_ - 1);
+    int lo_x = static_cast<int>(std::floor(blk_ptr->LLX()));
+    int hi_x = static_cast<int>(std::ceil(blk_ptr->URX()));
+    for (int row = lo_row; row <= hi_row; ++row) {
+      RemoveSpaceFromRow(row, lo_x, hi_x);
+    }
+  }
+  return true;
+}
+
+/****
+ * @brief Remove [lo, hi) from white space segments of a row.
+ */
+void AbacusLegalizer::RemoveSpaceFromRow(int row, int lo, int hi) {
+  auto &segments = row_segments_[row];
+  std::vector<SegI> remaining;
+  remaining.reserve(segments.size() + 1);
+  for (auto &seg: segments) {
+    if (seg.hi <= lo || seg.lo >= hi) {
+      remaining.push_back(seg);
+      continue;
+    }
+    if (seg.lo < lo) {
+      remaining.emplace_back(seg.lo, lo);
+    }
+    if (hi < seg.hi) {
+      remaining.emplace_back(hi, seg.hi);
+    }
+  }
+  segments.swap(remaining);
+}
+
+void AbacusLegalizer::InitAbacusSegments() {
+  abacus_segments_.clear();
+  abacus_segments_.resize(tot_num_rows_);
+  for (int row = 0; row < tot_num_rows_; ++row) {
+    auto &segments = abacus_segments_[row];
+    segments.reserve(row_segments_[row].size());
+    for (auto &seg: row_segments_[row]) {
+      segments.emplace_back();
+      segments.back().lo = seg.lo;
+      segments.back().hi = seg.hi;
+    }
+  }
+}
+
+/****
+ * @brief Find the location of a block if it is appended to a segment, without
+ * changing this segment.
+ *
+ * The new block forms a cluster of its own, and this cluster is merged into
+ * the previous one as long as they overlap, the same as PlaceInSegment(). Only
+ * clusters at the end of the segment are visited.
+ *
+ * @param segment: a segment with enough white space for this block
+ * @param width: width of the block
+ * @param x: target lower left x of the block
+ * @return the lower left x of the block after collapsing clusters
+ */
+int AbacusLegalizer::TrialLocInSegment(
+    AbacusSegment const &segment, int width, double x
+) const {
+  double e = 1;
+  double q = x;
+  int w = width;
+  int loc = std::clamp(
+      static_cast<int>(std::round(q)), segment.lo, segment.hi - w
+  );
+  auto &clusters = segment.clusters;
+  for (int k = static_cast<int>(clusters.size()) - 1; k >= 0; --k) {
+    auto &prev = clusters[k];
+    if (prev.x + prev.w <= loc) break;
+    q = prev.q + q - e * prev.w;
+    e += prev.e;
+    w += prev.w;
+    loc = std::clamp(
+        static_cast<int>(std::round(q / e)), segment.lo, segment.hi - w
+    );
+  }
+  // the new block is the last one in the merged cluster
+  return loc + w - width;
+}
+
+/****
+ * @brief Find the best segment in a row for a block.
+ *
+ * Segments are visited from the one near the target location towards both
+ * ends of the row, and a direction stops once the distance to the next
+ * segment is no better than the best displacement found so far.
+ *
+ * @param row: the row index
+ * @param block: the block to place
+ * @param bound: only locations with displacement less than this are returned
+ * @param seg_id: index of the best segment, -1 if not found
+ * @param x_loc: lower left x of the block in the best segment
+ * @return displacement of the block at the best location, or bound if not found
+ */
+double AbacusLegalizer::TrialPlaceInRow(
+    int row, Block &block, double bound, int &seg_id, int &x_loc
+) const {
+  seg_id = -1;
+  double x = target_llx_[block.Id()];
+  double dy = std::fabs(RowToLoc(row) - target_lly_[block.Id()]);
+  if (dy >= bound || !IsFitToRow(row, block)) return bound;
+
+  double min_cost = bound;
+  int width = block.Width();
+  auto &segments = abacus_segments_[row];
+  int seg_cnt = static_cast<int>(segments.size());
+  int start_id = FirstSegmentEndingAfter(
+      row, static_cast<int>(std::floor(x))
+  );
+  for (int id = start_id; id < seg_cnt; ++id) {
+    auto &seg = segments[id];
+    if (dy + std::max(0.0, seg.lo - x) >= min_cost) break;
+    if (seg.used_width + width > seg.hi - seg.lo) continue;
+    int loc = TrialLocInSegment(seg, width, x);
+    double cost = dy + std::fabs(loc - x);
+    if (cost < min_cost) {
+      min_cost = cost;
+      seg_id = id;
+      x_loc = loc;
+    }
+  }
+  for (int id = start_id - 1; id >= 0; --id) {
+    auto &seg = segments[id];
+    if (dy + std::max(0.0, x + width - seg.hi) >= min_cost) break;
+    if (seg.used_width + width > seg.hi - seg.lo) continue;
+    int loc = TrialLocInSegment(seg, width, x);
+    double cost = dy + std::fabs(loc - x);
+    if (cost < min_cost) {
+      min_cost = cost;
+      seg_id = id;
+      x_loc = loc;
+    }
+  }
+  return min_cost;
+}
+
+/****
+ * @brief Append a block to a segment, and collapse clusters at the end of this
+ * segment to their optimal locations.
+ *
+ * @param segment: a segment with enough white space for this block
+ * @param block: the block to place
+ * @param x: target lower left x of the block
+ */
+void AbacusLegalizer::PlaceInSegment(
+    AbacusSegment &segment, Block &block, double x
+) {
+  int width = block.Width();
+  segment.used_width += width;
+
+  AbacusCluster cluster;
+  cluster.e = 1;
+  cluster.q = x;
+  cluster.w = width;
+  cluster.x = std::clamp(
+      static_cast<int>(std::round(x)), segment.lo, segment.hi - width
+  );
+  cluster.first = static_cast<int>(segment.blks.size());
+  segment.blks.push_back(&block);
+
+  auto &clusters = segment.clusters;
+  while (!clusters.empty()
+      && clusters.back().x + clusters.back().w > cluster.x) {
+    AbacusCluster &prev = clusters.back();
+    prev.q += cluster.q - cluster.e * prev.w;
+    prev.e += cluster.e;
+    prev.w += cluster.w;
+    cluster = prev;
+    clusters.pop_back();
+    cluster.x = std::clamp(
+        static_cast<int>(std::round(cluster.q / cluster.e)),
+        segment.lo,
+        segment.hi - cluster.w
+    );
+  }
+  clusters.push_back(cluster);
+}
+
+/****
+ * @brief Place a block into the segment giving the smallest displacement.
+ *
+ * Rows are visited in the ascending order of their distances to the target
+ * location. They are evaluated in batches of growing sizes, and rows in a
+ * batch are evaluated concurrently against the best displacement found before
+ * this batch. The search stops when the distance to the next row is no better
+ * than the best displacement. The result does not depend on the number of
+ * threads.
+ *
+ * @return true if a segment with enough white space is found
+ */
+bool AbacusLegalizer::FindSegmentAndPlace(Block &block) {
+  double y = target_lly_[block.Id()];
+  int up_row = LocToRow(AlignLocToRowLoc(y));
+  int down_row = up_row - 1;
+
+  double min_cost = DBL_MAX;
+  int best_row = -1;
+  int best_seg = -1;
+  int best_x = 0;
+
+  std::array<int, kMaxTrialRowBatchSize> rows{};
+  std::array<double, kMaxTrialRowBatchSize> costs{};
+  std::array<int, kMaxTrialRowBatchSize> seg_ids{};
+  std::array<int, kMaxTrialRowBatchSize> locs{};
+  int batch_size = 1;
+  while (true) {
+    int row_cnt = 0;
+    while (row_cnt < batch_size) {
+      double up_dy = (up_row < tot_num_rows_) ?
+                     std::fabs(RowToLoc(up_row) - y) : DBL_MAX;
+      double down_dy = (down_row >= 0) ?
+                       std::fabs(RowToLoc(down_row) - y) : DBL_MAX;
+      if (std::min(up_dy, down_dy) >= min_cost) break;
+      if (down_dy <= up_dy) {
+        rows[row_cnt++] = down_row--;
+      } else {
+        rows[row_cnt++] = up_row++;
+      }
+    }
+    if (row_cnt == 0) break;
+
+    // entering a parallel region costs more than evaluating a few rows
+    double bound = min_cost;
+    if (num_threads_ > 1 && row_cnt >= kMinParallelTrialRowCount) {
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads_) default(none) shared(row_cnt, rows, block, bound, costs, seg_ids, locs)
+      for (int i = 0; i < row_cnt; ++i) {
+        costs[i] = TrialPlaceInRow(rows[i], block, bound, seg_ids[i], locs[i]);
+      }
+    } else {
+      for (int i = 0; i < row_cnt; ++i) {
+        costs[i] = TrialPlaceInRow(rows[i], block, bound, seg_ids[i], locs[i]);
+      }
+    }
+    for (int i = 0; i < row_cnt; ++i) {
+      if (seg_ids[i] >= 0 && costs[i] < min_cost) {
+        min_cost = costs[i];
+        best_row = rows[i];
+        best_seg = seg_ids[i];
+        best_x = locs[i];
+      }
+    }
+    batch_size = std::min(2 * batch_size, kMaxTrialRowBatchSize);
+  }
+
+  if (best_seg < 0) {
+    return false;
+  }
+  PlaceInSegment(
+      abacus_segments_[best_row][best_seg], block, target_llx_[block.Id()]
+  );
+  block.SetLoc(best_x, RowToLoc(best_row));
+  BlockOrient orient = ShouldOrientN(best_row, block) ? N : FS;
+  block.SetOrient(orient);
+  return true;
+}
+
+/****
+ * @brief Move blocks to the final locations of their clusters.
+ */
+void AbacusLegalizer::ApplySegmentLocations() {
+  for (auto &segments: abacus_segments_) {
+    for (auto &segment: segments) {
+      auto &clusters = segment.clusters;
+      int cluster_cnt = static_cast<int>(clusters.size());
+      int blk_cnt = static_cast<int>(segment.blks.size());
+      for (int k = 0; k < cluster_cnt; ++k) {
+        int x = clusters[k].x;
+        int end = (k + 1 < cluster_cnt) ? clusters[k + 1].first : blk_cnt;
+        for (int j = clusters[k].first; j < end; ++j) {
+          segment.blks[j]->SetLLX(x);
+          x += segment.blks[j]->Width();
+        }
+      }
+    }
+  }
+}
+
+/****
+ * @brief Legalize multi-row blocks first, then place single-row blocks in the
+ * ascending order of their x locations.
+ *
+ * @return false if some block cannot be legalized, locations of blocks may be
+ * changed in this case
+ */
+bool AbacusLegalizer::StartAbacusPlacement() {
+  auto &blocks = ckt_ptr_->Blocks();
+  size_t blk_cnt = blocks.size();
+  target_llx_.resize(blk_cnt);
+  target_lly_.resize(blk_cnt);
+  for (size_t i = 0; i < blk_cnt; ++i) {
+    target_llx_[i] = blocks[i].LLX();
+    target_lly_[i] = blocks[i].LLY();
+  }
+
+  std::vector<Block *> single_row_blks;
+  if (!LegalizeMultiRowBlocks(single_row_blks)) {
+    BOOST_LOG_TRIVIAL(info) << "Cannot legalize multi-row blocks\n";
+    return false;
+  }
+  InitAbacusSegments();
+
+  std::sort(
+      single_row_blks.begin(),
+      single_row_blks.end(),
+      [&](Block const *blk_ptr0, Block const *blk_ptr1) {
+        double x0 = target_llx_[blk_ptr0->Id()];
+        double x1 = target_llx_[blk_ptr1->Id()];
+        return (x0 < x1) || ((x0 == x1)
+            && (target_lly_[blk_ptr0->Id()] < target_lly_[blk_ptr1->Id()]));
+      }
+  );
+  for (auto &blk_ptr: single_row_blks) {
+    if (!FindSegmentAndPlace(*blk_ptr)) {
+      BOOST_LOG_TRIVIAL(info)
+        << "Cannot find white space for a block of width "
+        << blk_ptr->Width() << "\n";
+      return false;
+    }
+  }
+  ApplySegmentLocations();
+  ReportHPWL();
+  return true;
+}
+
+bool AbacusLegalizer::StartPlacement() {
+  PrintStartStatement("Abacus Legalization");
+
+  is_row_assignment_ = false;
+  InitLegalizer();
+
+  bool is_success = StartAbacusPlacement();
+  if (!is_success) {
+    BOOST_LOG_TRIVIAL(info)
+      << "Abacus legalization failed, falling back to Tetris sweeps\n";
+    auto &blocks = ckt_ptr_->Blocks();
+    for (auto &blk: blocks) {
+      if (IsDummyBlock(blk)) continue;
+      if (blk.IsFixed()) continue;
+      blk.SetLoc(target_llx_[blk.Id()], target_lly_[blk.Id()]);
+    }
+    row_segments_.clear();
+    DetectWhiteSpace();
+    is_success = SweepUntilLegal();
+  }
+
+  PrintEndStatement("Abacus Legalization", is_success);
+
+  return true;
+}
+
+}
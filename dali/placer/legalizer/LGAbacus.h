@@ -0,0 +1,89 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef DALI_PLACER_LEGALIZER_LGABACUS_H_
+#define DALI_PLACER_LEGALIZER_LGABACUS_H_
+
+#include <vector>
+
+#include "dali/circuit/block.h"
+#include "dali/placer/legalizer/LGTetrisEx.h"
+
+namespace dali {
+
+/****
+ * @brief Abacus legalizer for standard cell rows.
+ *
+ * Blocks are placed one by one in the ascending order of their x locations.
+ * Each block is tentatively appended to the nearest white space segments of
+ * nearby rows, and the clusters of abutting blocks at the end of a segment
+ * are collapsed to their optimal locations. The block goes to the segment
+ * with the smallest displacement. Rows are visited in the order of their
+ * distances to the block, and the search stops once the vertical distance
+ * alone exceeds the best displacement found so far.
+ *
+ * Row information, white space detection and well rules are inherited from
+ * LGTetrisEx. Multi-row blocks are placed by Tetris sweeps first and become
+ * obstacles for the rest of blocks.
+ */
+class AbacusLegalizer : public LGTetrisEx {
+ public:
+  AbacusLegalizer();
+
+  bool StartPlacement() override;
+ protected:
+  struct AbacusCluster {
+    double e = 0; // total weight of blocks in this cluster
+    double q = 0; // sum of weighted target locations, shifted by widths
+    int w = 0; // total width of blocks in this cluster
+    int x = 0; // lower left x of this cluster
+    int first = 0; // index of the first block of this cluster in a segment
+  };
+  struct AbacusSegment {
+    int lo = 0;
+    int hi = 0;
+    int used_width = 0;
+    std::vector<Block *> blks;
+    std::vector<AbacusCluster> clusters;
+  };
+
+  bool LegalizeMultiRowBlocks(std::vector<Block *> &single_row_blks);
+  void RemoveSpaceFromRow(int row, int lo, int hi);
+  void InitAbacusSegments();
+  int TrialLocInSegment(
+      AbacusSegment const &segment, int width, double x
+  ) const;
+  double TrialPlaceInRow(
+      int row, Block &block, double bound, int &seg_id, int &x_loc
+  ) const;
+  void PlaceInSegment(AbacusSegment &segment, Block &block, double x);
+  bool FindSegmentAndPlace(Block &block);
+  void ApplySegmentLocations();
+  bool StartAbacusPlacement();
+
+  std::vector<double> target_llx_;
+  std::vector<double> target_lly_;
+  // white space segments of each row, one-to-one with row_segments_
+  std::vector<std::vector<AbacusSegment>> abacus_segments_;
+};
+
+}
+
+#endif //DALI_PLACER_LEGALIZER_LGABACUS_H_
@@ -29,10 +29,20 @@
 
 namespace dali {
 
+// rows with at most this many white space segments are scanned linearly,
+// which is faster than a binary search for short rows
+constexpr int kMaxLinearScanSegmentCount = 8;
+// at most this many white space boundaries near a desired cut are evaluated
+// when partitioning the region into bands
+constexpr int kMaxBandCutCandidateCount = 32;
+// half width of windows around band boundaries, in average block widths
+constexpr double kBandStitchWidthFactor = 8.0;
+
 LGTetrisEx::LGTetrisEx()
     : Placer(),
       row_height_(0),
       row_height_set_(false),
+      is_first_row_N_(true),
       legalize_from_left_(true),
       cur_iter_(0),
       max_iter_(20),
@@ -58,6 +68,16 @@ void LGTetrisEx::SetLeftBoundFactor(double k_left, double k_left_step) {
   k_left_step_ = k_left_step;
 }
 
+void LGTetrisEx::SetHpwlWeight(double hpwl_weight) {
+  DaliExpects(hpwl_weight >= 0, "Negative HPWL weight? " << hpwl_weight);
+  hpwl_weight_ = hpwl_weight;
+}
+
+void LGTetrisEx::SetNumBands(int num_bands) {
+  DaliExpects(num_bands >= 1, "Number of bands must be positive: " << num_bands);
+  num_bands_ = num_bands;
+}
+
 void LGTetrisEx::InitializeFromGriddedRowLegalizer(GriddedRowLegalizer *grlg) {
   DaliExpects(grlg != nullptr,
               "Cannot initialize LGTetrisEx from a nullptr GriddedRowLegalizer");
@@ -85,6 +105,7 @@ void LGTetrisEx::InitializeFromGriddedRowLegalizer(GriddedRowLegalizer *grlg) {
       row_segments_[i].emplace_back(seg.LLX(), seg.URX());
     }
   }
+  SortRowSegments();
 
   block_contour_.clear();
   block_contour_.resize(tot_num_rows_, left_);
@@ -184,6 +205,7 @@ void LGTetrisEx::DetectWhiteSpace() {
       }
     }
   }
+  SortRowSegments();
   //PlotAvailSpace();
 }
 
@@ -202,6 +224,7 @@ void LGTetrisEx::InitLegalizer() {
   SetRowInfoAuto();
   DetectWhiteSpace();
   InitIndexLocList();
+  ckt_ptr_->UpdatePinTable();
 }
 
 int LGTetrisEx::RowHeight() const {
@@ -244,12 +267,121 @@ int LGTetrisEx::AlignLocToRowLoc(double y_loc) const {
   return row_num * row_height_ + bottom_;
 }
 
+/****
+ * Sorts white space segments in each row by their left ends. Segments in a row
+ * do not overlap, so their right ends are sorted as well.
+ * ****/
+void LGTetrisEx::SortRowSegments() {
+  for (auto &segments: row_segments_) {
+    std::sort(
+        segments.begin(),
+        segments.end(),
+        [](const SegI &seg0, const SegI &seg1) {
+          return seg0.lo < seg1.lo;
+        }
+    );
+  }
+}
+
+/****
+ * Returns the index of the first segment in a row whose right end is no less
+ * than x, or the number of segments if there is no such segment
+ * ****/
+int LGTetrisEx::FirstSegmentEndingAfter(int row, int x) const {
+  auto &segments = row_segments_[row];
+  int seg_cnt = static_cast<int>(segments.size());
+  if (seg_cnt <= kMaxLinearScanSegmentCount) {
+    int id = 0;
+    while (id < seg_cnt && segments[id].hi < x) ++id;
+    return id;
+  }
+  auto it = std::lower_bound(
+      segments.begin(),
+      segments.end(),
+      x,
+      [](const SegI &seg, int val) {
+        return seg.hi < val;
+      }
+  );
+  return static_cast<int>(it - segments.begin());
+}
+
+/****
+ * Returns the index of the last segment in a row whose left end is no greater
+ * than x, or -1 if there is no such segment
+ * ****/
+int LGTetrisEx::LastSegmentStartingBefore(int row, int x) const {
+  auto &segments = row_segments_[row];
+  int seg_cnt = static_cast<int>(segments.size());
+  if (seg_cnt <= kMaxLinearScanSegmentCount) {
+    int id = 0;
+    while (id < seg_cnt && segments[id].lo <= x) ++id;
+    return id - 1;
+  }
+  auto it = std::upper_bound(
+      segments.begin(),
+      segments.end(),
+      x,
+      [](int val, const SegI &seg) {
+        return val < seg.lo;
+      }
+  );
+  return static_cast<int>(it - segments.begin()) - 1;
+}
+
+/****
+ * Returns the index of the segment in a row closest to [lo_x, hi_x], or -1 if
+ * this row has no white space. The distance of a segment [lo_seg, hi_seg] is
+ *        min(|lo_seg - lo_x| + |lo_seg - hi_x|, |hi_seg - lo_x| + |hi_seg - hi_x|)
+ * and is 0 if this segment covers [lo_x, hi_x]. Ties go to the left segment.
+ *
+ * Segments entirely on the left of lo_x get closer from left to right, and
+ * a segment overlapping [lo_x, hi_x] without covering it has an end inside
+ * [lo_x, hi_x], which gives the smallest possible distance. So only the last
+ * segment on the left of lo_x and the one after it need to be checked.
+ * ****/
+int LGTetrisEx::ClosestSegment(
+    int row,
+    int lo_x, int hi_x,
+    int &distance
+) const {
+  auto &segments = row_segments_[row];
+  int seg_cnt = static_cast<int>(segments.size());
+  int id = FirstSegmentEndingAfter(row, lo_x);
+  if (id < seg_cnt && segments[id].lo <= lo_x && segments[id].hi >= hi_x) {
+    distance = 0;
+    return id;
+  }
+
+  auto seg_distance = [&](const SegI &seg) {
+    return std::min(
+        abs(seg.lo - lo_x) + abs(seg.lo - hi_x),
+        abs(seg.hi - lo_x) + abs(seg.hi - hi_x)
+    );
+  };
+  int closest_id = -1;
+  distance = INT_MAX;
+  if (id > 0) {
+    closest_id = id - 1;
+    distance = seg_distance(segments[id - 1]);
+  }
+  if (id < seg_cnt) {
+    int tmp_distance = seg_distance(segments[id]);
+    if (tmp_distance < distance) {
+      closest_id = id;
+      distance = tmp_distance;
+    }
+  }
+  return closest_id;
+}
+
 /****
  * This member function checks if the region specified by [lo_x, hi_x] and [lo_row, hi_row] is legal or not
  *
  * If this space overlaps with fixed macros or out of placement range, then this space is illegal.
  *
- * To determine this space is legal, one just need to show that every row is legal
+ * To determine this space is legal, one just need to show that every row is legal,
+ * i.e., the last segment starting no later than lo_x in each row covers [lo_x, hi_x]
  * ****/
 bool LGTetrisEx::IsSpaceLegal(
     int lo_x, int hi_x,
@@ -264,39 +396,73 @@ bool LGTetrisEx::IsSpaceLegal(
     return false;
   }
 
-  bool is_tmp_row_legal;
-  bool is_partial_cover_lo;
-  bool is_partial_cover_hi;
-  bool is_before_seg;
-  int seg_count = 0;
-
-  bool is_all_row_legal = true;
   for (int i = lo_row; i <= hi_row; ++i) {
-    seg_count = row_segments_[i].size();
-    is_tmp_row_legal = false;
-    for (int j = 0; j < seg_count; ++j) {
-      if (row_segments_[i][j].lo <= lo_x
-          && row_segments_[i][j].hi >= hi_x) {
-        is_tmp_row_legal = true;
-        break;
-      }
+    int id = LastSegmentStartingBefore(i, lo_x);
+    if (id < 0 || row_segments_[i][id].hi < hi_x) return false;
+  }
+  return true;
+}
 
-      is_partial_cover_lo = row_segments_[i][j].lo > lo_x
-          && row_segments_[i][j].lo < hi_x;
-      is_partial_cover_hi = row_segments_[i][j].hi > lo_x
-          && row_segments_[i][j].hi < hi_x;
-      is_before_seg = row_segments_[i][j].lo >= hi_x;
-      if (is_partial_cover_lo || is_partial_cover_hi || is_before_seg) {
-        break;
+/****
+ * Returns the smallest x no less than lo_x such that [x, x + width] is white
+ * space in every row of [lo_row, hi_row], or fail_x if there is no such x.
+ *
+ * Each row moves x to its first fitting segment; this repeats until no row
+ * moves x. x only increases, so it stops after at most one round per segment.
+ * ****/
+int LGTetrisEx::FirstFitLocLeft(
+    int lo_x, int width,
+    int lo_row, int hi_row,
+    int fail_x
+) const {
+  int x = lo_x;
+  bool is_moved = true;
+  while (is_moved) {
+    is_moved = false;
+    for (int i = lo_row; i <= hi_row; ++i) {
+      auto &segments = row_segments_[i];
+      int seg_cnt = static_cast<int>(segments.size());
+      int id = FirstSegmentEndingAfter(i, x + width);
+      while (id < seg_cnt && segments[id].hi - std::max(x, segments[id].lo) < width) {
+        ++id;
+      }
+      if (id == seg_cnt) return fail_x;
+      if (segments[id].lo > x) {
+        x = segments[id].lo;
+        is_moved = true;
       }
     }
+  }
+  return x;
+}
 
-    if (!is_tmp_row_legal) {
-      is_all_row_legal = false;
-      break;
+/****
+ * Returns the largest x no greater than hi_x such that [x - width, x] is white
+ * space in every row of [lo_row, hi_row], or fail_x if there is no such x.
+ * ****/
+int LGTetrisEx::LastFitLocRight(
+    int hi_x, int width,
+    int lo_row, int hi_row,
+    int fail_x
+) const {
+  int x = hi_x;
+  bool is_moved = true;
+  while (is_moved) {
+    is_moved = false;
+    for (int i = lo_row; i <= hi_row; ++i) {
+      auto &segments = row_segments_[i];
+      int id = LastSegmentStartingBefore(i, x - width);
+      while (id >= 0 && std::min(x, segments[id].hi) - segments[id].lo < width) {
+        --id;
+      }
+      if (id < 0) return fail_x;
+      if (segments[id].hi < x) {
+        x = segments[id].hi;
+        is_moved = true;
+      }
     }
   }
-  return is_all_row_legal;
+  return x;
 }
 
 bool LGTetrisEx::IsFitToRow(int row_id, Block &block) const {
@@ -328,15 +494,23 @@ void LGTetrisEx::InitBlockContourForward() {
 
 void LGTetrisEx::InitAndSortBlockAscendingX() {
   blk_inits_.clear();
-  auto &blocks = ckt_ptr_->Blocks();
-  for (auto &blk: blocks) {
-    // skipp dummy blocks and fixed blocks
-    if (IsDummyBlock(blk)) continue;
-    if (blk.IsFixed()) continue;
-    double x_loc = blk.LLX() - k_width_ * blk.Width()
-        - k_height_ * blk.Height();
-    double y_loc = blk.LLY();
-    blk_inits_.emplace_back(&blk, x_loc, y_loc);
+  if (is_band_) {
+    for (Block *blk_ptr: band_blks_) {
+      double x_loc = blk_ptr->LLX() - k_width_ * blk_ptr->Width()
+          - k_height_ * blk_ptr->Height();
+      blk_inits_.emplace_back(blk_ptr, x_loc, blk_ptr->LLY());
+    }
+  } else {
+    auto &blocks = ckt_ptr_->Blocks();
+    for (auto &blk: blocks) {
+      // skipp dummy blocks and fixed blocks
+      if (IsDummyBlock(blk)) continue;
+      if (blk.IsFixed()) continue;
+      double x_loc = blk.LLX() - k_width_ * blk.Width()
+          - k_height_ * blk.Height();
+      double y_loc = blk.LLY();
+      blk_inits_.emplace_back(&blk, x_loc, y_loc);
+    }
   }
 
   std::sort(
@@ -421,20 +595,11 @@ int LGTetrisEx::WhiteSpaceBoundLeft(
 
   for (int i = lo_row; i <= hi_row; ++i) {
     tmp_bound = left_;
-    for (auto &seg: row_segments_[i]) {
-      if (seg.lo <= lo_x && seg.hi >= hi_x) {
-        tmp_bound = seg.lo;
-        min_distance = 0;
-        break;
-      }
-      int tmp_distance = std::min(
-          abs(seg.lo - lo_x) + abs(seg.lo - hi_x),
-          abs(seg.hi - lo_x) + abs(seg.hi - hi_x)
-      );
-      if (tmp_distance < min_distance) {
-        tmp_bound = seg.lo;
-        min_distance = tmp_distance;
-      }
+    int tmp_distance;
+    int id = ClosestSegment(i, lo_x, hi_x, tmp_distance);
+    if (id >= 0 && (tmp_distance == 0 || tmp_distance < min_distance)) {
+      tmp_bound = row_segments_[i][id].lo;
+      min_distance = tmp_distance;
     }
     white_space_bound = std::max(white_space_bound, tmp_bound);
   }
@@ -443,24 +608,143 @@ int LGTetrisEx::WhiteSpaceBoundLeft(
 }
 
 /****
- * Returns whether a legal location can be found, and put the final location to @params loc
- * ****/
-bool LGTetrisEx::FindLocLeft(Value2D<int> &loc, Block &block) {
-  bool is_successful;
+ * @brief Returns the leftmost location a block can be pushed to in rows
+ * [lo_row, hi_row], given the target location @param loc_x.
+ */
+int LGTetrisEx::CandidateLocLeft(
+    int loc_x, int width, int left_block_bound, int lo_row, int hi_row
+) {
+  int left_white_space_bound = WhiteSpaceBoundLeft(
+      loc_x, loc_x + width, lo_row, hi_row
+  );
+  int x = std::max(left_white_space_bound, left_block_bound);
+  for (int n = lo_row; n <= hi_row; ++n) {
+    x = std::max(x, block_contour_[n]);
+  }
+  return FirstFitLocLeft(x, width, lo_row, hi_row, x);
+}
 
-  int left_white_space_bound;
-  int search_start_row;
-  int search_end_row;
+/****
+ * @brief Evaluates the location a block can be pushed to if its bottom is in
+ * row @param start_row, and the cost of this location.
+ */
+LGTetrisEx::RowCandidate LGTetrisEx::EvaluateRowCandidate(
+    Value2D<int> const &loc,
+    Block &block,
+    int block_bound,
+    bool is_from_left,
+    int start_row
+) {
+  int width = block.Width();
+  int end_row = start_row + HeightToRow(block.Height()) - 1;
+  int y = RowToLoc(start_row);
+  RowCandidate candidate{start_row, 0, 0};
+  if (is_from_left) {
+    candidate.x = CandidateLocLeft(
+        loc.x, width, block_bound, start_row, end_row
+    );
+    candidate.cost = CandidateCost(loc, candidate.x, y, candidate.x);
+  } else {
+    candidate.x = CandidateLocRight(
+        loc.x, width, block_bound, start_row, end_row
+    );
+    candidate.cost = CandidateCost(loc, candidate.x, y, candidate.x - width);
+  }
+  return candidate;
+}
 
-  int best_row;
-  int best_loc_x;
-  double min_cost;
+bool LGTetrisEx::IsCandidateLegal(
+    RowCandidate const &candidate,
+    Block &block,
+    bool is_from_left
+) {
+  int width = block.Width();
+  int lo_x = is_from_left ? candidate.x : candidate.x - width;
+  return IsSpaceLegal(
+      lo_x, lo_x + width,
+      candidate.row, candidate.row + HeightToRow(block.Height()) - 1
+  );
+}
 
-  double tmp_cost;
-  int tmp_end_row;
-  int tmp_x;
-  int tmp_y;
+/****
+ * @brief Visits start rows in [lo_row, hi_row] in rings around the target row,
+ * and keeps the candidate with the lowest cost in @param best.
+ *
+ * The cost of a candidate in a row is at least the distance from this row to
+ * the target y location plus the HPWL lower bound, so a row is skipped if
+ * this lower bound cannot beat the best candidate, and the search stops once
+ * no row in a ring can. Ties go to the lower row, the same as a bottom-up
+ * scan.
+ */
+void LGTetrisEx::RingSearchRows(
+    Value2D<int> const &loc,
+    Block &block,
+    int block_bound,
+    bool is_from_left,
+    int lo_row,
+    int hi_row,
+    RowCandidate &best
+) {
+  if (lo_row > hi_row) return;
+  int center_row = std::clamp(LocToRow(loc.y), lo_row, hi_row);
+  double hpwl_bound = hpwl_weight_ * hpwl_lower_bound_;
+  for (int d = 0; center_row - d >= lo_row || center_row + d <= hi_row; ++d) {
+    bool is_ring_promising = false;
+    int ring[2] = {center_row - d, center_row + d};
+    for (int i = 0; i < (d == 0 ? 1 : 2); ++i) {
+      int start_row = ring[i];
+      if (start_row < lo_row || start_row > hi_row) continue;
+      double lower_bound = std::fabs(RowToLoc(start_row) - loc.y) + hpwl_bound;
+      if (lower_bound > best.cost) continue;
+      is_ring_promising = true;
+      if (!IsFitToRow(start_row, block)) continue;
+      RowCandidate candidate = EvaluateRowCandidate(
+          loc, block, block_bound, is_from_left, start_row
+      );
+      if (candidate.cost < best.cost
+          || (candidate.cost == best.cost && start_row < best.row)) {
+        best = candidate;
+      }
+    }
+    if (!is_ring_promising) break;
+  }
+}
+
+/****
+ * @brief Visits start rows in [lo_row, hi_row) when the ring search cannot
+ * find a legal location, keeps the candidate with the lowest cost in
+ * @param best, and the legal candidate with the lowest cost in
+ * @param best_legal.
+ */
+void LGTetrisEx::ExtendedSearchRows(
+    Value2D<int> const &loc,
+    Block &block,
+    int block_bound,
+    bool is_from_left,
+    int lo_row,
+    int hi_row,
+    RowCandidate &best,
+    RowCandidate &best_legal
+) {
+  for (int start_row = lo_row; start_row < hi_row; ++start_row) {
+    if (!IsFitToRow(start_row, block)) continue;
+    RowCandidate candidate = EvaluateRowCandidate(
+        loc, block, block_bound, is_from_left, start_row
+    );
+    if (candidate.cost < best.cost) {
+      best = candidate;
+    }
+    if (candidate.cost < best_legal.cost
+        && IsCandidateLegal(candidate, block, is_from_left)) {
+      best_legal = candidate;
+    }
+  }
+}
 
+/****
+ * Returns whether a legal location can be found, and put the final location to @params loc
+ * ****/
+bool LGTetrisEx::FindLocLeft(Value2D<int> &loc, Block &block) {
   int width = block.Width();
   int height = block.Height();
 
@@ -470,151 +754,46 @@ bool LGTetrisEx::FindLocLeft(Value2D<int> &loc, Block &block) {
 
   int lower_search_y = static_cast<int>(std::round(loc.y - k_start * height));
   int upper_search_y = static_cast<int>(std::round(loc.y + k_end * height));
-  search_start_row = std::max(0, LocToRow(lower_search_y));
-  search_end_row = std::min(max_search_row, LocToRow(upper_search_y));
-
-  best_row = 0;
-  best_loc_x = INT_MIN;
-  min_cost = DBL_MAX;
-
-  for (int tmp_start_row = search_start_row; tmp_start_row <= search_end_row;
-       ++tmp_start_row) {
-    tmp_end_row = tmp_start_row + blk_row_height - 1;
-    if (!IsFitToRow(tmp_start_row, block)) continue;
-    //left_white_space_bound = left_;
-    left_white_space_bound = WhiteSpaceBoundLeft(
-        loc.x, loc.x + width,
-        tmp_start_row, tmp_end_row
-    );
-
-    tmp_x = std::max(left_white_space_bound, left_block_bound);
-
-    for (int n = tmp_start_row; n <= tmp_end_row; ++n) {
-      tmp_x = std::max(tmp_x, block_contour_[n]);
-    }
-
-    tmp_y = RowToLoc(tmp_start_row);
+  int search_start_row = std::max(0, LocToRow(lower_search_y));
+  int search_end_row = std::min(max_search_row, LocToRow(upper_search_y));
 
-    tmp_cost = std::abs(tmp_x - loc.x) + std::abs(tmp_y - loc.y);
-    if (tmp_cost < min_cost) {
-      best_loc_x = tmp_x;
-      best_row = tmp_start_row;
-      min_cost = tmp_cost;
-    }
+  if (hpwl_weight_ > 0) {
+    CacheNetBoundingBoxes(block);
   }
-
-  int best_row_legal = 0;
-  int best_loc_x_legal = INT_MIN;
-  double min_cost_legal = DBL_MAX;
-  bool is_loc_legal = IsSpaceLegal(
-      best_loc_x, best_loc_x + width,
-      best_row, best_row + blk_row_height - 1
+  RowCandidate best{0, INT_MIN, DBL_MAX};
+  RingSearchRows(
+      loc, block, left_block_bound, true,
+      search_start_row, search_end_row, best
   );
 
-  if (!is_loc_legal) {
-    int old_start_row = search_start_row;
-    int old_end_row = search_end_row;
+  RowCandidate best_legal{0, INT_MIN, DBL_MAX};
+  if (!IsCandidateLegal(best, block, true)) {
     int extended_range = cur_iter_ * blk_row_height;
-    search_start_row = std::max(0, search_start_row - extended_range);
-    search_end_row =
-        std::min(max_search_row, search_end_row + extended_range);
-    for (int tmp_start_row = search_start_row;
-         tmp_start_row < old_start_row; ++tmp_start_row) {
-      tmp_end_row = tmp_start_row + blk_row_height - 1;
-      if (!IsFitToRow(tmp_start_row, block)) continue;
-      left_white_space_bound = WhiteSpaceBoundLeft(
-          loc.x, loc.x + width,
-          tmp_start_row, tmp_end_row
-      );
-      tmp_x = std::max(left_white_space_bound, left_block_bound);
-
-      for (int n = tmp_start_row; n <= tmp_end_row; ++n) {
-        tmp_x = std::max(tmp_x, block_contour_[n]);
-      }
-
-      tmp_y = RowToLoc(tmp_start_row);
-      //double tmp_hpwl = EstimatedHPWL(block, tmp_x, tmp_y);
-
-      tmp_cost = std::abs(tmp_x - loc.x) + std::abs(tmp_y - loc.y);
-      if (tmp_cost < min_cost) {
-        best_loc_x = tmp_x;
-        best_row = tmp_start_row;
-        min_cost = tmp_cost;
-      }
-
-      is_loc_legal = IsSpaceLegal(
-          tmp_x, tmp_x + width,
-          tmp_start_row, tmp_end_row
-      );
-
-      if (is_loc_legal) {
-        if (tmp_cost < min_cost_legal) {
-          best_loc_x_legal = tmp_x;
-          best_row_legal = tmp_start_row;
-          min_cost_legal = tmp_cost;
-        }
-      }
-    }
-    for (int tmp_start_row = old_end_row; tmp_start_row < search_end_row;
-         ++tmp_start_row) {
-      tmp_end_row = tmp_start_row + blk_row_height - 1;
-      if (!IsFitToRow(tmp_start_row, block)) continue;
-      left_white_space_bound = WhiteSpaceBoundLeft(
-          loc.x, loc.x + width,
-          tmp_start_row, tmp_end_row
-      );
-      tmp_x = std::max(left_white_space_bound, left_block_bound);
-
-      for (int n = tmp_start_row; n <= tmp_end_row; ++n) {
-        tmp_x = std::max(tmp_x, block_contour_[n]);
-      }
-
-      tmp_y = RowToLoc(tmp_start_row);
-      //double tmp_hpwl = EstimatedHPWL(block, tmp_x, tmp_y);
-
-      tmp_cost = std::abs(tmp_x - loc.x) + std::abs(tmp_y - loc.y);
-      if (tmp_cost < min_cost) {
-        best_loc_x = tmp_x;
-        best_row = tmp_start_row;
-        min_cost = tmp_cost;
-      }
-
-      is_loc_legal = IsSpaceLegal(
-          tmp_x, tmp_x + width,
-          tmp_start_row, tmp_end_row
-      );
-
-      if (is_loc_legal) {
-        if (tmp_cost < min_cost_legal) {
-          best_loc_x_legal = tmp_x;
-          best_row_legal = tmp_start_row;
-          min_cost_legal = tmp_cost;
-        }
-      }
-    }
-
+    ExtendedSearchRows(
+        loc, block, left_block_bound, true,
+        std::max(0, search_start_row - extended_range), search_start_row,
+        best, best_legal
+    );
+    ExtendedSearchRows(
+        loc, block, left_block_bound, true,
+        search_end_row, std::min(max_search_row, search_end_row + extended_range),
+        best, best_legal
+    );
   }
 
   // if still cannot find a legal location, enter fail mode
-  is_successful = IsSpaceLegal(
-      best_loc_x, best_loc_x + width,
-      best_row, best_row + blk_row_height - 1
-  );
+  bool is_successful = IsCandidateLegal(best, block, true);
   if (!is_successful) {
-    if (best_loc_x_legal >= left_ && best_loc_x_legal <= right_ - width) {
-      is_successful = IsSpaceLegal(
-          best_loc_x_legal, best_loc_x_legal + width,
-          best_row_legal, best_row_legal + blk_row_height - 1
-      );
+    if (best_legal.x >= left_ && best_legal.x <= right_ - width) {
+      is_successful = IsCandidateLegal(best_legal, block, true);
     }
     if (is_successful) {
-      best_loc_x = best_loc_x_legal;
-      best_row = best_row_legal;
+      best = best_legal;
     }
   }
 
-  loc.x = best_loc_x;
-  loc.y = RowToLoc(best_row);
+  loc.x = best.x;
+  loc.y = RowToLoc(best.row);
 
   return is_successful;
 }
@@ -674,14 +853,22 @@ void LGTetrisEx::InitBlockContourBackward() {
 
 void LGTetrisEx::InitAndSortBlockDescendingX() {
   blk_inits_.clear();
-  auto &blocks = ckt_ptr_->Blocks();
-  for (auto &blk: blocks) {
-    if (IsDummyBlock(blk)) continue;
-    if (blk.IsFixed()) continue;
-    double x_loc = blk.URX() + k_width_ * blk.Width()
-        + k_height_ * blk.Height();
-    double y_loc = blk.LLY();
-    blk_inits_.emplace_back(&blk, x_loc, y_loc);
+  if (is_band_) {
+    for (Block *blk_ptr: band_blks_) {
+      double x_loc = blk_ptr->URX() + k_width_ * blk_ptr->Width()
+          + k_height_ * blk_ptr->Height();
+      blk_inits_.emplace_back(blk_ptr, x_loc, blk_ptr->LLY());
+    }
+  } else {
+    auto &blocks = ckt_ptr_->Blocks();
+    for (auto &blk: blocks) {
+      if (IsDummyBlock(blk)) continue;
+      if (blk.IsFixed()) continue;
+      double x_loc = blk.URX() + k_width_ * blk.Width()
+          + k_height_ * blk.Height();
+      double y_loc = blk.LLY();
+      blk_inits_.emplace_back(&blk, x_loc, y_loc);
+    }
   }
   std::sort(
       blk_inits_.begin(),
@@ -743,6 +930,23 @@ bool LGTetrisEx::IsCurrentLocLegalRight(Value2D<int> &loc, Block &block) {
   return all_row_avail;
 }
 
+/****
+ * @brief Returns the rightmost location (upper x) a block can be pushed to in
+ * rows [lo_row, hi_row], given the target upper x location @param loc_x.
+ */
+int LGTetrisEx::CandidateLocRight(
+    int loc_x, int width, int right_block_bound, int lo_row, int hi_row
+) {
+  int right_white_space_bound = WhiteSpaceBoundRight(
+      loc_x - width, loc_x, lo_row, hi_row
+  );
+  int x = std::min(right_white_space_bound, right_block_bound);
+  for (int n = lo_row; n <= hi_row; ++n) {
+    x = std::min(x, block_contour_[n]);
+  }
+  return LastFitLocRight(x, width, lo_row, hi_row, x);
+}
+
 /****
  * Returns the right boundary of the white space region where this block should be placed
  *
@@ -761,19 +965,11 @@ int LGTetrisEx::WhiteSpaceBoundRight(
 
   for (int i = lo_row; i <= hi_row; ++i) {
     tmp_bound = right_;
-    for (auto &seg: row_segments_[i]) {
-      if (seg.lo <= lo_x && seg.hi >= hi_x) {
-        tmp_bound = seg.hi;
-        min_distance = 0;
-        break;
-      }
-      int tmp_distance = std::min(abs(seg.lo - lo_x) + abs(seg.lo - hi_x),
-                                  abs(seg.hi - lo_x)
-                                      + abs(seg.hi - hi_x));
-      if (tmp_distance < min_distance) {
-        tmp_bound = seg.hi;
-        min_distance = tmp_distance;
-      }
+    int tmp_distance;
+    int id = ClosestSegment(i, lo_x, hi_x, tmp_distance);
+    if (id >= 0 && (tmp_distance == 0 || tmp_distance < min_distance)) {
+      tmp_bound = row_segments_[i][id].hi;
+      min_distance = tmp_distance;
     }
     white_space_bound = std::min(white_space_bound, tmp_bound);
   }
@@ -782,179 +978,56 @@ int LGTetrisEx::WhiteSpaceBoundRight(
 }
 
 bool LGTetrisEx::FindLocRight(Value2D<int> &loc, Block &block) {
-  bool is_successful;
-
-  int blk_row_height;
-  int right_block_bound;
-  int right_white_space_bound;
-
-  int max_search_row;
-  int search_start_row;
-  int search_end_row;
-
-  int best_row;
-  int best_loc_x;
-  double min_cost;
-
-  double tmp_cost;
-  int tmp_end_row;
-  int tmp_x;
-  int tmp_y;
-
   int width = block.Width();
   int height = block.Height();
 
-  right_block_bound = (int) std::round(loc.x + k_left_ * width);
+  int right_block_bound = (int) std::round(loc.x + k_left_ * width);
   //right_block_bound = loc.x;
 
-  max_search_row = MaxRow(height);
-  blk_row_height = HeightToRow(height);
-
-  search_start_row = std::max(0, LocToRow(loc.y - k_start * height));
-  search_end_row = std::min(max_search_row, LocToRow(loc.y + k_end * height));
-
-  best_row = 0;
-  best_loc_x = INT_MAX;
-  min_cost = DBL_MAX;
-
-  for (int tmp_start_row = search_start_row; tmp_start_row <= search_end_row;
-       ++tmp_start_row) {
-    tmp_end_row = tmp_start_row + blk_row_height - 1;
-    if (!IsFitToRow(tmp_start_row, block)) continue;
-    right_white_space_bound = WhiteSpaceBoundRight(loc.x - width,
-                                                   loc.x,
-                                                   tmp_start_row,
-                                                   tmp_end_row);
-
-    tmp_x = std::min(right_white_space_bound, right_block_bound);
-    //tmp_x = std::min(right_, right_block_bound);
-
-    for (int n = tmp_start_row; n <= tmp_end_row; ++n) {
-      tmp_x = std::min(tmp_x, block_contour_[n]);
-    }
-
-    //if (tmp_x - width < left_) continue;
+  int max_search_row = MaxRow(height);
+  int blk_row_height = HeightToRow(height);
 
-    tmp_y = RowToLoc(tmp_start_row);
-    //double tmp_hpwl = EstimatedHPWL(block, tmp_x, tmp_y);
+  int search_start_row = std::max(0, LocToRow(loc.y - k_start * height));
+  int search_end_row =
+      std::min(max_search_row, LocToRow(loc.y + k_end * height));
 
-    tmp_cost = std::abs(tmp_x - loc.x) + std::abs(tmp_y - loc.y);
-    if (tmp_cost < min_cost) {
-      best_loc_x = tmp_x;
-      best_row = tmp_start_row;
-      min_cost = tmp_cost;
-    }
+  if (hpwl_weight_ > 0) {
+    CacheNetBoundingBoxes(block);
   }
+  RowCandidate best{0, INT_MAX, DBL_MAX};
+  RingSearchRows(
+      loc, block, right_block_bound, false,
+      search_start_row, search_end_row, best
+  );
 
-  int best_row_legal = 0;
-  int best_loc_x_legal = INT_MAX;
-  double min_cost_legal = DBL_MAX;
-  bool is_loc_legal = IsSpaceLegal(best_loc_x - width,
-                                   best_loc_x,
-                                   best_row,
-                                   best_row + blk_row_height - 1);
-
-  if (!is_loc_legal) {
-    int old_start_row = search_start_row;
-    int old_end_row = search_end_row;
+  RowCandidate best_legal{0, INT_MAX, DBL_MAX};
+  if (!IsCandidateLegal(best, block, false)) {
     int extended_range = cur_iter_ * blk_row_height;
-    search_start_row = std::max(0, search_start_row - extended_range);
-    search_end_row =
-        std::min(max_search_row, search_end_row + extended_range);
-    for (int tmp_start_row = search_start_row;
-         tmp_start_row < old_start_row; ++tmp_start_row) {
-      tmp_end_row = tmp_start_row + blk_row_height - 1;
-      if (!IsFitToRow(tmp_start_row, block)) continue;
-      right_white_space_bound = WhiteSpaceBoundRight(loc.x - width,
-                                                     loc.x,
-                                                     tmp_start_row,
-                                                     tmp_end_row);
-
-      tmp_x = std::min(right_white_space_bound, right_block_bound);
-
-      for (int n = tmp_start_row; n <= tmp_end_row; ++n) {
-        tmp_x = std::min(tmp_x, block_contour_[n]);
-      }
-
-      tmp_y = RowToLoc(tmp_start_row);
-      //double tmp_hpwl = EstimatedHPWL(block, tmp_x, tmp_y);
-
-      tmp_cost = std::abs(tmp_x - loc.x) + std::abs(tmp_y - loc.y);
-      if (tmp_cost < min_cost) {
-        best_loc_x = tmp_x;
-        best_row = tmp_start_row;
-        min_cost = tmp_cost;
-      }
-
-      is_loc_legal =
-          IsSpaceLegal(tmp_x - width, tmp_x, tmp_start_row, tmp_end_row);
-
-      if (is_loc_legal) {
-        if (tmp_cost < min_cost_legal) {
-          best_loc_x_legal = tmp_x;
-          best_row_legal = tmp_start_row;
-          min_cost_legal = tmp_cost;
-        }
-      }
-    }
-    for (int tmp_start_row = old_end_row; tmp_start_row < search_end_row;
-         ++tmp_start_row) {
-      tmp_end_row = tmp_start_row + blk_row_height - 1;
-      if (!IsFitToRow(tmp_start_row, block)) continue;
-      right_white_space_bound = WhiteSpaceBoundRight(loc.x - width,
-                                                     loc.x,
-                                                     tmp_start_row,
-                                                     tmp_end_row);
-
-      tmp_x = std::min(right_white_space_bound, right_block_bound);
-
-      for (int n = tmp_start_row; n <= tmp_end_row; ++n) {
-        tmp_x = std::min(tmp_x, block_contour_[n]);
-      }
-
-      tmp_y = RowToLoc(tmp_start_row);
-      //double tmp_hpwl = EstimatedHPWL(block, tmp_x, tmp_y);
-
-      tmp_cost = std::abs(tmp_x - loc.x) + std::abs(tmp_y - loc.y);
-      if (tmp_cost < min_cost) {
-        best_loc_x = tmp_x;
-        best_row = tmp_start_row;
-        min_cost = tmp_cost;
-      }
-
-      is_loc_legal =
-          IsSpaceLegal(tmp_x - width, tmp_x, tmp_start_row, tmp_end_row);
-
-      if (is_loc_legal) {
-        if (tmp_cost < min_cost_legal) {
-          best_loc_x_legal = tmp_x;
-          best_row_legal = tmp_start_row;
-          min_cost_legal = tmp_cost;
-        }
-      }
-    }
-
+    ExtendedSearchRows(
+        loc, block, right_block_bound, false,
+        std::max(0, search_start_row - extended_range), search_start_row,
+        best, best_legal
+    );
+    ExtendedSearchRows(
+        loc, block, right_block_bound, false,
+        search_end_row, std::min(max_search_row, search_end_row + extended_range),
+        best, best_legal
+    );
   }
 
   // if still cannot find a legal location, enter fail mode
-  is_successful = IsSpaceLegal(best_loc_x - width, best_loc_x,
-                               best_row, best_row + blk_row_height - 1);
+  bool is_successful = IsCandidateLegal(best, block, false);
   if (!is_successful) {
-    if (best_loc_x_legal <= right_ && best_loc_x_legal >= left_ + width) {
-      is_successful =
-          IsSpaceLegal(best_loc_x_legal - width,
-                       best_loc_x_legal,
-                       best_row_legal,
-                       best_row_legal + blk_row_height - 1);
+    if (best_legal.x <= right_ && best_legal.x >= left_ + width) {
+      is_successful = IsCandidateLegal(best_legal, block, false);
     }
     if (is_successful) {
-      best_loc_x = best_loc_x_legal;
-      best_row = best_row_legal;
+      best = best_legal;
     }
   }
 
-  loc.x = best_loc_x;
-  loc.y = RowToLoc(best_row);;
+  loc.x = best.x;
+  loc.y = RowToLoc(best.row);
 
   return is_successful;
 }
@@ -1011,37 +1084,723 @@ void LGTetrisEx::UpdateLeftLimitFactor() {
   k_left_ += k_left_step_;
 }
 
-double LGTetrisEx::EstimatedHPWL(Block &block, int x, int y) {
-  double max_x = x;
-  double max_y = y;
-  double min_x = x;
-  double min_y = y;
-  double tot_hpwl = 0;
+/****
+ * @brief Caches the bounding box of each net connected to @param block,
+ * excluding pins of this block, and the span of pin offsets of this block on
+ * this net. Pins are visited through the flattened pin table, but offsets
+ * are resolved for the current orientations of blocks, because sweeps flip
+ * blocks without refreshing the table. A band legalizer reads other blocks
+ * from the frozen snapshot instead, whose orientations are the ones in the
+ * table. Nets with more than 100 pins are ignored, and so are nets without
+ * other pins.
+ *
+ * After this, the HPWL of these nets for any location of this block can be
+ * evaluated by CachedHPWL() without visiting pins again.
+ */
+void LGTetrisEx::CacheNetBoundingBoxes(Block &block) {
+  NetPinTable const &pin_table = ckt_ptr_->PinTable();
+  std::vector<Block> &blocks = ckt_ptr_->Blocks();
+  Block const *blk_data = blocks.data();
+  int const *pin_blk_ids = pin_table.PinBlkIds().data();
+  double const *pin_offsets_x = pin_table.PinOffsetsX().data();
+  double const *pin_offsets_y = pin_table.PinOffsetsY().data();
+  Pin *const *pin_ptrs = pin_table.PinPtrs().data();
+  int blk_id = block.Id();
+  BlockOrient blk_orient = block.Orient();
   auto &net_list = ckt_ptr_->Nets();
+
+  net_lo_x_.clear();
+  net_hi_x_.clear();
+  net_lo_y_.clear();
+  net_hi_y_.clear();
+  pin_lo_x_.clear();
+  pin_hi_x_.clear();
+  pin_lo_y_.clear();
+  pin_hi_y_.clear();
+  hpwl_lower_bound_ = 0;
   for (auto &net_num: block.NetList()) {
     auto &net = net_list[net_num];
     if (net.PinCnt() > 100) continue;
-    for (auto &blk_pin: net.BlockPins()) {
-      if (blk_pin.BlkPtr() != &block) {
-        min_x = std::min(min_x, blk_pin.AbsX());
-        min_y = std::min(min_y, blk_pin.AbsY());
-        max_x = std::max(max_x, blk_pin.AbsX());
-        max_y = std::max(max_y, blk_pin.AbsY());
+    double min_x = DBL_MAX;
+    double min_y = DBL_MAX;
+    double max_x = -DBL_MAX;
+    double max_y = -DBL_MAX;
+    double min_offset_x = DBL_MAX;
+    double min_offset_y = DBL_MAX;
+    double max_offset_x = -DBL_MAX;
+    double max_offset_y = -DBL_MAX;
+    int pin_end = pin_table.NetPinEnd(net_num);
+    for (int k = pin_table.NetPinBegin(net_num); k < pin_end; ++k) {
+      int pin_blk_id = pin_blk_ids[k];
+      if (pin_blk_id == blk_id) {
+        double offset_x = pin_ptrs[k]->OffsetX(blk_orient);
+        double offset_y = pin_ptrs[k]->OffsetY(blk_orient);
+        min_offset_x = std::min(min_offset_x, offset_x);
+        min_offset_y = std::min(min_offset_y, offset_y);
+        max_offset_x = std::max(max_offset_x, offset_x);
+        max_offset_y = std::max(max_offset_y, offset_y);
+      } else {
+        double pin_x, pin_y;
+        if (frozen_llx_ == nullptr) {
+          Block const &pin_blk = blk_data[pin_blk_id];
+          BlockOrient pin_blk_orient = pin_blk.Orient();
+          pin_x = pin_ptrs[k]->OffsetX(pin_blk_orient) + pin_blk.LLX();
+          pin_y = pin_ptrs[k]->OffsetY(pin_blk_orient) + pin_blk.LLY();
+        } else {
+          pin_x = pin_offsets_x[k] + (*frozen_llx_)[pin_blk_id];
+          pin_y = pin_offsets_y[k] + (*frozen_lly_)[pin_blk_id];
+        }
+        min_x = std::min(min_x, pin_x);
+        min_y = std::min(min_y, pin_y);
+        max_x = std::max(max_x, pin_x);
+        max_y = std::max(max_y, pin_y);
       }
     }
-    tot_hpwl += (max_x - min_x) + (max_y - min_y);
+    if (min_x > max_x || min_offset_x > max_offset_x) continue;
+    net_lo_x_.push_back(min_x);
+    net_hi_x_.push_back(max_x);
+    net_lo_y_.push_back(min_y);
+    net_hi_y_.push_back(max_y);
+    pin_lo_x_.push_back(min_offset_x);
+    pin_hi_x_.push_back(max_offset_x);
+    pin_lo_y_.push_back(min_offset_y);
+    pin_hi_y_.push_back(max_offset_y);
+    hpwl_lower_bound_ += (max_x - min_x) + (max_y - min_y);
   }
+}
 
+/****
+ * @brief Returns the HPWL of nets cached by CacheNetBoundingBoxes() if the
+ * lower left corner of the block is at (@param llx, @param lly). Each net
+ * only needs a few min/max operations, and the loop over nets is vectorized.
+ */
+double LGTetrisEx::CachedHPWL(double llx, double lly) const {
+  int net_cnt = static_cast<int>(net_lo_x_.size());
+  double const *net_lo_x = net_lo_x_.data();
+  double const *net_hi_x = net_hi_x_.data();
+  double const *net_lo_y = net_lo_y_.data();
+  double const *net_hi_y = net_hi_y_.data();
+  double const *pin_lo_x = pin_lo_x_.data();
+  double const *pin_hi_x = pin_hi_x_.data();
+  double const *pin_lo_y = pin_lo_y_.data();
+  double const *pin_hi_y = pin_hi_y_.data();
+  double tot_hpwl = 0;
+#pragma omp simd reduction(+:tot_hpwl)
+  for (int i = 0; i < net_cnt; ++i) {
+    double lo_x = llx + pin_lo_x[i];
+    double hi_x = llx + pin_hi_x[i];
+    double lo_y = lly + pin_lo_y[i];
+    double hi_y = lly + pin_hi_y[i];
+    double min_x = lo_x < net_lo_x[i] ? lo_x : net_lo_x[i];
+    double max_x = hi_x > net_hi_x[i] ? hi_x : net_hi_x[i];
+    double min_y = lo_y < net_lo_y[i] ? lo_y : net_lo_y[i];
+    double max_y = hi_y > net_hi_y[i] ? hi_y : net_hi_y[i];
+    tot_hpwl += (max_x - min_x) + (max_y - min_y);
+  }
   return tot_hpwl;
 }
 
-bool LGTetrisEx::StartPlacement() {
-  PrintStartStatement("LGTetrisEx Legalization");
+/****
+ * @brief Returns the cost of a candidate location (@param x, @param y) for a
+ * target location @param loc, which is the displacement plus the weighted
+ * HPWL of cached nets. @param llx is the lower left x of the candidate, which
+ * differs from @param x when legalizing from right.
+ */
+double LGTetrisEx::CandidateCost(
+    Value2D<int> const &loc, int x, int y, double llx
+) const {
+  double cost = std::abs(x - loc.x) + std::abs(y - loc.y);
+  if (hpwl_weight_ > 0) {
+    cost += hpwl_weight_ * CachedHPWL(llx, y);
+  }
+  return cost;
+}
 
-  is_row_assignment_ = false;
-  InitLegalizer();
-  ResetLeftLimitFactor();
+/****
+ * @brief Estimate the HPWL of nets connected to a block if this block is
+ * placed at (x, y).
+ */
+double LGTetrisEx::EstimatedHPWL(Block &block, int x, int y) {
+  CacheNetBoundingBoxes(block);
+  return CachedHPWL(x, y);
+}
+
+/****
+ * @brief Returns the number of rows which are not crossed by any white space
+ * segment at @param x, i.e., @param x is not strictly inside any segment.
+ */
+int LGTetrisEx::CountRowsSeparatedAt(int x) const {
+  int cnt = 0;
+  for (int row = 0; row < tot_num_rows_; ++row) {
+    auto &segments = row_segments_[row];
+    int id = FirstSegmentEndingAfter(row, x);
+    bool is_crossed = id < static_cast<int>(segments.size())
+        && segments[id].lo < x && segments[id].hi > x;
+    if (!is_crossed) ++cnt;
+  }
+  return cnt;
+}
+
+/****
+ * @brief Returns a location within @param tolerance of @param x to cut the
+ * region. Blocks near a cut cannot be pushed across it, so the location
+ * with the fewest blocks within @param radius, whose lower left x are in
+ * @param sorted_llx, is preferred. Among locations equally crowded, the one
+ * separating the most rows wins, e.g., an edge of a macro or of a white
+ * space region, and then the one closest to @param x.
+ *
+ * Candidates are boundaries of white space segments and evenly spaced
+ * locations around @param x.
+ */
+int LGTetrisEx::SelectBandCut(
+    int x,
+    int tolerance,
+    std::vector<double> const &sorted_llx,
+    int radius
+) const {
+  std::vector<int> boundaries;
+  for (int row = 0; row < tot_num_rows_; ++row) {
+    auto &segments = row_segments_[row];
+    int seg_cnt = static_cast<int>(segments.size());
+    for (int id = FirstSegmentEndingAfter(row, x - tolerance);
+         id < seg_cnt && segments[id].lo <= x + tolerance; ++id) {
+      if (segments[id].lo >= x - tolerance) {
+        boundaries.push_back(segments[id].lo);
+      }
+      if (segments[id].hi <= x + tolerance) {
+        boundaries.push_back(segments[id].hi);
+      }
+    }
+  }
+  std::sort(boundaries.begin(), boundaries.end());
+  boundaries.erase(
+      std::unique(boundaries.begin(), boundaries.end()),
+      boundaries.end()
+  );
+  std::sort(
+      boundaries.begin(),
+      boundaries.end(),
+      [x](int lhs, int rhs) {
+        return std::abs(lhs - x) < std::abs(rhs - x)
+            || (std::abs(lhs - x) == std::abs(rhs - x) && lhs < rhs);
+      }
+  );
+  if (static_cast<int>(boundaries.size()) > kMaxBandCutCandidateCount) {
+    boundaries.resize(kMaxBandCutCandidateCount);
+  }
+
+  std::vector<int> candidates = boundaries;
+  for (int k = 0; k <= kMaxBandCutCandidateCount; ++k) {
+    candidates.push_back(
+        x - tolerance + 2 * tolerance * k / kMaxBandCutCandidateCount
+    );
+  }
+
+  int best_cut = x;
+  int min_crowd = INT_MAX;
+  int max_separated_row_cnt = -1;
+  for (auto &cut: candidates) {
+    int crowd = static_cast<int>(
+        std::lower_bound(sorted_llx.begin(), sorted_llx.end(), cut + radius)
+            - std::lower_bound(
+                sorted_llx.begin(), sorted_llx.end(), cut - radius
+            )
+    );
+    if (crowd > min_crowd) continue;
+    int separated_row_cnt = CountRowsSeparatedAt(cut);
+    if (crowd == min_crowd) {
+      if (separated_row_cnt < max_separated_row_cnt) continue;
+      if (separated_row_cnt == max_separated_row_cnt
+          && std::abs(cut - x) >= std::abs(best_cut - x)) {
+        continue;
+      }
+    }
+    best_cut = cut;
+    min_crowd = crowd;
+    max_separated_row_cnt = separated_row_cnt;
+  }
+  return best_cut;
+}
+
+/****
+ * @brief Partitions the placement region into vertical bands. Cuts are first
+ * placed such that bands have roughly the same total width of movable
+ * blocks, then moved to nearby locations with few blocks around, see
+ * SelectBandCut(). A band narrower than twice the widest movable block is
+ * merged into its neighbor.
+ *
+ * @param cuts: the left boundary of each band, followed by the right
+ * boundary of the last band.
+ */
+void LGTetrisEx::CollectBandCuts(std::vector<int> &cuts) {
+  std::vector<std::pair<double, int>> loc_widths;
+  double tot_width = 0;
+  int max_width = 0;
+  for (auto &blk: ckt_ptr_->Blocks()) {
+    if (IsDummyBlock(blk)) continue;
+    if (blk.IsFixed()) continue;
+    loc_widths.emplace_back(blk.LLX(), blk.Width());
+    tot_width += blk.Width();
+    max_width = std::max(max_width, blk.Width());
+  }
+  std::sort(loc_widths.begin(), loc_widths.end());
+  std::vector<double> sorted_llx;
+  sorted_llx.reserve(loc_widths.size());
+  for (auto &loc_width: loc_widths) {
+    sorted_llx.push_back(loc_width.first);
+  }
+
+  cuts.clear();
+  cuts.push_back(left_);
+  int tolerance = RegionWidth() / num_bands_ / 4;
+  int min_band_width = 2 * max_width;
+  double accumulated_width = 0;
+  size_t cur = 0;
+  for (int k = 1; k < num_bands_; ++k) {
+    double target_width = tot_width * k / num_bands_;
+    while (cur < loc_widths.size() && accumulated_width < target_width) {
+      accumulated_width += loc_widths[cur].second;
+      ++cur;
+    }
+    if (cur == loc_widths.size()) break;
+    int x = static_cast<int>(std::round(loc_widths[cur].first));
+    int cut = SelectBandCut(x, tolerance, sorted_llx, max_width);
+    if (cut - cuts.back() < min_band_width) continue;
+    if (right_ - cut < min_band_width) break;
+    cuts.push_back(cut);
+  }
+  cuts.push_back(right_);
+}
+
+/****
+ * @brief Initializes a legalizer for the region [@param left, @param right),
+ * where row r is further limited to [@param row_lo[r], @param row_hi[r]).
+ * This legalizer shares row information and parameters with this one, but
+ * has its own contour and white space, so it can run concurrently with
+ * legalizers of other disjoint regions. Only blocks in @param blks are
+ * legalized by it.
+ */
+void LGTetrisEx::InitBandLegalizer(
+    LGTetrisEx &band,
+    int left,
+    int right,
+    std::vector<int> const &row_lo,
+    std::vector<int> const &row_hi,
+    std::vector<Block *> const &blks
+) const {
+  band.ckt_ptr_ = ckt_ptr_;
+  band.left_ = left;
+  band.right_ = right;
+  band.bottom_ = bottom_;
+  band.top_ = top_;
+  band.row_height_ = row_height_;
+  band.row_height_set_ = row_height_set_;
+  band.is_first_row_N_ = is_first_row_N_;
+  band.tot_num_rows_ = tot_num_rows_;
+  band.legalize_from_left_ = legalize_from_left_;
+  band.max_iter_ = max_iter_;
+  band.k_width_ = k_width_;
+  band.k_height_ = k_height_;
+  band.k_left_init_ = k_left_init_;
+  band.k_left_step_ = k_left_step_;
+  band.k_start = k_start;
+  band.k_end = k_end;
+  band.hpwl_weight_ = hpwl_weight_;
+  band.is_band_ = true;
+  band.band_blks_ = blks;
+
+  band.block_contour_.assign(tot_num_rows_, left);
+  band.row_segments_.resize(tot_num_rows_);
+  for (int row = 0; row < tot_num_rows_; ++row) {
+    auto &segments = band.row_segments_[row];
+    int lo = std::max(row_lo[row], left);
+    int hi = std::min(row_hi[row], right);
+    int seg_cnt = static_cast<int>(row_segments_[row].size());
+    for (int id = FirstSegmentEndingAfter(row, lo);
+         id < seg_cnt && row_segments_[row][id].lo < hi; ++id) {
+      int seg_lo = std::max(row_segments_[row][id].lo, lo);
+      int seg_hi = std::min(row_segments_[row][id].hi, hi);
+      if (seg_lo < seg_hi) {
+        segments.emplace_back(seg_lo, seg_hi);
+      }
+    }
+  }
+}
+
+/****
+ * @brief Re-legalizes blocks near boundaries between bands. Blocks were not
+ * allowed to cross these boundaries, so those whose targets are close to a
+ * boundary may have been pushed far away.
+ *
+ * For each boundary, blocks lying entirely in a window around it are moved
+ * back to their targets and legalized again inside the window, with other
+ * blocks overlapping the window acting as obstacles. The new result is kept
+ * only if it is legal and reduces the total displacement of these blocks.
+ * Windows are disjoint, so they are stitched concurrently.
+ */
+void LGTetrisEx::StitchBandBoundaries(
+    std::vector<int> const &cuts,
+    std::vector<std::vector<Block *>> const &band_blks,
+    std::vector<double> const &target_llx,
+    std::vector<double> const &target_lly
+) {
+  int band_cnt = static_cast<int>(cuts.size()) - 1;
+  int window_cnt = band_cnt - 1;
+  double tot_width = 0;
+  size_t blk_cnt = 0;
+  int min_band_width = INT_MAX;
+  for (int i = 0; i < band_cnt; ++i) {
+    for (auto &blk_ptr: band_blks[i]) {
+      tot_width += blk_ptr->Width();
+    }
+    blk_cnt += band_blks[i].size();
+    min_band_width = std::min(min_band_width, cuts[i + 1] - cuts[i]);
+  }
+  if (blk_cnt == 0) return;
+  int half_width = std::min(
+      static_cast<int>(std::round(kBandStitchWidthFactor * tot_width / blk_cnt)),
+      min_band_width / 3
+  );
+  if (half_width <= 0) return;
+
+  // blocks to re-legalize and available space of each row in each window,
+  // all collected before any block moves
+  std::vector<std::vector<Block *>> stitch_blks(window_cnt);
+  std::vector<std::vector<int>> row_lo(window_cnt);
+  std::vector<std::vector<int>> row_hi(window_cnt);
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads_) default(none) shared(window_cnt, cuts, band_blks, half_width, stitch_blks, row_lo, row_hi)
+  for (int k = 0; k < window_cnt; ++k) {
+    int lo_x = cuts[k + 1] - half_width;
+    int hi_x = cuts[k + 1] + half_width;
+    row_lo[k].assign(tot_num_rows_, lo_x);
+    row_hi[k].assign(tot_num_rows_, hi_x);
+    for (int i = k; i <= k + 1; ++i) {
+      for (auto &blk_ptr: band_blks[i]) {
+        double llx = blk_ptr->LLX();
+        double urx = blk_ptr->URX();
+        if (urx <= lo_x || llx >= hi_x) continue;
+        if (llx >= lo_x && urx <= hi_x) {
+          stitch_blks[k].push_back(blk_ptr);
+          continue;
+        }
+        int start_row = StartRow(static_cast<int>(blk_ptr->LLY()));
+        int end_row = EndRow(static_cast<int>(blk_ptr->URY()));
+        for (int r = start_row; r <= end_row; ++r) {
+          if (llx < lo_x) {
+            row_lo[k][r] = std::max(
+                row_lo[k][r], static_cast<int>(std::ceil(urx))
+            );
+          } else {
+            row_hi[k][r] = std::min(
+                row_hi[k][r], static_cast<int>(std::floor(llx))
+            );
+          }
+        }
+      }
+    }
+  }
+
+  int accepted_cnt = 0;
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads_) default(none) shared(window_cnt, cuts, half_width, stitch_blks, row_lo, row_hi, target_llx, target_lly) reduction(+:accepted_cnt)
+  for (int k = 0; k < window_cnt; ++k) {
+    auto &blks = stitch_blks[k];
+    if (blks.empty()) continue;
+    size_t sz = blks.size();
+    std::vector<double> llx(sz), lly(sz);
+    std::vector<BlockOrient> orients(sz);
+    double old_displacement = 0;
+    for (size_t j = 0; j < sz; ++j) {
+      Block &blk = *blks[j];
+      llx[j] = blk.LLX();
+      lly[j] = blk.LLY();
+      orients[j] = blk.Orient();
+      old_displacement += std::fabs(llx[j] - target_llx[blk.Id()])
+          + std::fabs(lly[j] - target_lly[blk.Id()]);
+      blk.SetLoc(target_llx[blk.Id()], target_lly[blk.Id()]);
+    }
+
+    LGTetrisEx window;
+    InitBandLegalizer(
+        window,
+        cuts[k + 1] - half_width,
+        cuts[k + 1] + half_width,
+        row_lo[k],
+        row_hi[k],
+        blks
+    );
+    window.frozen_llx_ = &target_llx;
+    window.frozen_lly_ = &target_lly;
+    bool is_legal = window.SweepUntilLegal();
+
+    double new_displacement = 0;
+    for (auto &blk_ptr: blks) {
+      new_displacement += std::fabs(blk_ptr->LLX() - target_llx[blk_ptr->Id()])
+          + std::fabs(blk_ptr->LLY() - target_lly[blk_ptr->Id()]);
+    }
+    if (is_legal && new_displacement < old_displacement) {
+      ++accepted_cnt;
+    } else {
+      for (size_t j = 0; j < sz; ++j) {
+        blks[j]->SetLoc(llx[j], lly[j]);
+        blks[j]->SetOrient(orients[j]);
+      }
+    }
+  }
+
+  BOOST_LOG_TRIVIAL(info)
+    << "  stitched " << accepted_cnt << "/" << window_cnt
+    << " band boundaries, window width " << 2 * half_width << "\n";
+}
+
+/****
+ * @brief Assigns movable blocks to bands. Blocks are sorted by their lower
+ * left x, and each band takes a contiguous range of them. A block first
+ * belongs to the band containing its lower left x. Since blocks cannot be
+ * pushed into neighboring bands, blocks overfilling a band are then moved to
+ * its neighbors, such that no band is much denser than the whole region.
+ * Blocks closest to the boundaries are moved first.
+ *
+ * Blocks whose locations are outside of their bands are moved to the closest
+ * boundary of their bands.
+ */
+void LGTetrisEx::AssignBlocksToBands(
+    std::vector<int> const &cuts,
+    std::vector<std::vector<Block *>> &band_blks
+) {
+  int band_cnt = static_cast<int>(cuts.size()) - 1;
+  std::vector<Block *> blks;
+  for (auto &blk: ckt_ptr_->Blocks()) {
+    if (IsDummyBlock(blk)) continue;
+    if (blk.IsFixed()) continue;
+    blks.push_back(&blk);
+  }
+  std::sort(
+      blks.begin(),
+      blks.end(),
+      [](Block const *lhs, Block const *rhs) {
+        return (lhs->LLX() < rhs->LLX())
+            || (lhs->LLX() == rhs->LLX() && lhs->Id() < rhs->Id());
+      }
+  );
+
+  // white space in each band and the area of blocks, in row * length
+  std::vector<double> capacity(band_cnt, 0);
+  for (int row = 0; row < tot_num_rows_; ++row) {
+    for (auto &segment: row_segments_[row]) {
+      for (int i = 0; i < band_cnt; ++i) {
+        int lo = std::max(segment.lo, cuts[i]);
+        int hi = std::min(segment.hi, cuts[i + 1]);
+        if (lo < hi) capacity[i] += hi - lo;
+      }
+    }
+  }
+  double tot_capacity = 0;
+  for (auto &cap: capacity) {
+    tot_capacity += cap;
+  }
+  std::vector<double> accumulated_area(blks.size() + 1, 0);
+  for (size_t j = 0; j < blks.size(); ++j) {
+    accumulated_area[j + 1] = accumulated_area[j]
+        + blks[j]->Width() * HeightToRow(blks[j]->Height());
+  }
+  double utilization = tot_capacity > 0 ?
+                       accumulated_area.back() / tot_capacity : 1.0;
+  double max_utilization = utilization + (1 - utilization) / 2;
+
+  // band i takes blocks [splits[i], splits[i + 1])
+  std::vector<size_t> splits(band_cnt + 1, 0);
+  splits[band_cnt] = blks.size();
+  for (int i = 1; i < band_cnt; ++i) {
+    splits[i] = std::lower_bound(
+        blks.begin(),
+        blks.end(),
+        cuts[i],
+        [](Block const *blk_ptr, int x) {
+          return blk_ptr->LLX() < x;
+        }
+    ) - blks.begin();
+  }
+  // push overflow to the right
+  for (int i = 0; i + 1 < band_cnt; ++i) {
+    double max_area = accumulated_area[splits[i]]
+        + max_utilization * capacity[i];
+    size_t max_split = std::upper_bound(
+        accumulated_area.begin() + splits[i],
+        accumulated_area.end(),
+        max_area
+    ) - accumulated_area.begin() - 1;
+    splits[i + 1] = std::max(splits[i], std::min(splits[i + 1], max_split));
+  }
+  // push overflow to the left
+  for (int i = band_cnt - 1; i > 0; --i) {
+    double min_area = accumulated_area[splits[i + 1]]
+        - max_utilization * capacity[i];
+    size_t min_split = std::lower_bound(
+        accumulated_area.begin(),
+        accumulated_area.begin() + splits[i + 1] + 1,
+        min_area
+    ) - accumulated_area.begin();
+    splits[i] = std::min(splits[i + 1], std::max(splits[i], min_split));
+  }
 
+  band_blks.assign(band_cnt, std::vector<Block *>());
+  for (int i = 0; i < band_cnt; ++i) {
+    band_blks[i].assign(blks.begin() + splits[i], blks.begin() + splits[i + 1]);
+    for (auto &blk_ptr: band_blks[i]) {
+      double llx = std::max(
+          std::min(blk_ptr->LLX(), double(cuts[i + 1] - blk_ptr->Width())),
+          double(cuts[i])
+      );
+      blk_ptr->SetLLX(llx);
+    }
+  }
+}
+
+/****
+ * @brief Legalizes bands which are not legal yet concurrently, each band
+ * with its own contour and white space.
+ */
+void LGTetrisEx::LegalizeBands(
+    std::vector<int> const &cuts,
+    std::vector<std::vector<Block *>> const &band_blks,
+    std::vector<double> const &target_llx,
+    std::vector<double> const &target_lly,
+    std::vector<char> &is_band_legal
+) {
+  int band_cnt = static_cast<int>(cuts.size()) - 1;
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads_) default(none) shared(band_cnt, cuts, band_blks, target_llx, target_lly, is_band_legal)
+  for (int i = 0; i < band_cnt; ++i) {
+    if (is_band_legal[i]) continue;
+    std::vector<int> row_lo(tot_num_rows_, cuts[i]);
+    std::vector<int> row_hi(tot_num_rows_, cuts[i + 1]);
+    LGTetrisEx band;
+    InitBandLegalizer(
+        band, cuts[i], cuts[i + 1], row_lo, row_hi, band_blks[i]
+    );
+    band.frozen_llx_ = &target_llx;
+    band.frozen_lly_ = &target_lly;
+    is_band_legal[i] = band.SweepUntilLegal();
+  }
+}
+
+/****
+ * @brief Merges each illegal band with its right neighbor, or with its left
+ * neighbor if it is the last band, so that blocks which do not fit into a
+ * band can use space of the neighbor. Legal bands which are not merged keep
+ * their results, blocks in merged bands are moved back to their targets.
+ */
+void LGTetrisEx::MergeIllegalBands(
+    std::vector<int> &cuts,
+    std::vector<std::vector<Block *>> &band_blks,
+    std::vector<double> const &target_llx,
+    std::vector<double> const &target_lly,
+    std::vector<char> &is_band_legal
+) {
+  int band_cnt = static_cast<int>(cuts.size()) - 1;
+  std::vector<int> merged_cuts{cuts[0]};
+  std::vector<std::vector<Block *>> merged_band_blks;
+  std::vector<char> is_merged_band_legal;
+  for (int i = 0; i < band_cnt; ++i) {
+    if (is_band_legal[i]) {
+      merged_cuts.push_back(cuts[i + 1]);
+      merged_band_blks.push_back(std::move(band_blks[i]));
+      is_merged_band_legal.push_back(1);
+      continue;
+    }
+    if (i + 1 < band_cnt) {
+      // merge with the right neighbor
+      merged_cuts.push_back(cuts[i + 2]);
+      merged_band_blks.push_back(std::move(band_blks[i]));
+      auto &blks = merged_band_blks.back();
+      blks.insert(blks.end(), band_blks[i + 1].begin(), band_blks[i + 1].end());
+      is_merged_band_legal.push_back(0);
+      ++i;
+    } else {
+      // the last band, merge with the left neighbor
+      merged_cuts.back() = cuts[i + 1];
+      auto &blks = merged_band_blks.back();
+      blks.insert(blks.end(), band_blks[i].begin(), band_blks[i].end());
+      is_merged_band_legal.back() = 0;
+    }
+  }
+
+  int merged_band_cnt = static_cast<int>(merged_band_blks.size());
+  for (int i = 0; i < merged_band_cnt; ++i) {
+    if (is_merged_band_legal[i]) continue;
+    for (auto &blk_ptr: merged_band_blks[i]) {
+      blk_ptr->SetLoc(target_llx[blk_ptr->Id()], target_lly[blk_ptr->Id()]);
+    }
+  }
+
+  cuts.swap(merged_cuts);
+  band_blks.swap(merged_band_blks);
+  is_band_legal.swap(is_merged_band_legal);
+}
+
+/****
+ * @brief Legalizes vertical bands of the placement region concurrently, each
+ * band with its own contour. If only a few bands are illegal, they are merged
+ * with their neighbors and legalized again. Boundaries between bands are
+ * stitched at the end.
+ *
+ * @return true if every band is legal.
+ */
+bool LGTetrisEx::StartBandPlacement() {
+  std::vector<int> cuts;
+  CollectBandCuts(cuts);
+  int band_cnt = static_cast<int>(cuts.size()) - 1;
+  BOOST_LOG_TRIVIAL(info)
+    << "  partitioned into " << band_cnt << " band(s)\n";
+  if (band_cnt <= 1) return false;
+
+  // bands read pin offsets of frozen blocks from the pin table, so it must
+  // match orientations of the snapshot below
+  ckt_ptr_->UpdatePinTable();
+  auto &blocks = ckt_ptr_->Blocks();
+  std::vector<double> target_llx(blocks.size());
+  std::vector<double> target_lly(blocks.size());
+  for (auto &blk: blocks) {
+    target_llx[blk.Id()] = blk.LLX();
+    target_lly[blk.Id()] = blk.LLY();
+  }
+  std::vector<std::vector<Block *>> band_blks;
+  AssignBlocksToBands(cuts, band_blks);
+
+  std::vector<char> is_band_legal(band_cnt, 0);
+  bool is_success = false;
+  while (true) {
+    LegalizeBands(cuts, band_blks, target_llx, target_lly, is_band_legal);
+    int legal_band_cnt = static_cast<int>(
+        std::count(is_band_legal.begin(), is_band_legal.end(), 1)
+    );
+    BOOST_LOG_TRIVIAL(info)
+      << "  " << legal_band_cnt << "/" << band_cnt << " band(s) legal\n";
+    is_success = legal_band_cnt == band_cnt;
+    // give up early if the placement is too dense locally to be split
+    if (is_success || 2 * legal_band_cnt < band_cnt) break;
+    MergeIllegalBands(cuts, band_blks, target_llx, target_lly, is_band_legal);
+    band_cnt = static_cast<int>(cuts.size()) - 1;
+    if (band_cnt <= 1) break;
+  }
+  if (!is_success) {
+    // global sweeps start from the original locations
+    for (auto &blk: blocks) {
+      blk.SetLoc(target_llx[blk.Id()], target_lly[blk.Id()]);
+    }
+    return false;
+  }
+
+  StitchBandBoundaries(cuts, band_blks, target_llx, target_lly);
+  ReportHPWL();
+  return true;
+}
+
+/****
+ * @brief Sweeps from left and from right alternately until all blocks are
+ * legal or the maximum number of iterations is reached.
+ */
+bool LGTetrisEx::SweepUntilLegal() {
+  ResetLeftLimitFactor();
   bool is_success = false;
   for (cur_iter_ = 0; cur_iter_ < max_iter_; ++cur_iter_) {
     if (legalize_from_left_) {
@@ -1052,11 +1811,36 @@ bool LGTetrisEx::StartPlacement() {
     legalize_from_left_ = !legalize_from_left_;
     UpdateLeftLimitFactor();
     //GenMATLABTable("lg" + std::to_string(cur_iter_) + "_result.txt");
-    ReportHPWL();
+    if (!is_band_) {
+      ReportHPWL();
+    }
     if (is_success) {
       break;
     }
   }
+  return is_success;
+}
+
+bool LGTetrisEx::StartPlacement() {
+  PrintStartStatement("LGTetrisEx Legalization");
+
+  is_row_assignment_ = false;
+  InitLegalizer();
+
+  bool is_success = false;
+  if (num_bands_ > 1) {
+    ProfileScope scope("band legalization");
+    is_success = StartBandPlacement();
+    if (!is_success) {
+      BOOST_LOG_TRIVIAL(info)
+        << "Band legalization failed, falling back to global sweeps\n";
+    }
+  }
+  if (!is_success) {
+    ProfileScope scope("sweeps");
+    is_success = SweepUntilLegal();
+    GlobalProfiler().AddCount("iterations", std::min(cur_iter_ + 1, max_iter_));
+  }
 
   PrintEndStatement("LGTetrisEx Legalization", is_success);
 
@@ -1090,6 +1874,7 @@ bool LGTetrisEx::StartRowAssignment() {
   if (!is_success) {
     BOOST_LOG_TRIVIAL(info) << "Placement illegal\n";
   }
+  GlobalProfiler().AddCount("iterations", std::min(cur_iter_ + 1, max_iter_));
 
   ReportHPWL();
   ReportBoundingBox();
@@ -1098,6 +1883,7 @@ bool LGTetrisEx::StartRowAssignment() {
   elapsed_time_.PrintTimeElapsed();
 
   ReportMemory();
+  GlobalProfiler().EndStage(profile_stage_);
 
   return true;
 }
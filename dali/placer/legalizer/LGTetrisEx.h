@@ -38,6 +38,8 @@ class LGTetrisEx : public Placer {
   void SetMaxIteration(size_t max_iter);
   void SetWidthHeightFactor(double k_width, double k_height);
   void SetLeftBoundFactor(double k_left, double k_left_step);
+  void SetHpwlWeight(double hpwl_weight);
+  void SetNumBands(int num_bands);
 
   void InitializeFromGriddedRowLegalizer(GriddedRowLegalizer *grlg);
   void SetRowInfoAuto();
@@ -53,16 +55,68 @@ class LGTetrisEx : public Placer {
   int LocToRow(int y_loc) const;
   int RowToLoc(int row_num, int displacement = 0) const;
   int AlignLocToRowLoc(double y_loc) const;
+  void SortRowSegments();
+  int FirstSegmentEndingAfter(int row, int x) const;
+  int LastSegmentStartingBefore(int row, int x) const;
+  int ClosestSegment(int row, int lo_x, int hi_x, int &distance) const;
   bool IsSpaceLegal(int lo_x, int hi_x, int lo_row, int hi_row) const;
+  int FirstFitLocLeft(
+      int lo_x, int width, int lo_row, int hi_row, int fail_x
+  ) const;
+  int LastFitLocRight(
+      int hi_x, int width, int lo_row, int hi_row, int fail_x
+  ) const;
 
   bool IsFitToRow(int row_id, Block &block) const;
   bool ShouldOrientN(int row_id, Block &block) const;
 
+  // a candidate location of a block, x is the lower x in the left sweep, and
+  // the upper x in the right sweep
+  struct RowCandidate {
+    int row;
+    int x;
+    double cost;
+  };
+  RowCandidate EvaluateRowCandidate(
+      Value2D<int> const &loc,
+      Block &block,
+      int block_bound,
+      bool is_from_left,
+      int start_row
+  );
+  bool IsCandidateLegal(
+      RowCandidate const &candidate,
+      Block &block,
+      bool is_from_left
+  );
+  void RingSearchRows(
+      Value2D<int> const &loc,
+      Block &block,
+      int block_bound,
+      bool is_from_left,
+      int lo_row,
+      int hi_row,
+      RowCandidate &best
+  );
+  void ExtendedSearchRows(
+      Value2D<int> const &loc,
+      Block &block,
+      int block_bound,
+      bool is_from_left,
+      int lo_row,
+      int hi_row,
+      RowCandidate &best,
+      RowCandidate &best_legal
+  );
+
   void InitBlockContourForward();
   void InitAndSortBlockAscendingX();
   void UseSpaceLeft(Block const &block);
   bool IsCurrentLocLegalLeft(Value2D<int> &loc, Block &block);
   int WhiteSpaceBoundLeft(int lo_x, int hi_x, int lo_row, int hi_row);
+  int CandidateLocLeft(
+      int loc_x, int width, int left_block_bound, int lo_row, int hi_row
+  );
   bool FindLocLeft(Value2D<int> &loc, Block &block);
   bool LocalLegalizationLeft();
 
@@ -71,13 +125,64 @@ class LGTetrisEx : public Placer {
   void UseSpaceRight(Block const &block);
   bool IsCurrentLocLegalRight(Value2D<int> &loc, Block &block);
   int WhiteSpaceBoundRight(int lo_x, int hi_x, int lo_row, int hi_row);
+  int CandidateLocRight(
+      int loc_x, int width, int right_block_bound, int lo_row, int hi_row
+  );
   bool FindLocRight(Value2D<int> &loc, Block &block);
   bool LocalLegalizationRight();
 
   void ResetLeftLimitFactor();
   void UpdateLeftLimitFactor();
+  void CacheNetBoundingBoxes(Block &block);
+  double CachedHPWL(double llx, double lly) const;
+  double CandidateCost(
+      Value2D<int> const &loc, int x, int y, double llx
+  ) const;
   double EstimatedHPWL(Block &block, int x, int y);
 
+  int CountRowsSeparatedAt(int x) const;
+  int SelectBandCut(
+      int x,
+      int tolerance,
+      std::vector<double> const &sorted_llx,
+      int radius
+  ) const;
+  void CollectBandCuts(std::vector<int> &cuts);
+  void InitBandLegalizer(
+      LGTetrisEx &band,
+      int left,
+      int right,
+      std::vector<int> const &row_lo,
+      std::vector<int> const &row_hi,
+      std::vector<Block *> const &blks
+  ) const;
+  void AssignBlocksToBands(
+      std::vector<int> const &cuts,
+      std::vector<std::vector<Block *>> &band_blks
+  );
+  void LegalizeBands(
+      std::vector<int> const &cuts,
+      std::vector<std::vector<Block *>> const &band_blks,
+      std::vector<double> const &target_llx,
+      std::vector<double> const &target_lly,
+      std::vector<char> &is_band_legal
+  );
+  void MergeIllegalBands(
+      std::vector<int> &cuts,
+      std::vector<std::vector<Block *>> &band_blks,
+      std::vector<double> const &target_llx,
+      std::vector<double> const &target_lly,
+      std::vector<char> &is_band_legal
+  );
+  void StitchBandBoundaries(
+      std::vector<int> const &cuts,
+      std::vector<std::vector<Block *>> const &band_blks,
+      std::vector<double> const &target_llx,
+      std::vector<double> const &target_lly
+  );
+  bool StartBandPlacement();
+  bool SweepUntilLegal();
+
   bool StartPlacement() override;
 
   bool StartRowAssignment();
@@ -85,6 +190,8 @@ class LGTetrisEx : public Placer {
   void GenAvailSpace(std::string const &name_of_file = "avail_space.txt");
  protected:
   bool is_row_assignment_ = false;
+  // white space segments in each row, sorted and disjoint, so every query on
+  // a row is a binary search
   std::vector<std::vector<SegI>> row_segments_;
   std::vector<int> block_contour_;
   std::vector<BlkInitPair> blk_inits_;
@@ -108,6 +215,34 @@ class LGTetrisEx : public Placer {
   double k_start = 2; // 4
   double k_end = 3; // 5
 
+  // weight of the estimated HPWL in the cost of a candidate location, the
+  // cost is the displacement only when this weight is 0
+  double hpwl_weight_ = 0.0;
+  // bounding boxes of nets of the block being placed, excluding pins of this
+  // block, and the span of pin offsets of this block on each net, stored as
+  // separate arrays so that the HPWL kernel can be vectorized
+  std::vector<double> net_lo_x_;
+  std::vector<double> net_hi_x_;
+  std::vector<double> net_lo_y_;
+  std::vector<double> net_hi_y_;
+  std::vector<double> pin_lo_x_;
+  std::vector<double> pin_hi_x_;
+  std::vector<double> pin_lo_y_;
+  std::vector<double> pin_hi_y_;
+  // sum of bounding box sizes above, no location of the block does better
+  double hpwl_lower_bound_ = 0.0;
+
+  // number of vertical bands legalized concurrently, the whole region is
+  // legalized by one sweep when this number is 1
+  int num_bands_ = 1;
+  // a band legalizer only sweeps blocks in band_blks_, and reads locations of
+  // other blocks from frozen_llx_ and frozen_lly_ when estimating HPWL,
+  // because those blocks may be moved by other bands at the same time
+  bool is_band_ = false;
+  std::vector<Block *> band_blks_;
+  std::vector<double> const *frozen_llx_ = nullptr;
+  std::vector<double> const *frozen_lly_ = nullptr;
+
   //cached data
   int tot_num_rows_;
 
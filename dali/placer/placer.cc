@@ -369,6 +369,7 @@ bool Placer::IsDummyBlock(Block &blk) {
 }
 
 void Placer::PrintStartStatement(std::string const &name_of_process) {
+  profile_stage_ = GlobalProfiler().BeginStage(name_of_process);
   elapsed_time_.RecordStartTime();
   PrintHorizontalLine();
   BOOST_LOG_TRIVIAL(info) << "Start " << name_of_process << "\n";
@@ -395,6 +396,7 @@ void Placer::PrintEndStatement(
   // report memory
   ReportMemory();
 
+  GlobalProfiler().EndStage(profile_stage_);
 }
 
 }
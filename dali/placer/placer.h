@@ -29,6 +29,7 @@
 
 #include "dali/circuit/circuit.h"
 #include "dali/common/elapsed_time.h"
+#include "dali/common/profiler.h"
 
 namespace dali {
 
@@ -157,6 +158,8 @@ class Placer {
 
   // record start/end time
   ElapsedTime elapsed_time_;
+  // the stage of this placer in the global profiler
+  int profile_stage_ = -1;
 
   double GetBlkHPWL(Block &blk);
 
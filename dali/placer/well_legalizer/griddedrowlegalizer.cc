@@ -20,6 +20,7 @@
  ******************************************************************************/
 #include "griddedrowlegalizer.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "dali/common/config.h"
@@ -27,6 +28,7 @@
 #include "dali/common/helper.h"
 #include "dali/common/logging.h"
 #include "dali/common/memory.h"
+#include "dali/common/profiler.h"
 
 #include "dali/placer/well_legalizer/optimizationhelper.h"
 #include "dali/placer/well_legalizer/stripehelper.h"
@@ -59,6 +61,10 @@ void GriddedRowLegalizer::SetUseCplex(bool use_cplex) {
   use_cplex_ = use_cplex;
 }
 
+void GriddedRowLegalizer::SetUseAdmm(bool use_admm) {
+  use_admm_ = use_admm;
+}
+
 void GriddedRowLegalizer::SetExternalSpacePartitioner(
     AbstractSpacePartitioner *p_external_partitioner
 ) {
@@ -229,6 +235,19 @@ void GriddedRowLegalizer::SetLegalizationMaxIteration(int max_iteration) {
   greedy_max_iter_ = max_iteration;
 }
 
+void GriddedRowLegalizer::SetAdmmMaxIteration(int max_iteration) {
+  DaliExpects(max_iteration > 0, "ADMM needs at least one iteration");
+  admm_max_iter_ = max_iteration;
+}
+
+void GriddedRowLegalizer::SetLocalReorderRange(int local_reorder_range) {
+  DaliExpects(
+      local_reorder_range >= 2 && local_reorder_range <= 8,
+      "Local reorder range should be in [2, 8]"
+  );
+  local_reorder_range_ = local_reorder_range;
+}
+
 bool GriddedRowLegalizer::StripeLegalizationUpward(
     Stripe &stripe,
     bool use_init_loc
@@ -289,10 +308,12 @@ void GriddedRowLegalizer::CleanUpTemporaryRowSegments() {
 
 bool GriddedRowLegalizer::UpwardDownwardLegalization(bool use_init_loc) {
   BOOST_LOG_TRIVIAL(info) << "Start upward-downward legalization\n";
+  ProfileScope scope("upward-downward legalization");
   ElapsedTime elapsed_time;
   elapsed_time.RecordStartTime();
 
   bool res = true;
+  long long iter_cnt = 0;
   for (ClusterStripe &col : col_list_) {
     bool is_success = true;
     for (Stripe &stripe : col.stripe_list_) {
@@ -301,6 +322,7 @@ bool GriddedRowLegalizer::UpwardDownwardLegalization(bool use_init_loc) {
       for (greedy_cur_iter_ = 0;
            greedy_cur_iter_ < greedy_max_iter_;
            ++greedy_cur_iter_) {
+        ++iter_cnt;
         if (is_from_bottom) {
           is_success = StripeLegalizationUpward(stripe, use_init_loc);
         } else {
@@ -314,6 +336,7 @@ bool GriddedRowLegalizer::UpwardDownwardLegalization(bool use_init_loc) {
       res = res && is_success;
     }
   }
+  GlobalProfiler().AddCount("iterations", iter_cnt);
   CleanUpTemporaryRowSegments();
   ReportDisplacement();
 
@@ -358,6 +381,7 @@ bool GriddedRowLegalizer::StripeLegalizationDownwardWithDispCheck(
 bool GriddedRowLegalizer::UpwardDownwardLegalizationWithDispCheck(bool use_init_loc) {
   BOOST_LOG_TRIVIAL(info)
     << "Start upward-downward legalization with displacement checking\n";
+  ProfileScope scope("upward-downward legalization");
   ElapsedTime elapsed_time;
   elapsed_time.RecordStartTime();
 
@@ -416,20 +440,31 @@ bool GriddedRowLegalizer::IsPlacementLegal() {
 }
 
 bool GriddedRowLegalizer::OptimizeDisplacementUsingQuadraticProgramming() {
-#if DALI_USE_CPLEX
   BOOST_LOG_TRIVIAL(info)
     << "Optimizing displacement X using quadratic programming\n";
-  double wall_time = get_wall_time();
-  double cpu_time = get_cpu_time();
+  ProfileScope scope("quadratic programming");
+  ElapsedTime elapsed_time;
+  elapsed_time.RecordStartTime();
 
   bool is_successful = true;
-  for (auto &col: col_list_) {
-    for (auto &stripe: col.stripe_list_) {
-      bool res = stripe.OptimizeDisplacementUsingQuadraticProgramming(
-          number_of_threads_);
-      is_successful = res && is_successful;
+#if DALI_USE_CPLEX
+  if (use_admm_) {
+    BOOST_LOG_TRIVIAL(info) << "Using the built-in ADMM solver\n";
+    is_successful = OptimizeDisplacementUsingAdmm();
+  } else {
+    for (auto &col: col_list_) {
+      for (auto &stripe: col.stripe_list_) {
+        bool res = stripe.OptimizeDisplacementUsingQuadraticProgramming(
+            number_of_threads_);
+        is_successful = res && is_successful;
+      }
     }
   }
+#else
+  BOOST_LOG_TRIVIAL(info)
+    << "CPLEX not found, using the built-in ADMM solver\n";
+  is_successful = OptimizeDisplacementUsingAdmm();
+#endif
 
   if (is_successful) {
     BOOST_LOG_TRIVIAL(info) << "Quadratic programming complete\n";
@@ -437,29 +472,57 @@ bool GriddedRowLegalizer::OptimizeDisplacementUsingQuadraticProgramming() {
     BOOST_LOG_TRIVIAL(info) << "Quadratic programming solution not found\n";
   }
 
-  wall_time = get_wall_time() - wall_time;
-  cpu_time = get_cpu_time() - cpu_time;
-  BOOST_LOG_TRIVIAL(info)
-    << "(wall time: " << wall_time << "s, cpu time: " << cpu_time << "s)\n";
+  elapsed_time.RecordEndTime();
+  elapsed_time.PrintTimeElapsed();
 
   ReportDisplacement();
   return is_successful;
-#else
-  BOOST_LOG_TRIVIAL(info)
-    << "Skip optimizing displacement using quadratic programming: CPLEX not found\n";
-  return true;
-#endif
+}
+
+/****
+ * @brief Solve the displacement QP of every stripe using the built-in ADMM
+ * solver. Stripes do not share blocks, so they are solved in parallel. The
+ * solver starts from the greedy locations if they are available, and blocks
+ * in a stripe where it does not converge stay at these locations.
+ */
+bool GriddedRowLegalizer::OptimizeDisplacementUsingAdmm() {
+  std::vector<Stripe *> stripe_ptrs;
+  for (auto &col: col_list_) {
+    for (auto &stripe: col.stripe_list_) {
+      stripe_ptrs.push_back(&stripe);
+    }
+  }
+
+  int sz = static_cast<int>(stripe_ptrs.size());
+  std::vector<char> is_solved(sz, 0);
+  bool is_warm_start = is_greedy_loc_cached_;
+#pragma omp parallel for schedule(dynamic, 1) num_threads(number_of_threads_) default(none) shared(sz, stripe_ptrs, is_solved, is_warm_start)
+  for (int i = 0; i < sz; ++i) {
+    is_solved[i] = stripe_ptrs[i]->OptimizeDisplacementUsingAdmm(
+        is_warm_start, admm_max_iter_
+    );
+  }
+
+  size_t unsolved_cnt = std::count(is_solved.begin(), is_solved.end(), 0);
+  if (unsolved_cnt > 0) {
+    BOOST_LOG_TRIVIAL(info)
+      << "ADMM does not converge in " << unsolved_cnt << " stripes\n";
+  }
+  return unsolved_cnt == 0;
 }
 
 bool GriddedRowLegalizer::IterativeDisplacementOptimization() {
   BOOST_LOG_TRIVIAL(info)
     << "Optimizing displacement X using the consensus algorithm\n";
+  ProfileScope scope("consensus optimization");
   ElapsedTime elapsed_time;
   elapsed_time.RecordStartTime();
 
   for (auto &col : col_list_) {
     for (auto &stripe : col.stripe_list_) {
-      stripe.IterativeCellReordering(consensus_max_iter_, number_of_threads_);
+      stripe.IterativeCellReordering(
+          consensus_max_iter_, number_of_threads_, local_reorder_range_
+      );
     }
   }
 
@@ -562,11 +625,17 @@ bool GriddedRowLegalizer::StartPlacement() {
   if (is_success) {
     if (use_cplex_) {
       RestoreInitialLocX();
-      IsLeftmostPlacementLegal();
       //IterativeCellReordering();
-      //bool is_qp_solved = OptimizeDisplacementUsingQuadraticProgramming();
-      OptimizeDisplacementUsingQuadraticProgramming();
-      SaveQPLoc();
+      bool is_qp_solved = OptimizeDisplacementUsingQuadraticProgramming();
+      if (is_qp_solved) {
+        SaveQPLoc();
+      } else {
+        BOOST_LOG_TRIVIAL(info)
+          << "Falling back to the consensus algorithm\n";
+        RestoreInitialLocX();
+        IterativeDisplacementOptimization();
+        SaveConsensusLoc();
+      }
       ReportHPWL();
     } else {
       RestoreInitialLocX();
@@ -39,11 +39,13 @@ class GriddedRowLegalizer : public Placer {
   void CheckWellInfo();
   void SetThreads(int number_of_threads);
   void SetUseCplex(bool use_cplex);
+  void SetUseAdmm(bool use_admm);
 
   void SetExternalSpacePartitioner(AbstractSpacePartitioner *p_external_partitioner);
   void SetPartitionMode(int partitioning_mode_);
   void SetMaxRowWidth(double max_row_width);
   void PartitionSpaceAndBlocks();
+  std::vector<ClusterStripe> &ColList() { return col_list_; }
 
   void SetWellTapCellParameters(
       bool is_well_tap_needed = true,
@@ -65,6 +67,8 @@ class GriddedRowLegalizer : public Placer {
   void RestoreConsensusLocX();
 
   void SetLegalizationMaxIteration(int max_iteration);
+  void SetAdmmMaxIteration(int max_iteration);
+  void SetLocalReorderRange(int local_reorder_range);
   bool StripeLegalizationUpward(Stripe &stripe, bool use_init_loc);
   bool StripeLegalizationDownward(Stripe &stripe, bool use_init_loc);
   void CleanUpTemporaryRowSegments();
@@ -83,6 +87,7 @@ class GriddedRowLegalizer : public Placer {
   bool IsLeftmostPlacementLegal();
   bool IsPlacementLegal();
   bool OptimizeDisplacementUsingQuadraticProgramming();
+  bool OptimizeDisplacementUsingAdmm();
 
   bool IterativeDisplacementOptimization();
 
@@ -129,6 +134,8 @@ class GriddedRowLegalizer : public Placer {
   int greedy_max_iter_ = 30;
 
   int consensus_max_iter_ = 1000;
+  // number of cells in a sliding window when reordering cells in a row segment
+  int local_reorder_range_ = 3;
 
   bool is_init_loc_cached_ = false;
   bool is_greedy_loc_cached_ = false;
@@ -138,6 +145,10 @@ class GriddedRowLegalizer : public Placer {
 
   int number_of_threads_ = 1;
   bool use_cplex_ = false;
+  // solve the displacement QP using the built-in ADMM solver even if CPLEX
+  // is available
+  bool use_admm_ = false;
+  int admm_max_iter_ = 1000;
 
   void SetWellTapCellNecessary(bool is_well_tap_needed);
   void SetWellTapCellPlacementMode(bool is_checker_board_mode);
@@ -20,6 +20,9 @@
  ******************************************************************************/
 #include "rowsegment.h"
 
+#include <algorithm>
+#include <cfloat>
+
 #include "dali/common/helper.h"
 #include "dali/placer/well_legalizer/blocksegment.h"
 #include "dali/placer/well_legalizer/optimizationhelper.h"
@@ -27,6 +30,11 @@
 
 namespace dali {
 
+// the subset table of a window grows as 2^range
+constexpr int kMaxLocalReorderRange = 8;
+// insertion sort gives up on a list needing more shifts than this per block
+constexpr size_t kMaxInsertionSortShiftPerBlock = 8;
+
 void RowSegment::SetLLX(int lx) {
   lx_ = lx;
 }
@@ -73,17 +81,45 @@ void RowSegment::AddBlockRegion(Block *blk_ptr, int region_id) {
   blk_regions_.emplace_back(blk_ptr, region_id);
 }
 
+/****
+ * @brief Sort blocks in this segment by their lower x locations, and by ids
+ * for ties.
+ *
+ * Between two consensus iterations, cells only move a little, so the list is
+ * nearly sorted and insertion sort repairs it in almost linear time. If the
+ * list turns out to be far from sorted, for example right after the segment is
+ * built, it falls back to std::sort. Both give the same order.
+ */
+void RowSegment::SortBlockRegions() {
+  auto is_less = [](const BlockRegion &br0, const BlockRegion &br1) {
+    return (br0.p_blk->LLX() < br1.p_blk->LLX()) ||
+        ((br0.p_blk->LLX() == br1.p_blk->LLX())
+            && (br0.p_blk->Id() < br1.p_blk->Id()));
+  };
+
+  size_t sz = blk_regions_.size();
+  size_t max_shift_cnt = kMaxInsertionSortShiftPerBlock * sz;
+  size_t shift_cnt = 0;
+  for (size_t i = 1; i < sz; ++i) {
+    if (!is_less(blk_regions_[i], blk_regions_[i - 1])) continue;
+    BlockRegion blk_region = blk_regions_[i];
+    size_t j = i;
+    while (j > 0 && is_less(blk_region, blk_regions_[j - 1])) {
+      blk_regions_[j] = blk_regions_[j - 1];
+      --j;
+    }
+    blk_regions_[j] = blk_region;
+    shift_cnt += i - j;
+    if (shift_cnt > max_shift_cnt) {
+      std::sort(blk_regions_.begin(), blk_regions_.end(), is_less);
+      return;
+    }
+  }
+}
+
 void RowSegment::MinDisplacementLegalization(bool use_init_loc) {
   if (blk_regions_.empty()) return;
-  std::sort(
-      blk_regions_.begin(),
-      blk_regions_.end(),
-      [](const BlockRegion &br0, const BlockRegion &br1) {
-        return (br0.p_blk->LLX() < br1.p_blk->LLX()) ||
-            ((br0.p_blk->LLX() == br1.p_blk->LLX())
-                && (br0.p_blk->Id() < br1.p_blk->Id()));
-      }
-  );
+  SortBlockRegions();
 
   std::vector<BlkDispVar> vars;
   vars.reserve(blk_regions_.size());
@@ -159,84 +195,259 @@ double RowSegment::DispCost(
   return quadratic_disp;
 }
 
+/****
+ * @brief Displacement cost of a cell if it is placed at a given location.
+ * Like DispCost(), the linear mode only counts the weight of the cell.
+ */
+double RowSegment::SlotCost(BlkDispVar &var, double loc, bool is_linear) {
+  if (is_linear) {
+    return var.Weight();
+  }
+  double disp = std::fabs(loc - var.InitX());
+  return var.Weight() * disp * disp;
+}
+
+/****
+ * @brief Admissible lower bound of the cost of cells [cur, r], which are not
+ * placed yet. Each of them ends up somewhere between the current left contour
+ * and the right bound of the window, so its cost is at least the cost at the
+ * point of that interval closest to its initial location.
+ */
+double RowSegment::RemainingCostLowerBound(
+    std::vector<BlkDispVar> &vars,
+    int cur, int r,
+    double left_contour, double right_bound,
+    bool is_linear
+) {
+  double lower_bound = 0;
+  for (int i = cur; i <= r; ++i) {
+    double hi = right_bound - vars[i].Width();
+    double loc = std::max(std::min(vars[i].InitX(), hi), left_contour);
+    lower_bound += SlotCost(vars[i], loc, is_linear);
+  }
+  return lower_bound;
+}
+
+/****
+ * @brief Branch and bound search of the best order of cells [l, r].
+ *
+ * Cells are placed from left to right, so the location of the cell in a slot
+ * only depends on the cells on its left, and the cost of a partial order is
+ * final for the placed cells. A branch is cut as soon as its partial cost plus
+ * a lower bound of the remaining cells cannot beat the best order found so
+ * far. Orders are visited in the same sequence as a plain enumeration, and
+ * only a strictly better order replaces the incumbent, so the result is the
+ * same as the one of an exhaustive search.
+ *
+ * @param res: the best order found so far
+ * @param best_cost: the cost of the best order found so far
+ * @param vars: cells, [l, cur) are placed, [cur, r] are not
+ * @param left_contour: location of the next slot
+ * @param right_bound: right bound of the window, the last cell abuts it
+ * @param gap: white space between two neighboring cells
+ * @param partial_cost: cost of cells [l, cur)
+ */
 void RowSegment::FindBestLocalOrder(
     std::vector<BlkDispVar> &res,
-    double &cost,
+    double &best_cost,
     std::vector<BlkDispVar> &vars,
     int cur, int l, int r,
-    double left_bound, double right_bound,
-    double gap, int range,
+    double left_contour, double right_bound,
+    double gap, double partial_cost,
     bool is_linear
 ) {
-  if (cur == r) {
-    vars[l].SetSolution(left_bound);
-    vars[r].SetSolution(right_bound - vars[r].Width());
-
-    double left_contour = left_bound + gap + vars[l].Width();
-    for (int i = l + 1; i < r; ++i) {
-      vars[i].SetSolution(left_contour);
-      left_contour += vars[i].Width() + gap;
-    }
-
-    double tmp_cost = DispCost(vars, l, r, is_linear);
-    if (tmp_cost < cost) {
-      cost = tmp_cost;
-      for (int j = 0; j < range; ++j) {
-        res[j] = vars[l + j];
+  for (int i = cur; i <= r; ++i) {
+    std::swap(vars[cur], vars[i]);
+
+    double loc = (cur == r) ? right_bound - vars[cur].Width() : left_contour;
+    vars[cur].SetSolution(loc);
+    double cost = partial_cost + SlotCost(vars[cur], loc, is_linear);
+    if (cur == r) {
+      if (cost < best_cost) {
+        best_cost = cost;
+        for (int j = l; j <= r; ++j) {
+          res[j - l] = vars[j];
+        }
+      }
+    } else {
+      double next_contour = left_contour + vars[cur].Width() + gap;
+      double lower_bound = RemainingCostLowerBound(
+          vars, cur + 1, r, next_contour, right_bound, is_linear
+      );
+      if (cost + lower_bound < best_cost) {
+        FindBestLocalOrder(
+            res, best_cost, vars,
+            cur + 1, l, r,
+            next_contour, right_bound, gap, cost,
+            is_linear
+        );
       }
     }
-  } else {
-    // Permutations made
-    for (int i = cur; i <= r; ++i) {
-      // Swapping done
-      std::swap(vars[cur], vars[i]);
 
-      // Recursion called
-      FindBestLocalOrder(
-          res, cost, vars,
-          cur + 1, l, r,
-          left_bound, right_bound, gap, range,
-          is_linear
-      );
+    std::swap(vars[cur], vars[i]);
+  }
+}
 
-      //backtrack
-      std::swap(vars[cur], vars[i]);
+/****
+ * @brief Make room for windows of @param range cells. Buffers only grow, the
+ * dynamic program initializes every entry it reads except those of the empty
+ * mask, which stay zero.
+ */
+void LocalReorderTable::Resize(int range) {
+  size_t table_size = size_t(1) << range;
+  if (cost.size() < table_size) {
+    cost.resize(table_size, DBL_MAX);
+    width.resize(table_size, 0);
+    count.resize(table_size, 0);
+    last.resize(table_size, -1);
+  }
+  window.reserve(range);
+  order.reserve(range);
+}
+
+/****
+ * @brief Dynamic programming search of the best order of cells [l, r].
+ *
+ * The location of the next slot only depends on the set of cells already
+ * placed on its left, not on their order, so the best partial placement of
+ * each subset is shared by all orders starting with that subset. This takes
+ * O(2^n * n) steps instead of O(n!) for a window of n cells. The current
+ * order, which is what the previous window left behind, is evaluated first
+ * and bounds the table: partial placements that cannot beat it are not
+ * extended, and the cells are only reordered if a strictly better order
+ * exists.
+ */
+void RowSegment::FindBestLocalOrderDP(
+    std::vector<BlkDispVar> &vars,
+    int l, int r,
+    double left_bound, double right_bound,
+    double gap, bool is_linear,
+    LocalReorderTable &table
+) {
+  int n = r - l + 1;
+  int full_mask = (1 << n) - 1;
+
+  table.window.assign(vars.begin() + l, vars.begin() + r + 1);
+  std::vector<BlkDispVar> &window = table.window;
+
+  // cost of the current order
+  double incumbent_cost = 0;
+  double left_contour = left_bound;
+  for (int i = 0; i < n; ++i) {
+    double loc = (i == n - 1) ? right_bound - window[i].Width() : left_contour;
+    incumbent_cost += SlotCost(window[i], loc, is_linear);
+    left_contour += window[i].Width() + gap;
+  }
+
+  for (int mask = 1; mask <= full_mask; ++mask) {
+    int low = 0;
+    while (((mask >> low) & 1) == 0) ++low;
+    int prev = mask & (mask - 1);
+    table.width[mask] = table.width[prev] + window[low].Width();
+    table.count[mask] = table.count[prev] + 1;
+    table.cost[mask] = DBL_MAX;
+  }
+  table.cost[0] = 0;
+
+  // masks are visited in increasing order, so a subset is always finalized
+  // before any of its supersets
+  for (int mask = 0; mask < full_mask; ++mask) {
+    double mask_cost = table.cost[mask];
+    if (mask_cost >= incumbent_cost) continue;
+    int slot = table.count[mask];
+    double slot_loc = left_bound + table.width[mask] + slot * gap;
+    for (int i = 0; i < n; ++i) {
+      if ((mask >> i) & 1) continue;
+      double loc = (slot == n - 1) ? right_bound - window[i].Width() : slot_loc;
+      double cost = mask_cost + SlotCost(window[i], loc, is_linear);
+      int next_mask = mask | (1 << i);
+      if (cost < table.cost[next_mask] && cost < incumbent_cost) {
+        table.cost[next_mask] = cost;
+        table.last[next_mask] = i;
+      }
     }
   }
+
+  if (table.cost[full_mask] >= incumbent_cost) return;
+  int mask = full_mask;
+  for (int j = r; j >= l; --j) {
+    int i = table.last[mask];
+    vars[j] = window[i];
+    mask ^= (1 << i);
+  }
 }
 
+/****
+ * @brief Slide a window of @param range cells along the segment and find the
+ * order of cells in each window that minimizes the displacement cost. The two
+ * ends of a window stay where they are, and white space is evenly distributed
+ * between cells in the window.
+ *
+ * Both searches below give the same order as an exhaustive enumeration. For
+ * the quadratic cost, windows are searched by dynamic programming over
+ * subsets, which keeps windows of up to kMaxLocalReorderRange cells cheap.
+ * For the linear cost, the lower bound of the remaining cells is tight enough
+ * for branch and bound to prune almost every order, and it is faster than the
+ * dynamic program at every window size.
+ *
+ * Neighboring windows share all but one cell, but the dynamic program does not
+ * reuse partial placements of the previous window: the bounds and the gap of a
+ * window are only known after the previous window is reordered and its cells
+ * are evenly spread, so slot locations, and hence partial costs, differ from
+ * one window to the next. What carries over is the order left by the previous
+ * window, which bounds the search of the current one.
+ *
+ * @param vars: cells in this segment sorted by their locations
+ * @param range: number of cells in a window
+ * @param omit: number of cells at both ends of the segment excluded from
+ * reordering
+ * @param is_linear: use linear or quadratic displacement cost
+ */
 void RowSegment::LocalReorder(
     std::vector<BlkDispVar> &vars,
     int range,
     int omit,
     bool is_linear
 ) {
+  DaliExpects(
+      range >= 2 && range <= kMaxLocalReorderRange,
+      "Local reorder range should be in [2, " << kMaxLocalReorderRange
+                                              << "], got " << range
+  );
   int sz = static_cast<int>(vars.size());
   if (sz < range) return;
 
+  bool use_dp = !is_linear;
+  LocalReorderTable &table = reorder_table_;
+  table.Resize(range);
+
   int last_segment = sz - range - omit;
-  BlkDispVar tmp(0, 0, 0);
-  std::vector<BlkDispVar> res_local_order(range, tmp);
   for (int l = omit; l <= last_segment; ++l) {
     int tot_blk_width = 0;
     for (int j = 0; j < range; ++j) {
-      res_local_order[j] = vars[l + j];
-      tot_blk_width += res_local_order[j].Width();
+      tot_blk_width += vars[l + j].Width();
     }
     int r = l + range - 1;
-    double best_cost = DBL_MAX;
     double left_bound = vars[l].Solution();
     double right_bound = vars[r].Solution() + vars[r].Width();
     double gap = (right_bound - left_bound - tot_blk_width) / (range - 1);
 
-    FindBestLocalOrder(
-        res_local_order, best_cost, vars,
-        l, l, r,
-        left_bound, right_bound, gap, range,
-        is_linear
-    );
-    for (int j = 0; j < range; ++j) {
-      vars[l + j] = res_local_order[j];
+    if (use_dp) {
+      FindBestLocalOrderDP(
+          vars, l, r,
+          left_bound, right_bound, gap,
+          is_linear, table
+      );
+    } else {
+      table.order.assign(vars.begin() + l, vars.begin() + r + 1);
+      double best_cost = DBL_MAX;
+      FindBestLocalOrder(
+          table.order, best_cost, vars,
+          l, l, r,
+          left_bound, right_bound, gap, 0,
+          is_linear
+      );
+      std::copy(table.order.begin(), table.order.end(), vars.begin() + l);
     }
 
     vars[l].SetSolution(left_bound);
@@ -287,24 +498,26 @@ void RowSegment::LocalReorder2(
   }
 }
 
-std::vector<BlkDispVar> RowSegment::OptimizeQuadraticDisplacement(
+/****
+ * @brief Minimize the quadratic displacement of cells in this segment. Only
+ * blocks in this segment and their own sub-cell locations are read, and the
+ * results are written to @param vars instead of the blocks, so different
+ * segments can be optimized concurrently.
+ *
+ * @param vars: output buffer, its capacity is reused across calls
+ */
+void RowSegment::OptimizeQuadraticDisplacement(
     double lambda,
     bool is_weighted_anchor,
-    bool is_reorder
+    bool is_reorder,
+    std::vector<BlkDispVar> &vars,
+    int reorder_range
 ) {
-  std::vector<BlkDispVar> vars;
-  if (blk_regions_.empty()) return vars;
+  vars.clear();
+  if (blk_regions_.empty()) return;
 
   // sort cells based on their lower x location
-  std::sort(
-      blk_regions_.begin(),
-      blk_regions_.end(),
-      [](const BlockRegion &br0, const BlockRegion &br1) {
-        return (br0.p_blk->LLX() < br1.p_blk->LLX()) ||
-            ((br0.p_blk->LLX() == br1.p_blk->LLX())
-                && (br0.p_blk->Id() < br1.p_blk->Id()));
-      }
-  );
+  SortBlockRegions();
 
   // compute average discrepancy
   double ave_discrepancy = 1;
@@ -366,32 +579,29 @@ std::vector<BlkDispVar> RowSegment::OptimizeQuadraticDisplacement(
   if (is_weighted_anchor) {
     FitInRange(vars);
     if (is_reorder) {
-      LocalReorder(vars, 3, 0, false);
+      LocalReorder(vars, reorder_range, 0, false);
       //LocalReorder2(vars);
     }
   }
-
-  return vars;
 }
 
-std::vector<BlkDispVar> RowSegment::OptimizeLinearDisplacement(
+/****
+ * @brief Linear counterpart of OptimizeQuadraticDisplacement().
+ *
+ * @param vars: output buffer, its capacity is reused across calls
+ */
+void RowSegment::OptimizeLinearDisplacement(
     double lambda,
     bool is_weighted_anchor,
-    bool is_reorder
+    bool is_reorder,
+    std::vector<BlkDispVar> &vars,
+    int reorder_range
 ) {
-  std::vector<BlkDispVar> vars;
-  if (blk_regions_.empty()) return vars;
+  vars.clear();
+  if (blk_regions_.empty()) return;
 
   // sort cells based on their lower x location
-  std::sort(
-      blk_regions_.begin(),
-      blk_regions_.end(),
-      [](const BlockRegion &br0, const BlockRegion &br1) {
-        return (br0.p_blk->LLX() < br1.p_blk->LLX()) ||
-            ((br0.p_blk->LLX() == br1.p_blk->LLX())
-                && (br0.p_blk->Id() < br1.p_blk->Id()));
-      }
-  );
+  SortBlockRegions();
 
   // compute average discrepancy
   double ave_discrepancy = 1;
@@ -445,10 +655,8 @@ std::vector<BlkDispVar> RowSegment::OptimizeLinearDisplacement(
 
   if (is_weighted_anchor) {
     FitInRange(vars);
-    if (is_reorder) LocalReorder(vars, 3, 0, true);
+    if (is_reorder) LocalReorder(vars, reorder_range, 0, true);
   }
-
-  return vars;
 }
 
 void RowSegment::GenSubCellTable(
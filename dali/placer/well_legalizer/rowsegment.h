@@ -31,6 +31,24 @@
 
 namespace dali {
 
+/****
+ * @brief Scratch buffers of RowSegment::LocalReorder. Entries of the subset
+ * tables are indexed by the bitmask of window cells already placed from the
+ * left end of the window, so every partial placement is evaluated once no
+ * matter how many orders share it. Each row segment owns its buffers, which
+ * grow to the largest window used so far and are reused by every window and
+ * every consensus round.
+ */
+struct LocalReorderTable {
+  std::vector<double> cost;       // min cost of placing the cells in a mask
+  std::vector<int> width;         // total width of the cells in a mask
+  std::vector<int> count;         // number of cells in a mask
+  std::vector<int> last;          // rightmost cell of the best placement of a mask
+  std::vector<BlkDispVar> window; // cells of the current window in input order
+  std::vector<BlkDispVar> order;  // best order found by branch and bound
+  void Resize(int range);
+};
+
 class RowSegment {
  public:
   RowSegment() = default;
@@ -47,6 +65,7 @@ class RowSegment {
 
   std::vector<BlockRegion> &BlkRegions();
   void AddBlockRegion(Block *blk_ptr, int region_id);
+  void SortBlockRegions();
   void MinDisplacementLegalization(bool use_init_loc);
   void SnapCellToPlacementGrid();
 
@@ -57,15 +76,29 @@ class RowSegment {
       int l, int r,
       bool is_linear
   );
+  static double SlotCost(BlkDispVar &var, double loc, bool is_linear);
+  double RemainingCostLowerBound(
+      std::vector<BlkDispVar> &vars,
+      int cur, int r,
+      double left_contour, double right_bound,
+      bool is_linear
+  );
   void FindBestLocalOrder(
       std::vector<BlkDispVar> &res,
       double &best_cost,
       std::vector<BlkDispVar> &vars,
       int cur, int l, int r,
-      double left_bound, double right_bound,
-      double gap, int range,
+      double left_contour, double right_bound,
+      double gap, double partial_cost,
       bool is_linear
   );
+  void FindBestLocalOrderDP(
+      std::vector<BlkDispVar> &vars,
+      int l, int r,
+      double left_bound, double right_bound,
+      double gap, bool is_linear,
+      LocalReorderTable &table
+  );
   void LocalReorder(
       std::vector<BlkDispVar> &vars,
       int range = 3,
@@ -75,15 +108,19 @@ class RowSegment {
   void LocalReorder2(
       std::vector<BlkDispVar> &vars
   );
-  std::vector<BlkDispVar> OptimizeQuadraticDisplacement(
+  void OptimizeQuadraticDisplacement(
       double lambda,
       bool is_weighted_anchor,
-      bool is_reorder
+      bool is_reorder,
+      std::vector<BlkDispVar> &vars,
+      int reorder_range = 3
   );
-  std::vector<BlkDispVar> OptimizeLinearDisplacement(
+  void OptimizeLinearDisplacement(
       double lambda,
       bool is_weighted_anchor,
-      bool is_reorder
+      bool is_reorder,
+      std::vector<BlkDispVar> &vars,
+      int reorder_range = 3
   );
 
   void GenSubCellTable(
@@ -103,6 +140,7 @@ class RowSegment {
 
   /**** for iterative displacement optimization ****/
   double opt_anchor_weight_ = 0;
+  LocalReorderTable reorder_table_;
 };
 
 }
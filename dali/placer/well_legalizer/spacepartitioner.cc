@@ -175,7 +175,11 @@ void DefaultSpacePartitioner::UpdateWhiteSpaceInCol(ClusterStripe &col) {
             continue;
         }
         */
-        col.white_space_[i].push_back(*tmp_seg);
+        // a stripe narrower than the widest cell cannot hold every cell
+        // assigned to it, and such cells would be pushed out of the stripe
+        if (tmp_seg->Span() >= max_cell_width_) {
+          col.white_space_[i].push_back(*tmp_seg);
+        }
       }
       delete tmp_seg;
     }
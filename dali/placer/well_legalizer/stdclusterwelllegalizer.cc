@@ -109,10 +109,35 @@ void StdClusterWellLegalizer::InitializeWellLegalizer(int cluster_width) {
   space_partitioner_.SetPartitionMode(stripe_mode_);
   space_partitioner_.SetMaxRowWidth(cluster_width);
   space_partitioner_.StartPartitioning();
+  CollectStripes();
 
   index_loc_list_.resize(ckt_ptr_->Blocks().size());
 }
 
+/****
+ * @brief Collect pointers to all stripes, and record the stripe each movable
+ * block belongs to. Stripes do not share movable blocks, so each stripe can be
+ * legalized, flipped, reordered and tapped by its own thread.
+ */
+void StdClusterWellLegalizer::CollectStripes() {
+  stripe_ptrs_.clear();
+  for (auto &col : col_list_) {
+    for (auto &stripe : col.stripe_list_) {
+      stripe_ptrs_.push_back(&stripe);
+    }
+  }
+  blk_stripe_ids_.assign(ckt_ptr_->Blocks().size(), -1);
+  int stripe_cnt = static_cast<int>(stripe_ptrs_.size());
+  for (int k = 0; k < stripe_cnt; ++k) {
+    for (auto &blk_ptr : stripe_ptrs_[k]->blk_ptrs_vec_) {
+      if (blk_ptr->IsFixed()) continue;
+      DaliExpects(blk_stripe_ids_[blk_ptr->Id()] == -1,
+                  "Block in more than one stripe: " << blk_ptr->Name());
+      blk_stripe_ids_[blk_ptr->Id()] = k;
+    }
+  }
+}
+
 void StdClusterWellLegalizer::CreateClusterAndAppendSingleWellBlock(
     Stripe &stripe,
     Block &blk
@@ -517,56 +542,72 @@ bool StdClusterWellLegalizer::BlockClustering() {
 }
 
 /****
- * Clustering blocks in each stripe
+ * Clustering blocks in a stripe
  * After clustering, leave clusters as they are
  * ****/
-bool StdClusterWellLegalizer::BlockClusteringLoose() {
+bool StdClusterWellLegalizer::StripeLegalizationLoose(Stripe &stripe) {
   int step = 50;
-  int count = 0;
-  bool res = true;
-  for (auto &col : col_list_) {
-    bool is_success = true;
-    for (auto &stripe : col.stripe_list_) {
-      int i = 0;
-      bool is_from_bottom = true;
-      for (i = 0; i < max_iter_; ++i) {
-        if (is_from_bottom) {
-          is_success = StripeLegalizationBottomUp(stripe);
-        } else {
-          is_success = StripeLegalizationTopDown(stripe);
-        }
-        if (!is_success) {
-          is_success = TrialClusterLegalization(stripe);
-        }
-        is_from_bottom = !is_from_bottom;
-        if (is_success) {
-          break;
-        }
-      }
-      res = res && is_success;
-      /*if (is_success) {
-        BOOST_LOG_TRIVIAL(info)  <<"stripe legalization success, %d\n", i);
-      } else {
-        BOOST_LOG_TRIVIAL(info)  <<"stripe legalization fail, %d\n", i);
-      }*/
-
-      for (auto &row : stripe.gridded_rows_) {
-        row.UpdateBlockLocY();
-        row.MinDisplacementLegalization();
-        if (is_dump) {
-          if (count % step == 0) {
-            std::string tmp_file_name =
-                "wlg_result_" + std::to_string(dump_count) + ".txt";
-            ckt_ptr_->GenMATLABTable(tmp_file_name);
-            ++dump_count;
-          }
-          ++count;
-        }
+  bool is_success = true;
+  bool is_from_bottom = true;
+  for (int i = 0; i < max_iter_; ++i) {
+    if (is_from_bottom) {
+      is_success = StripeLegalizationBottomUp(stripe);
+    } else {
+      is_success = StripeLegalizationTopDown(stripe);
+    }
+    if (!is_success) {
+      is_success = TrialClusterLegalization(stripe);
+    }
+    is_from_bottom = !is_from_bottom;
+    if (is_success) {
+      break;
+    }
+  }
+  /*if (is_success) {
+    BOOST_LOG_TRIVIAL(info)  <<"stripe legalization success, %d\n", i);
+  } else {
+    BOOST_LOG_TRIVIAL(info)  <<"stripe legalization fail, %d\n", i);
+  }*/
+
+  for (auto &row : stripe.gridded_rows_) {
+    row.UpdateBlockLocY();
+    row.MinDisplacementLegalization();
+    if (is_dump) {
+      if (dump_row_count_ % step == 0) {
+        std::string tmp_file_name =
+            "wlg_result_" + std::to_string(dump_count) + ".txt";
+        ckt_ptr_->GenMATLABTable(tmp_file_name);
+        ++dump_count;
       }
-      stripe.MinDisplacementAdjustment();
+      ++dump_row_count_;
     }
   }
+  stripe.MinDisplacementAdjustment();
 
+  return is_success;
+}
+
+/****
+ * Clustering blocks in each stripe
+ * After clustering, leave clusters as they are
+ * Stripes are independent, so they are legalized in parallel. Threads pick up
+ * stripes dynamically, because stripes may have very different numbers of
+ * blocks. Intermediate results can only be dumped by a single thread.
+ * ****/
+bool StdClusterWellLegalizer::BlockClusteringLoose() {
+  dump_row_count_ = 0;
+  int stripe_cnt = static_cast<int>(stripe_ptrs_.size());
+  int num_threads = is_dump ? 1 : std::max(num_threads_, 1);
+  std::vector<char> is_stripe_success(stripe_cnt, 1);
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads) default(none) shared(stripe_cnt, is_stripe_success)
+  for (int k = 0; k < stripe_cnt; ++k) {
+    is_stripe_success[k] = StripeLegalizationLoose(*stripe_ptrs_[k]);
+  }
+
+  bool res = true;
+  for (int k = 0; k < stripe_cnt; ++k) {
+    res = res && is_stripe_success[k];
+  }
   return res;
 }
 
@@ -677,101 +718,188 @@ bool StdClusterWellLegalizer::TrialClusterLegalization(Stripe &stripe) {
 }
 
 /****
- * Returns the wire-length cost of the small group from l-th element to r-th element in this cluster
- * "for each order, we keep the left and right boundaries of the group and evenly distribute the cells inside the group.
- * Since we have the Single-Segment Clustering technique to take care of the cell positions,
- * we do not pay much attention to the exact positions of the cells during Local Re-ordering."
- * from "An Efficient and Effective Detailed Placement Algorithm"
- * ****/
-double StdClusterWellLegalizer::WireLengthCost(
+ * @brief Save the locations of all blocks. During local reordering, a stripe
+ * moves its own blocks, and sees blocks in other stripes at these saved
+ * locations.
+ */
+void StdClusterWellLegalizer::SnapshotBlockLocations() {
+  std::vector<Block> &blocks = ckt_ptr_->Blocks();
+  blk_snapshot_locs_.resize(blocks.size());
+  size_t sz = blocks.size();
+  for (size_t i = 0; i < sz; ++i) {
+    blk_snapshot_locs_[i].x = blocks[i].LLX();
+    blk_snapshot_locs_[i].y = blocks[i].LLY();
+  }
+}
+
+/****
+ * @brief Collect nets affected by reordering the window from the l-th block to
+ * the r-th block in a cluster. For each net, pins of blocks outside the window
+ * are folded into a bound, because they do not move when the window is
+ * reordered. Blocks in other stripes are seen at their saved locations.
+ * Nets with 100 or more pins are ignored.
+ *
+ * The y-locations of blocks do not change during reordering, so only the
+ * x-direction is considered.
+ */
+void StdClusterWellLegalizer::CollectWindowNets(
     GriddedRow *cluster,
     int l,
-    int r
-) {
+    int r,
+    LocalReorderScratch &scratch
+) const {
   auto &net_list = ckt_ptr_->Nets();
-  std::set<Net *> net_involved;
+  auto &blk_list = cluster->Blocks();
+  int stripe_id = blk_stripe_ids_[blk_list[l]->Id()];
+
+  scratch.window_blk_ids.clear();
+  scratch.net_ids.clear();
   for (int i = l; i <= r; ++i) {
-    auto *blk = cluster->Blocks()[i];
-    for (auto &net_num : blk->NetList()) {
+    scratch.window_blk_ids.push_back(blk_list[i]->Id());
+    for (auto &net_num : blk_list[i]->NetList()) {
       if (net_list[net_num].PinCnt() < 100) {
-        net_involved.insert(&(net_list[net_num]));
+        scratch.net_ids.push_back(net_num);
       }
     }
   }
+  std::sort(scratch.net_ids.begin(), scratch.net_ids.end());
+  scratch.net_ids.erase(
+      std::unique(scratch.net_ids.begin(), scratch.net_ids.end()),
+      scratch.net_ids.end()
+  );
 
-  double hpwl_x = 0;
-  double hpwl_y = 0;
-  for (auto &net : net_involved) {
-    hpwl_x += net->WeightedHPWLX();
-    hpwl_y += net->WeightedHPWLY();
+  size_t net_cnt = scratch.net_ids.size();
+  size_t window_sz = scratch.window_blk_ids.size();
+  scratch.ext_min_x.assign(net_cnt, DBL_MAX);
+  scratch.ext_max_x.assign(net_cnt, -DBL_MAX);
+  scratch.pin_begin.assign(net_cnt + 1, 0);
+  scratch.pin_slots.clear();
+  scratch.pin_offsets_x.clear();
+  for (size_t k = 0; k < net_cnt; ++k) {
+    Net &net = net_list[scratch.net_ids[k]];
+    for (auto &blk_pin : net.BlockPins()) {
+      int blk_id = blk_pin.BlkId();
+      int slot = -1;
+      for (size_t j = 0; j < window_sz; ++j) {
+        if (scratch.window_blk_ids[j] == blk_id) {
+          slot = static_cast<int>(j);
+          break;
+        }
+      }
+      if (slot >= 0) {
+        scratch.pin_slots.push_back(slot);
+        scratch.pin_offsets_x.push_back(blk_pin.OffsetX());
+        continue;
+      }
+      double x = blk_stripe_ids_[blk_id] == stripe_id ?
+                 blk_pin.AbsX() :
+                 blk_snapshot_locs_[blk_id].x + blk_pin.OffsetX();
+      scratch.ext_min_x[k] = std::min(scratch.ext_min_x[k], x);
+      scratch.ext_max_x[k] = std::max(scratch.ext_max_x[k], x);
+    }
+    scratch.pin_begin[k + 1] = static_cast<int>(scratch.pin_slots.size());
   }
-
-  return hpwl_x * ckt_ptr_->GridValueX() + hpwl_y * ckt_ptr_->GridValueY();
 }
 
 /****
-* Returns the best permutation in @param res
-* @param cost records the cost function associated with the best permutation
-* @param l is the left bound of the range
-* @param r is the right bound of the range
-* @param cluster points to the whole range, but we are only interested in the permutation of range [l,r]
-* ****/
-void StdClusterWellLegalizer::FindBestLocalOrder(
-    std::vector<Block *> &res,
-    double &cost, GriddedRow *cluster,
-    int cur, int l, int r,
-    int left_bound, int right_bound,
-    int gap, int range
-) {
-  //BOOST_LOG_TRIVIAL(info)  <<"l : %d, r: %d\n", l, r);
-  if (cur == r) {
-    cluster->Blocks()[l]->SetLLX(left_bound);
-    cluster->Blocks()[r]->SetURX(right_bound);
-
-    int left_contour = left_bound + gap + cluster->Blocks()[l]->Width();
-    for (int i = l + 1; i < r; ++i) {
-      auto *blk = cluster->Blocks()[i];
-      blk->SetLLX(left_contour);
-      left_contour += blk->Width() + gap;
+ * @brief Returns the wire-length cost of nets collected by CollectWindowNets(),
+ * with blocks in the window at scratch.slot_llx. Only pins in the window are
+ * visited, pins outside the window are represented by their bounds.
+ */
+double StdClusterWellLegalizer::WindowWireLengthCost(
+    LocalReorderScratch &scratch
+) const {
+  auto &net_list = ckt_ptr_->Nets();
+  double hpwl_x = 0;
+  size_t net_cnt = scratch.net_ids.size();
+  for (size_t k = 0; k < net_cnt; ++k) {
+    double max_x = scratch.ext_max_x[k];
+    double min_x = scratch.ext_min_x[k];
+    for (int p = scratch.pin_begin[k]; p < scratch.pin_begin[k + 1]; ++p) {
+      double x = scratch.slot_llx[scratch.pin_slots[p]]
+          + scratch.pin_offsets_x[p];
+      max_x = std::max(max_x, x);
+      min_x = std::min(min_x, x);
     }
+    hpwl_x += (max_x - min_x) * net_list[scratch.net_ids[k]].Weight();
+  }
+  return hpwl_x * ckt_ptr_->GridValueX();
+}
 
-    double tmp_cost = WireLengthCost(cluster, l, r);
-    if (tmp_cost < cost) {
-      cost = tmp_cost;
-      for (int j = 0; j < range; ++j) {
-        res[j] = cluster->Blocks()[l + j];
-      }
+/****
+ * Returns the best permutation of the window from the l-th block to the r-th
+ * block in scratch.best_order, in which each value is an index in the window.
+ * "for each order, we keep the left and right boundaries of the group and
+ * evenly distribute the cells inside the group. Since we have the
+ * Single-Segment Clustering technique to take care of the cell positions,
+ * we do not pay much attention to the exact positions of the cells during
+ * Local Re-ordering."
+ * from "An Efficient and Effective Detailed Placement Algorithm"
+ * ****/
+void StdClusterWellLegalizer::FindBestLocalOrder(
+    GriddedRow *cluster,
+    int l,
+    int r,
+    int left_bound,
+    int right_bound,
+    int gap,
+    LocalReorderScratch &scratch
+) const {
+  CollectWindowNets(cluster, l, r, scratch);
+
+  auto &blk_list = cluster->Blocks();
+  int range = r - l + 1;
+  scratch.order.resize(range);
+  for (int j = 0; j < range; ++j) {
+    scratch.order[j] = j;
+  }
+  scratch.best_order = scratch.order;
+  scratch.slot_llx.resize(range);
+  double best_cost = DBL_MAX;
+  do {
+    int first = scratch.order[0];
+    int last = scratch.order[range - 1];
+    scratch.slot_llx[first] = left_bound;
+    scratch.slot_llx[last] = right_bound - blk_list[l + last]->Width();
+    int left_contour = left_bound + gap + blk_list[l + first]->Width();
+    for (int j = 1; j < range - 1; ++j) {
+      int slot = scratch.order[j];
+      scratch.slot_llx[slot] = left_contour;
+      left_contour += blk_list[l + slot]->Width() + gap;
     }
-  } else {
-    // Permutations made
-    auto &blk_list = cluster->Blocks();
-    for (int i = cur; i <= r; ++i) {
-      // Swapping done
-      std::swap(blk_list[cur], blk_list[i]);
-
-      // Recursion called
-      FindBestLocalOrder(res, cost, cluster, cur + 1, l, r,
-                         left_bound, right_bound, gap, range);
-
-      //backtrack
-      std::swap(blk_list[cur], blk_list[i]);
+    double cost = WindowWireLengthCost(scratch);
+    if (cost < best_cost) {
+      best_cost = cost;
+      scratch.best_order = scratch.order;
     }
-  }
+  } while (std::next_permutation(scratch.order.begin(), scratch.order.end()));
+}
 
+/****
+ * @brief Set the number of blocks in each local reordering window. All
+ * permutations of a window are evaluated, so the range should be small.
+ *
+ * @param range: the number of blocks in a window, from 2 to 8
+ */
+void StdClusterWellLegalizer::SetLocalReorderRange(int range) {
+  DaliExpects(range >= 2 && range <= 8,
+              "Local reordering range should be in [2, 8]: " << range);
+  local_reorder_range_ = range;
 }
 
 void StdClusterWellLegalizer::LocalReorderInCluster(
     GriddedRow *cluster,
-    int range
+    int range,
+    LocalReorderScratch &scratch
 ) {
   /****
    * Enumerate all local permutations, @param range determines how big the local range is
    * ****/
 
-  assert(range > 0);
+  DaliExpects(range > 1, "Local reordering needs at least two blocks");
 
   int sz = cluster->Blocks().size();
-  if (sz < 3) return;
+  if (sz < 3 || sz < range) return;
 
   std::sort(
       cluster->Blocks().begin(),
@@ -781,54 +909,47 @@ void StdClusterWellLegalizer::LocalReorderInCluster(
       }
   );
 
+  auto &blk_list = cluster->Blocks();
   int last_segment = sz - range;
-  std::vector<Block *> res_local_order(range, nullptr);
   for (int l = 0; l <= last_segment; ++l) {
     int tot_blk_width = 0;
     for (int j = 0; j < range; ++j) {
-      res_local_order[j] = cluster->Blocks()[l + j];
-      tot_blk_width += res_local_order[j]->Width();
+      tot_blk_width += blk_list[l + j]->Width();
     }
     int r = l + range - 1;
-    double best_cost = DBL_MAX;
-    int left_bound = (int) cluster->Blocks()[l]->LLX();
-    int right_bound = (int) cluster->Blocks()[r]->URX();
+    int left_bound = (int) blk_list[l]->LLX();
+    int right_bound = (int) blk_list[r]->URX();
     int gap = (right_bound - left_bound - tot_blk_width) / (r - l);
 
-    FindBestLocalOrder(res_local_order, best_cost, cluster,
-                       l, l, r, left_bound, right_bound, gap, range);
+    FindBestLocalOrder(
+        cluster, l, r, left_bound, right_bound, gap, scratch
+    );
+    scratch.window_blks.assign(blk_list.begin() + l, blk_list.begin() + r + 1);
     for (int j = 0; j < range; ++j) {
-      cluster->Blocks()[l + j] = res_local_order[j];
+      blk_list[l + j] = scratch.window_blks[scratch.best_order[j]];
     }
 
-    cluster->Blocks()[l]->SetLLX(left_bound);
-    cluster->Blocks()[r]->SetURX(right_bound);
-    int left_contour = left_bound + cluster->Blocks()[l]->Width() + gap;
+    blk_list[l]->SetLLX(left_bound);
+    blk_list[r]->SetURX(right_bound);
+    int left_contour = left_bound + blk_list[l]->Width() + gap;
     for (int i = l + 1; i < r; ++i) {
-      auto *blk = cluster->Blocks()[i];
+      auto *blk = blk_list[i];
       blk->SetLLX(left_contour);
       left_contour += blk->Width() + gap;
     }
   }
 }
 
-void StdClusterWellLegalizer::LocalReorderAllClusters() {
-  // sort all cluster based on their lower left corners
-  size_t tot_cluster_count = 0;
-  for (auto &col : col_list_) {
-    for (auto &stripe : col.stripe_list_) {
-      tot_cluster_count += stripe.gridded_rows_.size();
-    }
-  }
-  std::vector<GriddedRow *> cluster_ptr_list(tot_cluster_count, nullptr);
-  int counter = 0;
-  for (auto &col : col_list_) {
-    for (auto &stripe : col.stripe_list_) {
-      for (auto &cluster : stripe.gridded_rows_) {
-        cluster_ptr_list[counter] = &cluster;
-        ++counter;
-      }
-    }
+/****
+ * Reorder blocks in each cluster of a stripe. Scratch buffers are shared by
+ * all windows in this stripe.
+ * ****/
+void StdClusterWellLegalizer::LocalReorderInStripe(Stripe &stripe) {
+  // sort all clusters in this stripe based on their lower left corners
+  std::vector<GriddedRow *> cluster_ptr_list;
+  cluster_ptr_list.reserve(stripe.gridded_rows_.size());
+  for (auto &cluster : stripe.gridded_rows_) {
+    cluster_ptr_list.push_back(&cluster);
   }
   std::sort(
       cluster_ptr_list.begin(),
@@ -839,8 +960,24 @@ void StdClusterWellLegalizer::LocalReorderAllClusters() {
       }
   );
 
+  LocalReorderScratch scratch;
   for (auto &cluster_ptr : cluster_ptr_list) {
-    LocalReorderInCluster(cluster_ptr, 3);
+    LocalReorderInCluster(cluster_ptr, local_reorder_range_, scratch);
+  }
+}
+
+/****
+ * Stripes are reordered in parallel. A stripe only moves its own blocks, and
+ * sees blocks in other stripes at their locations before this function is
+ * called, so the result is the same for any number of threads.
+ * ****/
+void StdClusterWellLegalizer::LocalReorderAllClusters() {
+  SnapshotBlockLocations();
+  int stripe_cnt = static_cast<int>(stripe_ptrs_.size());
+  int num_threads = std::max(num_threads_, 1);
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads) default(none) shared(stripe_cnt)
+  for (int k = 0; k < stripe_cnt; ++k) {
+    LocalReorderInStripe(*stripe_ptrs_[k]);
   }
 }
 
@@ -903,26 +1040,50 @@ void StdClusterWellLegalizer::SingleSegmentClusteringOptimization() {
 }
  */
 
+/****
+ * Rows in a column alternate their orientations from bottom to top. The
+ * orientation of the first row of each stripe is determined first, and then
+ * stripes are flipped in parallel.
+ * ****/
 void StdClusterWellLegalizer::UpdateClusterOrient() {
+  std::vector<char> is_first_row_orient_N(stripe_ptrs_.size(), 1);
+  int counter = 0;
   for (auto &col : col_list_) {
     bool is_orient_N = is_first_row_orient_N_;
     for (auto &stripe : col.stripe_list_) {
-      if (stripe.is_bottom_up_) {
-        for (auto &cluster : stripe.gridded_rows_) {
-          cluster.SetOrient(is_orient_N);
-          is_orient_N = !is_orient_N;
-        }
-      } else {
-        int sz = stripe.gridded_rows_.size();
-        for (int i = sz - 1; i >= 0; --i) {
-          stripe.gridded_rows_[i].SetOrient(is_orient_N);
-          is_orient_N = !is_orient_N;
-        }
+      is_first_row_orient_N[counter++] = is_orient_N;
+      if (stripe.gridded_rows_.size() % 2 == 1) {
+        is_orient_N = !is_orient_N;
+      }
+    }
+  }
+
+  int stripe_cnt = static_cast<int>(stripe_ptrs_.size());
+  int num_threads = std::max(num_threads_, 1);
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads) default(none) shared(stripe_cnt, is_first_row_orient_N)
+  for (int k = 0; k < stripe_cnt; ++k) {
+    Stripe &stripe = *stripe_ptrs_[k];
+    bool is_orient_N = is_first_row_orient_N[k];
+    if (stripe.is_bottom_up_) {
+      for (auto &cluster : stripe.gridded_rows_) {
+        cluster.SetOrient(is_orient_N);
+        is_orient_N = !is_orient_N;
+      }
+    } else {
+      int sz = static_cast<int>(stripe.gridded_rows_.size());
+      for (int i = sz - 1; i >= 0; --i) {
+        stripe.gridded_rows_[i].SetOrient(is_orient_N);
+        is_orient_N = !is_orient_N;
       }
     }
   }
 }
 
+/****
+ * Well tap cells are created in a fixed order first, because they are stored
+ * in a single list in the circuit. Then they are inserted into rows, and rows
+ * are legalized, in parallel.
+ * ****/
 void StdClusterWellLegalizer::InsertWellTap() {
   auto &tap_cell_list = ckt_ptr_->design().WellTaps();
   tap_cell_list.clear();
@@ -932,39 +1093,48 @@ void StdClusterWellLegalizer::InsertWellTap() {
       tot_cluster_count += stripe.gridded_rows_.size();
     }
   }
-  tap_cell_list.reserve(tot_cluster_count * 2);
+  //int tap_cell_num = std::ceil(cluster.Width() / (double) max_unplug_length_);
+  int tap_cell_num = 2;
+  tap_cell_list.reserve(tot_cluster_count * tap_cell_num);
   ckt_ptr_->design().TapNameIdMap().clear();
 
+  int stripe_cnt = static_cast<int>(stripe_ptrs_.size());
+  // index of the first tap cell of each stripe
+  std::vector<size_t> first_tap_ids(stripe_cnt, 0);
   int counter = 0;
-  int tot_tap_cell_num = 0;
-  for (auto &col : col_list_) {
-    for (auto &stripe : col.stripe_list_) {
-      for (auto &row : stripe.gridded_rows_) {
-        //int tap_cell_num = std::ceil(cluster.Width() / (double) max_unplug_length_);
-        int tap_cell_num = 2;
-        tot_tap_cell_num += tap_cell_num;
-        int step = row.Width();
-        int tap_cell_loc = row.LLX() - well_tap_cell_->Width() / 2;
-        for (int i = 0; i < tap_cell_num; ++i) {
-          std::string block_name = "__well_tap__" + std::to_string(counter++);
-          tap_cell_list.emplace_back();
-          auto &tap_cell = tap_cell_list.back();
-          tap_cell.SetPlacementStatus(PLACED);
-          tap_cell.SetType(ckt_ptr_->tech().WellTapCellPtrs()[0]);
-          int map_size = ckt_ptr_->design().TapNameIdMap().size();
-          auto ret = ckt_ptr_->design().TapNameIdMap().insert(
-              std::pair<std::string, int>(block_name, map_size)
-          );
-          auto *name_id_pair_ptr = &(*ret.first);
-          tap_cell.SetNameNumPair(name_id_pair_ptr);
-          row.InsertWellTapCell(tap_cell, tap_cell_loc);
-          tap_cell_loc += step;
-        }
-        row.LegalizeLooseX(space_to_well_tap_);
+  for (int k = 0; k < stripe_cnt; ++k) {
+    first_tap_ids[k] = tap_cell_list.size();
+    size_t tap_cnt = stripe_ptrs_[k]->gridded_rows_.size() * tap_cell_num;
+    for (size_t i = 0; i < tap_cnt; ++i) {
+      std::string block_name = "__well_tap__" + std::to_string(counter++);
+      tap_cell_list.emplace_back();
+      auto &tap_cell = tap_cell_list.back();
+      tap_cell.SetPlacementStatus(PLACED);
+      tap_cell.SetType(ckt_ptr_->tech().WellTapCellPtrs()[0]);
+      int map_size = ckt_ptr_->design().TapNameIdMap().size();
+      auto ret = ckt_ptr_->design().TapNameIdMap().insert(
+          std::pair<std::string, int>(block_name, map_size)
+      );
+      auto *name_id_pair_ptr = &(*ret.first);
+      tap_cell.SetNameNumPair(name_id_pair_ptr);
+    }
+  }
+
+  int num_threads = std::max(num_threads_, 1);
+#pragma omp parallel for schedule(dynamic, 1) num_threads(num_threads) default(none) shared(stripe_cnt, first_tap_ids, tap_cell_list, tap_cell_num)
+  for (int k = 0; k < stripe_cnt; ++k) {
+    size_t tap_id = first_tap_ids[k];
+    for (auto &row : stripe_ptrs_[k]->gridded_rows_) {
+      int step = row.Width();
+      int tap_cell_loc = row.LLX() - well_tap_cell_->Width() / 2;
+      for (int i = 0; i < tap_cell_num; ++i) {
+        row.InsertWellTapCell(tap_cell_list[tap_id++], tap_cell_loc);
+        tap_cell_loc += step;
       }
+      row.LegalizeLooseX(space_to_well_tap_);
     }
   }
-  BOOST_LOG_TRIVIAL(info) << "Inserting complete: " << tot_tap_cell_num
+  BOOST_LOG_TRIVIAL(info) << "Inserting complete: " << tap_cell_list.size()
                           << " well tap cell created\n";
 }
 
@@ -1016,13 +1186,19 @@ bool StdClusterWellLegalizer::StartPlacement() {
   BOOST_LOG_TRIVIAL(info) << "Form block clustering\n";
   //BlockClustering();
   //is_success = BlockClusteringCompact();
-  is_success = BlockClusteringLoose();
+  {
+    ProfileScope scope("block clustering");
+    is_success = BlockClusteringLoose();
+  }
   ReportHPWL();
   //circuit_ptr_->GenMATLABWellTable("clu", false);
   //GenMatlabClusterTable("clu_result");
 
   BOOST_LOG_TRIVIAL(info) << "Flip cluster orientation\n";
-  UpdateClusterOrient();
+  {
+    ProfileScope scope("cluster orientation");
+    UpdateClusterOrient();
+  }
   ReportHPWL();
   //circuit_ptr_->GenMATLABWellTable("ori", false);
   //GenMatlabClusterTable("ori_result");
@@ -1030,6 +1206,7 @@ bool StdClusterWellLegalizer::StartPlacement() {
   BOOST_LOG_TRIVIAL(info) << "Perform local reordering\n";
   for (int i = 0; i < 6; ++i) {
     BOOST_LOG_TRIVIAL(info) << "reorder iteration: " << i << "\n";
+    ProfileScope scope("local reordering");
     LocalReorderAllClusters();
     ReportHPWL();
     //BOOST_LOG_TRIVIAL(info) << "optimization: " << i;
@@ -1040,7 +1217,10 @@ bool StdClusterWellLegalizer::StartPlacement() {
   //GenMatlabClusterTable("lop_result");
 
   BOOST_LOG_TRIVIAL(info) << "Insert well tap cells\n";
-  InsertWellTap();
+  {
+    ProfileScope scope("well tap insertion");
+    InsertWellTap();
+  }
   //circuit_ptr_->GenMATLABWellTable("wtc", false);
   //GenMatlabClusterTable("wtc_result");
 
@@ -33,6 +33,29 @@
 
 namespace dali {
 
+/****
+ * Buffers used by local reordering, they are reused by all windows to avoid
+ * memory allocation. Nets affected by a window are stored in a CSR-like
+ * format: pins of the k-th net in the window are in
+ * [pin_begin[k], pin_begin[k+1]).
+ */
+struct LocalReorderScratch {
+  std::vector<int> window_blk_ids;
+  std::vector<Block *> window_blks;
+  std::vector<int> net_ids;
+  // bounds of pins outside the window
+  std::vector<double> ext_min_x;
+  std::vector<double> ext_max_x;
+  std::vector<int> pin_begin;
+  // index of the block in the window, and the offset of each pin
+  std::vector<int> pin_slots;
+  std::vector<double> pin_offsets_x;
+  // current and best permutations, and x-locations of blocks in the window
+  std::vector<int> order;
+  std::vector<int> best_order;
+  std::vector<double> slot_llx;
+};
+
 class StdClusterWellLegalizer : public Placer {
   friend class Dali;
  public:
@@ -46,6 +69,8 @@ class StdClusterWellLegalizer : public Placer {
   void FetchNpWellParams();
   void SaveInitialBlockLocation();
   void InitializeWellLegalizer(int cluster_width = 0);
+  void CollectStripes();
+  std::vector<Stripe *> &StripePtrs() { return stripe_ptrs_; }
 
   void CreateClusterAndAppendSingleWellBlock(Stripe &stripe, Block &blk);
   void AppendSingleWellBlockToFrontCluster(Stripe &stripe, Block &blk);
@@ -60,25 +85,36 @@ class StdClusterWellLegalizer : public Placer {
   bool StripeLegalizationTopDownCompact(Stripe &stripe);
 
   bool BlockClustering();
+  bool StripeLegalizationLoose(Stripe &stripe);
   bool BlockClusteringLoose();
   bool BlockClusteringCompact();
 
   bool TrialClusterLegalization(Stripe &stripe);
 
-  double WireLengthCost(GriddedRow *cluster, int l, int r);
+  void SnapshotBlockLocations();
+  void CollectWindowNets(
+      GriddedRow *cluster,
+      int l,
+      int r,
+      LocalReorderScratch &scratch
+  ) const;
+  double WindowWireLengthCost(LocalReorderScratch &scratch) const;
   void FindBestLocalOrder(
-      std::vector<Block *> &res,
-      double &cost,
       GriddedRow *cluster,
-      int cur,
       int l,
       int r,
       int left_bound,
       int right_bound,
       int gap,
-      int range
+      LocalReorderScratch &scratch
+  ) const;
+  void SetLocalReorderRange(int range);
+  void LocalReorderInCluster(
+      GriddedRow *cluster,
+      int range,
+      LocalReorderScratch &scratch
   );
-  void LocalReorderInCluster(GriddedRow *cluster, int range = 3);
+  void LocalReorderInStripe(Stripe &stripe);
   void LocalReorderAllClusters();
 
   //void SingleSegmentClusteringOptimization();
@@ -132,8 +168,20 @@ class StdClusterWellLegalizer : public Placer {
   std::vector<BlkInitPair> index_loc_list_;
   std::vector<ClusterStripe> col_list_; // list of stripes
 
+  /**** stripe-parallel execution ****/
+  // all stripes in col_list_, each stripe is processed by one thread
+  std::vector<Stripe *> stripe_ptrs_;
+  // the index of the stripe each movable block belongs to, -1 for others
+  std::vector<int> blk_stripe_ids_;
+  // block locations before the current local reordering, a stripe sees
+  // blocks in other stripes at these locations, so the result does not
+  // depend on the order in which stripes are processed
+  std::vector<double2d> blk_snapshot_locs_;
+
   /**** parameters for legalization ****/
   int max_iter_ = 10;
+  // number of blocks in each local reordering window
+  int local_reorder_range_ = 3;
 
   /**** initial location ****/
   std::vector<int2d> block_init_locations_;
@@ -141,6 +189,7 @@ class StdClusterWellLegalizer : public Placer {
   // dump result
   bool is_dump = false;
   int dump_count = 0;
+  int dump_row_count_ = 0;
 
 };
 
@@ -20,12 +20,11 @@
  ******************************************************************************/
 #include "stripe.h"
 
-#include <omp.h>
-
 #include <algorithm>
 
 #include "dali/placer/well_legalizer/blockhelper.h"
 #include "dali/placer/well_legalizer/lgblkaux.h"
+#include "dali/placer/well_legalizer/optimizationhelper.h"
 #include "dali/placer/well_legalizer/stripehelper.h"
 
 namespace dali {
@@ -609,6 +608,7 @@ void Stripe::CollectAllRowSegments() {
       row_seg_ptrs_.push_back(&segment);
     }
   }
+  row_seg_vars_.resize(row_seg_ptrs_.size());
 }
 
 void Stripe::UpdateSubCellLocs(std::vector<BlkDispVar> &vars) {
@@ -624,29 +624,53 @@ void Stripe::UpdateSubCellLocs(std::vector<BlkDispVar> &vars) {
   }
 }
 
+/****
+ * @brief Scatter the results of all row segments to the sub-cell locations of
+ * blocks. Each sub-cell belongs to exactly one row segment, so segments write
+ * disjoint entries.
+ */
+void Stripe::UpdateAllSubCellLocs() {
+  int sz = static_cast<int>(row_seg_vars_.size());
+#pragma omp parallel for schedule(dynamic, 4) num_threads(num_threads_) default(none) shared(sz)
+  for (int i = 0; i < sz; ++i) {
+    UpdateSubCellLocs(row_seg_vars_[i]);
+  }
+}
+
+/****
+ * @brief Optimize displacement in every row segment. Segments only read the
+ * state left by the previous round and write to their own buffers in
+ * row_seg_vars_, so they run concurrently without synchronization. The
+ * sub-cell locations are updated in a separate phase afterwards.
+ */
 void Stripe::OptimizeDisplacementInEachRowSegment(
     double lambda,
     bool is_weighted_anchor,
-    bool is_reorder
+    bool is_reorder,
+    int reorder_range
 ) {
-  size_t sz = row_seg_ptrs_.size();
-#pragma omp parallel for
-  for (size_t i = 0; i < sz; ++i) {
-    RowSegment *seg = row_seg_ptrs_[i];
-    std::vector<BlkDispVar> vars =
-        seg->OptimizeQuadraticDisplacement(lambda,
-                                           is_weighted_anchor,
-                                           is_reorder);
-    //std::vector<BlkDispVar> vars =
-    //    seg->OptimizeLinearDisplacement(lambda, is_weighted_anchor, is_reorder);
-    UpdateSubCellLocs(vars);
+  int sz = static_cast<int>(row_seg_ptrs_.size());
+#pragma omp parallel for schedule(dynamic, 4) num_threads(num_threads_) default(none) shared(sz, lambda, is_weighted_anchor, is_reorder, reorder_range)
+  for (int i = 0; i < sz; ++i) {
+    row_seg_ptrs_[i]->OptimizeQuadraticDisplacement(
+        lambda, is_weighted_anchor, is_reorder,
+        row_seg_vars_[i], reorder_range
+    );
+    //row_seg_ptrs_[i]->OptimizeLinearDisplacement(
+    //    lambda, is_weighted_anchor, is_reorder,
+    //    row_seg_vars_[i], reorder_range
+    //);
   }
+  UpdateAllSubCellLocs();
 }
 
+/****
+ * @brief Reduce the sub-cell locations of each block to its average location.
+ */
 void Stripe::ComputeAverageLoc() {
-  size_t sz = blk_ptrs_vec_.size();
-#pragma omp parallel for
-  for (size_t i = 0; i < sz; ++i) {
+  int sz = static_cast<int>(blk_ptrs_vec_.size());
+#pragma omp parallel for schedule(static) num_threads(num_threads_) default(none) shared(sz)
+  for (int i = 0; i < sz; ++i) {
     Block *blk_ptr = blk_ptrs_vec_[i];
     auto aux_ptr = static_cast<LgBlkAux *>(blk_ptr->AuxPtr());
     aux_ptr->ComputeAverageLoc();
@@ -694,9 +718,9 @@ bool Stripe::IsDiscrepancyConverge() {
 }
 
 void Stripe::SetBlockLoc() {
-  size_t sz = blk_ptrs_vec_.size();
-#pragma omp parallel for
-  for (size_t i = 0; i < sz; ++i) {
+  int sz = static_cast<int>(blk_ptrs_vec_.size());
+#pragma omp parallel for schedule(static) num_threads(num_threads_) default(none) shared(sz)
+  for (int i = 0; i < sz; ++i) {
     Block *blk_ptr = blk_ptrs_vec_[i];
     auto aux_ptr = static_cast<LgBlkAux *>(blk_ptr->AuxPtr());
     blk_ptr->SetLLX(std::round(aux_ptr->AverageLoc()));
@@ -705,18 +729,24 @@ void Stripe::SetBlockLoc() {
 
 void Stripe::ClearMultiRowCellBreaking() {
   row_seg_ptrs_.clear();
+  row_seg_vars_.clear();
 }
 
-void Stripe::IterativeCellReordering(int max_iter, int number_of_threads) {
+void Stripe::IterativeCellReordering(
+    int max_iter,
+    int number_of_threads,
+    int reorder_range
+) {
+  DaliExpects(number_of_threads > 0, "negative threads?");
+  num_threads_ = number_of_threads;
   CollectAllRowSegments();
-  omp_set_num_threads(number_of_threads);
   bool is_weighted_anchor = false;
   for (int i = 0; i < max_iter; ++i) {
     //double decay = 30.0; // the bigger, the closer to CPLEX result
     //double lambda = exp(-i / decay);
     double lambda = 1 / double(i + 1);
     OptimizeDisplacementInEachRowSegment(
-        lambda, is_weighted_anchor, i % 10 == 0
+        lambda, is_weighted_anchor, i % 10 == 0, reorder_range
     );
     ComputeAverageLoc();
     ReportIterativeStatus(i);
@@ -726,7 +756,6 @@ void Stripe::IterativeCellReordering(int max_iter, int number_of_threads) {
     if (max_discrepancy_ < 0.1) break;
   }
   SetBlockLoc();
-  omp_set_num_threads(1);
   ClearMultiRowCellBreaking();
   BOOST_LOG_TRIVIAL(info) << "displacement: " << displacements_ << "\n";
   BOOST_LOG_TRIVIAL(info) << "discrepancy : " << discrepancies_ << "\n";
@@ -746,6 +775,157 @@ size_t Stripe::OutOfBoundCell() {
   return cnt;
 }
 
+/****
+ * @brief Solve the same QP as OptimizeDisplacementUsingQuadraticProgramming()
+ * without CPLEX, using consensus ADMM.
+ *
+ * A block spanning k rows has one copy (sub-cell) in each of these rows. Like
+ * ConstructQuadraticObjective(), the objective has one term (x - x_init)^2
+ * for each row a block spans, and each copy takes the term of its row, so a
+ * k-row block weighs k. Each row then only keeps the ordering constraints of its own cells, and
+ * with the augmented Lagrangian term, a row sub-problem is a chain of weighted
+ * quadratic costs with non-overlapping constraints, which Abacus solves
+ * exactly in linear time. The copies of a block are averaged into the block
+ * location, and the scaled dual variable of each copy accumulates the
+ * disagreement between the copy and the block.
+ *
+ * Blocks keep the order given by their current locations in each row, the
+ * same ordering constraints as the CPLEX model.
+ *
+ * Until ADMM converges, copies of a block disagree, and their average may
+ * overlap with other blocks. So if ADMM does not converge, blocks are put back
+ * at the locations it started from, which are legal when it starts from the
+ * greedy locations.
+ *
+ * @param is_warm_start: start from the greedy locations instead of the
+ * current ones
+ * @param max_iter: maximum number of ADMM iterations
+ * @param tolerance: primal and dual residual threshold in grid units
+ * @return true if the residuals drop below the tolerance within max_iter
+ */
+bool Stripe::OptimizeDisplacementUsingAdmm(
+    bool is_warm_start,
+    int max_iter,
+    double tolerance
+) {
+  // penalty of the augmented Lagrangian term, adapted by residual balancing
+  double rho = 1.0;
+
+  SortBlocksInEachRow();
+
+  std::vector<double> start_locs;
+  start_locs.reserve(blk_ptrs_vec_.size());
+  for (Block *blk_ptr : blk_ptrs_vec_) {
+    auto aux_ptr = static_cast<LgBlkAux *>(blk_ptr->AuxPtr());
+    double loc = is_warm_start ? aux_ptr->GreedyLoc().x : blk_ptr->LLX();
+    start_locs.push_back(loc);
+    int region_cnt = static_cast<int>(aux_ptr->SubLocs().size());
+    for (int i = 0; i < region_cnt; ++i) {
+      aux_ptr->SetSubCellLoc(i, loc, 1.0);
+    }
+    aux_ptr->ComputeAverageLoc();
+  }
+
+  size_t row_cnt = gridded_rows_.size();
+  std::vector<std::vector<double>> sub_locs(row_cnt);
+  std::vector<std::vector<double>> duals(row_cnt);
+  for (size_t r = 0; r < row_cnt; ++r) {
+    size_t sz = gridded_rows_[r].blk_regions_.size();
+    sub_locs[r].assign(sz, 0);
+    duals[r].assign(sz, 0);
+  }
+  std::vector<double> prev_locs(blk_ptrs_vec_.size(), 0);
+  std::vector<BlkDispVar> vars;
+
+  bool is_converged = false;
+  int iter = 0;
+  double primal_residual = 0;
+  double dual_residual = 0;
+  for (; iter < max_iter && !is_converged; ++iter) {
+    // update copies row by row
+    for (size_t r = 0; r < row_cnt; ++r) {
+      auto &blk_regions = gridded_rows_[r].blk_regions_;
+      vars.clear();
+      for (size_t i = 0; i < blk_regions.size(); ++i) {
+        Block *blk_ptr = blk_regions[i].p_blk;
+        auto aux_ptr = static_cast<LgBlkAux *>(blk_ptr->AuxPtr());
+        vars.emplace_back(blk_ptr->Width(), aux_ptr->InitLoc().x, 1.0);
+        vars.back().SetAnchor(aux_ptr->AverageLoc() - duals[r][i], rho / 2);
+      }
+      AbacusPlaceRow(vars);
+      for (size_t i = 0; i < blk_regions.size(); ++i) {
+        sub_locs[r][i] = vars[i].Solution();
+      }
+    }
+
+    // update block locations using copies shifted by their dual variables
+    for (size_t r = 0; r < row_cnt; ++r) {
+      auto &blk_regions = gridded_rows_[r].blk_regions_;
+      for (size_t i = 0; i < blk_regions.size(); ++i) {
+        auto aux_ptr = static_cast<LgBlkAux *>(blk_regions[i].p_blk->AuxPtr());
+        aux_ptr->SetSubCellLoc(
+            blk_regions[i].region_id,
+            sub_locs[r][i] + duals[r][i],
+            1.0
+        );
+      }
+    }
+    dual_residual = 0;
+    for (size_t j = 0; j < blk_ptrs_vec_.size(); ++j) {
+      auto aux_ptr = static_cast<LgBlkAux *>(blk_ptrs_vec_[j]->AuxPtr());
+      prev_locs[j] = aux_ptr->AverageLoc();
+      aux_ptr->ComputeAverageLoc();
+      dual_residual = std::max(
+          dual_residual,
+          rho * std::fabs(aux_ptr->AverageLoc() - prev_locs[j])
+      );
+    }
+
+    // update dual variables
+    primal_residual = 0;
+    for (size_t r = 0; r < row_cnt; ++r) {
+      auto &blk_regions = gridded_rows_[r].blk_regions_;
+      for (size_t i = 0; i < blk_regions.size(); ++i) {
+        auto aux_ptr = static_cast<LgBlkAux *>(blk_regions[i].p_blk->AuxPtr());
+        double residual = sub_locs[r][i] - aux_ptr->AverageLoc();
+        duals[r][i] += residual;
+        primal_residual = std::max(primal_residual, std::fabs(residual));
+      }
+    }
+
+    is_converged = primal_residual < tolerance && dual_residual < tolerance;
+
+    // keep the primal and dual residuals within a factor of each other, the
+    // scaled dual variables are rescaled to keep unscaled ones unchanged
+    double rho_factor = 1;
+    if (primal_residual > 10 * dual_residual) {
+      rho_factor = 2;
+    } else if (dual_residual > 10 * primal_residual) {
+      rho_factor = 0.5;
+    }
+    if (rho_factor != 1) {
+      rho *= rho_factor;
+      for (auto &row_duals : duals) {
+        for (auto &dual : row_duals) {
+          dual /= rho_factor;
+        }
+      }
+    }
+  }
+
+  for (size_t j = 0; j < blk_ptrs_vec_.size(); ++j) {
+    auto aux_ptr = static_cast<LgBlkAux *>(blk_ptrs_vec_[j]->AuxPtr());
+    double loc = is_converged ? aux_ptr->AverageLoc() : start_locs[j];
+    blk_ptrs_vec_[j]->SetLLX(loc);
+  }
+
+  BOOST_LOG_TRIVIAL(debug)
+    << "ADMM iterations: " << iter
+    << ", primal residual: " << primal_residual
+    << ", dual residual: " << dual_residual << "\n";
+  return is_converged;
+}
+
 #if DALI_USE_CPLEX
 void Stripe::PopulateVariableArray(IloModel &model, IloNumVarArray &x) {
   IloEnv env = model.getEnv();
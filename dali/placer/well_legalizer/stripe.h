@@ -63,6 +63,9 @@ class Stripe {
   std::vector<SegI> well_tap_cell_location_odd_;
 
   std::vector<RowSegment *> row_seg_ptrs_;
+  // per row segment results of the consensus iteration, reused across rounds
+  std::vector<std::vector<BlkDispVar>> row_seg_vars_;
+  int num_threads_ = 1;
 
   std::vector<double> displacements_;
   std::vector<double> discrepancies_;
@@ -125,22 +128,35 @@ class Stripe {
 
   void CollectAllRowSegments();
   void UpdateSubCellLocs(std::vector<BlkDispVar> &vars);
+  void UpdateAllSubCellLocs();
   void OptimizeDisplacementInEachRowSegment(
       double lambda,
       bool is_weighted_anchor,
-      bool is_reorder
+      bool is_reorder,
+      int reorder_range = 3
   );
   void ComputeAverageLoc();
   void ReportIterativeStatus(int i);
   bool IsDiscrepancyConverge();
   void SetBlockLoc();
   void ClearMultiRowCellBreaking();
-  void IterativeCellReordering(int max_iter, int number_of_threads = 1);
+  void IterativeCellReordering(
+      int max_iter,
+      int number_of_threads = 1,
+      int reorder_range = 3
+  );
 
   void SortBlocksInEachRow();
 
   size_t OutOfBoundCell();
 
+  /**** built-in QP solver, used when CPLEX is not available ****/
+  bool OptimizeDisplacementUsingAdmm(
+      bool is_warm_start,
+      int max_iter = 1000,
+      double tolerance = 0.01
+  );
+
 #if DALI_USE_CPLEX
   std::unordered_map<Block *, IloInt> blk_ptr_2_tmp_id;
   std::unordered_map<IloInt, Block *> blk_tmp_id_2_ptr;
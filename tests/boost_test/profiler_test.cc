@@ -0,0 +1,208 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MAIN
+#include <boost/test/unit_test.hpp>
+
+#include "dali/common/profiler.h"
+#define BOOST_TEST_MODULE profiler
+
+using namespace dali;
+
+/****
+ * Stages of the profiler below are
+ *   flow
+ *   flow/gp            entered twice
+ *   flow/gp/solver     left by EndStage() of flow/gp
+ *   flow/lg            with counter "iterations" and the first HPWL record
+ *   flow/lg/cg         created by AddTime()
+ *   flow/lg/cg/x       created by AddTime(), 0.5 seconds
+ *   io, "pins"         a name which needs escaping, left open
+ * ****/
+void BuildProfile(Profiler &profiler) {
+  int flow = profiler.BeginStage("flow");
+  int gp = profiler.BeginStage("gp");
+  profiler.BeginStage("solver");
+  profiler.EndStage(gp);
+  int lg = profiler.BeginStage("lg");
+  profiler.AddCount("iterations", 3);
+  profiler.AddCount("iterations", 2);
+  profiler.AddTime("cg/x", 0.5);
+  profiler.RecordHpwl(0, 10, 20);
+  profiler.EndStage(lg);
+  profiler.BeginStage("gp");
+  profiler.RecordHpwl(1, 12, 18);
+  profiler.EndStage(flow);
+  profiler.EndStage(flow); // not entered, nothing happens
+  profiler.BeginStage("io, \"pins\"");
+}
+
+std::vector<std::string> ReadLines(std::string const &file_name) {
+  std::ifstream ist(file_name);
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(ist, line)) {
+    lines.push_back(line);
+  }
+  return lines;
+}
+
+std::string ReadFile(std::string const &file_name) {
+  std::ifstream ist(file_name);
+  return std::string(
+      (std::istreambuf_iterator<char>(ist)),
+      std::istreambuf_iterator<char>()
+  );
+}
+
+bool HasLine(std::vector<std::string> const &lines, std::string const &line) {
+  for (auto &l : lines) {
+    if (l == line) return true;
+  }
+  return false;
+}
+
+BOOST_AUTO_TEST_SUITE(profiler)
+BOOST_AUTO_TEST_CASE(stage_tree) {
+  Profiler profiler;
+  BuildProfile(profiler);
+  auto &stages = profiler.Stages();
+  BOOST_REQUIRE_EQUAL(stages.size(), 7);
+
+  std::vector<std::string> paths = {
+      "flow", "flow/gp", "flow/gp/solver", "flow/lg", "flow/lg/cg",
+      "flow/lg/cg/x", "io, \"pins\""
+  };
+  std::vector<int> parents = {-1, 0, 1, 0, 3, 4, -1};
+  std::vector<int> depths = {0, 1, 2, 1, 2, 3, 0};
+  std::vector<int> call_cnts = {1, 2, 1, 1, 0, 0, 1};
+  for (size_t i = 0; i < stages.size(); ++i) {
+    BOOST_CHECK_EQUAL(stages[i].path, paths[i]);
+    BOOST_CHECK_EQUAL(stages[i].parent, parents[i]);
+    BOOST_CHECK_EQUAL(stages[i].depth, depths[i]);
+    BOOST_CHECK_EQUAL(stages[i].call_cnt, call_cnts[i]);
+  }
+  BOOST_CHECK_EQUAL(stages[4].wall_time, 0);
+  BOOST_CHECK_EQUAL(stages[5].wall_time, 0.5);
+  // a stage is left after its sub-stages
+  BOOST_CHECK_GE(stages[1].wall_time, stages[2].wall_time);
+  BOOST_CHECK_GE(stages[0].wall_time, stages[1].wall_time);
+
+  BOOST_REQUIRE_EQUAL(stages[3].counters.size(), 1);
+  BOOST_CHECK_EQUAL(stages[3].counters[0].first, "iterations");
+  BOOST_CHECK_EQUAL(stages[3].counters[0].second, 5);
+
+  auto &iterations = profiler.Iterations();
+  BOOST_REQUIRE_EQUAL(iterations.size(), 2);
+  BOOST_CHECK_EQUAL(iterations[0].stage, 3);
+  BOOST_CHECK_EQUAL(iterations[0].iteration, 0);
+  BOOST_CHECK_EQUAL(iterations[0].lower_bound, 10);
+  BOOST_CHECK_EQUAL(iterations[0].upper_bound, 20);
+  BOOST_CHECK_EQUAL(iterations[1].stage, 1);
+  BOOST_CHECK_EQUAL(iterations[1].iteration, 1);
+}
+
+BOOST_AUTO_TEST_CASE(csv_report) {
+  Profiler profiler;
+  BuildProfile(profiler);
+  profiler.SaveCsv("profiler_test.csv");
+  auto lines = ReadLines("profiler_test.csv");
+  // 5 metrics per stage, 1 counter, 2 metrics per iteration
+  BOOST_REQUIRE_EQUAL(lines.size(), 1 + 7 * 5 + 1 + 2 * 2);
+  BOOST_CHECK_EQUAL(lines[0], "stage,iteration,metric,value");
+  BOOST_CHECK_EQUAL(lines[1], "flow,,calls,1");
+  BOOST_CHECK(HasLine(lines, "flow/gp,,calls,2"));
+  BOOST_CHECK(HasLine(lines, "flow/gp/solver,,calls,1"));
+  BOOST_CHECK(HasLine(lines, "flow/lg,,iterations,5"));
+  BOOST_CHECK(HasLine(lines, "flow/lg/cg,,wall_time,0"));
+  BOOST_CHECK(HasLine(lines, "flow/lg/cg/x,,calls,0"));
+  BOOST_CHECK(HasLine(lines, "flow/lg/cg/x,,wall_time,0.5"));
+  BOOST_CHECK(HasLine(lines, "\"io, \"\"pins\"\"\",,calls,1"));
+  BOOST_CHECK_EQUAL(lines[37], "flow/lg,0,lower_bound_hpwl,10");
+  BOOST_CHECK_EQUAL(lines[38], "flow/lg,0,upper_bound_hpwl,20");
+  BOOST_CHECK_EQUAL(lines[39], "flow/gp,1,lower_bound_hpwl,12");
+  BOOST_CHECK_EQUAL(lines[40], "flow/gp,1,upper_bound_hpwl,18");
+
+  // saving a report leaves all stages, so a new stage is at the top level
+  profiler.AddTime("after", 1);
+  BOOST_CHECK_EQUAL(profiler.Stages().back().path, "after");
+}
+
+BOOST_AUTO_TEST_CASE(json_report) {
+  Profiler profiler;
+  BuildProfile(profiler);
+  profiler.SaveJson("profiler_test.json");
+  std::string report = ReadFile("profiler_test.json");
+  BOOST_CHECK_EQUAL(report.rfind("{\n  \"stages\": [\n", 0), 0);
+  BOOST_CHECK_NE(
+      report.find(
+          "{\"path\": \"flow/lg/cg/x\", \"name\": \"x\", \"depth\": 3, "
+          "\"calls\": 0, \"wall_time\": 0.5, \"cpu_time\": 0, "
+          "\"rss_delta\": 0, \"peak_rss\": 0, \"counters\": {}}"
+      ),
+      std::string::npos
+  );
+  BOOST_CHECK_NE(
+      report.find("\"counters\": {\"iterations\": 5}}"),
+      std::string::npos
+  );
+  BOOST_CHECK_NE(
+      report.find("{\"path\": \"io, \\\"pins\\\"\", \"name\": "),
+      std::string::npos
+  );
+  BOOST_CHECK_NE(
+      report.find(
+          "  \"iterations\": [\n"
+          "    {\"stage\": \"flow/lg\", \"iteration\": 0, "
+          "\"lower_bound_hpwl\": 10, \"upper_bound_hpwl\": 20},\n"
+          "    {\"stage\": \"flow/gp\", \"iteration\": 1, "
+          "\"lower_bound_hpwl\": 12, \"upper_bound_hpwl\": 18}\n"
+          "  ]\n}\n"
+      ),
+      std::string::npos
+  );
+}
+
+// the -profile flag of dali and the --profile flag of mhlg
+BOOST_AUTO_TEST_CASE(global_report) {
+  GlobalProfiler().Clear();
+  {
+    ProfileScope flow_scope("flow");
+    ProfileScope lg_scope("lg");
+    GlobalProfiler().AddCount("iterations", 7);
+  }
+  GlobalProfiler().SaveReport("profiler_test_global.csv");
+  GlobalProfiler().SaveReport("profiler_test_global.json");
+  auto lines = ReadLines("profiler_test_global.csv");
+  BOOST_REQUIRE_EQUAL(lines.size(), 1 + 2 * 5 + 1);
+  BOOST_CHECK_EQUAL(lines[0], "stage,iteration,metric,value");
+  BOOST_CHECK(HasLine(lines, "flow/lg,,iterations,7"));
+  std::string report = ReadFile("profiler_test_global.json");
+  BOOST_CHECK_EQUAL(report.rfind("{\n  \"stages\": [\n", 0), 0);
+  BOOST_CHECK_NE(report.find("\"path\": \"flow/lg\""), std::string::npos);
+  GlobalProfiler().Clear();
+}
+BOOST_AUTO_TEST_SUITE_END()
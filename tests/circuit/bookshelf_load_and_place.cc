@@ -0,0 +1,84 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <memory>
+
+#include "dali/circuit/circuit.h"
+#include "dali/common/logging.h"
+#include "dali/placer.h"
+#include "helper.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+/****
+ * @brief Load a Bookshelf benchmark, perform global placement, and legalize it
+ * by the given legalizer.
+ *
+ * @return true if the final placement is legal, otherwise, false
+ */
+bool LoadPlaceAndLegalize(std::string const &aux_file_name, bool is_abacus) {
+  Circuit circuit;
+  circuit.LoadBookshelf(aux_file_name);
+
+  auto gb_placer = std::make_unique<GlobalPlacer>();
+  gb_placer->SetInputCircuit(&circuit);
+  gb_placer->SetMaxIteration(30);
+  gb_placer->SetPlacementDensity(0.7);
+  gb_placer->StartPlacement();
+
+  if (is_abacus) {
+    auto legalizer = std::make_unique<AbacusLegalizer>();
+    legalizer->TakeOver(gb_placer.get());
+    legalizer->StartPlacement();
+  } else {
+    auto legalizer = std::make_unique<LGTetrisEx>();
+    legalizer->TakeOver(gb_placer.get());
+    legalizer->StartPlacement();
+  }
+  return IsRowPlacementLegal(circuit);
+}
+
+/****
+ * @brief Testcase for the Bookshelf reader: Circuit::LoadBookshelf().
+ *
+ * A Bookshelf benchmark has no LEF, so BlockTypes created by the Bookshelf
+ * reader have fake well regions. This testcase shows that a Bookshelf
+ * benchmark can go through global placement and legalization, and that
+ * 1. LGTetrisEx gives a legal placement
+ * 2. AbacusLegalizer gives a legal placement
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  std::string aux_file_name =
+      WriteBookshelfBenchmark("bookshelf_load_and_place", 2000, 1);
+
+  bool is_tetris_legal = LoadPlaceAndLegalize(aux_file_name, false);
+  bool is_abacus_legal = LoadPlaceAndLegalize(aux_file_name, true);
+
+  if (is_tetris_legal && is_abacus_legal) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
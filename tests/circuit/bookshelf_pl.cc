@@ -0,0 +1,148 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <fstream>
+#include <memory>
+
+#include "dali/circuit/circuit.h"
+#include "dali/common/logging.h"
+#include "dali/placer.h"
+#include "helper.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+/****
+ * @brief Check if a .pl file with headers, comments, and short lines is
+ * loaded like the old .pl parser, which skips lines without a location and an
+ * orientation, and only /FIXED changes the placement status.
+ */
+bool IsPlLoadedCorrectly(std::string const &aux_file_name) {
+  Circuit circuit;
+  circuit.LoadBookshelf(aux_file_name);
+  int mov_blk_cnt = circuit.TotMovBlkCnt();
+
+  std::string pl_file_name = "bookshelf_pl_partial.pl";
+  std::ofstream ost(pl_file_name);
+  ost << "UCLA pl 1.0\n"
+      << "# created by hand\n"
+      << "\n"
+      << "Version : 2\n"
+      << "o0  10  24  : N\n"
+      << "o1  5\n"
+      << "o2  36  12  : N /FIXED\n"
+      << "o3  abc  12  : N\n"
+      << "unknown_node  8  8  : N\n";
+  ost.close();
+  circuit.LoadBookshelfPl(pl_file_name);
+
+  bool res = true;
+  Block *o0 = circuit.GetBlockPtr("o0");
+  Block *o1 = circuit.GetBlockPtr("o1");
+  Block *o2 = circuit.GetBlockPtr("o2");
+  Block *o3 = circuit.GetBlockPtr("o3");
+  if (o0->LLX() != 10 || o0->LLY() != 24 || o0->Status() != UNPLACED) {
+    BOOST_LOG_TRIVIAL(info) << "o0 is not loaded correctly\n";
+    res = false;
+  }
+  if (o1->LLX() != 0 || o1->LLY() != 0 || o1->Status() != UNPLACED) {
+    BOOST_LOG_TRIVIAL(info) << "o1 is changed by a line without location\n";
+    res = false;
+  }
+  if (o2->LLX() != 36 || o2->LLY() != 12 || o2->Status() != FIXED) {
+    BOOST_LOG_TRIVIAL(info) << "o2 is not loaded as a FIXED block\n";
+    res = false;
+  }
+  if (o3->LLX() != 0 || o3->LLY() != 0 || o3->Status() != UNPLACED) {
+    BOOST_LOG_TRIVIAL(info) << "o3 is changed by an invalid location\n";
+    res = false;
+  }
+  if (circuit.TotMovBlkCnt() != mov_blk_cnt - 1) {
+    BOOST_LOG_TRIVIAL(info) << "number of movable blocks is not updated\n";
+    res = false;
+  }
+
+  BOOST_LOG_TRIVIAL(info) << "Is the .pl file loaded correctly? ";
+  if (res) {
+    BOOST_LOG_TRIVIAL(info) << "Yes\n";
+  } else {
+    BOOST_LOG_TRIVIAL(info) << "No\n";
+  }
+  return res;
+}
+
+/****
+ * @brief Check if a legal placement saved by Circuit::SaveBookshelfPl() is
+ * loaded back to the same locations.
+ */
+bool IsPlRoundTripExact(std::string const &aux_file_name) {
+  Circuit circuit0;
+  circuit0.LoadBookshelf(aux_file_name);
+  auto gb_placer = std::make_unique<GlobalPlacer>();
+  gb_placer->SetInputCircuit(&circuit0);
+  gb_placer->SetMaxIteration(30);
+  gb_placer->SetPlacementDensity(0.7);
+  gb_placer->StartPlacement();
+  auto legalizer = std::make_unique<LGTetrisEx>();
+  legalizer->TakeOver(gb_placer.get());
+  legalizer->StartPlacement();
+  std::string pl_file_name = "bookshelf_pl_round_trip.pl";
+  circuit0.SaveBookshelfPl(pl_file_name);
+
+  Circuit circuit1;
+  circuit1.LoadBookshelf(aux_file_name);
+  circuit1.LoadBookshelfPl(pl_file_name, true);
+
+  // orientations are not saved in .pl files
+  bool res = IsSameBlockLocation(circuit0, circuit1, false);
+  BOOST_LOG_TRIVIAL(info) << "Is the .pl round trip exact? ";
+  if (res) {
+    BOOST_LOG_TRIVIAL(info) << "Yes\n";
+  } else {
+    BOOST_LOG_TRIVIAL(info) << "No\n";
+  }
+  return res;
+}
+
+/****
+ * @brief Testcase for loading .pl files: Circuit::LoadBookshelfPl().
+ *
+ * This testcase shows that
+ * 1. headers, comments, lines without a valid location, and unknown nodes in
+ *    a .pl file are skipped, and the placement status of a block only changes
+ *    if the block is marked /FIXED
+ * 2. a legal placement saved to a .pl file can be loaded back exactly
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  std::string aux_file_name = WriteBookshelfBenchmark("bookshelf_pl", 500, 2);
+
+  bool is_loaded_correctly = IsPlLoadedCorrectly(aux_file_name);
+  bool is_round_trip_exact = IsPlRoundTripExact(aux_file_name);
+
+  if (is_loaded_correctly && is_round_trip_exact) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
@@ -0,0 +1,145 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <memory>
+
+#include "dali/circuit/circuit.h"
+#include "dali/common/logging.h"
+#include "dali/placer.h"
+#include "helper.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+/****
+ * @brief Check if two circuits have the same placement region, the same
+ * blocks, and the same nets.
+ */
+bool IsSameBookshelfCircuit(Circuit &circuit0, Circuit &circuit1) {
+  if (circuit0.RegionLLX() != circuit1.RegionLLX()
+      || circuit0.RegionLLY() != circuit1.RegionLLY()
+      || circuit0.RegionURX() != circuit1.RegionURX()
+      || circuit0.RegionURY() != circuit1.RegionURY()
+      || circuit0.RowHeightGridUnit() != circuit1.RowHeightGridUnit()) {
+    BOOST_LOG_TRIVIAL(info) << "different placement regions or rows\n";
+    return false;
+  }
+
+  auto &blocks0 = circuit0.Blocks();
+  auto &blocks1 = circuit1.Blocks();
+  if (blocks0.size() != blocks1.size()) {
+    BOOST_LOG_TRIVIAL(info)
+      << "different number of blocks: " << blocks0.size() << " vs "
+      << blocks1.size() << "\n";
+    return false;
+  }
+  for (size_t i = 0; i < blocks0.size(); ++i) {
+    Block &blk0 = blocks0[i];
+    Block &blk1 = blocks1[i];
+    if (blk0.Name() != blk1.Name()
+        || blk0.Width() != blk1.Width() || blk0.Height() != blk1.Height()
+        || blk0.LLX() != blk1.LLX() || blk0.LLY() != blk1.LLY()
+        || blk0.Orient() != blk1.Orient()
+        || blk0.IsMovable() != blk1.IsMovable()) {
+      BOOST_LOG_TRIVIAL(info)
+        << "block " << blk0.Name() << " is different from "
+        << blk1.Name() << "\n";
+      return false;
+    }
+  }
+
+  auto &nets0 = circuit0.Nets();
+  auto &nets1 = circuit1.Nets();
+  if (nets0.size() != nets1.size()) {
+    BOOST_LOG_TRIVIAL(info)
+      << "different number of nets: " << nets0.size() << " vs "
+      << nets1.size() << "\n";
+    return false;
+  }
+  for (size_t i = 0; i < nets0.size(); ++i) {
+    auto &pins0 = nets0[i].BlockPins();
+    auto &pins1 = nets1[i].BlockPins();
+    bool is_same = nets0[i].Name() == nets1[i].Name()
+        && pins0.size() == pins1.size();
+    for (size_t j = 0; is_same && j < pins0.size(); ++j) {
+      is_same = pins0[j].BlkId() == pins1[j].BlkId()
+          && pins0[j].AbsX() == pins1[j].AbsX()
+          && pins0[j].AbsY() == pins1[j].AbsY()
+          && pins0[j].PinPtr()->IsInput() == pins1[j].PinPtr()->IsInput();
+    }
+    if (!is_same) {
+      BOOST_LOG_TRIVIAL(info) << "net " << nets0[i].Name() << " is different\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+/****
+ * @brief Testcase for Bookshelf writers and the Bookshelf reader.
+ *
+ * This testcase legalizes a Bookshelf benchmark, so some blocks are flipped,
+ * saves it to .nodes, .nets, .pl, .scl, .wts and .aux files, and loads these
+ * files into another circuit. It shows that the round trip reproduces
+ * 1. the placement region and rows
+ * 2. names, sizes, locations, orientations and statuses of blocks
+ * 3. nets and absolute locations of their pins
+ * 4. HPWL
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  std::string aux_file_name =
+      WriteBookshelfBenchmark("bookshelf_round_trip", 1000, 4);
+
+  Circuit circuit;
+  circuit.LoadBookshelf(aux_file_name);
+  auto gb_placer = std::make_unique<GlobalPlacer>();
+  gb_placer->SetInputCircuit(&circuit);
+  gb_placer->SetMaxIteration(30);
+  gb_placer->SetPlacementDensity(0.7);
+  gb_placer->StartPlacement();
+  auto legalizer = std::make_unique<LGTetrisEx>();
+  legalizer->TakeOver(gb_placer.get());
+  legalizer->StartPlacement();
+
+  std::string out_name = "bookshelf_round_trip_out";
+  circuit.SaveBookshelfNode(out_name + ".nodes");
+  circuit.SaveBookshelfNet(out_name + ".nets");
+  circuit.SaveBookshelfPl(out_name + ".pl");
+  circuit.SaveBookshelfScl(out_name + ".scl");
+  circuit.SaveBookshelfWts(out_name + ".wts");
+  circuit.SaveBookshelfAux(out_name);
+
+  Circuit circuit_loaded;
+  circuit_loaded.LoadBookshelf(out_name + ".aux");
+
+  bool is_same = IsSameBookshelfCircuit(circuit, circuit_loaded)
+      && IsSameValue(
+          circuit.WeightedHPWL(), circuit_loaded.WeightedHPWL(), "HPWL"
+      );
+  if (is_same) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
@@ -0,0 +1,231 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <cstdio>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "dali/circuit/circuit.h"
+#include "dali/common/logging.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+/****
+ * @brief Build a small circuit with blocks of different placement statuses and
+ * orientations, placed and unplaced I/O pins, and nets connecting them.
+ * Shapes of I/O pins have non-integer and large coordinates in DEF units.
+ */
+void BuildCircuit(Circuit &circuit) {
+  circuit.SetDatabaseMicrons(2000);
+  circuit.SetManufacturingGrid(0.005);
+  circuit.AddMetalLayer("m1", 0.1, 0.1, 0.02, 0.2, 0.2, HORIZONTAL);
+  circuit.AddMetalLayer("m2", 0.1, 0.1, 0.02, 0.2, 0.2, VERTICAL);
+  circuit.SetGridValue(0.2, 0.2);
+  circuit.SetRowHeight(1.2);
+
+  BlockType *inv = circuit.AddBlockType("INV", 0.6, 1.2);
+  circuit.AddBlkTypePin(inv, "A", true);
+  circuit.AddBlkTypePin(inv, "Y", false);
+  BlockType *nand2 = circuit.AddBlockType("NAND2", 0.8, 1.2);
+  circuit.AddBlkTypePin(nand2, "A", true);
+  circuit.AddBlkTypePin(nand2, "B", true);
+  circuit.AddBlkTypePin(nand2, "Y", false);
+  BlockType *ram = circuit.AddBlockType("RAM", 4.0, 3.6);
+  circuit.AddBlkTypePin(ram, "D", true);
+
+  circuit.SetUnitsDistanceMicrons(2000);
+  circuit.SetDieArea(400, 800, 40400, 24800);
+  circuit.SetListCapacity(5, 3, 4);
+  circuit.AddBlock("u0", "INV", 2, 6, PLACED, N);
+  circuit.AddBlock("u1", "INV", 5, 12, PLACED, FS);
+  circuit.AddBlock("u2", "NAND2", 10, 0, FIXED, N);
+  circuit.AddBlock("u3", "NAND2", 0, 0, UNPLACED, N);
+  circuit.AddBlock("ram0", "RAM", 40, 30, FIXED, FN);
+
+  IoPin *clk = circuit.AddIoPin("clk", PLACED, CLOCK, INPUT, 0, 30);
+  clk->SetLayerPtr(circuit.GetMetalLayerPtr("m1"));
+  clk->SetShape(-0.05, -0.0701234, 0.05, 0.0701234);
+  IoPin *out = circuit.AddIoPin("out", FIXED, SIGNAL, OUTPUT, 100, 12.5);
+  out->SetLayerPtr(circuit.GetMetalLayerPtr("m2"));
+  out->SetShape(-1000.5, 0, 0, 0.1);
+  circuit.AddIoPin("rst", UNPLACED, RESET, INPUT);
+
+  circuit.AddNet("n0", 3, 1);
+  circuit.AddIoPinToNet("clk", "n0");
+  circuit.AddBlkPinToNet("u0", "A", "n0");
+  circuit.AddBlkPinToNet("u1", "A", "n0");
+  circuit.AddNet("n1", 3, 1);
+  circuit.AddBlkPinToNet("u0", "Y", "n1");
+  circuit.AddBlkPinToNet("u2", "A", "n1");
+  circuit.AddBlkPinToNet("u2", "B", "n1");
+  circuit.AddNet("n2", 2, 1);
+  circuit.AddBlkPinToNet("u2", "Y", "n2");
+  circuit.AddIoPinToNet("out", "n2");
+  circuit.AddNet("n3", 2, 1);
+  circuit.AddIoPinToNet("rst", "n3");
+  circuit.AddBlkPinToNet("u3", "A", "n3");
+  circuit.AddBlkPinToNet("ram0", "D", "n3");
+}
+
+/****
+ * @brief Write the input DEF file, its COMPONENTS, PINS and NETS sections are
+ * replaced by DEF writers.
+ */
+void WriteInputDef(std::string const &def_file_name) {
+  std::ofstream ost(def_file_name);
+  ost << "VERSION 5.8 ;\n"
+      << "DIVIDERCHAR \"/\" ;\n"
+      << "BUSBITCHARS \"[]\" ;\n"
+      << "DESIGN def_writer ;\n"
+      << "UNITS DISTANCE MICRONS 2000 ;\n"
+      << "\n"
+      << "DIEAREA ( 400 800 ) ( 40400 24800 ) ;\n"
+      << "\n"
+      << "ROW ROW_0 core 400 800 N DO 100 BY 1 STEP 400 0 ;\n"
+      << "ROW ROW_1 core 400 3200 FS DO 100 BY 1 STEP 400 0 ;\n"
+      << "\n"
+      << "COMPONENTS 1 ;\n"
+      << "- old INV + PLACED ( 400 800 ) N ;\n"
+      << "END COMPONENTS\n"
+      << "\n"
+      << "PINS 0 ;\n"
+      << "END PINS\n"
+      << "\n"
+      << "NETS 0 ;\n"
+      << "END NETS\n"
+      << "\n"
+      << "END DESIGN\n";
+}
+
+/****
+ * @brief Read a file, and drop the title block written by
+ * Circuit::ExportDefTitle(), which contains the build time and the current
+ * time.
+ */
+std::string ReadWithoutTitle(std::string const &file_name) {
+  std::ifstream ist(file_name);
+  if (!ist.is_open()) {
+    BOOST_LOG_TRIVIAL(info) << "Cannot open file " << file_name << "\n";
+    return "";
+  }
+  std::string content(
+      (std::istreambuf_iterator<char>(ist)),
+      std::istreambuf_iterator<char>()
+  );
+  std::string title_line =
+      "##################################################\n";
+  if (content.compare(0, title_line.size(), title_line) == 0) {
+    size_t title_end = content.find(title_line, title_line.size());
+    if (title_end != std::string::npos) {
+      content.erase(0, title_end + title_line.size());
+    }
+  }
+  return content;
+}
+
+/****
+ * @brief Testcase for DEF writers: Circuit::SaveDefFile(),
+ * Circuit::SaveDefFiles() and Circuit::SaveDefFileComponent().
+ *
+ * Golden files were written by the DEF writers formatting each line with an
+ * std::ofstream, before DEF files were built in memory. This testcase shows
+ * that, apart from the title block,
+ * 1. each combination of save options gives the same bytes as the golden file
+ * 2. saving several DEF files in one call gives the same bytes as saving them
+ *    one by one
+ * 3. replacing COMPONENTS of the input DEF gives the same bytes as the golden
+ *    file
+ *
+ * @param argv[1]: directory of golden files
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main(int argc, char *argv[]) {
+  InitLogging("", boost::log::trivial::info, true);
+  if (argc < 2) {
+    BOOST_LOG_TRIVIAL(info) << "Usage: def_writer <golden_directory>\n";
+    return FAIL;
+  }
+  std::string golden_dir(argv[1]);
+
+  Circuit circuit;
+  BuildCircuit(circuit);
+  std::string def_file_name = "def_writer_input.def";
+  WriteInputDef(def_file_name);
+
+  // name padding, save_floorplan, save_cell, save_iopin, save_net
+  std::vector<DefFileOption> options = {
+      {"_all", 1, 1, 1, 1},
+      {"_pre_io", 1, 1, 2, 1},
+      {"_well", 1, 3, 0, 0},
+      {"_ppnp", 1, 4, 0, 0},
+      {"_placed", 1, 5, 1, 1},
+      {"_tap", 1, 2, 0, 3},
+      {"_empty", 1, 0, 0, 0},
+  };
+  // cover cells are named after the base name, so files saved in one call
+  // are renamed before saving them one by one with the same base name
+  circuit.SaveDefFiles("def_writer", def_file_name, options);
+  for (auto &option : options) {
+    std::string file_name = "def_writer" + option.name_padding + ".def";
+    std::rename(file_name.c_str(), ("batch_" + file_name).c_str());
+  }
+
+  std::vector<std::string> file_names;
+  for (auto &option : options) {
+    circuit.SaveDefFile(
+        "def_writer", option.name_padding, def_file_name,
+        option.save_floorplan, option.save_cell,
+        option.save_iopin, option.save_net
+    );
+    file_names.push_back("def_writer" + option.name_padding + ".def");
+  }
+  circuit.SaveDefFileComponent("def_writer_component.def", def_file_name);
+  file_names.emplace_back("def_writer_component.def");
+
+  bool is_passed = true;
+  for (auto &file_name : file_names) {
+    if (ReadWithoutTitle(file_name)
+        != ReadWithoutTitle(golden_dir + "/" + file_name)) {
+      BOOST_LOG_TRIVIAL(info)
+        << file_name << " is different from the golden file\n";
+      is_passed = false;
+    }
+  }
+  for (auto &option : options) {
+    std::string file_name = "def_writer" + option.name_padding + ".def";
+    if (ReadWithoutTitle("batch_" + file_name) != ReadWithoutTitle(file_name)) {
+      BOOST_LOG_TRIVIAL(info)
+        << "batch_" << file_name << " is different from " << file_name
+        << "\n";
+      is_passed = false;
+    }
+  }
+
+  if (is_passed) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
@@ -0,0 +1,443 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "helper.h"
+
+#include <cmath>
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "dali/common/logging.h"
+
+namespace dali {
+
+/****
+ * @brief Write a row-based placement benchmark in the Bookshelf format
+ *
+ * The benchmark has standard cells with random widths, four FIXED macros
+ * aligned to rows, and nets whose pins are mostly close to each other in the
+ * order of cells, so that the netlist has some locality like a real design.
+ * All cells are at (0, 0) in the .pl file. The same name, cell count, seed and
+ * double-height interval always give the same files.
+ *
+ * @param name: name of the benchmark, files are <name>.aux, <name>.nodes, ...
+ * @param cell_count: number of standard cells
+ * @param seed: seed of the random number generator
+ * @param double_height_interval: if positive, every this many cells, one cell
+ * is two rows high
+ * @return the name of the .aux file
+ */
+std::string WriteBookshelfBenchmark(
+    std::string const &name,
+    int cell_count,
+    unsigned int seed,
+    int double_height_interval
+) {
+  std::mt19937 rng(seed);
+  int row_height = 12;
+  int macro_width = 24;
+  int macro_height = 3 * row_height;
+  int macro_count = 4;
+  std::vector<int> widths(cell_count);
+  std::vector<int> heights(cell_count, row_height);
+  std::uniform_int_distribution<int> width_dist(2, 8);
+  long long cell_area = 0;
+  for (int i = 0; i < cell_count; ++i) {
+    widths[i] = width_dist(rng);
+    if (double_height_interval > 0
+        && i % double_height_interval == double_height_interval - 1) {
+      heights[i] = 2 * row_height;
+    }
+    cell_area += widths[i] * heights[i];
+  }
+  // cells take about half of the placement region
+  double region_area = 2.0 * cell_area
+      + macro_count * macro_width * macro_height;
+  int row_count = std::max(
+      16, static_cast<int>(std::ceil(std::sqrt(region_area) / row_height))
+  );
+  int site_count = std::max(
+      8 * macro_width,
+      static_cast<int>(std::ceil(region_area / (row_count * row_height)))
+  );
+
+  std::ofstream aux(name + ".aux");
+  aux << "RowBasedPlacement : " << name << ".nodes " << name << ".nets "
+      << name << ".wts " << name << ".pl " << name << ".scl\n";
+
+  std::ofstream scl(name + ".scl");
+  scl << "UCLA scl 1.0\n\nNumRows : " << row_count << "\n\n";
+  for (int i = 0; i < row_count; ++i) {
+    scl << "CoreRow Horizontal\n"
+        << "  Coordinate    :   " << i * row_height << "\n"
+        << "  Height        :   " << row_height << "\n"
+        << "  Sitewidth     :   1\n"
+        << "  Sitespacing   :   1\n"
+        << "  Siteorient    :   1\n"
+        << "  Sitesymmetry  :   1\n"
+        << "  SubrowOrigin  :   0  NumSites  :  " << site_count << "\n"
+        << "End\n";
+  }
+
+  std::ofstream nodes(name + ".nodes");
+  nodes << "UCLA nodes 1.0\n# synthetic benchmark\n\n"
+        << "NumNodes : " << cell_count + macro_count << "\n"
+        << "NumTerminals : " << macro_count << "\n";
+  for (int i = 0; i < cell_count; ++i) {
+    nodes << "  o" << i << "  " << widths[i] << "  " << heights[i] << "\n";
+  }
+  for (int i = 0; i < macro_count; ++i) {
+    nodes << "  m" << i << "  " << macro_width << "  " << macro_height
+          << "  terminal\n";
+  }
+
+  // nets, a pin is written as (node name, width, is_output)
+  int net_count = cell_count;
+  std::uniform_int_distribution<int> degree_dist(2, 5);
+  std::uniform_int_distribution<int> cell_dist(0, cell_count - 1);
+  std::uniform_int_distribution<int> neighbor_dist(-30, 30);
+  std::uniform_int_distribution<int> macro_dist(0, 19);
+  std::vector<std::vector<std::pair<std::string, int>>> net_pins(net_count);
+  int pin_count = 0;
+  for (int i = 0; i < net_count; ++i) {
+    int driver = i % cell_count;
+    int degree = degree_dist(rng);
+    net_pins[i].emplace_back("o" + std::to_string(driver), widths[driver]);
+    for (int j = 1; j < degree; ++j) {
+      int id = driver + neighbor_dist(rng);
+      if (j == 1 && macro_dist(rng) == 0) {
+        int macro_id = i % macro_count;
+        net_pins[i].emplace_back("m" + std::to_string(macro_id), macro_width);
+        continue;
+      }
+      if (id < 0 || id >= cell_count) id = cell_dist(rng);
+      net_pins[i].emplace_back("o" + std::to_string(id), widths[id]);
+    }
+    pin_count += static_cast<int>(net_pins[i].size());
+  }
+  std::ofstream nets(name + ".nets");
+  nets << "UCLA nets 1.0\n\n"
+       << "NumNets : " << net_count << "\n"
+       << "NumPins : " << pin_count << "\n\n";
+  std::uniform_int_distribution<int> offset_y_dist(-4, 4);
+  for (int i = 0; i < net_count; ++i) {
+    nets << "NetDegree : " << net_pins[i].size() << "   n" << i << "\n";
+    for (size_t j = 0; j < net_pins[i].size(); ++j) {
+      int width = net_pins[i][j].second;
+      std::uniform_int_distribution<int> offset_x_dist(-width, width);
+      nets << "  " << net_pins[i][j].first << "  " << (j == 0 ? "O" : "I")
+           << " : " << offset_x_dist(rng) / 2.0 << " "
+           << offset_y_dist(rng) / 2.0 << "\n";
+    }
+  }
+
+  std::ofstream wts(name + ".wts");
+  wts << "UCLA wts 1.0\n\n";
+  for (int i = 0; i < net_count; i += 7) {
+    wts << "  n" << i << "  2\n";
+  }
+
+  std::ofstream pl(name + ".pl");
+  pl << "UCLA pl 1.0\n\n";
+  for (int i = 0; i < cell_count; ++i) {
+    pl << "o" << i << "  0  0  : N\n";
+  }
+  for (int i = 0; i < macro_count; ++i) {
+    int x = (i % 2 == 0) ? site_count / 4 : site_count * 3 / 4;
+    int row = (i / 2 == 0) ? row_count / 4 : row_count - row_count / 4 - 3;
+    pl << "m" << i << "  " << x << "  " << row * row_height
+       << "  : N /FIXED\n";
+  }
+
+  return name + ".aux";
+}
+
+/****
+ * @brief Run a short global placement on a circuit loaded from a benchmark
+ * written by WriteBookshelfBenchmark()
+ *
+ * Tests of legalizers take over the returned placer, so that all of them
+ * start from the same kind of global placement result.
+ *
+ * @param circuit: the circuit to be placed
+ * @param num_threads: number of threads of the global placer
+ * @param solver_type: linear solver backend of the global placer
+ * @return the global placer, which legalizers can take over
+ */
+std::unique_ptr<GlobalPlacer> GlobalPlace(
+    Circuit &circuit,
+    int num_threads,
+    LinearSolverType solver_type
+) {
+  auto gb_placer = std::make_unique<GlobalPlacer>();
+  gb_placer->SetInputCircuit(&circuit);
+  gb_placer->SetMaxIteration(30);
+  gb_placer->SetPlacementDensity(0.7);
+  gb_placer->SetLinearSolverType(solver_type);
+  gb_placer->SetNumThreads(num_threads);
+  gb_placer->StartPlacement();
+  return gb_placer;
+}
+
+/****
+ * @brief Add N/P-well layers and a well tap cell to a circuit loaded from a
+ * benchmark written by WriteBookshelfBenchmark()
+ *
+ * Bookshelf types have a P-well in the bottom half and an N-well in the top
+ * half. The well tap cell has the same well shape and the same height as
+ * standard cells, so that well legalizers can run on the circuit.
+ *
+ * @param circuit: the circuit loaded from the Bookshelf benchmark
+ */
+void AddBookshelfWellTapCell(Circuit &circuit) {
+  circuit.SetNwellParams(2, 2, 2, 60, 0);
+  circuit.SetPwellParams(2, 2, 2, 60, 0);
+  circuit.AddWellTapBlockType("WELLTAP", 2, 12);
+  circuit.AddBlockTypeWell("WELLTAP");
+  circuit.SetWellRect("WELLTAP", false, 0, 0, 2, 6);
+  circuit.SetWellRect("WELLTAP", true, 0, 6, 2, 12);
+}
+
+/****
+ * @brief Give double-height types of a circuit loaded from a benchmark written
+ * by WriteBookshelfBenchmark() two well regions
+ *
+ * The Bookshelf reader gives each type one P-well in the bottom half and one
+ * N-well in the top half. A double-height type gets P/N wells in the bottom
+ * row and N/P wells in the top row instead, like a multi-deck cell, so that
+ * it spans two gridded rows.
+ *
+ * @param circuit: the circuit loaded from the Bookshelf benchmark
+ */
+void SplitDoubleHeightWells(Circuit &circuit) {
+  int row_height = circuit.RowHeightGridUnit();
+  std::unordered_set<BlockType *> types;
+  for (auto &blk : circuit.Blocks()) {
+    BlockType *type_ptr = blk.TypePtr();
+    if (!blk.IsMovable() || type_ptr->Height() != 2 * row_height) continue;
+    types.insert(type_ptr);
+  }
+  int half_row = row_height / 2;
+  for (BlockType *type_ptr : types) {
+    BlockTypeWell *well_ptr = type_ptr->WellPtr();
+    if (well_ptr->RegionCount() != 1) continue;
+    int width = type_ptr->Width();
+    well_ptr->PwellRect(0).SetValue(0, 0, width, half_row);
+    well_ptr->NwellRect(0).SetValue(0, half_row, width, row_height);
+    well_ptr->AddNwellRect(0, row_height, width, row_height + half_row);
+    well_ptr->AddPwellRect(0, row_height + half_row, width, 2 * row_height);
+    well_ptr->CheckLegality();
+  }
+}
+
+/****
+ * @brief Check if blocks in a row-based placement are legal
+ *
+ * A placement is legal if every movable block is on the placement grid, in
+ * the placement region, and aligned to a row, and no two blocks overlap.
+ *
+ * @param circuit: the circuit to be checked
+ * @return true if this placement is legal, otherwise, false
+ */
+bool IsRowPlacementLegal(Circuit &circuit) {
+  int row_height = circuit.RowHeightGridUnit();
+  int bottom = circuit.RegionLLY();
+  int row_count = circuit.RegionHeight() / row_height;
+  std::vector<std::vector<std::pair<double, double>>> rows(row_count);
+  bool res = true;
+  for (auto &blk : circuit.Blocks()) {
+    if (blk.IsMovable()) {
+      bool is_on_grid = std::fabs(blk.LLX() - std::round(blk.LLX())) < 1e-6
+          && std::fabs(blk.LLY() - std::round(blk.LLY())) < 1e-6;
+      bool is_in_region = blk.LLX() >= circuit.RegionLLX()
+          && blk.URX() <= circuit.RegionURX()
+          && blk.LLY() >= circuit.RegionLLY()
+          && blk.URY() <= circuit.RegionURY();
+      bool is_on_row =
+          (static_cast<int>(std::round(blk.LLY())) - bottom) % row_height == 0;
+      if (!is_on_grid || !is_in_region || !is_on_row) {
+        BOOST_LOG_TRIVIAL(info)
+          << "block " << blk.Name() << " at (" << blk.LLX() << ", "
+          << blk.LLY() << ") is not on the grid, a row, or the region\n";
+        res = false;
+        continue;
+      }
+    }
+    int lo_row = std::max(
+        0, static_cast<int>(std::floor((blk.LLY() - bottom) / row_height))
+    );
+    int hi_row = std::min(
+        row_count - 1,
+        static_cast<int>(std::ceil((blk.URY() - bottom) / row_height)) - 1
+    );
+    for (int row = lo_row; row <= hi_row; ++row) {
+      rows[row].emplace_back(blk.LLX(), blk.URX());
+    }
+  }
+  for (int row = 0; row < row_count; ++row) {
+    auto &segments = rows[row];
+    std::sort(segments.begin(), segments.end());
+    for (size_t i = 1; i < segments.size(); ++i) {
+      if (segments[i].first < segments[i - 1].second - 1e-6) {
+        BOOST_LOG_TRIVIAL(info)
+          << "blocks overlap in row " << row << ": ["
+          << segments[i - 1].first << ", " << segments[i - 1].second
+          << ") and [" << segments[i].first << ", " << segments[i].second
+          << ")\n";
+        res = false;
+      }
+    }
+  }
+
+  BOOST_LOG_TRIVIAL(info) << "Is the row-based placement legal? ";
+  if (res) {
+    BOOST_LOG_TRIVIAL(info) << "Yes\n";
+  } else {
+    BOOST_LOG_TRIVIAL(info) << "No\n";
+  }
+  return res;
+}
+
+/****
+ * @brief Save the lower left corner of every block
+ *
+ * @param circuit: the circuit whose block locations are saved
+ * @return the lower left corners, indexed by block id
+ */
+std::vector<double2d> SaveBlockLocations(Circuit &circuit) {
+  std::vector<double2d> locations;
+  locations.reserve(circuit.Blocks().size());
+  for (auto &blk : circuit.Blocks()) {
+    locations.emplace_back(blk.LLX(), blk.LLY());
+  }
+  return locations;
+}
+
+/****
+ * @brief Compute the total Manhattan displacement of movable blocks from the
+ * locations saved by SaveBlockLocations()
+ *
+ * @param circuit: the circuit after legalization
+ * @param locations: block locations before legalization
+ * @return the total displacement
+ */
+double TotalDisplacement(
+    Circuit &circuit,
+    std::vector<double2d> const &locations
+) {
+  double displacement = 0;
+  auto &blocks = circuit.Blocks();
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    if (blocks[i].IsFixed()) continue;
+    displacement += std::fabs(blocks[i].LLX() - locations[i].x)
+        + std::fabs(blocks[i].LLY() - locations[i].y);
+  }
+  return displacement;
+}
+
+/****
+ * @brief Check if blocks with the same index in two circuits have exactly the
+ * same locations, orientations, and placement status
+ *
+ * @param is_orient_checked: false if orientations are not compared, e.g., a
+ * .pl file saved by Dali does not keep orientations
+ */
+bool IsSameBlockLocation(
+    Circuit &circuit0,
+    Circuit &circuit1,
+    bool is_orient_checked
+) {
+  auto &blocks0 = circuit0.Blocks();
+  auto &blocks1 = circuit1.Blocks();
+  if (blocks0.size() != blocks1.size()) {
+    BOOST_LOG_TRIVIAL(info)
+      << "different number of blocks: " << blocks0.size() << " vs "
+      << blocks1.size() << "\n";
+    return false;
+  }
+  for (size_t i = 0; i < blocks0.size(); ++i) {
+    Block &blk0 = blocks0[i];
+    Block &blk1 = blocks1[i];
+    if (blk0.LLX() != blk1.LLX() || blk0.LLY() != blk1.LLY()
+        || (is_orient_checked && blk0.Orient() != blk1.Orient())
+        || blk0.Status() != blk1.Status()) {
+      BOOST_LOG_TRIVIAL(info)
+        << "block " << blk0.Name() << " is different: ("
+        << blk0.LLX() << ", " << blk0.LLY() << ", "
+        << OrientStr(blk0.Orient()) << ", " << blk0.StatusStr() << ") vs ("
+        << blk1.LLX() << ", " << blk1.LLY() << ", "
+        << OrientStr(blk1.Orient()) << ", " << blk1.StatusStr() << ")\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+/****
+ * @brief Check if well tap cells of two circuits have the same names and
+ * locations
+ *
+ * @param circuit0: the first circuit
+ * @param circuit1: the second circuit
+ * @return true if all well tap cells are the same, otherwise, false
+ */
+bool IsSameWellTapLocation(Circuit &circuit0, Circuit &circuit1) {
+  auto &taps0 = circuit0.design().WellTaps();
+  auto &taps1 = circuit1.design().WellTaps();
+  if (taps0.size() != taps1.size()) {
+    BOOST_LOG_TRIVIAL(info)
+      << "different number of well tap cells: " << taps0.size() << " vs "
+      << taps1.size() << "\n";
+    return false;
+  }
+  for (size_t i = 0; i < taps0.size(); ++i) {
+    if (taps0[i].Name() != taps1[i].Name()
+        || taps0[i].LLX() != taps1[i].LLX()
+        || taps0[i].LLY() != taps1[i].LLY()
+        || taps0[i].Orient() != taps1[i].Orient()) {
+      BOOST_LOG_TRIVIAL(info)
+        << "well tap cell " << taps0[i].Name() << " is different: ("
+        << taps0[i].LLX() << ", " << taps0[i].LLY() << ") vs "
+        << taps1[i].Name() << " (" << taps1[i].LLX() << ", "
+        << taps1[i].LLY() << ")\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+/****
+ * @brief Check if two values are exactly the same, and report them if not
+ */
+bool IsSameValue(double value0, double value1, std::string const &name) {
+  if (value0 != value1) {
+    BOOST_LOG_TRIVIAL(info)
+      << "different " << name << ": " << value0 << " vs " << value1 << "\n";
+    return false;
+  }
+  return true;
+}
+
+}
@@ -0,0 +1,61 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#ifndef DALI_TESTS_CIRCUIT_HELPER_H
+#define DALI_TESTS_CIRCUIT_HELPER_H
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "dali/circuit/circuit.h"
+#include "dali/placer/global_placer/global_placer.h"
+
+namespace dali {
+
+std::string WriteBookshelfBenchmark(
+    std::string const &name,
+    int cell_count,
+    unsigned int seed,
+    int double_height_interval = 0
+);
+std::unique_ptr<GlobalPlacer> GlobalPlace(
+    Circuit &circuit,
+    int num_threads = 1,
+    LinearSolverType solver_type = LinearSolverType::DIAGONAL
+);
+void AddBookshelfWellTapCell(Circuit &circuit);
+void SplitDoubleHeightWells(Circuit &circuit);
+bool IsRowPlacementLegal(Circuit &circuit);
+std::vector<double2d> SaveBlockLocations(Circuit &circuit);
+double TotalDisplacement(
+    Circuit &circuit,
+    std::vector<double2d> const &locations
+);
+bool IsSameBlockLocation(
+    Circuit &circuit0,
+    Circuit &circuit1,
+    bool is_orient_checked = true
+);
+bool IsSameWellTapLocation(Circuit &circuit0, Circuit &circuit1);
+bool IsSameValue(double value0, double value1, std::string const &name);
+
+}
+
+#endif //DALI_TESTS_CIRCUIT_HELPER_H
@@ -0,0 +1,138 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <cmath>
+
+#include <random>
+#include <vector>
+
+#include "dali/circuit/circuit.h"
+#include "dali/circuit/incremental_hpwl.h"
+#include "dali/common/logging.h"
+#include "helper.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+/****
+ * @brief Move a fraction of movable blocks to random locations in the
+ * placement region.
+ */
+void MoveBlocksRandomly(Circuit &circuit, double fraction, std::mt19937 &rng) {
+  std::uniform_real_distribution<double> rate_dist(0, 1);
+  std::uniform_real_distribution<double> x_dist(
+      circuit.RegionLLX(), circuit.RegionURX()
+  );
+  std::uniform_real_distribution<double> y_dist(
+      circuit.RegionLLY(), circuit.RegionURY()
+  );
+  for (auto &blk : circuit.Blocks()) {
+    if (blk.IsMovable() && rate_dist(rng) < fraction) {
+      blk.SetLLX(x_dist(rng));
+      blk.SetLLY(y_dist(rng));
+    }
+  }
+}
+
+bool IsCloseEnough(double value, double reference, std::string const &name) {
+  if (std::fabs(value - reference) > 1e-9 * std::fabs(reference)) {
+    BOOST_LOG_TRIVIAL(info)
+      << "inaccurate " << name << ": " << value
+      << ", reference: " << reference << "\n";
+    return false;
+  }
+  return true;
+}
+
+/****
+ * @brief Evaluate HPWL by IncrementalHpwl with zero thresholds using 1, 2, and
+ * 8 threads, and compare results with a fresh evaluation and with
+ * Circuit::WeightedHPWLX/Y().
+ *
+ * @return true if all results are the same as the fresh evaluation, and close
+ * to Circuit::WeightedHPWLX/Y()
+ */
+bool IsIncrementalHpwlCorrect(
+    Circuit &circuit,
+    std::vector<IncrementalHpwl> &evaluators
+) {
+  IncrementalHpwl fresh_evaluator;
+  fresh_evaluator.Initialize(&circuit);
+  double fresh_hpwl_x = fresh_evaluator.WeightedHPWLX();
+  double fresh_hpwl_y = fresh_evaluator.WeightedHPWLY();
+  bool is_correct = IsCloseEnough(fresh_hpwl_x, circuit.WeightedHPWLX(), "HPWLX")
+      && IsCloseEnough(fresh_hpwl_y, circuit.WeightedHPWLY(), "HPWLY");
+
+  std::vector<int> thread_counts = {1, 2, 8};
+  for (size_t i = 0; i < evaluators.size(); ++i) {
+    int num_threads = thread_counts[i];
+    is_correct = is_correct
+        && IsSameValue(
+            evaluators[i].WeightedHPWLX(num_threads), fresh_hpwl_x, "HPWLX"
+        )
+        && IsSameValue(
+            evaluators[i].WeightedHPWLY(num_threads), fresh_hpwl_y, "HPWLY"
+        );
+  }
+  return is_correct;
+}
+
+/****
+ * @brief Testcase for IncrementalHpwl.
+ *
+ * With zero thresholds, IncrementalHpwl is supposed to give the same result
+ * no matter how many threads are used and which nets are recomputed. This
+ * testcase places blocks randomly, then moves a few blocks several times, and
+ * shows that after each move
+ * 1. incremental evaluations using 1, 2, and 8 threads are bit-identical to
+ * a fresh evaluation
+ * 2. the result is the same as Circuit::WeightedHPWLX/Y() up to rounding
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  std::string aux_file_name =
+      WriteBookshelfBenchmark("incremental_hpwl", 10000, 3);
+  Circuit circuit;
+  circuit.LoadBookshelf(aux_file_name);
+  circuit.UpdatePinTable();
+
+  std::mt19937 rng(3);
+  MoveBlocksRandomly(circuit, 1.0, rng);
+  std::vector<IncrementalHpwl> evaluators(3);
+  for (auto &evaluator : evaluators) {
+    evaluator.Initialize(&circuit);
+    evaluator.SetMoveThresholds(0, 0);
+  }
+
+  bool is_correct = IsIncrementalHpwlCorrect(circuit, evaluators);
+  for (double fraction : {0.01, 0.05, 0.3}) {
+    MoveBlocksRandomly(circuit, fraction, rng);
+    is_correct = is_correct && IsIncrementalHpwlCorrect(circuit, evaluators);
+  }
+
+  if (is_correct) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
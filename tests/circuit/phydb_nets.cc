@@ -0,0 +1,119 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <phydb/phydb.h>
+
+#include "dali/circuit/circuit.h"
+#include "dali/common/logging.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+/****
+ * @brief Check if block pins of every net and nets of every block are the same
+ * as adding pins one by one using names of components and macro pins in PhyDB.
+ */
+bool IsEveryNetSameAsNameBasedPath(Circuit &circuit, phydb::PhyDB &phy_db) {
+  auto &components = phy_db.design().GetComponentsRef();
+  for (auto &phydb_net : phy_db.design().GetNetsRef()) {
+    std::string net_name(phydb_net.GetName());
+    Net *net = circuit.GetNetPtr(net_name);
+    auto &phydb_pins = phydb_net.GetPinsRef();
+    auto &blk_pins = net->BlockPins();
+    if (phydb_pins.size() != blk_pins.size()) {
+      BOOST_LOG_TRIVIAL(info)
+        << "net " << net_name << " has " << blk_pins.size()
+        << " block pins, expecting " << phydb_pins.size() << "\n";
+      return false;
+    }
+    for (size_t i = 0; i < phydb_pins.size(); ++i) {
+      auto &comp = components[phydb_pins[i].InstanceId()];
+      std::string comp_name(comp.GetName());
+      std::string pin_name(
+          comp.GetMacro()->GetPinsRef()[phydb_pins[i].PinId()].GetName()
+      );
+      if (blk_pins[i].BlkPtr()->Name() != comp_name
+          || blk_pins[i].PinPtr()->Name() != pin_name) {
+        BOOST_LOG_TRIVIAL(info)
+          << "net " << net_name << ", pin " << i << " is "
+          << blk_pins[i].BlkPtr()->Name() << " "
+          << blk_pins[i].PinPtr()->Name() << ", expecting "
+          << comp_name << " " << pin_name << "\n";
+        return false;
+      }
+    }
+  }
+
+  // adding pins one by one appends nets to blocks in the order of nets
+  auto &blocks = circuit.Blocks();
+  std::vector<std::vector<int>> blk_net_lists(blocks.size());
+  for (auto &net : circuit.Nets()) {
+    for (auto &blk_pin : net.BlockPins()) {
+      blk_net_lists[blk_pin.BlkId()].push_back(net.Id());
+    }
+  }
+  for (size_t i = 0; i < blocks.size(); ++i) {
+    if (blocks[i].NetList() != blk_net_lists[i]) {
+      BOOST_LOG_TRIVIAL(info)
+        << "net list of block " << blocks[i].Name() << " is different\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+/****
+ * @brief Testcase for loading nets from PhyDB by indices.
+ *
+ * Blocks and pins of BlockTypes are created in the same order as components
+ * and macro pins in PhyDB, so nets are loaded by indices instead of names.
+ * This testcase shows that with 1 and 8 threads, block pins of every net and
+ * nets of every block are the same as loading nets by names.
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  std::string lef_file_name = "ispd19_test3.input.lef";
+  std::string def_file_name = "ispd19_test3.input.def";
+
+  phydb::PhyDB phy_db;
+  phy_db.ReadLef(lef_file_name);
+  phy_db.ReadDef(def_file_name);
+
+  bool is_passed = true;
+  for (int num_threads : {1, 8}) {
+    Circuit circuit;
+    circuit.SetNumThreads(num_threads);
+    circuit.InitializeFromPhyDB(&phy_db);
+    if (!IsEveryNetSameAsNameBasedPath(circuit, phy_db)) {
+      BOOST_LOG_TRIVIAL(info)
+        << "nets loaded with " << num_threads << " threads are different\n";
+      is_passed = false;
+    }
+  }
+
+  if (is_passed) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
@@ -0,0 +1,127 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <random>
+#include <vector>
+
+#include <omp.h>
+
+#include "dali/circuit/circuit.h"
+#include "dali/common/logging.h"
+#include "helper.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+/****
+ * @brief Returns HPWL evaluated net by net through Block and Pin pointers.
+ */
+double NetByNetHpwl(Circuit &circuit) {
+  double hpwl_x = 0;
+  double hpwl_y = 0;
+  for (auto &net : circuit.Nets()) {
+    hpwl_x += net.WeightedHPWLX();
+    hpwl_y += net.WeightedHPWLY();
+  }
+  return hpwl_x * circuit.GridValueX() + hpwl_y * circuit.GridValueY();
+}
+
+/****
+ * @brief Evaluate HPWL by 8 threads at the same time.
+ *
+ * @return true if all threads get the expected value
+ */
+bool IsConcurrentHpwlSame(Circuit &circuit, double expected_hpwl) {
+  int num_threads = 8;
+  std::vector<double> hpwls(num_threads, 0);
+#pragma omp parallel for num_threads(num_threads)
+  for (int i = 0; i < num_threads; ++i) {
+    hpwls[i] = circuit.WeightedHPWL();
+  }
+  bool is_same = true;
+  for (auto hpwl : hpwls) {
+    is_same = is_same && IsSameValue(hpwl, expected_hpwl, "concurrent HPWL");
+  }
+  return is_same;
+}
+
+/****
+ * @brief Testcase for the flattened pin table of a Circuit.
+ *
+ * Circuit::WeightedHPWL() is supposed to be read-only, and to give the right
+ * value whether the pin table is up to date or not. This testcase flips some
+ * blocks after the pin table is built, and shows that
+ * 1. the pin table is detected as stale
+ * 2. HPWL from the stale table and from the refreshed table are both the
+ * same as HPWL evaluated net by net
+ * 3. HPWL evaluated by multiple threads at the same time is the same
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  std::string aux_file_name =
+      WriteBookshelfBenchmark("pin_table", 2000, 4);
+  Circuit circuit;
+  circuit.LoadBookshelf(aux_file_name);
+  circuit.UpdatePinTable();
+
+  std::mt19937 rng(4);
+  std::uniform_real_distribution<double> x_dist(
+      circuit.RegionLLX(), circuit.RegionURX()
+  );
+  std::uniform_real_distribution<double> y_dist(
+      circuit.RegionLLY(), circuit.RegionURY()
+  );
+  std::uniform_int_distribution<int> flip_dist(0, 1);
+  for (auto &blk : circuit.Blocks()) {
+    if (blk.IsMovable()) {
+      blk.SetLoc(x_dist(rng), y_dist(rng));
+      if (flip_dist(rng) == 1) {
+        blk.SetOrient(FS);
+      }
+    }
+  }
+
+  bool is_stale = !circuit.PinTable().IsUpToDate();
+  if (!is_stale) {
+    BOOST_LOG_TRIVIAL(info) << "flipped blocks are not detected\n";
+  }
+  double expected_hpwl = NetByNetHpwl(circuit);
+  bool is_stale_hpwl_same =
+      IsSameValue(circuit.WeightedHPWL(), expected_hpwl, "stale table HPWL")
+          && IsConcurrentHpwlSame(circuit, expected_hpwl);
+
+  circuit.UpdatePinTable();
+  bool is_refreshed = circuit.PinTable().IsUpToDate();
+  if (!is_refreshed) {
+    BOOST_LOG_TRIVIAL(info) << "pin table is not refreshed\n";
+  }
+  bool is_refreshed_hpwl_same =
+      IsSameValue(circuit.WeightedHPWL(), expected_hpwl, "refreshed table HPWL")
+          && IsConcurrentHpwlSame(circuit, expected_hpwl);
+
+  if (is_stale && is_stale_hpwl_same && is_refreshed && is_refreshed_hpwl_same) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
@@ -0,0 +1,147 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <memory>
+
+#include "dali/circuit/circuit.h"
+#include "dali/common/logging.h"
+#include "dali/placer.h"
+#include "helper.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+/****
+ * @brief Check if two circuits have the same placement region, the same
+ * BlockTypes of blocks, the same nets, and the same net lists of blocks.
+ */
+bool IsSameNetlist(Circuit &circuit0, Circuit &circuit1) {
+  if (circuit0.RegionLLX() != circuit1.RegionLLX()
+      || circuit0.RegionLLY() != circuit1.RegionLLY()
+      || circuit0.RegionURX() != circuit1.RegionURX()
+      || circuit0.RegionURY() != circuit1.RegionURY()) {
+    BOOST_LOG_TRIVIAL(info) << "different placement regions\n";
+    return false;
+  }
+
+  auto &blocks0 = circuit0.Blocks();
+  auto &blocks1 = circuit1.Blocks();
+  for (size_t i = 0; i < blocks0.size(); ++i) {
+    BlockType *type0 = blocks0[i].TypePtr();
+    BlockType *type1 = blocks1[i].TypePtr();
+    if (blocks0[i].Name() != blocks1[i].Name()
+        || type0->Name() != type1->Name()
+        || type0->Width() != type1->Width()
+        || type0->Height() != type1->Height()
+        || type0->PinList().size() != type1->PinList().size()
+        || blocks0[i].NetList() != blocks1[i].NetList()) {
+      BOOST_LOG_TRIVIAL(info)
+        << "block " << blocks0[i].Name() << " is different\n";
+      return false;
+    }
+  }
+
+  auto &nets0 = circuit0.Nets();
+  auto &nets1 = circuit1.Nets();
+  if (nets0.size() != nets1.size()) {
+    BOOST_LOG_TRIVIAL(info)
+      << "different number of nets: " << nets0.size() << " vs "
+      << nets1.size() << "\n";
+    return false;
+  }
+  for (size_t i = 0; i < nets0.size(); ++i) {
+    auto &pins0 = nets0[i].BlockPins();
+    auto &pins1 = nets1[i].BlockPins();
+    bool is_same = nets0[i].Name() == nets1[i].Name()
+        && nets0[i].Weight() == nets1[i].Weight()
+        && pins0.size() == pins1.size();
+    for (size_t j = 0; is_same && j < pins0.size(); ++j) {
+      is_same = pins0[j].BlkId() == pins1[j].BlkId()
+          && pins0[j].PinPtr()->Name() == pins1[j].PinPtr()->Name()
+          && pins0[j].AbsX() == pins1[j].AbsX()
+          && pins0[j].AbsY() == pins1[j].AbsY();
+    }
+    if (!is_same) {
+      BOOST_LOG_TRIVIAL(info) << "net " << nets0[i].Name() << " is different\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+/****
+ * @brief Testcase for the binary snapshot format: Circuit::SaveSnapshot() and
+ * Circuit::LoadSnapshot().
+ *
+ * This testcase legalizes a Bookshelf benchmark, so some blocks are flipped,
+ * and saves a snapshot. It shows that
+ * 1. loading the snapshot into an empty circuit reproduces blocks, BlockTypes,
+ *    nets, net lists of blocks, and HPWL
+ * 2. loading the snapshot into a circuit with the same netlist but without
+ *    placement restores locations, orientations, statuses, and HPWL
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  std::string aux_file_name =
+      WriteBookshelfBenchmark("snapshot_round_trip", 1000, 5);
+
+  Circuit circuit;
+  circuit.LoadBookshelf(aux_file_name);
+  auto gb_placer = std::make_unique<GlobalPlacer>();
+  gb_placer->SetInputCircuit(&circuit);
+  gb_placer->SetMaxIteration(30);
+  gb_placer->SetPlacementDensity(0.7);
+  gb_placer->StartPlacement();
+  auto legalizer = std::make_unique<LGTetrisEx>();
+  legalizer->TakeOver(gb_placer.get());
+  legalizer->StartPlacement();
+
+  std::string snapshot_file_name = "snapshot_round_trip.snapshot";
+  circuit.SaveSnapshot(snapshot_file_name);
+
+  Circuit circuit_full;
+  circuit_full.LoadSnapshot(snapshot_file_name);
+  bool is_full_same = IsSameBlockLocation(circuit, circuit_full)
+      && IsSameNetlist(circuit, circuit_full)
+      && IsSameValue(circuit.WeightedHPWL(), circuit_full.WeightedHPWL(), "HPWL");
+  if (!is_full_same) {
+    BOOST_LOG_TRIVIAL(info) << "loading into an empty circuit fails\n";
+  }
+
+  Circuit circuit_placement;
+  circuit_placement.LoadBookshelf(aux_file_name);
+  circuit_placement.LoadSnapshot(snapshot_file_name);
+  bool is_placement_same = IsSameBlockLocation(circuit, circuit_placement)
+      && IsSameValue(
+          circuit.WeightedHPWL(), circuit_placement.WeightedHPWL(), "HPWL"
+      );
+  if (!is_placement_same) {
+    BOOST_LOG_TRIVIAL(info) << "restoring placement fails\n";
+  }
+
+  if (is_full_same && is_placement_same) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
@@ -0,0 +1,115 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <memory>
+#include <vector>
+
+#include "dali/circuit/circuit.h"
+#include "dali/common/logging.h"
+#include "dali/placer.h"
+#include "../circuit/helper.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+/****
+ * @brief Legalize a global placement result using AbacusLegalizer, or
+ * LGTetrisEx if @param is_abacus is false
+ *
+ * @return the total displacement from the global placement result
+ */
+double LoadPlaceAndLegalize(
+    Circuit &circuit,
+    std::string const &aux_file_name,
+    bool is_abacus,
+    int num_threads
+) {
+  circuit.LoadBookshelf(aux_file_name);
+  auto gb_placer = GlobalPlace(circuit);
+  std::vector<double2d> gp_locations = SaveBlockLocations(circuit);
+
+  std::unique_ptr<LGTetrisEx> legalizer;
+  if (is_abacus) {
+    legalizer = std::make_unique<AbacusLegalizer>();
+  } else {
+    legalizer = std::make_unique<LGTetrisEx>();
+  }
+  legalizer->TakeOver(gb_placer.get());
+  legalizer->SetNumThreads(num_threads);
+  legalizer->StartPlacement();
+  return TotalDisplacement(circuit, gp_locations);
+}
+
+/****
+ * @brief Testcase for AbacusLegalizer::StartPlacement().
+ *
+ * The benchmark has fixed macros, which split rows into several white space
+ * segments, and one in twenty cells is two rows high. This testcase shows
+ * that
+ * 1. the placement is legal
+ * 2. the total displacement is smaller than the total displacement of
+ *    LGTetrisEx on the same global placement result
+ * 3. legalization with 2 and 8 threads gives identical block locations as
+ *    legalization with 1 thread
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  std::string aux_file_name =
+      WriteBookshelfBenchmark("abacus_legalization", 2000, 5, 20);
+
+  bool is_passed = true;
+  Circuit circuit_tetris;
+  double tetris_displacement =
+      LoadPlaceAndLegalize(circuit_tetris, aux_file_name, false, 1);
+  Circuit circuit_serial;
+  double abacus_displacement =
+      LoadPlaceAndLegalize(circuit_serial, aux_file_name, true, 1);
+  BOOST_LOG_TRIVIAL(info)
+    << "total displacement, Abacus: " << abacus_displacement
+    << ", Tetris: " << tetris_displacement << "\n";
+  if (!IsRowPlacementLegal(circuit_serial)) {
+    BOOST_LOG_TRIVIAL(info) << "Abacus placement is illegal\n";
+    is_passed = false;
+  }
+  if (abacus_displacement >= tetris_displacement) {
+    BOOST_LOG_TRIVIAL(info)
+      << "Abacus displacement is not smaller than Tetris displacement\n";
+    is_passed = false;
+  }
+  for (int num_threads : {2, 8}) {
+    Circuit circuit;
+    LoadPlaceAndLegalize(circuit, aux_file_name, true, num_threads);
+    if (!IsSameBlockLocation(circuit_serial, circuit)) {
+      BOOST_LOG_TRIVIAL(info)
+        << "Abacus legalization with " << num_threads
+        << " threads is different from the serial one\n";
+      is_passed = false;
+    }
+  }
+
+  if (is_passed) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
@@ -0,0 +1,301 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <cmath>
+
+#include <algorithm>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "dali/circuit/circuit.h"
+#include "dali/common/logging.h"
+#include "dali/placer.h"
+#include "dali/placer/well_legalizer/lgblkaux.h"
+#include "../circuit/helper.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+std::unique_ptr<GriddedRowLegalizer> CreateLegalizer(
+    Circuit &circuit,
+    std::string const &aux_file_name
+) {
+  circuit.LoadBookshelf(aux_file_name);
+  AddBookshelfWellTapCell(circuit);
+  SplitDoubleHeightWells(circuit);
+  auto gb_placer = GlobalPlace(circuit);
+
+  auto multi_well_legalizer = std::make_unique<GriddedRowLegalizer>();
+  multi_well_legalizer->TakeOver(gb_placer.get());
+  multi_well_legalizer->SetWellTapCellParameters(true, false, -1, "");
+  multi_well_legalizer->SetMaxRowWidth(100);
+  multi_well_legalizer->SetPartitionMode(0);
+  return multi_well_legalizer;
+}
+
+/****
+ * @brief Run the steps of GriddedRowLegalizer::StartPlacement() before the
+ * displacement QP, so that blocks are assigned to rows, greedy locations are
+ * saved, and x locations are restored to the global placement result.
+ */
+bool PrepareQuadraticProgramming(GriddedRowLegalizer &legalizer) {
+  legalizer.CheckWellInfo();
+  legalizer.PartitionSpaceAndBlocks();
+  legalizer.PrecomputeWellTapCellLocation();
+  legalizer.InitializeBlockAuxiliaryInfo();
+  legalizer.SaveInitialLoc();
+  bool is_success = legalizer.UpwardDownwardLegalization();
+  legalizer.SaveUpDownLoc();
+  legalizer.RestoreInitialLocX();
+  return is_success;
+}
+
+/****
+ * @brief Solve the displacement QP of a stripe using Hildreth's method, i.e.,
+ * coordinate ascent on the dual problem.
+ *
+ * The objective has one term (x - x_init)^2 for each row a block spans, and
+ * adjacent blocks in a row keep their order in GriddedRow::BlkRegions(). The
+ * objective is separable, so each dual update is exact, and the solver stops
+ * when no dual variable changes by more than 1e-12.
+ *
+ * @return the solution, indexed by blocks in Stripe::blk_ptrs_vec_
+ */
+std::vector<double> SolveReferenceQP(Stripe &stripe) {
+  std::unordered_map<Block *, int> blk_ids;
+  std::vector<double> weights(stripe.blk_ptrs_vec_.size(), 0);
+  std::vector<double> locs(stripe.blk_ptrs_vec_.size(), 0);
+  for (size_t j = 0; j < stripe.blk_ptrs_vec_.size(); ++j) {
+    Block *blk_ptr = stripe.blk_ptrs_vec_[j];
+    blk_ids[blk_ptr] = static_cast<int>(j);
+    locs[j] = static_cast<LgBlkAux *>(blk_ptr->AuxPtr())->InitLoc().x;
+  }
+
+  // constraint x[next] - x[prev] >= width of prev
+  struct OrderConstraint {
+    int prev;
+    int next;
+    double width;
+  };
+  std::vector<OrderConstraint> constraints;
+  for (auto &row : stripe.gridded_rows_) {
+    auto &blk_regions = row.BlkRegions();
+    for (size_t i = 0; i < blk_regions.size(); ++i) {
+      weights[blk_ids[blk_regions[i].p_blk]] += 1;
+      if (i == 0) continue;
+      Block *prev_ptr = blk_regions[i - 1].p_blk;
+      constraints.push_back(
+          OrderConstraint{
+              blk_ids[prev_ptr],
+              blk_ids[blk_regions[i].p_blk],
+              static_cast<double>(prev_ptr->Width())
+          }
+      );
+    }
+  }
+
+  // x = x_init + D^-1 A^T lambda, where D = diag(2 * weights)
+  std::vector<double> lambdas(constraints.size(), 0);
+  double max_change = 1;
+  for (int sweep = 0; sweep < 10000000 && max_change > 1e-12; ++sweep) {
+    max_change = 0;
+    for (size_t j = 0; j < constraints.size(); ++j) {
+      auto &c = constraints[j];
+      double inv_prev = 0.5 / weights[c.prev];
+      double inv_next = 0.5 / weights[c.next];
+      double slack = locs[c.next] - locs[c.prev] - c.width;
+      double lambda = std::max(0.0, lambdas[j] - slack / (inv_prev + inv_next));
+      double change = lambda - lambdas[j];
+      lambdas[j] = lambda;
+      locs[c.next] += change * inv_next;
+      locs[c.prev] -= change * inv_prev;
+      max_change = std::max(max_change, std::fabs(change));
+    }
+  }
+  return locs;
+}
+
+/****
+ * @brief Check that adjacent blocks in each row do not overlap by more than
+ * a tolerance, and the distance between a block and its location in
+ * @param ref_locs is smaller than the tolerance.
+ */
+bool IsStripeCloseToReference(
+    Stripe &stripe,
+    std::vector<double> const &ref_locs,
+    double tolerance
+) {
+  for (auto &row : stripe.gridded_rows_) {
+    auto &blk_regions = row.BlkRegions();
+    for (size_t i = 1; i < blk_regions.size(); ++i) {
+      Block *prev_ptr = blk_regions[i - 1].p_blk;
+      Block *blk_ptr = blk_regions[i].p_blk;
+      if (blk_ptr->LLX() < prev_ptr->LLX() + prev_ptr->Width() - tolerance) {
+        BOOST_LOG_TRIVIAL(info)
+          << "block " << blk_ptr->Name() << " overlaps with "
+          << prev_ptr->Name() << "\n";
+        return false;
+      }
+    }
+  }
+  for (size_t j = 0; j < stripe.blk_ptrs_vec_.size(); ++j) {
+    Block *blk_ptr = stripe.blk_ptrs_vec_[j];
+    if (std::fabs(blk_ptr->LLX() - ref_locs[j]) > tolerance) {
+      BOOST_LOG_TRIVIAL(info)
+        << "block " << blk_ptr->Name() << " is at " << blk_ptr->LLX()
+        << ", reference QP solution: " << ref_locs[j] << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+/****
+ * @brief Run ADMM in every stripe and compare the result with the reference
+ * QP solution.
+ */
+bool IsAdmmSameAsReferenceQP(std::string const &aux_file_name) {
+  Circuit circuit;
+  auto legalizer = CreateLegalizer(circuit, aux_file_name);
+  if (!PrepareQuadraticProgramming(*legalizer)) return false;
+
+  size_t multi_row_blk_cnt = 0;
+  for (auto &col : legalizer->ColList()) {
+    for (auto &stripe : col.stripe_list_) {
+      if (!stripe.OptimizeDisplacementUsingAdmm(true)) {
+        BOOST_LOG_TRIVIAL(info) << "ADMM does not converge\n";
+        return false;
+      }
+      // ADMM sorts blocks in each row, the reference QP uses the same order
+      std::vector<double> ref_locs = SolveReferenceQP(stripe);
+      if (!IsStripeCloseToReference(stripe, ref_locs, 0.05)) {
+        return false;
+      }
+      for (Block *blk_ptr : stripe.blk_ptrs_vec_) {
+        auto aux_ptr = static_cast<LgBlkAux *>(blk_ptr->AuxPtr());
+        if (aux_ptr->SubLocs().size() > 1) ++multi_row_blk_cnt;
+      }
+    }
+  }
+  if (multi_row_blk_cnt == 0) {
+    BOOST_LOG_TRIVIAL(info) << "no block spans more than one row\n";
+    return false;
+  }
+  return true;
+}
+
+/****
+ * @brief Stop ADMM after one iteration, and check that it reports failure
+ * and puts blocks back at their greedy locations.
+ */
+bool IsStartLocationKeptWhenAdmmFails(std::string const &aux_file_name) {
+  Circuit circuit;
+  auto legalizer = CreateLegalizer(circuit, aux_file_name);
+  if (!PrepareQuadraticProgramming(*legalizer)) return false;
+
+  for (auto &col : legalizer->ColList()) {
+    for (auto &stripe : col.stripe_list_) {
+      if (stripe.OptimizeDisplacementUsingAdmm(true, 1)) {
+        BOOST_LOG_TRIVIAL(info) << "ADMM converges in one iteration\n";
+        return false;
+      }
+      for (Block *blk_ptr : stripe.blk_ptrs_vec_) {
+        auto aux_ptr = static_cast<LgBlkAux *>(blk_ptr->AuxPtr());
+        if (blk_ptr->LLX() != aux_ptr->GreedyLoc().x) {
+          BOOST_LOG_TRIVIAL(info)
+            << "block " << blk_ptr->Name()
+            << " is not at its greedy location\n";
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+/****
+ * @brief Legalize using the quadratic programming flow of
+ * GriddedRowLegalizer::StartPlacement().
+ *
+ * @return true if the final placement is legal
+ */
+bool LegalizeUsingQuadraticProgramming(
+    Circuit &circuit,
+    std::string const &aux_file_name,
+    int admm_max_iter
+) {
+  auto legalizer = CreateLegalizer(circuit, aux_file_name);
+  legalizer->SetUseCplex(true);
+  legalizer->SetUseAdmm(true);
+  legalizer->SetAdmmMaxIteration(admm_max_iter);
+  legalizer->StartPlacement();
+  return legalizer->IsPlacementLegal();
+}
+
+/****
+ * @brief Testcase for the built-in ADMM solver of the displacement QP:
+ * Stripe::OptimizeDisplacementUsingAdmm().
+ *
+ * One in ten cells is a two-deck cell, which has a copy in each of its rows.
+ * This testcase shows that
+ * 1. ADMM converges in every stripe, adjacent blocks in a row do not overlap,
+ *    and blocks are within 0.05 of the QP solution found by Hildreth's
+ *    method, where a k-row block has k objective terms as in the CPLEX model
+ * 2. if ADMM stops before it converges, it reports failure and blocks stay
+ *    at the greedy locations it starts from
+ * 3. the quadratic programming flow of the legalizer gives a legal placement,
+ *    and so does the consensus algorithm it falls back to when ADMM does not
+ *    converge
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  std::string aux_file_name =
+      WriteBookshelfBenchmark("admm_displacement", 500, 11, 10);
+
+  bool is_passed = true;
+  if (!IsAdmmSameAsReferenceQP(aux_file_name)) {
+    BOOST_LOG_TRIVIAL(info) << "ADMM result is not the QP solution\n";
+    is_passed = false;
+  }
+  if (!IsStartLocationKeptWhenAdmmFails(aux_file_name)) {
+    BOOST_LOG_TRIVIAL(info) << "ADMM failure is not handled\n";
+    is_passed = false;
+  }
+  for (int admm_max_iter : {1000, 1}) {
+    Circuit circuit;
+    if (!LegalizeUsingQuadraticProgramming(
+        circuit, aux_file_name, admm_max_iter)) {
+      BOOST_LOG_TRIVIAL(info)
+        << "placement is illegal when ADMM runs at most " << admm_max_iter
+        << " iterations\n";
+      is_passed = false;
+    }
+  }
+
+  if (is_passed) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
@@ -0,0 +1,114 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <memory>
+#include <vector>
+
+#include "dali/circuit/circuit.h"
+#include "dali/common/logging.h"
+#include "dali/placer.h"
+#include "../circuit/helper.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+/****
+ * @brief Legalize a global placement result using LGTetrisEx
+ *
+ * @return the total displacement from the global placement result
+ */
+double LoadPlaceAndLegalize(
+    Circuit &circuit,
+    std::string const &aux_file_name,
+    int num_bands,
+    int num_threads
+) {
+  circuit.LoadBookshelf(aux_file_name);
+  auto gb_placer = GlobalPlace(circuit);
+  std::vector<double2d> gp_locations = SaveBlockLocations(circuit);
+
+  auto legalizer = std::make_unique<LGTetrisEx>();
+  legalizer->TakeOver(gb_placer.get());
+  legalizer->SetNumBands(num_bands);
+  legalizer->SetNumThreads(num_threads);
+  legalizer->StartPlacement();
+  return TotalDisplacement(circuit, gp_locations);
+}
+
+/****
+ * @brief Testcase for band-parallel legalization: LGTetrisEx::SetNumBands().
+ *
+ * Bands are legalized concurrently, and each band estimates HPWL using the
+ * frozen locations before legalization, so the result is supposed to depend
+ * on the number of bands, but not on the number of threads. This testcase
+ * shows that for each number of bands
+ * 1. the placement is legal
+ * 2. the total displacement is at most 10% larger than the total
+ *    displacement of serial Tetris legalization, i.e., one band
+ * 3. legalization with 2 and 8 threads gives identical block locations as
+ *    legalization with 1 thread
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  std::string aux_file_name =
+      WriteBookshelfBenchmark("band_legalization", 2000, 3);
+
+  bool is_passed = true;
+  double tetris_displacement = 0;
+  for (int num_bands : {1, 4, 8}) {
+    Circuit circuit_serial;
+    double displacement =
+        LoadPlaceAndLegalize(circuit_serial, aux_file_name, num_bands, 1);
+    BOOST_LOG_TRIVIAL(info)
+      << num_bands << " bands, total displacement: " << displacement << "\n";
+    if (!IsRowPlacementLegal(circuit_serial)) {
+      BOOST_LOG_TRIVIAL(info)
+        << "placement with " << num_bands << " bands is illegal\n";
+      is_passed = false;
+    }
+    if (num_bands == 1) {
+      tetris_displacement = displacement;
+    } else if (displacement > 1.1 * tetris_displacement) {
+      BOOST_LOG_TRIVIAL(info)
+        << "displacement with " << num_bands << " bands is "
+        << displacement << ", serial Tetris: " << tetris_displacement << "\n";
+      is_passed = false;
+    }
+    for (int num_threads : {2, 8}) {
+      Circuit circuit;
+      LoadPlaceAndLegalize(circuit, aux_file_name, num_bands, num_threads);
+      if (!IsSameBlockLocation(circuit_serial, circuit)) {
+        BOOST_LOG_TRIVIAL(info)
+          << num_bands << " bands, legalization with " << num_threads
+          << " threads is different from the serial one\n";
+        is_passed = false;
+      }
+    }
+  }
+
+  if (is_passed) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
@@ -0,0 +1,84 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include "dali/circuit/circuit.h"
+#include "dali/common/logging.h"
+#include "../circuit/helper.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+/****
+ * @brief Testcase for linear solver backends of the global placer.
+ *
+ * The result of global placement is supposed to be independent of the number
+ * of threads. This testcase shows that for each linear solver backend
+ * 1. global placement with 2 and 8 threads gives bit-identical block
+ *    locations and HPWL as global placement with 1 thread
+ * 2. HPWL is at most 5% worse than the one given by the default diagonal
+ *    preconditioner
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  std::string aux_file_name =
+      WriteBookshelfBenchmark("global_placement_threads", 1000, 2);
+
+  bool is_identical = true;
+  double diagonal_hpwl = 0;
+  for (auto solver_type : {LinearSolverType::DIAGONAL, LinearSolverType::IC0,
+                           LinearSolverType::AMG, LinearSolverType::FUSED}) {
+    Circuit circuit_serial;
+    circuit_serial.LoadBookshelf(aux_file_name);
+    GlobalPlace(circuit_serial, 1, solver_type);
+    double hpwl = circuit_serial.WeightedHPWL();
+    BOOST_LOG_TRIVIAL(info)
+      << LinearSolverTypeStr(solver_type) << " solver, HPWL: " << hpwl << "\n";
+    if (solver_type == LinearSolverType::DIAGONAL) {
+      diagonal_hpwl = hpwl;
+    } else if (hpwl > 1.05 * diagonal_hpwl) {
+      BOOST_LOG_TRIVIAL(info)
+        << LinearSolverTypeStr(solver_type)
+        << " solver, HPWL is more than 5% worse than the diagonal solver\n";
+      is_identical = false;
+    }
+    for (int num_threads : {2, 8}) {
+      Circuit circuit;
+      circuit.LoadBookshelf(aux_file_name);
+      GlobalPlace(circuit, num_threads, solver_type);
+      bool is_same = IsSameBlockLocation(circuit_serial, circuit) &&
+          IsSameValue(circuit_serial.WeightedHPWL(), circuit.WeightedHPWL(), "HPWL");
+      if (!is_same) {
+        BOOST_LOG_TRIVIAL(info)
+          << LinearSolverTypeStr(solver_type) << " solver, placement with "
+          << num_threads << " threads is different from the serial one\n";
+      }
+      is_identical = is_identical && is_same;
+    }
+  }
+
+  if (is_identical) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
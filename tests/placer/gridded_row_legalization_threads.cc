@@ -0,0 +1,216 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <memory>
+
+#include "dali/circuit/circuit.h"
+#include "dali/common/logging.h"
+#include "dali/placer.h"
+#include "dali/placer/well_legalizer/lgblkaux.h"
+#include "../circuit/helper.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+std::unique_ptr<GriddedRowLegalizer> CreateLegalizer(
+    Circuit &circuit,
+    std::string const &aux_file_name,
+    int num_threads
+) {
+  circuit.LoadBookshelf(aux_file_name);
+  AddBookshelfWellTapCell(circuit);
+  SplitDoubleHeightWells(circuit);
+  auto gb_placer = GlobalPlace(circuit);
+
+  auto multi_well_legalizer = std::make_unique<GriddedRowLegalizer>();
+  multi_well_legalizer->SetThreads(num_threads);
+  multi_well_legalizer->SetUseCplex(false);
+  multi_well_legalizer->TakeOver(gb_placer.get());
+  multi_well_legalizer->SetWellTapCellParameters(true, false, -1, "");
+  multi_well_legalizer->SetMaxRowWidth(100);
+  multi_well_legalizer->SetPartitionMode(0);
+  return multi_well_legalizer;
+}
+
+/****
+ * @brief Run the steps of GriddedRowLegalizer::StartPlacement() before the
+ * consensus algorithm, so that blocks are assigned to row segments and their
+ * x locations are restored to the global placement result.
+ */
+bool PrepareConsensus(GriddedRowLegalizer &legalizer) {
+  legalizer.CheckWellInfo();
+  legalizer.PartitionSpaceAndBlocks();
+  legalizer.PrecomputeWellTapCellLocation();
+  legalizer.InitializeBlockAuxiliaryInfo();
+  legalizer.SaveInitialLoc();
+  bool is_success = legalizer.UpwardDownwardLegalization();
+  legalizer.SaveUpDownLoc();
+  legalizer.RestoreInitialLocX();
+  return is_success;
+}
+
+/****
+ * @brief A serial reference of Stripe::IterativeCellReordering(), where the
+ * sub-cell locations of a row segment are updated right after the segment is
+ * optimized, and average locations are computed block by block.
+ */
+void SerialCellReordering(Stripe &stripe, int max_iter, int reorder_range) {
+  stripe.num_threads_ = 1;
+  stripe.CollectAllRowSegments();
+  bool is_weighted_anchor = false;
+  std::vector<BlkDispVar> vars;
+  for (int i = 0; i < max_iter; ++i) {
+    double lambda = 1 / double(i + 1);
+    for (RowSegment *segment : stripe.row_seg_ptrs_) {
+      segment->OptimizeQuadraticDisplacement(
+          lambda, is_weighted_anchor, i % 10 == 0, vars, reorder_range
+      );
+      stripe.UpdateSubCellLocs(vars);
+    }
+    for (Block *blk_ptr : stripe.blk_ptrs_vec_) {
+      auto aux_ptr = static_cast<LgBlkAux *>(blk_ptr->AuxPtr());
+      aux_ptr->ComputeAverageLoc();
+      blk_ptr->SetLLX(aux_ptr->AverageLoc());
+    }
+    stripe.ReportIterativeStatus(i);
+    if (!is_weighted_anchor) {
+      is_weighted_anchor = stripe.IsDiscrepancyConverge();
+    }
+    if (stripe.max_discrepancy_ < 0.1) break;
+  }
+  stripe.SetBlockLoc();
+  stripe.ClearMultiRowCellBreaking();
+}
+
+/****
+ * @brief Compare consensus rounds run by 8 threads with the serial reference
+ * on two copies of the same design.
+ */
+bool IsConsensusSameAsSerialReference(std::string const &aux_file_name) {
+  int max_iter = 1000;
+  int reorder_range = 3;
+  Circuit circuit_serial;
+  auto serial_legalizer = CreateLegalizer(circuit_serial, aux_file_name, 1);
+  Circuit circuit;
+  auto legalizer = CreateLegalizer(circuit, aux_file_name, 8);
+  if (!PrepareConsensus(*serial_legalizer) || !PrepareConsensus(*legalizer)) {
+    BOOST_LOG_TRIVIAL(info) << "upward-downward legalization fails\n";
+    return false;
+  }
+
+  auto &serial_col_list = serial_legalizer->ColList();
+  auto &col_list = legalizer->ColList();
+  if (serial_col_list.size() != col_list.size()) return false;
+  size_t multi_round_stripe_cnt = 0;
+  for (size_t i = 0; i < col_list.size(); ++i) {
+    auto &serial_stripes = serial_col_list[i].stripe_list_;
+    auto &stripes = col_list[i].stripe_list_;
+    if (serial_stripes.size() != stripes.size()) return false;
+    for (size_t j = 0; j < stripes.size(); ++j) {
+      SerialCellReordering(serial_stripes[j], max_iter, reorder_range);
+      stripes[j].IterativeCellReordering(max_iter, 8, reorder_range);
+      if (serial_stripes[j].displacements_ != stripes[j].displacements_ ||
+          serial_stripes[j].discrepancies_ != stripes[j].discrepancies_) {
+        BOOST_LOG_TRIVIAL(info)
+          << "stripe " << i << "-" << j
+          << " does not follow the serial reference round by round\n";
+        return false;
+      }
+      if (stripes[j].displacements_.size() > 1) {
+        ++multi_round_stripe_cnt;
+      }
+    }
+  }
+  if (multi_round_stripe_cnt == 0) {
+    BOOST_LOG_TRIVIAL(info) << "no stripe needs more than one round\n";
+    return false;
+  }
+  if (!IsSameBlockLocation(circuit_serial, circuit)) {
+    BOOST_LOG_TRIVIAL(info)
+      << "consensus result is different from the serial reference\n";
+    return false;
+  }
+  return true;
+}
+
+void LoadPlaceAndLegalize(
+    Circuit &circuit,
+    std::string const &aux_file_name,
+    int num_threads
+) {
+  auto multi_well_legalizer =
+      CreateLegalizer(circuit, aux_file_name, num_threads);
+  multi_well_legalizer->StartPlacement();
+}
+
+/****
+ * @brief Testcase for parallel consensus rounds of
+ * Stripe::IterativeCellReordering().
+ *
+ * In each round, every row segment optimizes displacement using only
+ * sub-cell locations from the previous round, then sub-cell locations are
+ * scattered and averaged in separate phases. One in ten cells is a two-deck
+ * cell, whose sub-cells are in different row segments. This testcase shows
+ * that
+ * 1. consensus rounds with 8 threads give the same displacement and
+ *    discrepancy in every round, and the same block locations, as a serial
+ *    reference which updates sub-cell locations right after each row segment
+ * 2. legalization with 2 and 8 threads gives identical block locations and
+ *    orientations as legalization with 1 thread
+ * 3. the same well tap cells are created at the same locations
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  std::string aux_file_name =
+      WriteBookshelfBenchmark("gridded_row_legalization_threads", 2000, 7, 10);
+
+  bool is_passed = IsConsensusSameAsSerialReference(aux_file_name);
+  Circuit circuit_serial;
+  LoadPlaceAndLegalize(circuit_serial, aux_file_name, 1);
+  if (circuit_serial.design().WellTaps().empty()) {
+    BOOST_LOG_TRIVIAL(info) << "no well tap cell is created\n";
+    is_passed = false;
+  }
+  for (int num_threads : {2, 8}) {
+    Circuit circuit;
+    LoadPlaceAndLegalize(circuit, aux_file_name, num_threads);
+    if (!IsSameBlockLocation(circuit_serial, circuit)) {
+      BOOST_LOG_TRIVIAL(info)
+        << "gridded row legalization with " << num_threads
+        << " threads is different from the serial one\n";
+      is_passed = false;
+    }
+    if (!IsSameWellTapLocation(circuit_serial, circuit)) {
+      BOOST_LOG_TRIVIAL(info)
+        << "well tap cells created with " << num_threads
+        << " threads are different from the serial ones\n";
+      is_passed = false;
+    }
+  }
+
+  if (is_passed) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
@@ -0,0 +1,216 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <cfloat>
+#include <climits>
+#include <cmath>
+
+#include <algorithm>
+#include <memory>
+
+#include "dali/circuit/circuit.h"
+#include "dali/common/logging.h"
+#include "dali/placer.h"
+#include "../circuit/helper.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+/****
+ * @brief A Tetris legalizer which runs one sweep from left, and compares the
+ * ring search of every block with a scan of all rows in the search range.
+ */
+class RingSearchChecker : public LGTetrisEx {
+ public:
+  /****
+   * @brief Sweep from left as LocalLegalizationLeft() does. Before each block
+   * is placed, the candidate found by RingSearchRows() is compared with the
+   * lowest cost candidate found by a bottom-up scan, which breaks ties in
+   * the same way.
+   *
+   * @param pruned_row_cnt: number of scanned rows whose lower bound exceeds
+   * the best cost, i.e., rows the ring search does not need to evaluate
+   * @return true if both searches return the same candidate for every block
+   */
+  bool IsRingSearchSameAsScan(size_t &pruned_row_cnt) {
+    InitLegalizer();
+    cur_iter_ = 0;
+    InitBlockContourForward();
+    InitAndSortBlockAscendingX();
+
+    pruned_row_cnt = 0;
+    for (auto &blk_init_pair : blk_inits_) {
+      auto &block = *(blk_init_pair.blk_ptr);
+      Value2D<int> target_loc;
+      target_loc.x = static_cast<int>(std::round(block.LLX()));
+      target_loc.y = AlignLocToRowLoc(block.LLY());
+
+      // the same search range and left bound as FindLocLeft()
+      int width = block.Width();
+      int height = block.Height();
+      int left_block_bound =
+          static_cast<int>(std::round(target_loc.x - k_left_ * width));
+      int lower_search_y =
+          static_cast<int>(std::round(target_loc.y - k_start * height));
+      int upper_search_y =
+          static_cast<int>(std::round(target_loc.y + k_end * height));
+      int lo_row = std::max(0, LocToRow(lower_search_y));
+      int hi_row = std::min(MaxRow(height), LocToRow(upper_search_y));
+
+      if (hpwl_weight_ > 0) {
+        CacheNetBoundingBoxes(block);
+      }
+      RowCandidate ring{0, INT_MIN, DBL_MAX};
+      RingSearchRows(
+          target_loc, block, left_block_bound, true, lo_row, hi_row, ring
+      );
+      RowCandidate scan{0, INT_MIN, DBL_MAX};
+      for (int row = lo_row; row <= hi_row; ++row) {
+        if (!IsFitToRow(row, block)) continue;
+        RowCandidate candidate = EvaluateRowCandidate(
+            target_loc, block, left_block_bound, true, row
+        );
+        if (candidate.cost < scan.cost) {
+          scan = candidate;
+        }
+      }
+      if (ring.row != scan.row || ring.x != scan.x || ring.cost != scan.cost) {
+        BOOST_LOG_TRIVIAL(info)
+          << "block " << block.Name() << ", ring search: (" << ring.x << ", "
+          << ring.row << ", " << ring.cost << "), scan: (" << scan.x << ", "
+          << scan.row << ", " << scan.cost << ")\n";
+        return false;
+      }
+      for (int row = lo_row; row <= hi_row; ++row) {
+        double lower_bound = std::fabs(RowToLoc(row) - target_loc.y)
+            + hpwl_weight_ * hpwl_lower_bound_;
+        if (lower_bound > scan.cost) ++pruned_row_cnt;
+      }
+
+      // place this block the same way as LocalLegalizationLeft()
+      if (!IsCurrentLocLegalLeft(target_loc, block)) {
+        FindLocLeft(target_loc, block);
+      }
+      block.SetLoc(target_loc.x, target_loc.y);
+      int row_id = LocToRow(target_loc.y);
+      block.SetOrient(ShouldOrientN(row_id, block) ? N : FS);
+      UseSpaceLeft(block);
+    }
+    return true;
+  }
+};
+
+bool IsRingSearchSameAsScan(std::string const &aux_file_name, double weight) {
+  Circuit circuit;
+  circuit.LoadBookshelf(aux_file_name);
+  auto gb_placer = GlobalPlace(circuit);
+
+  RingSearchChecker checker;
+  checker.TakeOver(gb_placer.get());
+  checker.SetHpwlWeight(weight);
+  size_t pruned_row_cnt = 0;
+  if (!checker.IsRingSearchSameAsScan(pruned_row_cnt)) return false;
+  BOOST_LOG_TRIVIAL(info)
+    << "HPWL weight " << weight << ", rows pruned: " << pruned_row_cnt << "\n";
+  if (pruned_row_cnt == 0) {
+    BOOST_LOG_TRIVIAL(info) << "no row can be pruned\n";
+    return false;
+  }
+  return true;
+}
+
+/****
+ * @brief Legalize a global placement result using LGTetrisEx
+ *
+ * @return the HPWL after legalization
+ */
+double LoadPlaceAndLegalize(
+    Circuit &circuit,
+    std::string const &aux_file_name,
+    double weight
+) {
+  circuit.LoadBookshelf(aux_file_name);
+  auto gb_placer = GlobalPlace(circuit);
+
+  auto legalizer = std::make_unique<LGTetrisEx>();
+  legalizer->TakeOver(gb_placer.get());
+  legalizer->SetHpwlWeight(weight);
+  legalizer->StartPlacement();
+  return circuit.WeightedHPWL();
+}
+
+/****
+ * @brief Testcase for the HPWL term in the cost of candidate locations of
+ * LGTetrisEx: LGTetrisEx::SetHpwlWeight().
+ *
+ * The cost of a candidate is its displacement plus the weighted HPWL of nets
+ * of the block, and RingSearchRows() skips rows whose distance to the target
+ * plus the weighted HPWL lower bound cannot beat the best candidate. This
+ * testcase shows that
+ * 1. for HPWL weights 0, 0.1 and 1, the ring search finds the same row,
+ *    location and cost as a scan of all rows for every block in a sweep,
+ *    while some rows can be pruned
+ * 2. for each positive HPWL weight, the placement is legal, and the HPWL is
+ *    not worse than the HPWL with weight 0
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  std::string aux_file_name =
+      WriteBookshelfBenchmark("hpwl_weighted_legalization", 1000, 13);
+
+  bool is_passed = true;
+  for (double weight : {0.0, 0.1, 1.0}) {
+    if (!IsRingSearchSameAsScan(aux_file_name, weight)) {
+      BOOST_LOG_TRIVIAL(info)
+        << "ring search with HPWL weight " << weight
+        << " is different from the scan\n";
+      is_passed = false;
+    }
+  }
+
+  Circuit circuit_disp;
+  double disp_hpwl = LoadPlaceAndLegalize(circuit_disp, aux_file_name, 0);
+  for (double weight : {0.1, 1.0}) {
+    Circuit circuit;
+    double hpwl = LoadPlaceAndLegalize(circuit, aux_file_name, weight);
+    BOOST_LOG_TRIVIAL(info)
+      << "HPWL weight " << weight << ", HPWL: " << hpwl
+      << ", HPWL with weight 0: " << disp_hpwl << "\n";
+    if (!IsRowPlacementLegal(circuit)) {
+      BOOST_LOG_TRIVIAL(info)
+        << "placement with HPWL weight " << weight << " is illegal\n";
+      is_passed = false;
+    }
+    if (hpwl > disp_hpwl) {
+      BOOST_LOG_TRIVIAL(info)
+        << "HPWL with weight " << weight << " is worse than with weight 0\n";
+      is_passed = false;
+    }
+  }
+
+  if (is_passed) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
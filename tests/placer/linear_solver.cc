@@ -0,0 +1,195 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <cmath>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <Eigen/SparseCholesky>
+
+#include "dali/common/logging.h"
+#include "dali/placer/global_placer/linear_solver.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+typedef Eigen::Triplet<double> T;
+
+/****
+ * @brief Create a symmetric positive definite matrix like the one of the B2B
+ * net model: a weighted graph Laplacian of mostly local two-pin connections,
+ * plus small anchor weights on the diagonal.
+ */
+SpMat CreatePlacementMatrix(int dim, std::mt19937 &rng) {
+  std::uniform_int_distribution<int> offset_dist(1, 50);
+  std::uniform_real_distribution<double> weight_dist(0.01, 1.0);
+  std::vector<T> coefficients;
+  for (int i = 0; i < dim; ++i) {
+    for (int k = 0; k < 2; ++k) {
+      int j = (i + offset_dist(rng)) % dim;
+      double weight = weight_dist(rng);
+      coefficients.emplace_back(i, i, weight);
+      coefficients.emplace_back(j, j, weight);
+      coefficients.emplace_back(i, j, -weight);
+      coefficients.emplace_back(j, i, -weight);
+    }
+    coefficients.emplace_back(i, i, 0.001 * weight_dist(rng));
+  }
+  SpMat A(dim, dim);
+  A.setFromTriplets(coefficients.begin(), coefficients.end());
+  return A;
+}
+
+Eigen::VectorXd CreateRhs(int dim, std::mt19937 &rng) {
+  std::uniform_real_distribution<double> rhs_dist(-1.0, 1.0);
+  Eigen::VectorXd b(dim);
+  for (int i = 0; i < dim; ++i) {
+    b[i] = rhs_dist(rng);
+  }
+  return b;
+}
+
+/****
+ * @brief Solve Ax = b from a zero initial guess using a backend.
+ */
+Eigen::VectorXd Solve(
+    LinearSolverType solver_type,
+    SpMat const &A,
+    Eigen::VectorXd const &b,
+    int max_iterations,
+    double tolerance,
+    int num_threads
+) {
+  auto solver = CreateLinearSolver(solver_type);
+  solver->SetMaxIterations(max_iterations);
+  solver->SetTolerance(tolerance);
+  solver->SetNumThreads(num_threads);
+  solver->Compute(A, true);
+  Eigen::VectorXd x = Eigen::VectorXd::Zero(b.size());
+  solver->SolveWithGuess(b, x);
+  return x;
+}
+
+bool IsSameVector(Eigen::VectorXd const &x0, Eigen::VectorXd const &x1) {
+  if (x0.size() != x1.size()) return false;
+  for (int i = 0; i < x0.size(); ++i) {
+    if (x0[i] != x1[i]) return false;
+  }
+  return true;
+}
+
+/****
+ * @brief Testcase for linear solver backends of HpwlOptimizer.
+ *
+ * The matrix is like the one of the B2B net model, and has several row blocks
+ * of PcgSolver. This testcase shows that
+ * 1. every backend converges to the solution given by a direct solver
+ * 2. with the same small amount of iterations, IC0 and AMG preconditioners
+ *    give smaller residuals than the diagonal preconditioner
+ * 3. solving x and y in lock-step gives bit-identical solutions as solving
+ *    them one by one, and the solutions do not depend on the number of threads
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  std::mt19937 rng(3);
+  int dim = 20000;
+  SpMat A = CreatePlacementMatrix(dim, rng);
+  Eigen::VectorXd bx = CreateRhs(dim, rng);
+  Eigen::VectorXd by = CreateRhs(dim, rng);
+
+  Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> direct_solver(A);
+  Eigen::VectorXd x_direct = direct_solver.solve(bx);
+
+  std::vector<LinearSolverType> solver_types{
+      LinearSolverType::DIAGONAL, LinearSolverType::IC0,
+      LinearSolverType::AMG, LinearSolverType::FUSED
+  };
+
+  bool is_passed = true;
+  for (auto solver_type : solver_types) {
+    Eigen::VectorXd x = Solve(solver_type, A, bx, 5000, 1e-12, 4);
+    double error = (x - x_direct).norm() / x_direct.norm();
+    BOOST_LOG_TRIVIAL(info)
+      << LinearSolverTypeStr(solver_type) << " solver, relative error: "
+      << error << "\n";
+    if (!(error < 1e-6)) {
+      BOOST_LOG_TRIVIAL(info)
+        << LinearSolverTypeStr(solver_type)
+        << " solver does not converge to the direct solution\n";
+      is_passed = false;
+    }
+  }
+
+  int few_iterations = 20;
+  std::vector<double> residuals;
+  for (auto solver_type : solver_types) {
+    Eigen::VectorXd x = Solve(solver_type, A, bx, few_iterations, 1e-35, 4);
+    residuals.push_back((A * x - bx).norm() / bx.norm());
+    BOOST_LOG_TRIVIAL(info)
+      << LinearSolverTypeStr(solver_type) << " solver, relative residual after "
+      << few_iterations << " iterations: " << residuals.back() << "\n";
+  }
+  if (!(residuals[1] < residuals[0]) || !(residuals[2] < residuals[0])) {
+    BOOST_LOG_TRIVIAL(info)
+      << "preconditioners do not reduce residuals faster than the diagonal one\n";
+    is_passed = false;
+  }
+
+  Eigen::VectorXd x_serial =
+      Solve(LinearSolverType::FUSED, A, bx, few_iterations, 1e-35, 1);
+  Eigen::VectorXd y_serial =
+      Solve(LinearSolverType::FUSED, A, by, few_iterations, 1e-35, 1);
+  for (int num_threads : {1, 2, 8}) {
+    auto solver_x = CreateLinearSolver(LinearSolverType::FUSED);
+    auto solver_y = CreateLinearSolver(LinearSolverType::FUSED);
+    for (auto *solver : {solver_x.get(), solver_y.get()}) {
+      solver->SetMaxIterations(few_iterations);
+      solver->SetNumThreads(num_threads);
+      solver->Compute(A, true);
+    }
+    Eigen::VectorXd x = Eigen::VectorXd::Zero(dim);
+    Eigen::VectorXd y = Eigen::VectorXd::Zero(dim);
+    std::vector<Eigen::Ref<Eigen::VectorXd>> xs{x, y};
+    PcgSolver::SolveWithGuess(
+        {dynamic_cast<PcgSolver *>(solver_x.get()),
+         dynamic_cast<PcgSolver *>(solver_y.get())},
+        {&bx, &by},
+        xs,
+        num_threads
+    );
+    if (!IsSameVector(x_serial, x) || !IsSameVector(y_serial, y)) {
+      BOOST_LOG_TRIVIAL(info)
+        << "solving x and y in lock-step with " << num_threads
+        << " threads is different from solving them one by one\n";
+      is_passed = false;
+    }
+  }
+
+  if (is_passed) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
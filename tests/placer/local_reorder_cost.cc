@@ -0,0 +1,213 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <cmath>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "dali/circuit/circuit.h"
+#include "dali/common/logging.h"
+#include "dali/placer.h"
+#include "../circuit/helper.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+/****
+ * Place blocks of a window as the local reordering does: the first block
+ * abuts the left bound, the last block abuts the right bound, and the others
+ * are separated by the same gap. Locations are stored in slot_llx, indexed by
+ * the position of the block in the window before reordering.
+ */
+void PlaceWindow(
+    std::vector<Block *> &window_blks,
+    std::vector<int> &order,
+    int left_bound,
+    int right_bound,
+    int gap,
+    std::vector<double> &slot_llx
+) {
+  int range = static_cast<int>(order.size());
+  slot_llx[order[0]] = left_bound;
+  slot_llx[order[range - 1]] =
+      right_bound - window_blks[order[range - 1]]->Width();
+  int left_contour = left_bound + gap + window_blks[order[0]]->Width();
+  for (int j = 1; j < range - 1; ++j) {
+    slot_llx[order[j]] = left_contour;
+    left_contour += window_blks[order[j]]->Width() + gap;
+  }
+}
+
+/****
+ * Move blocks of a window to slot_llx, and evaluate the weighted HPWL in the
+ * x direction of every net with fewer than 100 pins connected to the window,
+ * using the full evaluation of Net.
+ */
+double FullWindowHpwlX(
+    Circuit &circuit,
+    std::vector<Block *> &window_blks,
+    std::vector<double> &slot_llx
+) {
+  std::vector<int> net_ids;
+  for (size_t j = 0; j < window_blks.size(); ++j) {
+    window_blks[j]->SetLLX(slot_llx[j]);
+    for (int net_id : window_blks[j]->NetList()) {
+      if (circuit.Nets()[net_id].PinCnt() < 100) {
+        net_ids.push_back(net_id);
+      }
+    }
+  }
+  std::sort(net_ids.begin(), net_ids.end());
+  net_ids.erase(std::unique(net_ids.begin(), net_ids.end()), net_ids.end());
+  double hpwl_x = 0;
+  for (int net_id : net_ids) {
+    hpwl_x += circuit.Nets()[net_id].WeightedHPWLX();
+  }
+  return hpwl_x * circuit.GridValueX();
+}
+
+/****
+ * @brief Testcase for the window cost of local reordering:
+ * StdClusterWellLegalizer::CollectWindowNets() and WindowWireLengthCost().
+ *
+ * Each window of each cluster is reordered by FindBestLocalOrder(), then all
+ * orders of the window are enumerated again, and blocks are moved to evaluate
+ * nets of the window from scratch. This testcase shows that for windows of 3
+ * and 5 blocks
+ * 1. the window cost of every order is the same as the full HPWL in the x
+ *    direction of nets connected to the window
+ * 2. the order found by FindBestLocalOrder() has the minimum full HPWL
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  std::string aux_file_name =
+      WriteBookshelfBenchmark("local_reorder_cost", 1000, 11);
+
+  Circuit circuit;
+  circuit.LoadBookshelf(aux_file_name);
+  AddBookshelfWellTapCell(circuit);
+  auto gb_placer = std::make_unique<GlobalPlacer>();
+  gb_placer->SetInputCircuit(&circuit);
+  gb_placer->SetMaxIteration(30);
+  gb_placer->SetPlacementDensity(0.7);
+  gb_placer->StartPlacement();
+
+  auto well_legalizer = std::make_unique<StdClusterWellLegalizer>();
+  well_legalizer->TakeOver(gb_placer.get());
+  well_legalizer->InitializeWellLegalizer();
+  well_legalizer->BlockClusteringLoose();
+  well_legalizer->SnapshotBlockLocations();
+
+  bool is_passed = true;
+  int window_cnt = 0;
+  LocalReorderScratch scratch;
+  std::vector<Block *> window_blks;
+  std::vector<int> order;
+  std::vector<double> slot_llx;
+  std::vector<double> init_llx;
+  for (int range : {3, 5}) {
+    for (Stripe *stripe : well_legalizer->StripePtrs()) {
+      for (auto &cluster : stripe->gridded_rows_) {
+        auto &blk_list = cluster.Blocks();
+        int sz = static_cast<int>(blk_list.size());
+        std::sort(
+            blk_list.begin(),
+            blk_list.end(),
+            [](const Block *blk_ptr0, const Block *blk_ptr1) {
+              return blk_ptr0->LLX() < blk_ptr1->LLX();
+            }
+        );
+        for (int l = 0; l + range <= sz; ++l) {
+          int r = l + range - 1;
+          window_blks.assign(blk_list.begin() + l, blk_list.begin() + r + 1);
+          int tot_blk_width = 0;
+          init_llx.clear();
+          for (auto &blk_ptr : window_blks) {
+            tot_blk_width += blk_ptr->Width();
+            init_llx.push_back(blk_ptr->LLX());
+          }
+          int left_bound = (int) blk_list[l]->LLX();
+          int right_bound = (int) blk_list[r]->URX();
+          int gap = (right_bound - left_bound - tot_blk_width) / (r - l);
+          well_legalizer->FindBestLocalOrder(
+              &cluster, l, r, left_bound, right_bound, gap, scratch
+          );
+          std::vector<int> best_order = scratch.best_order;
+          ++window_cnt;
+
+          order.resize(range);
+          for (int j = 0; j < range; ++j) {
+            order[j] = j;
+          }
+          slot_llx.resize(range);
+          scratch.slot_llx.resize(range);
+          double min_hpwl = DBL_MAX;
+          double best_order_hpwl = DBL_MAX;
+          do {
+            PlaceWindow(
+                window_blks, order, left_bound, right_bound, gap, slot_llx
+            );
+            scratch.slot_llx = slot_llx;
+            double window_cost = well_legalizer->WindowWireLengthCost(scratch);
+            double full_hpwl = FullWindowHpwlX(circuit, window_blks, slot_llx);
+            if (std::fabs(window_cost - full_hpwl)
+                > 1e-9 * std::max(1.0, full_hpwl)) {
+              BOOST_LOG_TRIVIAL(info)
+                << "window starting at " << window_blks[0]->Name()
+                << ", window cost " << window_cost << " vs full HPWL "
+                << full_hpwl << "\n";
+              is_passed = false;
+            }
+            min_hpwl = std::min(min_hpwl, full_hpwl);
+            if (order == best_order) {
+              best_order_hpwl = full_hpwl;
+            }
+          } while (std::next_permutation(order.begin(), order.end()));
+          if (best_order_hpwl > min_hpwl + 1e-9 * std::max(1.0, min_hpwl)) {
+            BOOST_LOG_TRIVIAL(info)
+              << "window starting at " << window_blks[0]->Name()
+              << ", best order costs " << best_order_hpwl
+              << ", but the minimum is " << min_hpwl << "\n";
+            is_passed = false;
+          }
+
+          for (int j = 0; j < range; ++j) {
+            window_blks[j]->SetLLX(init_llx[j]);
+          }
+        }
+      }
+    }
+  }
+  BOOST_LOG_TRIVIAL(info) << window_cnt << " windows checked\n";
+  if (window_cnt == 0) {
+    is_passed = false;
+  }
+
+  if (is_passed) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
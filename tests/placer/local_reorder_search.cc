@@ -0,0 +1,347 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <cmath>
+
+#include <algorithm>
+#include <cfloat>
+#include <random>
+#include <vector>
+
+#include "dali/common/elapsed_time.h"
+#include "dali/common/logging.h"
+#include "dali/placer/well_legalizer/rowsegment.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+/****
+ * Create cells with random widths, initial locations and weights, and pack
+ * them from left to right in the order of their initial locations. The index
+ * of each cell is saved as its region id to identify it after reordering.
+ */
+std::vector<BlkDispVar> CreateCells(int cell_count, std::mt19937 &rng) {
+  std::uniform_int_distribution<int> width_dist(1, 8);
+  std::uniform_real_distribution<double> loc_dist(0, 4.0 * cell_count);
+  std::uniform_real_distribution<double> weight_dist(0.5, 2.0);
+  std::vector<BlkDispVar> vars;
+  for (int i = 0; i < cell_count; ++i) {
+    vars.emplace_back(width_dist(rng), loc_dist(rng), weight_dist(rng));
+  }
+  std::sort(
+      vars.begin(), vars.end(),
+      [](BlkDispVar &var0, BlkDispVar &var1) {
+        return var0.InitX() < var1.InitX();
+      }
+  );
+  double left_contour = 0;
+  for (int i = 0; i < cell_count; ++i) {
+    vars[i].blk_rgn.region_id = i;
+    vars[i].SetSolution(std::max(vars[i].InitX(), left_contour));
+    left_contour = vars[i].Solution() + vars[i].Width();
+  }
+  return vars;
+}
+
+/****
+ * Reference local reordering: slide a window of range cells along the cells,
+ * evaluate every order of the window, keep the first order with the minimum
+ * cost, and evenly spread cells in the window like RowSegment::LocalReorder.
+ */
+void ExhaustiveLocalReorder(
+    std::vector<BlkDispVar> &vars,
+    int range,
+    bool is_linear
+) {
+  int sz = static_cast<int>(vars.size());
+  std::vector<int> order(range);
+  std::vector<int> best_order(range);
+  std::vector<BlkDispVar> window;
+  for (int l = 0; l + range <= sz; ++l) {
+    int r = l + range - 1;
+    window.assign(vars.begin() + l, vars.begin() + r + 1);
+    int tot_blk_width = 0;
+    for (auto &var : window) {
+      tot_blk_width += var.Width();
+    }
+    double left_bound = vars[l].Solution();
+    double right_bound = vars[r].Solution() + vars[r].Width();
+    double gap = (right_bound - left_bound - tot_blk_width) / (range - 1);
+
+    for (int j = 0; j < range; ++j) {
+      order[j] = j;
+    }
+    double best_cost = DBL_MAX;
+    do {
+      double cost = 0;
+      double left_contour = left_bound;
+      for (int j = 0; j < range; ++j) {
+        BlkDispVar &var = window[order[j]];
+        double loc = (j == range - 1) ? right_bound - var.Width() : left_contour;
+        cost += RowSegment::SlotCost(var, loc, is_linear);
+        left_contour += var.Width() + gap;
+      }
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_order = order;
+      }
+    } while (std::next_permutation(order.begin(), order.end()));
+
+    for (int j = 0; j < range; ++j) {
+      vars[l + j] = window[best_order[j]];
+    }
+    vars[l].SetSolution(left_bound);
+    vars[r].SetSolution(right_bound - vars[r].Width());
+    double left_contour = left_bound + vars[l].Width() + gap;
+    for (int i = l + 1; i < r; ++i) {
+      vars[i].SetSolution(left_contour);
+      left_contour += vars[i].Width() + gap;
+    }
+  }
+}
+
+/****
+ * Search the best order of cells [l, r] by dynamic programming if
+ * @param use_dp is true, otherwise by branch and bound, and spread them like
+ * RowSegment::LocalReorder().
+ *
+ * @return the cost of cells [l, r] after they are spread
+ */
+double ReorderWindow(
+    RowSegment &segment,
+    std::vector<BlkDispVar> &vars,
+    int l, int r,
+    bool is_linear,
+    bool use_dp,
+    LocalReorderTable &table
+) {
+  int tot_blk_width = 0;
+  for (int j = l; j <= r; ++j) {
+    tot_blk_width += vars[j].Width();
+  }
+  double left_bound = vars[l].Solution();
+  double right_bound = vars[r].Solution() + vars[r].Width();
+  double gap = (right_bound - left_bound - tot_blk_width) / (r - l);
+
+  if (use_dp) {
+    segment.FindBestLocalOrderDP(
+        vars, l, r, left_bound, right_bound, gap, is_linear, table
+    );
+  } else {
+    table.order.assign(vars.begin() + l, vars.begin() + r + 1);
+    double best_cost = DBL_MAX;
+    segment.FindBestLocalOrder(
+        table.order, best_cost, vars, l, l, r,
+        left_bound, right_bound, gap, 0, is_linear
+    );
+    std::copy(table.order.begin(), table.order.end(), vars.begin() + l);
+  }
+
+  vars[l].SetSolution(left_bound);
+  vars[r].SetSolution(right_bound - vars[r].Width());
+  double left_contour = left_bound + vars[l].Width() + gap;
+  for (int i = l + 1; i < r; ++i) {
+    vars[i].SetSolution(left_contour);
+    left_contour += vars[i].Width() + gap;
+  }
+  double cost = 0;
+  for (int i = l; i <= r; ++i) {
+    cost += RowSegment::SlotCost(vars[i], vars[i].Solution(), is_linear);
+  }
+  return cost;
+}
+
+/****
+ * Slide a window along the cells, and check that the dynamic program and
+ * branch and bound find orders of the same cost in every window. Orders of
+ * the same cost are common with the linear cost, and the two searches may
+ * break such ties differently, so the search continues with the order found
+ * by the dynamic program.
+ */
+bool IsSameWindowCost(
+    std::vector<BlkDispVar> vars,
+    int range,
+    bool is_linear
+) {
+  RowSegment segment;
+  LocalReorderTable table;
+  table.Resize(range);
+  std::vector<BlkDispVar> bnb_vars;
+  int sz = static_cast<int>(vars.size());
+  for (int l = 0; l + range <= sz; ++l) {
+    int r = l + range - 1;
+    bnb_vars = vars;
+    double bnb_cost =
+        ReorderWindow(segment, bnb_vars, l, r, is_linear, false, table);
+    double dp_cost = ReorderWindow(segment, vars, l, r, is_linear, true, table);
+    if (std::fabs(dp_cost - bnb_cost) > 1e-9 * (1 + bnb_cost)) {
+      BOOST_LOG_TRIVIAL(info)
+        << "range " << range << (is_linear ? ", linear" : ", quadratic")
+        << ", window " << l << ": dynamic programming cost " << dp_cost
+        << " vs branch and bound cost " << bnb_cost << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+/****
+ * Reorder every row using the dynamic program or branch and bound for all
+ * windows, and return the shortest wall time of a few runs.
+ */
+double TimeLocalReorder(
+    std::vector<std::vector<BlkDispVar>> const &rows,
+    int range,
+    bool is_linear,
+    bool use_dp
+) {
+  RowSegment segment;
+  LocalReorderTable table;
+  table.Resize(range);
+  double min_time = DBL_MAX;
+  for (int run = 0; run < 5; ++run) {
+    std::vector<std::vector<BlkDispVar>> results = rows;
+    ElapsedTime elapsed_time;
+    elapsed_time.RecordStartTime();
+    for (auto &vars : results) {
+      int sz = static_cast<int>(vars.size());
+      for (int l = 0; l + range <= sz; ++l) {
+        ReorderWindow(segment, vars, l, l + range - 1, is_linear, use_dp, table);
+      }
+    }
+    elapsed_time.RecordEndTime();
+    min_time = std::min(min_time, elapsed_time.GetWallTime());
+  }
+  return min_time;
+}
+
+bool IsSameOrder(
+    std::vector<BlkDispVar> &vars0,
+    std::vector<BlkDispVar> &vars1,
+    int range,
+    bool is_linear
+) {
+  for (size_t i = 0; i < vars0.size(); ++i) {
+    if (vars0[i].blk_rgn.region_id != vars1[i].blk_rgn.region_id
+        || std::fabs(vars0[i].Solution() - vars1[i].Solution()) > 1e-9) {
+      BOOST_LOG_TRIVIAL(info)
+        << "range " << range << (is_linear ? ", linear" : ", quadratic")
+        << ", slot " << i << ": cell " << vars0[i].blk_rgn.region_id
+        << " at " << vars0[i].Solution() << " vs cell "
+        << vars1[i].blk_rgn.region_id << " at " << vars1[i].Solution()
+        << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+/****
+ * @brief Testcase for window searches of RowSegment::LocalReorder().
+ *
+ * Windows are searched by dynamic programming over subsets for the quadratic
+ * cost, and by branch and bound for the linear cost. Both keep the bounds of
+ * a window and spread its cells evenly, like an exhaustive enumeration of all
+ * orders. This testcase shows that for every window size from 2 to 8, on
+ * rows of cells with random widths, locations and weights
+ * 1. the quadratic mode gives the same order and locations as the exhaustive
+ *    enumeration
+ * 2. the linear mode, in which all orders of cells with unit weights cost
+ *    the same, keeps every order like the exhaustive enumeration
+ * 3. a row segment reused for windows of different sizes gives the same
+ *    result as a new one
+ * and for window sizes from 5 to 8, with either cost
+ * 4. the dynamic program and branch and bound find orders of the same cost
+ *    in every window
+ * 5. the search used by RowSegment::LocalReorder() is faster than the other
+ *    one, the dynamic program for the quadratic cost, and branch and bound
+ *    for the linear cost
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  std::mt19937 rng(13);
+  RowSegment reused_segment;
+
+  bool is_passed = true;
+  for (int trial = 0; trial < 20; ++trial) {
+    std::vector<BlkDispVar> cells = CreateCells(60, rng);
+    for (int range = 8; range >= 2; --range) {
+      for (bool is_linear : {false, true}) {
+        std::vector<BlkDispVar> input = cells;
+        if (is_linear) {
+          // unit weights, so that costs of all orders are exactly the same
+          for (auto &var : input) {
+            var.SetWeight(1.0);
+          }
+        }
+        std::vector<BlkDispVar> expected = input;
+        ExhaustiveLocalReorder(expected, range, is_linear);
+
+        std::vector<BlkDispVar> vars = input;
+        RowSegment segment;
+        segment.LocalReorder(vars, range, 0, is_linear);
+        if (!IsSameOrder(expected, vars, range, is_linear)) {
+          is_passed = false;
+        }
+
+        std::vector<BlkDispVar> reused_vars = input;
+        reused_segment.LocalReorder(reused_vars, range, 0, is_linear);
+        if (!IsSameOrder(expected, reused_vars, range, is_linear)) {
+          is_passed = false;
+        }
+      }
+    }
+  }
+
+  std::vector<std::vector<BlkDispVar>> rows;
+  for (int i = 0; i < 20; ++i) {
+    rows.push_back(CreateCells(100, rng));
+  }
+  for (int range = 5; range <= 8; ++range) {
+    for (bool is_linear : {false, true}) {
+      for (auto &vars : rows) {
+        if (!IsSameWindowCost(vars, range, is_linear)) {
+          is_passed = false;
+        }
+      }
+      double dp_time = TimeLocalReorder(rows, range, is_linear, true);
+      double bnb_time = TimeLocalReorder(rows, range, is_linear, false);
+      BOOST_LOG_TRIVIAL(info)
+        << "range " << range << (is_linear ? ", linear" : ", quadratic")
+        << ", dynamic programming: " << dp_time << " s, branch and bound: "
+        << bnb_time << " s\n";
+      bool is_dp_used = !is_linear;
+      if (is_dp_used ? dp_time >= bnb_time : bnb_time >= dp_time) {
+        BOOST_LOG_TRIVIAL(info)
+          << "the search used by LocalReorder() is not the faster one\n";
+        is_passed = false;
+      }
+    }
+  }
+
+  if (is_passed) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
@@ -0,0 +1,365 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "dali/common/logging.h"
+#include "dali/placer/global_placer/parallel_assembler.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+typedef Eigen::Triplet<double> T;
+
+/****
+ * A group of matrix entries and right-hand-side contributions, like the
+ * entries emitted by a two-pin net in the B2B net model. Entries only depend
+ * on the key, values depend on the weight.
+ */
+struct Group {
+  int key0;
+  int key1;
+  double weight;
+};
+
+/****
+ * A linear system in the order a serial pass would emit it: entries of all
+ * groups in group order, followed by entries in the tail.
+ */
+struct LinearSystem {
+  int dim = 0;
+  // groups only connect rows in [0, group_dim)
+  int group_dim = 0;
+  std::vector<Group> groups;
+  std::vector<T> tail;
+};
+
+void EmitGroup(
+    Group const &group,
+    std::vector<T> &coefficients,
+    std::vector<std::pair<int, double>> &rhs
+) {
+  coefficients.emplace_back(group.key0, group.key0, group.weight);
+  coefficients.emplace_back(group.key1, group.key1, group.weight);
+  coefficients.emplace_back(group.key0, group.key1, -group.weight);
+  coefficients.emplace_back(group.key1, group.key0, -group.weight);
+  rhs.emplace_back(group.key0, 0.5 * group.weight);
+  rhs.emplace_back(group.key1, -0.5 * group.weight);
+}
+
+/****
+ * @brief Create a random linear system. Groups connect the first @param dim
+ * rows, and the last @param num_bare_rows rows only get an off-diagonal entry
+ * in the tail, so they have no diagonal entry in SpMat::setFromTriplets().
+ */
+LinearSystem CreateLinearSystem(
+    int dim,
+    int num_bare_rows,
+    int num_groups,
+    std::mt19937 &rng
+) {
+  LinearSystem system;
+  system.dim = dim + num_bare_rows;
+  system.group_dim = dim;
+  std::uniform_int_distribution<int> blk_dist(0, dim - 1);
+  std::uniform_int_distribution<int> offset_dist(1, 20);
+  std::uniform_real_distribution<double> weight_dist(0.01, 1.0);
+  for (int i = 0; i < num_groups; ++i) {
+    // mostly local connections, so that many entries are duplicated
+    int key0 = blk_dist(rng);
+    int key1 = std::min(dim - 1, key0 + offset_dist(rng));
+    if (key0 == key1) key0 = key1 - 1;
+    system.groups.push_back(Group{key0, key1, weight_dist(rng)});
+  }
+  for (int i = 0; i < dim; i += 3) {
+    system.tail.emplace_back(i, i, weight_dist(rng));
+  }
+  for (int i = dim; i < system.dim; ++i) {
+    system.tail.emplace_back(i, blk_dist(rng), weight_dist(rng));
+  }
+  return system;
+}
+
+/****
+ * @brief Assemble the linear system serially by SpMat::setFromTriplets().
+ */
+void AssembleSerially(LinearSystem const &system, SpMat &A, Eigen::VectorXd &b) {
+  std::vector<T> coefficients;
+  std::vector<std::pair<int, double>> rhs;
+  for (auto &group : system.groups) {
+    EmitGroup(group, coefficients, rhs);
+  }
+  coefficients.insert(
+      coefficients.end(), system.tail.begin(), system.tail.end()
+  );
+  A.resize(system.dim, system.dim);
+  A.setFromTriplets(coefficients.begin(), coefficients.end());
+  b.setZero(system.dim);
+  for (auto &[row, value] : rhs) {
+    b[row] += value;
+  }
+}
+
+/****
+ * @brief Assemble the linear system by a ParallelAssembler. Groups are split
+ * into contiguous chunks, like nets in B2BHpwlOptimizer::BuildProblemX().
+ * Like B2BHpwlOptimizer, the matrix @param A and the groups of the assembler
+ * are only initialized once, so that the matrix structure can be reused.
+ */
+void AssembleInParallel(
+    LinearSystem const &system,
+    ParallelAssembler &assembler,
+    int num_chunks,
+    SpMat &A,
+    Eigen::VectorXd &b
+) {
+  int num_groups = static_cast<int>(system.groups.size());
+  if (assembler.NumChunks() != num_chunks) {
+    assembler.Initialize(system.dim, num_chunks);
+    assembler.InitializeGroups(std::vector<int>(num_groups, 4));
+    A.resize(system.dim, system.dim);
+    b.resize(system.dim);
+  } else {
+    assembler.Initialize(system.dim, num_chunks);
+  }
+  int chunk_size = (num_groups + num_chunks - 1) / num_chunks;
+  std::vector<T> coefficients;
+  std::vector<std::pair<int, double>> rhs;
+  for (int chunk = 0; chunk < num_chunks; ++chunk) {
+    int lo = std::min(num_groups, chunk * chunk_size);
+    int hi = std::min(num_groups, lo + chunk_size);
+    for (int i = lo; i < hi; ++i) {
+      coefficients.clear();
+      rhs.clear();
+      EmitGroup(system.groups[i], coefficients, rhs);
+      assembler.BeginGroup(
+          chunk, i, system.groups[i].key0, system.groups[i].key1
+      );
+      for (auto &triplet : coefficients) {
+        assembler.AddCoefficient(
+            chunk, triplet.row(), triplet.col(), triplet.value()
+        );
+      }
+      for (auto &[row, value] : rhs) {
+        assembler.AddRhs(chunk, row, value);
+      }
+      assembler.EndGroup(chunk);
+    }
+  }
+  assembler.MergeRhs(b);
+  assembler.MergeMatrix(system.tail, A);
+}
+
+/****
+ * @brief Compare a matrix @param A assembled by the assembler with the matrix
+ * @param A_serial assembled by SpMat::setFromTriplets().
+ *
+ * Both matrices need to be compressed with sorted columns in each row. The
+ * assembler keeps an explicit diagonal entry in every row, so @param A
+ * is supposed to have the structure of @param A_serial plus the diagonal
+ * entries missing from it, and these extra entries are supposed to be zero.
+ * All other entries need to have bit-identical values.
+ *
+ * @return true if the structure and values are as expected, otherwise, false
+ */
+bool IsSameMatrix(SpMat const &A_serial, SpMat const &A) {
+  if (A_serial.rows() != A.rows() || A_serial.cols() != A.cols()) {
+    BOOST_LOG_TRIVIAL(info) << "different matrix size\n";
+    return false;
+  }
+  if (!A.isCompressed()) {
+    BOOST_LOG_TRIVIAL(info) << "matrix is not compressed\n";
+    return false;
+  }
+  for (int row = 0; row < A.outerSize(); ++row) {
+    SpMat::InnerIterator it_serial(A_serial, row);
+    SpMat::InnerIterator it(A, row);
+    int last_col = -1;
+    bool is_diagonal_found = false;
+    for (; it; ++it) {
+      if (it.col() <= last_col) {
+        BOOST_LOG_TRIVIAL(info)
+          << "columns are not sorted in row " << row << "\n";
+        return false;
+      }
+      last_col = it.col();
+      is_diagonal_found = is_diagonal_found || (it.col() == row);
+      if (it_serial && it_serial.col() == it.col()) {
+        if (it_serial.value() != it.value()) {
+          BOOST_LOG_TRIVIAL(info)
+            << "different matrix entry (" << row << ", " << it.col()
+            << "): " << it_serial.value() << " vs " << it.value() << "\n";
+          return false;
+        }
+        ++it_serial;
+      } else if (it.col() != row || it.value() != 0) {
+        BOOST_LOG_TRIVIAL(info)
+          << "unexpected matrix entry (" << row << ", " << it.col()
+          << "): " << it.value() << "\n";
+        return false;
+      }
+    }
+    if (it_serial) {
+      BOOST_LOG_TRIVIAL(info)
+        << "missing matrix entry (" << row << ", " << it_serial.col()
+        << ")\n";
+      return false;
+    }
+    if (!is_diagonal_found) {
+      BOOST_LOG_TRIVIAL(info)
+        << "missing diagonal entry in row " << row << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+/****
+ * @brief Count rows without a diagonal entry in a matrix.
+ */
+int CountRowsWithoutDiagonal(SpMat const &A) {
+  int cnt = 0;
+  for (int row = 0; row < A.outerSize(); ++row) {
+    bool is_diagonal_found = false;
+    for (SpMat::InnerIterator it(A, row); it; ++it) {
+      is_diagonal_found = is_diagonal_found || (it.col() == row);
+    }
+    if (!is_diagonal_found) ++cnt;
+  }
+  return cnt;
+}
+
+bool IsSameVector(Eigen::VectorXd const &b0, Eigen::VectorXd const &b1) {
+  if (b0.size() != b1.size()) return false;
+  for (int i = 0; i < b0.size(); ++i) {
+    if (b0[i] != b1[i]) {
+      BOOST_LOG_TRIVIAL(info)
+        << "different vector entry " << i << ": "
+        << b0[i] << " vs " << b1[i] << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+/****
+ * @brief Change weights of all groups, and keys of some groups. Entries of
+ * groups with a new key may not be in the current matrix structure.
+ */
+void UpdateLinearSystem(
+    LinearSystem &system,
+    double key_change_rate,
+    std::mt19937 &rng
+) {
+  std::uniform_real_distribution<double> weight_dist(0.01, 1.0);
+  std::uniform_real_distribution<double> rate_dist(0, 1);
+  std::uniform_int_distribution<int> blk_dist(0, system.group_dim - 1);
+  for (auto &group : system.groups) {
+    group.weight = weight_dist(rng);
+    if (rate_dist(rng) < key_change_rate) {
+      // long connections, which are unlikely to exist before
+      group.key1 = blk_dist(rng);
+      if (group.key1 == group.key0) {
+        group.key1 = (group.key0 + system.group_dim / 2) % system.group_dim;
+      }
+    }
+  }
+  for (auto &triplet : system.tail) {
+    triplet = T(triplet.row(), triplet.col(), weight_dist(rng));
+  }
+}
+
+/****
+ * @brief Testcase for ParallelAssembler.
+ *
+ * ParallelAssembler is supposed to give the same linear system as a serial
+ * pass over the input, regardless of the number of threads, and regardless of
+ * whether the matrix structure is built from scratch, reused, or patched.
+ * This testcase builds a random linear system with many duplicated entries
+ * and a few rows without diagonal entries,
+ * and assembles it three times with the same assembler:
+ * 1. the first time, the structure is built from scratch
+ * 2. then only weights change, and the structure is reused
+ * 3. then keys of some groups change, and the structure is patched
+ * It shows that in each round, with 1, 2, and 8 chunks,
+ * 1. the right-hand-side vector is bit-identical to the serial one
+ * 2. the matrix has the structure given by SpMat::setFromTriplets() plus
+ *    explicit zero diagonal entries, and all values are bit-identical
+ * 3. the expected merge path is taken
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  std::mt19937 rng(1);
+  std::vector<LinearSystem> systems;
+  systems.push_back(CreateLinearSystem(1000, 10, 5000, rng));
+  systems.push_back(systems.back());
+  UpdateLinearSystem(systems.back(), 0, rng);
+  systems.push_back(systems.back());
+  UpdateLinearSystem(systems.back(), 0.1, rng);
+
+  bool is_identical = true;
+  for (int num_chunks : {1, 2, 8}) {
+    ParallelAssembler assembler;
+    SpMat A;
+    Eigen::VectorXd b;
+    for (size_t round = 0; round < systems.size(); ++round) {
+      SpMat A_serial;
+      Eigen::VectorXd b_serial;
+      AssembleSerially(systems[round], A_serial, b_serial);
+      if (CountRowsWithoutDiagonal(A_serial) == 0) {
+        BOOST_LOG_TRIVIAL(info)
+          << "round " << round << ", every row has a diagonal entry\n";
+        is_identical = false;
+      }
+      AssembleInParallel(systems[round], assembler, num_chunks, A, b);
+      bool is_same = IsSameMatrix(A_serial, A) && IsSameVector(b_serial, b);
+      bool is_rebuild_expected = (round == 0);
+      bool is_patch_expected = (round == 2);
+      bool is_path_expected =
+          (assembler.IsLastMergeRebuild() == is_rebuild_expected) &&
+              (assembler.IsLastMergePatch() == is_patch_expected);
+      if (!is_same) {
+        BOOST_LOG_TRIVIAL(info)
+          << "round " << round << ", linear system assembled with "
+          << num_chunks << " chunks is different from the serial one\n";
+      }
+      if (!is_path_expected) {
+        BOOST_LOG_TRIVIAL(info)
+          << "round " << round << ", " << num_chunks
+          << " chunks, unexpected merge path, rebuild: "
+          << assembler.IsLastMergeRebuild()
+          << ", patch: " << assembler.IsLastMergePatch() << "\n";
+      }
+      is_identical = is_identical && is_same && is_path_expected;
+    }
+  }
+
+  if (is_identical) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
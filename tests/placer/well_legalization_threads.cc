@@ -0,0 +1,209 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "dali/circuit/circuit.h"
+#include "dali/common/logging.h"
+#include "dali/placer.h"
+#include "../circuit/helper.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+std::unique_ptr<StdClusterWellLegalizer> LoadPlaceAndLegalize(
+    Circuit &circuit,
+    std::string const &aux_file_name,
+    int num_threads
+) {
+  circuit.LoadBookshelf(aux_file_name);
+  AddBookshelfWellTapCell(circuit);
+  auto gb_placer = GlobalPlace(circuit);
+
+  auto well_legalizer = std::make_unique<StdClusterWellLegalizer>();
+  well_legalizer->TakeOver(gb_placer.get());
+  well_legalizer->SetNumThreads(num_threads);
+  well_legalizer->StartPlacement();
+  return well_legalizer;
+}
+
+/****
+ * @brief Check the result of each stripe
+ *
+ * Stripes are legalized, flipped, reordered and tapped by different threads,
+ * so each stripe needs to be legal on its own, and stripes in the same column
+ * need to agree on the orientation of rows. A stripe is legal if
+ * 1. its rows are inside the stripe, and blocks in a row, including well tap
+ *    cells, are inside the row and do not overlap
+ * 2. each row has two well tap cells, and every block has the orientation of
+ *    its row
+ * 3. every movable block is in exactly one row
+ * Abutting rows, in the same stripe or not, need different orientations.
+ *
+ * @return true if all stripes are legal, otherwise, false
+ */
+bool IsEachStripeLegal(
+    Circuit &circuit,
+    StdClusterWellLegalizer &well_legalizer
+) {
+  std::vector<int> row_cnts(circuit.Blocks().size(), 0);
+  std::vector<GriddedRow *> rows;
+  bool is_legal = true;
+  for (Stripe *stripe : well_legalizer.StripePtrs()) {
+    for (auto &row : stripe->gridded_rows_) {
+      rows.push_back(&row);
+      if (row.LLX() < stripe->LLX() || row.URX() > stripe->URX()) {
+        BOOST_LOG_TRIVIAL(info)
+          << "row at (" << row.LLX() << ", " << row.LLY()
+          << ") is outside its stripe\n";
+        is_legal = false;
+      }
+      std::vector<Block *> blocks = row.Blocks();
+      std::sort(
+          blocks.begin(), blocks.end(),
+          [](Block const *blk0, Block const *blk1) {
+            return blk0->LLX() < blk1->LLX();
+          }
+      );
+      BlockOrient row_orient = row.IsOrientN() ? N : FS;
+      int tap_cnt = 0;
+      double last_urx = row.LLX();
+      for (Block *blk : blocks) {
+        bool is_tap = blk->TypePtr() == circuit.tech().WellTapCellPtrs()[0];
+        if (is_tap) {
+          ++tap_cnt;
+        } else {
+          ++row_cnts[blk->Id()];
+        }
+        if (blk->LLX() < last_urx || blk->URX() > row.URX()
+            || blk->LLY() < row.LLY() || blk->URY() > row.URY()) {
+          BOOST_LOG_TRIVIAL(info)
+            << "block " << blk->Name() << " overlaps with its left neighbor, "
+            << "or is outside its row at (" << row.LLX() << ", "
+            << row.LLY() << ")\n" << blk->LLX() << " " << blk->URX() << " " << blk->LLY() << " " << blk->URY() << " last " << last_urx << " row " << row.URX() << " " << row.URY() << " stripe " << stripe->URX();
+          is_legal = false;
+        }
+        if (blk->Orient() != row_orient) {
+          BOOST_LOG_TRIVIAL(info)
+            << "block " << blk->Name() << " has a different orientation "
+            << "from its row\n";
+          is_legal = false;
+        }
+        last_urx = blk->URX();
+      }
+      if (tap_cnt != 2) {
+        BOOST_LOG_TRIVIAL(info)
+          << "row at (" << row.LLX() << ", " << row.LLY() << ") has "
+          << tap_cnt << " well tap cells\n";
+        is_legal = false;
+      }
+    }
+  }
+
+  for (auto &blk : circuit.Blocks()) {
+    if (blk.IsMovable() && row_cnts[blk.Id()] != 1) {
+      BOOST_LOG_TRIVIAL(info)
+        << "block " << blk.Name() << " is in " << row_cnts[blk.Id()]
+        << " rows\n";
+      is_legal = false;
+    }
+  }
+
+  for (GriddedRow *row0 : rows) {
+    for (GriddedRow *row1 : rows) {
+      bool is_abutting = row0->URY() == row1->LLY()
+          && row0->LLX() < row1->URX() && row1->LLX() < row0->URX();
+      if (is_abutting && row0->IsOrientN() == row1->IsOrientN()) {
+        BOOST_LOG_TRIVIAL(info)
+          << "abutting rows at (" << row0->LLX() << ", " << row0->LLY()
+          << ") and (" << row1->LLX() << ", " << row1->LLY()
+          << ") have the same orientation\n";
+        is_legal = false;
+      }
+    }
+  }
+  return is_legal;
+}
+
+/****
+ * @brief Testcase for stripe-parallel well legalization:
+ * StdClusterWellLegalizer::SetNumThreads().
+ *
+ * Stripes are clustered, flipped, reordered and tapped concurrently, and
+ * wire-length costs of a stripe read blocks in other stripes from a copy
+ * saved before each pass. This testcase shows that
+ * 1. each stripe is legal on its own, and abutting rows of different
+ *    stripes have different orientations, see IsEachStripeLegal()
+ * 2. legalization with 2 and 8 threads gives identical block locations and
+ *    orientations as legalization with 1 thread
+ * 3. the same well tap cells are inserted at the same locations
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  std::string aux_file_name =
+      WriteBookshelfBenchmark("well_legalization_threads", 2000, 5);
+
+  bool is_passed = true;
+  Circuit circuit_serial;
+  auto serial_legalizer =
+      LoadPlaceAndLegalize(circuit_serial, aux_file_name, 1);
+  if (!IsEachStripeLegal(circuit_serial, *serial_legalizer)) {
+    BOOST_LOG_TRIVIAL(info) << "well legalization gives illegal stripes\n";
+    is_passed = false;
+  }
+  if (circuit_serial.design().WellTaps().empty()) {
+    BOOST_LOG_TRIVIAL(info) << "no well tap cell is inserted\n";
+    is_passed = false;
+  }
+  for (int num_threads : {2, 8}) {
+    Circuit circuit;
+    auto well_legalizer =
+        LoadPlaceAndLegalize(circuit, aux_file_name, num_threads);
+    if (!IsEachStripeLegal(circuit, *well_legalizer)) {
+      BOOST_LOG_TRIVIAL(info)
+        << "well legalization with " << num_threads
+        << " threads gives illegal stripes\n";
+      is_passed = false;
+    }
+    if (!IsSameBlockLocation(circuit_serial, circuit)) {
+      BOOST_LOG_TRIVIAL(info)
+        << "well legalization with " << num_threads
+        << " threads is different from the serial one\n";
+      is_passed = false;
+    }
+    if (!IsSameWellTapLocation(circuit_serial, circuit)) {
+      BOOST_LOG_TRIVIAL(info)
+        << "well tap cells inserted with " << num_threads
+        << " threads are different from the serial ones\n";
+      is_passed = false;
+    }
+  }
+
+  if (is_passed) {
+    return SUCCESS;
+  }
+  return FAIL;
+}
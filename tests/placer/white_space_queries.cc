@@ -0,0 +1,263 @@
+/*******************************************************************************
+ *
+ * Copyright (c) 2022 Yihang Yang
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor,
+ * Boston, MA  02110-1301, USA.
+ *
+ ******************************************************************************/
+#include <climits>
+
+#include <string>
+#include <vector>
+
+#include "dali/circuit/circuit.h"
+#include "dali/common/logging.h"
+#include "dali/placer.h"
+
+#define SUCCESS 0
+#define FAIL 1
+
+using namespace dali;
+
+/****
+ * @brief A Tetris legalizer which exposes white space segments of rows.
+ */
+class WhiteSpaceLegalizer : public LGTetrisEx {
+ public:
+  std::vector<SegI> const &RowSegments(int row) const {
+    return row_segments_[row];
+  }
+};
+
+/****
+ * @brief Build a circuit with 5 rows in [0, 200] x [0, 30], in grid units,
+ * rows are 6 high. Fixed blocks are
+ * row 0: [0, 10], [20, 30], [50, 60] and [60, 70] which abut, [80, 90] and
+ *        [92, 102] which leave a gap narrower than the movable cell, and
+ *        [150, 200]
+ * rows 1 and 2: one two-row block [40, 60]
+ * row 3: 13 blocks of width 5 at 10, 25, ..., 190, so that this row has more
+ *        segments than rows searched linearly
+ * row 4: one block covering the whole row
+ * The only movable cell is 3 wide.
+ */
+void BuildCircuit(Circuit &circuit) {
+  circuit.SetDatabaseMicrons(2000);
+  circuit.SetManufacturingGrid(0.005);
+  circuit.AddMetalLayer("m1", 0.1, 0.1, 0.02, 0.2, 0.2, HORIZONTAL);
+  circuit.AddMetalLayer("m2", 0.1, 0.1, 0.02, 0.2, 0.2, VERTICAL);
+  circuit.SetGridValue(0.2, 0.2);
+  circuit.SetRowHeight(1.2);
+
+  circuit.AddBlockType("INV", 0.6, 1.2);
+  circuit.AddBlockType("B5", 1.0, 1.2);
+  circuit.AddBlockType("B10", 2.0, 1.2);
+  circuit.AddBlockType("B20T", 4.0, 2.4);
+  circuit.AddBlockType("B50", 10.0, 1.2);
+  circuit.AddBlockType("B200", 40.0, 1.2);
+
+  circuit.SetUnitsDistanceMicrons(2000);
+  circuit.SetDieArea(0, 0, 80000, 12000);
+  circuit.SetListCapacity(24, 0, 0);
+  int id = 0;
+  for (int x : {0, 20, 50, 60, 80, 92}) {
+    circuit.AddBlock("f" + std::to_string(id++), "B10", x, 0, FIXED, N);
+  }
+  circuit.AddBlock("f" + std::to_string(id++), "B50", 150, 0, FIXED, N);
+  circuit.AddBlock("f" + std::to_string(id++), "B20T", 40, 6, FIXED, N);
+  for (int x = 10; x <= 190; x += 15) {
+    circuit.AddBlock("f" + std::to_string(id++), "B5", x, 18, FIXED, N);
+  }
+  circuit.AddBlock("f" + std::to_string(id++), "B200", 0, 24, FIXED, N);
+  circuit.AddBlock("u0", "INV", 100, 6, PLACED, N);
+}
+
+bool IsSameSegments(
+    WhiteSpaceLegalizer const &legalizer,
+    int row,
+    std::vector<SegI> const &expected
+) {
+  auto &segments = legalizer.RowSegments(row);
+  bool is_same = segments.size() == expected.size();
+  for (size_t i = 0; is_same && i < segments.size(); ++i) {
+    is_same = segments[i].lo == expected[i].lo
+        && segments[i].hi == expected[i].hi;
+  }
+  if (!is_same) {
+    BOOST_LOG_TRIVIAL(info) << "unexpected white space in row " << row << ":";
+    for (auto &seg : segments) {
+      BOOST_LOG_TRIVIAL(info) << " [" << seg.lo << ", " << seg.hi << "]";
+    }
+    BOOST_LOG_TRIVIAL(info) << "\n";
+  }
+  return is_same;
+}
+
+struct FitQuery {
+  int x; // lo_x of FirstFitLocLeft(), or hi_x of LastFitLocRight()
+  int width;
+  int lo_row;
+  int hi_row;
+  int expected;
+};
+
+struct ClosestQuery {
+  int row;
+  int lo_x;
+  int hi_x;
+  int expected_id;
+  int expected_distance;
+};
+
+bool IsFirstFitLocLeftCorrect(WhiteSpaceLegalizer const &legalizer) {
+  std::vector<FitQuery> queries = {
+      {0, 8, 0, 0, 10}, // the left end of the row is blocked
+      {15, 8, 0, 0, 30}, // does not fit in the rest of [10, 20]
+      {45, 8, 0, 0, 70}, // skips the merged blockage [50, 70]
+      {75, 8, 0, 0, 102}, // skips [80, 102], the gap [90, 92] is dropped
+      {142, 8, 0, 0, 142}, // fits exactly at the end of the last segment
+      {145, 8, 0, 0, -1}, // the right end of the row is blocked
+      {0, 60, 0, 0, -1}, // wider than every segment
+      {35, 10, 1, 2, 60}, // rows blocked by the same two-row block
+      {35, 10, 0, 2, 70}, // row 0 moves x after rows 1 and 2 do
+      {12, 4, 3, 3, 15}, // rows with many segments use binary search
+      {22, 4, 3, 3, 30},
+      {196, 4, 3, 3, 196}, // the last segment of row 3
+      {197, 4, 3, 3, -1},
+      {0, 3, 4, 4, -1}, // a row without white space
+      {0, 3, 3, 4, -1},
+  };
+  bool is_correct = true;
+  for (auto &q : queries) {
+    int x = legalizer.FirstFitLocLeft(q.x, q.width, q.lo_row, q.hi_row, -1);
+    if (x != q.expected) {
+      BOOST_LOG_TRIVIAL(info)
+        << "FirstFitLocLeft(" << q.x << ", " << q.width << ", " << q.lo_row
+        << ", " << q.hi_row << ") returns " << x << ", expected "
+        << q.expected << "\n";
+      is_correct = false;
+    }
+  }
+  return is_correct;
+}
+
+bool IsLastFitLocRightCorrect(WhiteSpaceLegalizer const &legalizer) {
+  std::vector<FitQuery> queries = {
+      {200, 8, 0, 0, 150}, // the right end of the row is blocked
+      {110, 8, 0, 0, 110}, // fits exactly at the start of [102, 150]
+      {105, 8, 0, 0, 80}, // skips [80, 102], the gap [90, 92] is dropped
+      {25, 8, 0, 0, 20},
+      {15, 8, 0, 0, -1}, // the left end of the row is blocked
+      {40, 12, 0, 0, -1}, // no segment on the left is wide enough
+      {65, 10, 1, 2, 40}, // rows blocked by the same two-row block
+      {200, 4, 3, 3, 200}, // rows with many segments use binary search
+      {199, 5, 3, 3, 190},
+      {4, 5, 3, 3, -1},
+      {200, 3, 4, 4, -1}, // a row without white space
+  };
+  bool is_correct = true;
+  for (auto &q : queries) {
+    int x = legalizer.LastFitLocRight(q.x, q.width, q.lo_row, q.hi_row, -1);
+    if (x != q.expected) {
+      BOOST_LOG_TRIVIAL(info)
+        << "LastFitLocRight(" << q.x << ", " << q.width << ", " << q.lo_row
+        << ", " << q.hi_row << ") returns " << x << ", expected "
+        << q.expected << "\n";
+      is_correct = false;
+    }
+  }
+  return is_correct;
+}
+
+bool IsClosestSegmentCorrect(WhiteSpaceLegalizer const &legalizer) {
+  std::vector<ClosestQuery> queries = {
+      {0, 12, 18, 0, 0}, // covered by a segment
+      {0, 0, 5, 0, 15}, // before the first segment
+      {0, 21, 28, 0, 9}, // between two segments, closer to the left one
+      {0, 22, 28, 0, 10}, // a tie goes to the left segment
+      {0, 23, 28, 1, 9},
+      {0, 45, 55, 1, 10}, // overlaps with a segment without being covered
+      {0, 160, 170, 3, 30}, // after the last segment
+      {1, 50, 55, 1, 15}, // inside the two-row block
+      {3, 186, 194, 12, 8}, // rows with many segments use binary search
+      {3, 196, 199, 13, 0}, // the last segment
+      {3, 0, 4, 0, 0}, // the first segment
+      {4, 10, 20, -1, INT_MAX}, // a row without white space
+  };
+  bool is_correct = true;
+  for (auto &q : queries) {
+    int distance = -1;
+    int id = legalizer.ClosestSegment(q.row, q.lo_x, q.hi_x, distance);
+    if (id != q.expected_id || distance != q.expected_distance) {
+      BOOST_LOG_TRIVIAL(info)
+        << "ClosestSegment(" << q.row << ", " << q.lo_x << ", " << q.hi_x
+        << ") returns " << id << " at distance " << distance << ", expected "
+        << q.expected_id << " at distance " << q.expected_distance << "\n";
+      is_correct = false;
+    }
+  }
+  return is_correct;
+}
+
+/****
+ * @brief Testcase for white space queries of LGTetrisEx:
+ * LGTetrisEx::FirstFitLocLeft(), LGTetrisEx::LastFitLocRight() and
+ * LGTetrisEx::ClosestSegment().
+ *
+ * This testcase shows that
+ * 1. white space segments exclude fixed blocks, abutting blocks are merged,
+ *    and gaps narrower than the narrowest cell are dropped
+ * 2. each query returns the expected location or segment, for segments at
+ *    both ends of a row, queries spanning several rows, rows searched
+ *    linearly and by binary search, and a row without white space
+ *
+ * @return 0 if this test is passed, 1 if failed
+ */
+int main() {
+  InitLogging("", boost::log::trivial::info, true);
+  Circuit circuit;
+  BuildCircuit(circuit);
+  WhiteSpaceLegalizer legalizer;
+  legalizer.SetInputCircuit(&circuit);
+  legalizer.InitLegalizer();
+
+  bool is_passed = true;
+  is_passed = IsSameSegments(
+      legalizer, 0, {SegI(10, 20), SegI(30, 50), SegI(70, 80), SegI(102, 150)}
+  ) && is_passed;
+  is_passed = IsSameSegments(
+      legalizer, 1, {SegI(0, 40), SegI(60, 200)}
+  ) && is_passed;
+  is_passed = IsSameSegments(
+      legalizer, 2, {SegI(0, 40), SegI(60, 200)}
+  ) && is_passed;
+  std::vector<SegI> row3_segments = {SegI(0, 10)};
+  for (int x = 15; x < 195; x += 15) {
+    row3_segments.emplace_back(x, x + 10);
+  }
+  row3_segments.emplace_back(195, 200);
+  is_passed = IsSameSegments(legalizer, 3, row3_segments) && is_passed;
+  is_passed = IsSameSegments(legalizer, 4, {}) && is_passed;
+
+  is_passed = IsFirstFitLocLeftCorrect(legalizer) && is_passed;
+  is_passed = IsLastFitLocRightCorrect(legalizer) && is_passed;
+  is_passed = IsClosestSegmentCorrect(legalizer) && is_passed;
+
+  if (is_passed) {
+    return SUCCESS;
+  }
+  return FAIL;
+}